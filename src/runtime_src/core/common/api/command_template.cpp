@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2020, Xilinx Inc - All rights reserved
+ * Xilinx Runtime (XRT) Experimental APIs
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+#define XRT_CORE_COMMON_SOURCE // in same dll as core_common
+
+#include "command_template.h"
+#include "core/include/ert_fa.h"
+
+namespace xrt_core { namespace command_template {
+
+std::vector<uint32_t>
+build(const std::bitset<128>& cumask, size_t num_cumasks, size_t regmap_size,
+      const fa_desc* fa)
+{
+  std::vector<uint32_t> tmpl(1 + num_cumasks + regmap_size, 0);
+  auto kcmd = reinterpret_cast<ert_start_kernel_cmd*>(tmpl.data());
+  kcmd->extra_cu_masks = num_cumasks - 1;  //  -1 for mandatory mask
+  kcmd->count = num_cumasks + regmap_size;
+  kcmd->opcode = fa ? ERT_START_FA : ERT_START_CU;
+  kcmd->type = ERT_CU;
+
+  // cu_mask is immediately followed by the extra cu masks
+  auto masks = &kcmd->cu_mask;
+  for (size_t mask_idx = 0; mask_idx < num_cumasks; ++mask_idx) {
+    for (size_t bit = 0; bit < 32; ++bit)
+      if (cumask.test(mask_idx * 32 + bit))
+        masks[mask_idx] |= (1u << bit);
+  }
+
+  if (!fa)
+    return tmpl;
+
+  auto data = masks + num_cumasks;
+  auto desc = reinterpret_cast<ert_fa_descriptor*>(data);
+  desc->status = ERT_FA_ISSUED; // somewhat misleading
+  desc->num_input_entries = fa->num_inputs;
+  desc->input_entry_bytes = fa->input_entry_bytes;
+  desc->num_output_entries = fa->num_outputs;
+  desc->output_entry_bytes = fa->output_entry_bytes;
+  for (auto& arg : fa->args) {
+    auto desc_entry = reinterpret_cast<ert_fa_desc_entry*>(desc->data + arg.desc_offset / sizeof(uint32_t));
+    desc_entry->arg_offset = arg.offset;
+    desc_entry->arg_size = arg.size;
+  }
+  return tmpl;
+}
+
+size_t
+fa_payload_offset(size_t desc_offset)
+{
+  return (sizeof(ert_fa_descriptor) + desc_offset + sizeof(ert_fa_desc_entry)) / sizeof(uint32_t);
+}
+
+}} // command_template, xrt_core
@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2020, Xilinx Inc - All rights reserved
+ * Xilinx Runtime (XRT) Experimental APIs
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef _XRT_COMMON_COMMAND_TEMPLATE_H_
+#define _XRT_COMMON_COMMAND_TEMPLATE_H_
+
+// This file defines the kernel start command packet that is computed
+// once per kernel and copied into the exec buffer of each run (see
+// xrt_kernel.cpp).  It is separate from xrt_kernel.cpp so that the
+// packet layout can be tested without a device, see
+// tests/xrt_kernel_cmd.
+//
+// The template removes the per run command initialization (header,
+// cu masks, fast adapter descriptor).  Setting an argument value was
+// already a copy to a fixed location in the payload, so it costs the
+// same as before; tests/xrt_kernel_cmd measures 0.8x-1.1x for
+// set_arg versus 35x-65x for run construction.
+#include "core/include/ert.h"
+
+#include <algorithm>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace xrt_core { namespace command_template {
+
+// Fast adapter descriptor entry of one kernel argument
+struct fa_arg
+{
+  size_t desc_offset; // byte offset of entry in descriptor data
+  size_t offset;      // argument offset in CU register map
+  size_t size;        // argument size in bytes
+};
+
+// Static part of a fast adapter descriptor (see ert_fa.h)
+struct fa_desc
+{
+  size_t num_inputs = 0;
+  size_t num_outputs = 0;
+  size_t input_entry_bytes = 0;
+  size_t output_entry_bytes = 0;
+  std::vector<fa_arg> args;
+};
+
+/**
+ * build() - Build command packet shared by all runs of a kernel
+ *
+ * @cumask:       Compute units the kernel can execute on
+ * @num_cumasks:  Number of 32 bit cu masks in the packet
+ * @regmap_size:  Number of payload words after the cu masks
+ * @fa:           Fast adapter descriptor, nullptr for other protocols
+ * Return:        Packet words, the header is the first word
+ *
+ * For FAST_ADAPTER the payload is the fa descriptor with its static
+ * fields and the static fields of every descriptor entry filled in.
+ */
+std::vector<uint32_t>
+build(const std::bitset<128>& cumask, size_t num_cumasks, size_t regmap_size,
+      const fa_desc* fa);
+
+/**
+ * fa_payload_offset() - Payload word offset of a fast adapter argument value
+ *
+ * @desc_offset:  Byte offset of argument entry in descriptor data
+ */
+size_t
+fa_payload_offset(size_t desc_offset);
+
+/**
+ * initialize() - Initialize command packet from template
+ *
+ * @tmpl:   Template from build()
+ * @kcmd:   Command packet of a run, at least tmpl.size() words
+ * Return:  Payload of the command after the cu masks
+ */
+inline uint32_t*
+initialize(const std::vector<uint32_t>& tmpl, ert_start_kernel_cmd* kcmd)
+{
+  std::copy(tmpl.begin(), tmpl.end(), &kcmd->header);
+  return kcmd->data + kcmd->extra_cu_masks;
+}
+
+/**
+ * set_payload() - Copy argument value to its location in payload
+ *
+ * @data:         Payload returned by initialize()
+ * @offset:       Word offset of argument value in payload
+ * @words:        Number of words of argument value in payload
+ * @value:        Argument value
+ * @value_words:  Number of words in @value
+ */
+inline void
+set_payload(uint32_t* data, size_t offset, size_t words,
+            const uint32_t* value, size_t value_words)
+{
+  std::copy_n(value, std::min(words, value_words), data + offset);
+}
+
+}} // command_template, xrt_core
+
+#endif
@@ -20,6 +20,7 @@
 
 // This file defines implementation extensions to the XRT BO APIs.
 #include "core/include/experimental/xrt_enqueue.h"
+#include <exception>
 
 namespace xrt_core { namespace enqueue {
 
@@ -27,6 +28,11 @@ namespace xrt_core { namespace enqueue {
 void
 done(xrt::event_impl* ev);
 
+// Callback to notify event of failed completion.  The exception
+// is rethrown when the event is waited on.
+void
+done(xrt::event_impl* ev, std::exception_ptr eptr);
+
 } // event
   
 }
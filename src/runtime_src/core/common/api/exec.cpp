@@ -93,6 +93,15 @@ schedule(command* cmd)
     sws::schedule(cmd);
 }
 
+void
+schedule(command** cmds, size_t count)
+{
+  if (kds_enabled())
+    kds::schedule(cmds, count);
+  else
+    sws::schedule(cmds, count);
+}
+
 void
 init(xrt_core::device* device)
 {
@@ -19,6 +19,9 @@
 
 #include <vector>
 #include <memory>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
 
 namespace xrt_core {
 
@@ -33,6 +36,9 @@ namespace sws {
 void
 schedule(command* cmd);
 
+void
+schedule(command** cmds, size_t count);
+
 void
 start();
 
@@ -42,6 +48,17 @@ stop();
 void
 init(xrt_core::device* device);
 
+/**
+ * get_cu_latency_histogram() - Get CU execution time histogram
+ *
+ * Bucket i counts commands whose observed execution time was in
+ * the range [2^i-1, 2^(i+1)-1) microseconds.  The histograms are
+ * also logged when sws is stopped with Runtime.adaptive_polling.
+ * See tests/sws_adaptive_polling.
+ */
+std::vector<uint64_t>
+get_cu_latency_histogram(const xrt_core::device* device, unsigned int cuidx);
+
 } // sws
 
 /**
@@ -52,6 +69,9 @@ namespace kds {
 void
 schedule(command* cmd);
 
+void
+schedule(command** cmds, size_t count);
+
 void
 start();
 
@@ -64,12 +84,51 @@ init(xrt_core::device* device);
 } // kds
 
 namespace exec {
+
+/**
+ * class schedule_error - Failure to submit a batch of commands
+ *
+ * Commands [0, submitted()) of the batch were submitted and will
+ * complete normally.  The remaining commands were not submitted,
+ * their state is set to ERT_CMD_STATE_ABORT and they are notified,
+ * so waiting for them returns.
+ */
+class schedule_error : public std::runtime_error
+{
+  size_t m_submitted;
+public:
+  schedule_error(size_t submitted, const std::string& what)
+    : std::runtime_error(what), m_submitted(submitted)
+  {}
+
+  size_t
+  submitted() const
+  {
+    return m_submitted;
+  }
+};
+
 /**
  * Schedule a command for execution on either sws or mbs
+ *
+ * If the command cannot be submitted it is aborted and notified
+ * before the exception is propagated.
  */
 void
 schedule(command* cmd);
 
+/**
+ * Schedule a batch of commands for execution on either sws or mbs
+ *
+ * Commands may be for different devices.  The scheduler data
+ * structures are updated once for each run of consecutive commands
+ * for the same device.
+ *
+ * Throws schedule_error if not all commands could be submitted.
+ */
+void
+schedule(command** cmds, size_t count);
+
 void
 start();
 
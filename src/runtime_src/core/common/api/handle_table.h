@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2020, Xilinx Inc - All rights reserved
+ * Xilinx Runtime (XRT) Experimental APIs
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef _XRT_COMMON_HANDLE_TABLE_H_
+#define _XRT_COMMON_HANDLE_TABLE_H_
+
+// This file defines the table used by C API implementations to map
+// opaque handles to implementation objects.
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+namespace xrt_core {
+
+// class handle_table - concurrent map from opaque handle to object
+//
+// C API handles are addresses of objects, so the table is split into
+// shards selected by the handle address, each shard protected by its
+// own mutex.  Threads operating on different handles rarely contend
+// on the same shard and no lookup takes a table wide lock.
+//
+// Pointers returned by find() remain valid until the handle is
+// erased.  As with the C APIs, it is undefined behavior to close a
+// handle while it is used by another thread.
+template <typename HandleType, typename ValueType, size_t num_shards = 64>
+class handle_table
+{
+  // Each shard on its own cache line to avoid false sharing
+  struct alignas(64) shard
+  {
+    std::mutex mutex;
+    std::unordered_map<HandleType, ValueType> map;
+  };
+
+  std::array<shard, num_shards> m_shards;
+
+  shard&
+  get_shard(HandleType handle)
+  {
+    // handles are addresses of heap objects, the low order bits are
+    // mostly zero, fold in higher order bits
+    auto addr = reinterpret_cast<uintptr_t>(handle);
+    return m_shards[((addr >> 4) ^ (addr >> 12)) % num_shards];
+  }
+
+public:
+  // emplace() - add handle and its value
+  void
+  emplace(HandleType handle, ValueType value)
+  {
+    auto& s = get_shard(handle);
+    std::lock_guard<std::mutex> lk(s.mutex);
+    s.map.emplace(handle, std::move(value));
+  }
+
+  // find() - pointer to the value of handle or nullptr if not found
+  ValueType*
+  find(HandleType handle)
+  {
+    auto& s = get_shard(handle);
+    std::lock_guard<std::mutex> lk(s.mutex);
+    auto itr = s.map.find(handle);
+    return (itr != s.map.end()) ? &(*itr).second : nullptr;
+  }
+
+  // get() - copy of the value of handle or default value if not found
+  ValueType
+  get(HandleType handle)
+  {
+    auto& s = get_shard(handle);
+    std::lock_guard<std::mutex> lk(s.mutex);
+    auto itr = s.map.find(handle);
+    return (itr != s.map.end()) ? (*itr).second : ValueType{};
+  }
+
+  // update() - call function with value of handle while holding the
+  // shard lock, the value is default constructed if not found
+  template <typename Function>
+  void
+  update(HandleType handle, Function&& fcn)
+  {
+    auto& s = get_shard(handle);
+    std::lock_guard<std::mutex> lk(s.mutex);
+    fcn(s.map[handle]);
+  }
+
+  // erase() - remove handle, return true if it was found
+  //
+  // The value is destructed after the shard lock is released, since
+  // destruction may close other handles in the same table.
+  bool
+  erase(HandleType handle)
+  {
+    ValueType value;
+    {
+      auto& s = get_shard(handle);
+      std::lock_guard<std::mutex> lk(s.mutex);
+      auto itr = s.map.find(handle);
+      if (itr == s.map.end())
+        return false;
+      value = std::move((*itr).second);
+      s.map.erase(itr);
+    }
+    return true;
+  }
+};
+
+} // xrt_core
+
+#endif
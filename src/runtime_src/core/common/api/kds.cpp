@@ -29,23 +29,54 @@
 #include <thread>
 #include <mutex>
 #include <condition_variable>
-#include <list>
+#include <deque>
+#include <vector>
 #include <map>
 
 namespace {
 
 using command_queue_type = std::vector<xrt_core::command*>;
+using cu_queue_type = std::deque<xrt_core::command*>;
+
+// Max number of CUs addressable by cu masks in an ERT packet
+constexpr size_t max_cus = 128;
+
+////////////////////////////////////////////////////////////////
+// Command monitor for one device.
+//
+// Commands that target exactly one CU complete in the order they
+// were submitted to that CU, so they are indexed per CU and the
+// monitor only needs to check the head of each CU queue when
+// exec_wait reports a completion.  Commands that can run on any of
+// several CUs, or that are not CU commands at all, may complete out
+// of order and are kept in a list that is swept in full.
+//
+// All state is protected by the per device mutex, so commands
+// submitted to different devices do not contend.
+////////////////////////////////////////////////////////////////
+struct device_monitor
+{
+  std::mutex mutex;
+  std::condition_variable work;
+  std::vector<cu_queue_type> cu_cmds;  // in-order completion per CU
+  command_queue_type unordered_cmds;   // swept on every wakeup
+  size_t outstanding = 0;              // total number of submitted commands
+  size_t cu_hwm = 0;                   // one past highest CU index used
+  std::thread thread;
+
+  device_monitor()
+    : cu_cmds(max_cus)
+  {}
+};
 
 ////////////////////////////////////////////////////////////////
 // Main command monitor interfacing to embedded MB scheduler
 ////////////////////////////////////////////////////////////////
 static std::mutex s_mutex;
-static std::condition_variable s_work;
 static bool s_running = false;
 static bool s_stop = false;
 static std::exception_ptr s_exception;
-static std::map<const xrt_core::device*, command_queue_type> s_device_cmds;
-static std::map<const xrt_core::device*, std::thread> s_device_monitor_threads;
+static std::map<const xrt_core::device*, std::unique_ptr<device_monitor>> s_device_monitors;
 
 inline ert_cmd_state
 get_command_state(xrt_core::command* cmd)
@@ -60,6 +91,43 @@ completed(xrt_core::command* cmd)
   return (get_command_state(cmd) >= ERT_CMD_STATE_COMPLETED);
 }
 
+// Get the index of the single CU targeted by a command, or -1 if the
+// command is not a CU command or can execute on more than one CU.
+static int
+get_cu_index(xrt_core::command* cmd)
+{
+  auto epacket = cmd->get_ert_packet();
+  if (epacket->opcode != ERT_START_CU && epacket->opcode != ERT_EXEC_WRITE)
+    return -1;
+
+  auto skcmd = reinterpret_cast<const ert_start_kernel_cmd*>(epacket);
+  unsigned int masks = 1 + skcmd->extra_cu_masks;
+  const uint32_t* cumasks = &skcmd->cu_mask;
+  int cuidx = -1;
+  for (unsigned int m = 0; m < masks; ++m) {
+    auto mask = cumasks[m];
+    if (!mask)
+      continue;
+    if (cuidx != -1 || (mask & (mask - 1)))
+      return -1;  // more than one CU
+    int bit = 0;
+    while (!(mask & 1)) {
+      mask >>= 1;
+      ++bit;
+    }
+    cuidx = static_cast<int>(m * 32) + bit;
+  }
+  return cuidx;
+}
+
+static device_monitor*
+get_monitor(const xrt_core::device* device)
+{
+  // safe since inserted in init
+  auto itr = s_device_monitors.find(device);
+  return itr->second.get();
+}
+
 static void
 notify_host(xrt_core::command* cmd)
 {
@@ -70,22 +138,65 @@ notify_host(xrt_core::command* cmd)
   cmd->notify(state);
 }
 
+// Store command so completion can be tracked.
+// Must be called with monitor mutex locked.
+static void
+add_command(device_monitor* monitor, xrt_core::command* cmd)
+{
+  auto cuidx = get_cu_index(cmd);
+  if (cuidx >= 0) {
+    monitor->cu_cmds[cuidx].push_back(cmd);
+    monitor->cu_hwm = std::max(monitor->cu_hwm, static_cast<size_t>(cuidx + 1));
+  }
+  else {
+    monitor->unordered_cmds.push_back(cmd);
+  }
+  if (monitor->outstanding++ == 0)
+    monitor->work.notify_all();
+}
+
+// Remove a command that failed submission, other threads may have
+// submitted commands since this one was stored.
+// Must be called with monitor mutex locked.
+static void
+remove_command(device_monitor* monitor, xrt_core::command* cmd)
+{
+  assert(get_command_state(cmd)==ERT_CMD_STATE_NEW);
+  auto cuidx = get_cu_index(cmd);
+  if (cuidx >= 0) {
+    auto& cmds = monitor->cu_cmds[cuidx];
+    cmds.erase(std::find(cmds.rbegin(), cmds.rend(), cmd).base() - 1);
+  }
+  else {
+    auto& cmds = monitor->unordered_cmds;
+    cmds.erase(std::find(cmds.rbegin(), cmds.rend(), cmd).base() - 1);
+  }
+  --monitor->outstanding;
+}
+
+// Abort a command that was not submitted.  The command is notified
+// so that waiters return and the command can be started again.
+static void
+abort_command(xrt_core::command* cmd)
+{
+  XRT_DEBUGF("xrt_core::kds::command(%d), [new->abort]\n", cmd->get_uid());
+  cmd->get_ert_packet()->state = ERT_CMD_STATE_ABORT;
+  notify_host(cmd);
+}
+
 static void
 launch(xrt_core::command* cmd)
 {
   XRT_DEBUGF("xrt_core::kds::command(%d) [new->submitted->running]\n", cmd->get_uid());
 
   auto device = cmd->get_device();
-  auto& submitted_cmds = s_device_cmds[device]; // safe since inserted in init
-
-  command_queue_type::const_iterator pos;
+  auto monitor = get_monitor(device);
 
   // Store command so completion can be tracked.  Make sure this is
   // done prior to exec_buf as exec_wait can otherwise be missed.
   {
-    std::lock_guard<std::mutex> lk(s_mutex);
-    submitted_cmds.push_back(cmd);
-    s_work.notify_all();
+    std::lock_guard<std::mutex> lk(monitor->mutex);
+    add_command(monitor, cmd);
   }
 
   // Submit the command
@@ -94,34 +205,104 @@ launch(xrt_core::command* cmd)
   }
   catch (...) {
     // Remove the pending command
-    std::lock_guard<std::mutex> lk(s_mutex);
-    assert(get_command_state(cmd)==ERT_CMD_STATE_NEW);
-    submitted_cmds.pop_back();
+    {
+      std::lock_guard<std::mutex> lk(monitor->mutex);
+      remove_command(monitor, cmd);
+    }
+    abort_command(cmd);
     throw;
   }
 }
 
+// Launch count commands that are all for the same device
+// Throws schedule_error with the number of submitted commands if
+// exec_buf fails, the commands that were not submitted are aborted.
+static void
+launch(xrt_core::command** cmds, size_t count)
+{
+  auto device = cmds[0]->get_device();
+  auto monitor = get_monitor(device);
+
+  // Store all commands with one lock
+  {
+    std::lock_guard<std::mutex> lk(monitor->mutex);
+    for (size_t idx = 0; idx < count; ++idx) {
+      XRT_DEBUGF("xrt_core::kds::command(%d) [new->submitted->running]\n", cmds[idx]->get_uid());
+      add_command(monitor, cmds[idx]);
+    }
+  }
+
+  // Submit the commands, the shim has no multi-command exec_buf
+  size_t submitted = 0;
+  try {
+    for (; submitted < count; ++submitted)
+      device->exec_buf(cmds[submitted]->get_exec_bo());
+  }
+  catch (const std::exception& ex) {
+    // Remove the commands that were not submitted
+    {
+      std::lock_guard<std::mutex> lk(monitor->mutex);
+      for (size_t idx = submitted; idx < count; ++idx)
+        remove_command(monitor, cmds[idx]);
+    }
+    for (size_t idx = submitted; idx < count; ++idx)
+      abort_command(cmds[idx]);
+    throw xrt_core::exec::schedule_error(submitted, ex.what());
+  }
+}
+
+// Move completed commands from monitor queues to completed_cmds.
+// Must be called with monitor mutex locked.
+static void
+collect_completed(device_monitor* monitor, command_queue_type& completed_cmds)
+{
+  // Per CU queues complete in order, only heads need checking
+  for (size_t cuidx = 0; cuidx < monitor->cu_hwm; ++cuidx) {
+    auto& cmds = monitor->cu_cmds[cuidx];
+    while (!cmds.empty() && completed(cmds.front())) {
+      completed_cmds.push_back(cmds.front());
+      cmds.pop_front();
+    }
+  }
+
+  // Commands without an ordering guarantee
+  auto& cmds = monitor->unordered_cmds;
+  auto size = cmds.size();
+  for (size_t idx=0; idx<size; ++idx) {
+    auto cmd = cmds[idx];
+    if (!completed(cmd))
+      continue;
+
+    completed_cmds.push_back(cmd);
+    auto last = cmds.back();
+    if (last != cmd)
+      cmds[idx--] = last;
+    cmds.pop_back();
+    --size;
+  }
+
+  monitor->outstanding -= completed_cmds.size();
+}
+
 static void
-monitor_loop(const xrt_core::device* device)
+monitor_loop(const xrt_core::device* device, device_monitor* monitor)
 {
   unsigned long loops = 0;           // number of outer loops
   unsigned long sleeps = 0;          // number of sleeps
 
-  // thread safe access, since guaranteed to be inserted in init
-  auto& submitted_cmds = s_device_cmds[device];
-  std::vector<xrt_core::command*> completed_cmds;
+  command_queue_type completed_cmds;
 
   while (1) {
     ++loops;
 
     {
       {
-        std::unique_lock<std::mutex> lk(s_mutex);
+        std::unique_lock<std::mutex> lk(monitor->mutex);
 
         // Larger wait
-        while (!s_stop && submitted_cmds.empty()) {
+        while (!s_stop && !monitor->outstanding) {
           ++sleeps;
-          s_work.wait(lk);
+          monitor->work.wait(lk);
         }
       }
 
@@ -132,20 +313,8 @@ monitor_loop(const xrt_core::device* device)
       while (device->exec_wait(1000)==0) {}
 
       {
-        std::lock_guard<std::mutex> lk(s_mutex);
-        auto size = submitted_cmds.size();
-        for (size_t idx=0; idx<size; ++idx) {
-          auto cmd = submitted_cmds[idx];
-          if (!completed(cmd))
-            continue;
-
-          completed_cmds.push_back(cmd);
-          auto last = submitted_cmds.back();
-          if (last != cmd)
-            submitted_cmds[idx--] = last;
-          submitted_cmds.pop_back();
-          --size;
-        }
+        std::lock_guard<std::mutex> lk(monitor->mutex);
+        collect_completed(monitor, completed_cmds);
       }
 
       // Notify host outside lock
@@ -158,10 +327,10 @@ monitor_loop(const xrt_core::device* device)
 
 
 static void
-monitor(const xrt_core::device* device)
+monitor(const xrt_core::device* device, device_monitor* monitor)
 {
   try {
-    monitor_loop(device);
+    monitor_loop(device, monitor);
   }
   catch (const std::exception& ex) {
     std::string msg = std::string("kds command monitor died unexpectedly: ") + ex.what();
@@ -185,6 +354,27 @@ schedule(xrt_core::command* cmd)
   return launch(cmd);
 }
 
+void
+schedule(xrt_core::command** cmds, size_t count)
+{
+  // launch each run of consecutive commands for same device
+  size_t first = 0;
+  for (size_t idx = 1; idx <= count; ++idx) {
+    if (idx == count || cmds[idx]->get_device() != cmds[first]->get_device()) {
+      try {
+        launch(cmds + first, idx - first);
+      }
+      catch (const xrt_core::exec::schedule_error& ex) {
+        // commands for later devices were never launched
+        for (; idx < count; ++idx)
+          abort_command(cmds[idx]);
+        throw xrt_core::exec::schedule_error(first + ex.submitted(), ex.what());
+      }
+      first = idx;
+    }
+  }
+}
+
 void
 start()
 {
@@ -206,9 +396,17 @@ stop()
     s_stop = true;
   }
 
-  s_work.notify_all();
-  for (auto& e : s_device_monitor_threads)
-    e.second.join();
+  for (auto& e : s_device_monitors) {
+    auto monitor = e.second.get();
+    {
+      // synchronize with monitor thread's wait predicate
+      std::lock_guard<std::mutex> lk(monitor->mutex);
+    }
+    monitor->work.notify_all();
+  }
+
+  for (auto& e : s_device_monitors)
+    e.second->thread.join();
 
   s_running = false;
 }
@@ -219,11 +417,11 @@ init(xrt_core::device* device)
   // create a submitted command queue for this device if necessary,
   // create a command monitor thread for this device if necessary
   std::lock_guard<std::mutex> lk(s_mutex);
-  auto itr = s_device_monitor_threads.find(device);
-  if (itr==s_device_monitor_threads.end()) {
+  auto itr = s_device_monitors.find(device);
+  if (itr==s_device_monitors.end()) {
     XRT_DEBUGF("creating monitor thread and queue for device\n");
-    s_device_cmds.emplace(device,command_queue_type());
-    s_device_monitor_threads.emplace(device,xrt_core::thread(::monitor,device));
+    auto monitor = s_device_monitors.emplace(device,std::make_unique<device_monitor>()).first->second.get();
+    monitor->thread = xrt_core::thread(::monitor,device,monitor);
   }
 }
 
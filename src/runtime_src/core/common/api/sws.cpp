@@ -27,17 +27,23 @@
 #include "ert.h"
 #include "xclbin.h"
 #include "core/common/device.h"
+#include "core/common/config_reader.h"
 #include "core/common/debug.h"
+#include "core/common/message.h"
 #include "core/common/task.h"
 #include "core/common/thread.h"
 #include "core/common/xclbin_parser.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
 #include <limits>
 #include <bitset>
 #include <vector>
-#include <list>
+#include <atomic>
 #include <map>
 #include <mutex>
 #include <condition_variable>
+#include <thread>
 #include <cstring>
 
 #ifdef _WIN32
@@ -69,6 +75,8 @@ using size_type   = uint32_t;
 using addr_type   = uint32_t;
 using value_type  = uint32_t;
 using cmd_ptr     = xrt_core::command*;
+using clock_type  = std::chrono::steady_clock;
+using time_type   = clock_type::time_point;
 
 ////////////////////////////////////////////////////////////////
 // Constants
@@ -80,6 +88,15 @@ const size_type no_index = std::numeric_limits<size_type>::max();
 
 const size_type MAX_SLOTS = 128;
 
+// Number of log2 buckets in CU latency histogram
+const size_type HISTOGRAM_BUCKETS = 32;
+
+// Adaptive polling spins when a completion is predicted within this window
+const std::chrono::microseconds SPIN_WINDOW {20};
+
+// Adaptive polling never sleeps longer than this between polls
+const std::chrono::microseconds MAX_SLEEP {1000};
+
 // FFA  handling
 const value_type AP_START    = 0x1;
 const value_type AP_DONE     = 0x2;
@@ -114,6 +131,8 @@ class exec_core;
 // @m_state: current state of this command
 // @slotidx: command queue slot when command is submitted
 // @cuidx: index of CU executing this command
+// @start_time: time when command was started on CU
+// @next: intrusive link used by submission list and command queue
 ////////////////////////////////////////////////////////////////
 class xocl_cmd
 {
@@ -132,6 +151,8 @@ private:
 public:
   size_type slotidx = no_index;
   size_type cuidx = no_index;
+  time_type start_time;
+  xocl_cmd* next = nullptr;
 
   xocl_cmd(exec_core* ec, cmd_ptr cmd)
     : m_cmd(cmd), m_ecmd(m_cmd->get_ert_packet()), m_exec(ec), m_state(ERT_CMD_STATE_NEW)
@@ -277,28 +298,62 @@ public:
   {
     return m_exec;
   }
-
-  // Create a command object
-  static std::shared_ptr<xocl_cmd>
-  create(exec_core* ec, cmd_ptr cmd)
-  {
-    return std::make_shared<xocl_cmd>(ec,cmd);
-  }
 };
 
-using xcmd_ptr = std::shared_ptr<xocl_cmd>;
-
 ////////////////////////////////////////////////////////////////
-// List of new pending xocl_cmd objects
+// class cmd_queue: intrusive fifo of xocl_cmd objects
 //
-// @s_pending_cmds: populated from user space with new commands for buffer objects
-// @s_num_pending: number of pending commands
-//
-// Scheduler copies pending commands to its private queue when necessary
+// Commands are linked through xocl_cmd::next, so queue operations
+// never allocate.  Not thread safe, the queue is owned by the
+// scheduler thread.
 ////////////////////////////////////////////////////////////////
-static std::vector<xcmd_ptr> s_pending_cmds;
-static std::mutex s_pending_mutex;
-static std::atomic<unsigned int> s_num_pending {0};
+class cmd_queue
+{
+  xocl_cmd* m_head = nullptr;
+  xocl_cmd* m_tail = nullptr;
+
+public:
+  bool
+  empty() const
+  {
+    return m_head == nullptr;
+  }
+
+  xocl_cmd*
+  front() const
+  {
+    return m_head;
+  }
+
+  void
+  push_back(xocl_cmd* xcmd)
+  {
+    xcmd->next = nullptr;
+    if (m_tail)
+      m_tail->next = xcmd;
+    else
+      m_head = xcmd;
+    m_tail = xcmd;
+  }
+
+  // Unlink xcmd which follows prev (nullptr if xcmd is the head)
+  //
+  // @return
+  //  The command that followed xcmd
+  xocl_cmd*
+  erase(xocl_cmd* prev, xocl_cmd* xcmd)
+  {
+    auto next = xcmd->next;
+    if (prev)
+      prev->next = next;
+    else
+      m_head = next;
+    if (m_tail == xcmd)
+      m_tail = prev;
+    xcmd->next = nullptr;
+    return next;
+  }
+};
 
 ////////////////////////////////////////////////////////////////
 // class xocl_cu represents a compute unit on a device
@@ -309,6 +364,9 @@ static std::atomic<unsigned int> s_num_pending {0};
 // @addr: base address of this CU
 // @ctrlreg: state of the CU (value of AXI-lite control register)
 // @done_counter: number of command that have completed (<=running_queue.size())
+// @expected_us: moving average of execution time lower bound in microseconds
+// @histogram: log2 histogram of observed execution times in microseconds
+// @samples: number of execution times recorded in histogram
 //
 // The CU supports HLS data flow model where running_queue represents
 // all the commands that have been started on this CU. The CU is polled
@@ -318,6 +376,15 @@ static std::atomic<unsigned int> s_num_pending {0};
 //
 // New commands can be pushed to the running_queue when the CU has
 // asserted AP_READY (=> AP_START is low)
+//
+// The execution time of a command is measured from its start until
+// its completion is observed by the scheduler.  Bucket i of the
+// histogram counts execution times in [2^i-1, 2^(i+1)-1) us.
+//
+// The observed time includes the polling delay.  A prediction based
+// on it would keep the scheduler sleeping as long as it did before,
+// so the prediction uses the time of the last poll that found the CU
+// busy instead, which is a lower bound of the execution time.
 ////////////////////////////////////////////////////////////////
 class xocl_cu
 {
@@ -331,6 +398,34 @@ private:
   mutable size_type done_cnt = 0;
   mutable size_type run_cnt = 0;
 
+  // With adaptive polling, time of last poll without completion, and
+  // that time when the last completion was observed
+  mutable time_type busy_time;
+  mutable time_type done_after;
+
+  double expected_us = 0;
+  std::array<std::atomic<uint64_t>, HISTOGRAM_BUCKETS> histogram {};
+  uint64_t samples = 0; // scheduler thread only
+
+  // Record execution time of a completed command
+  void
+  record(const xocl_cmd* xcmd)
+  {
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>
+      (clock_type::now() - xcmd->start_time).count();
+    auto lower_us = std::chrono::duration_cast<std::chrono::microseconds>
+      (std::max(done_after, xcmd->start_time) - xcmd->start_time).count();
+    expected_us = samples
+      ? expected_us + (lower_us - expected_us) / 8
+      : lower_us;
+    ++samples;
+
+    size_type bucket = 0;
+    for (auto val = static_cast<uint64_t>(us) + 1; val > 1 && bucket < HISTOGRAM_BUCKETS - 1; val >>= 1)
+      ++bucket;
+    histogram[bucket].fetch_add(1, std::memory_order_relaxed);
+  }
+
   void
   poll() const
   {
@@ -340,6 +435,7 @@ private:
     xdev->xread(addr,&ctrlreg,4);
     XRT_DEBUGF("sws cu(%d) poll(0x%x) done(%d) run(%d)\n",cuidx,ctrlreg,done_cnt,run_cnt);
     if (ctrlreg & (AP_DONE | AP_IDLE))  { // AP_IDLE check in sw emulation
+      done_after = busy_time;
       ++done_cnt;
       --run_cnt;
       XRT_ASSERT(done_cnt <= running_queue.size(),"too many dones");
@@ -347,6 +443,9 @@ private:
       value_type cont = AP_CONTINUE;
       xdev->xwrite(addr,&cont,4);
     }
+    else if (xrt_core::config::get_adaptive_polling()) {
+      busy_time = clock_type::now();
+    }
   }
 
 public:
@@ -397,6 +496,7 @@ public:
     if (!done_cnt)
       return;
 
+    record(running_queue.front());
     running_queue.pop();
     --done_cnt;
     XRT_DEBUGF("sws pop_done() popped cu(%d) done(%d) run(%d)\n",cuidx,done_cnt,run_cnt);
@@ -429,6 +529,7 @@ public:
 
     // invoke callback for starting cu
     xcmd->notify_start(cuidx);
+    xcmd->start_time = clock_type::now();
 
     // start cu
     ctrlreg |= AP_START;
@@ -442,6 +543,31 @@ public:
     ++run_cnt;
     XRT_DEBUGF("started cu(%d) xcmd(%d) done(%d) run(%d)\n",cuidx,xcmd->get_uid(),done_cnt,run_cnt);
   }
+
+  // Predicted completion time of first command in running queue
+  //
+  // @return
+  //  Predicted time, or time_type::max() if nothing is running or
+  //  there is no execution history for this CU
+  time_type
+  predicted_completion() const
+  {
+    if (running_queue.empty() || !samples)
+      return time_type::max();
+    auto expected = std::chrono::microseconds(static_cast<uint64_t>(expected_us));
+    return running_queue.front()->start_time + expected;
+  }
+
+  // Copy of execution time histogram
+  std::vector<uint64_t>
+  get_histogram() const
+  {
+    std::vector<uint64_t> hist;
+    hist.reserve(HISTOGRAM_BUCKETS);
+    for (auto& count : histogram)
+      hist.push_back(count.load(std::memory_order_relaxed));
+    return hist;
+  }
 };
 
 
@@ -450,6 +576,8 @@ public:
 //
 // @xdev: the xrt device on which to execute
 // @scheduler: scheduler that manages this execution core
+// @pending: lock free list of new commands pushed by user threads
+// @cmd_queue: commands managed by the scheduler for this device
 // @submit_queue: queue holding command that have been submitted by scheduler
 // @slot_status: bitset representing free/busy slots in submit_queue
 // @cu_usage: list of CUs managed by this execution core (device)
@@ -467,6 +595,11 @@ public:
 // queue.  The command is annotated with the CU on which is has been
 // started, so scheduler will revisit the command and check for its
 // completion.
+//
+// User threads push new commands onto the pending list with a single
+// compare-and-swap.  The scheduler takes the entire list in one
+// exchange and moves the commands in submission order to the command
+// queue of this execution core.
 ////////////////////////////////////////////////////////////////
 class exec_core
 {
@@ -476,6 +609,12 @@ class exec_core
   // scheduler for this device
   xocl_scheduler* m_scheduler = nullptr;
 
+  // New commands, most recently pushed first
+  std::atomic<xocl_cmd*> m_pending {nullptr};
+
+  // Commands managed by scheduler in order of submission
+  cmd_queue m_cmd_queue;
+
   // Commands submitted to this device, the queue is slot based
   // and a slot becomes free when its command is started on a CU
   xocl_cmd* submit_queue[MAX_SLOTS] = {nullptr}; // reflects ERT CQ # slots
@@ -503,6 +642,57 @@ public:
     return m_scheduler;
   }
 
+  // Command queue managed by scheduler
+  cmd_queue&
+  get_cmd_queue()
+  {
+    return m_cmd_queue;
+  }
+
+  // Push a new command to this execution core
+  //
+  // Called from any user thread
+  void
+  push_pending(xocl_cmd* xcmd)
+  {
+    push_pending(xcmd, xcmd);
+  }
+
+  // Push a list of new commands to this execution core
+  //
+  // The commands from first to last must be linked most recently
+  // submitted first.
+  //
+  // Called from any user thread
+  void
+  push_pending(xocl_cmd* first, xocl_cmd* last)
+  {
+    auto head = m_pending.load(std::memory_order_relaxed);
+    do {
+      last->next = head;
+    } while (!m_pending.compare_exchange_weak(head, first, std::memory_order_release, std::memory_order_relaxed));
+  }
+
+  // Take all pending commands
+  //
+  // Called from scheduler thread only
+  //
+  // @return
+  //  List of new commands linked in submission order
+  xocl_cmd*
+  take_pending()
+  {
+    auto xcmd = m_pending.exchange(nullptr, std::memory_order_acquire);
+    xocl_cmd* head = nullptr;
+    while (xcmd) {
+      auto next = xcmd->next;
+      xcmd->next = head;
+      head = xcmd;
+      xcmd = next;
+    }
+    return head;
+  }
+
   // Get a free slot index into submit queue
   //
   // @return
@@ -611,12 +801,39 @@ public:
   {
     return penguin_query(xcmd);
   }
+
+  // Earliest predicted completion time of any running command
+  time_type
+  predicted_completion() const
+  {
+    auto predicted = time_type::max();
+    for (auto& cu : cu_usage)
+      predicted = std::min(predicted, cu->predicted_completion());
+    return predicted;
+  }
+
+  // Execution time histogram of CU with specified index
+  std::vector<uint64_t>
+  get_cu_histogram(size_type cuidx) const
+  {
+    if (cuidx >= num_cus)
+      throw std::runtime_error("sws: no such cu index " + std::to_string(cuidx));
+    return cu_usage[cuidx]->get_histogram();
+  }
+
+  size_type
+  get_num_cus() const
+  {
+    return num_cus;
+  }
 };
 
 ////////////////////////////////////////////////////////////////
 // class xocl_scheduler: The scheduler data structure
 //
-// @m_command_queue: all the commands managed by scheduler
+// @m_cores: execution cores managed by this scheduler
+// @m_num_pending: number of commands pushed but not yet queued
+// @m_num_active: number of commands in execution core command queues
 //
 // The scheduler babysits all commands launched by user. It
 // transitions the commands from state to state until the command
@@ -627,49 +844,69 @@ public:
 // a scheduler can manage any number of cores.  Because the scheduler
 // is the only client of an exec_core, and exec_core is the only
 // client of xocl_cu, no locking is necessary is any of the data
-// structures.  Exception is the pending command list which is copied
-// to the scheduler command queue, the pending list is populated by
-// user thread, and harvested by scheduler thread.
+// structures.  Exception is the pending command list of an exec_core
+// which is populated by user threads without locking, and harvested
+// by the scheduler thread.
+//
+// The scheduler mutex is acquired by user threads only when the
+// scheduler is sleeping and must be woken up.
+//
+// With Runtime.adaptive_polling the scheduler predicts when the next
+// running command completes from the execution history of its CU.
+// It polls continuously when the completion is near, and otherwise
+// sleeps until shortly before the predicted time, or until a new
+// command is pushed.
 ////////////////////////////////////////////////////////////////
 class xocl_scheduler
 {
   std::mutex                 m_mutex;
   std::condition_variable    m_work;
+  std::thread                m_thread;
 
   bool                       m_stop = false;
-  std::list<xcmd_ptr>        m_command_queue;
+  std::atomic<bool>          m_sleeping {false};
+  std::atomic<int>           m_num_pending {0};
+  size_type                  m_num_active = 0;
+
+  // Execution cores, modified by init while scheduler runs
+  std::mutex                 m_cores_mutex;
+  std::vector<exec_core*>    m_cores;
 
   // if command has completed in the iteration
   bool                       m_cmd_completed = false;
 
-  // Copy pending commands into command queue.
+  // earliest predicted completion of a running command
+  time_type                  m_predicted = time_type::max();
+
+  // moving average of how late the scheduler wakes up from a sleep
+  clock_type::duration       m_wake_latency {0};
+
+  // Move pending commands into execution core command queues.
   void
   queue_cmds()
   {
-    std::lock_guard<std::mutex> lk(s_pending_mutex);
-    for (auto itr=s_pending_cmds.begin(); itr!=s_pending_cmds.end(); ) {
-      auto xcmd = (*itr);
-      auto exec = xcmd->get_exec();
-      if (exec->get_scheduler()==this) {
+    int count = 0;
+    for (auto exec : m_cores) {
+      auto& queue = exec->get_cmd_queue();
+      for (auto xcmd = exec->take_pending(); xcmd; ++count) {
+        auto next = xcmd->next;
         XRT_DEBUGF("xcmd(%d) [new->queued]\n",xcmd->get_uid());
-        itr = s_pending_cmds.erase(itr);
         xcmd->set_int_state(ERT_CMD_STATE_QUEUED);
-        m_command_queue.push_back(std::move(xcmd));
-      }
-      else {
-        ++itr;
+        queue.push_back(xcmd);
+        xcmd = next;
       }
     }
-    s_num_pending = s_pending_cmds.size();
+    m_num_pending -= count;
+    m_num_active += count;
   }
 
   // Transition command to submitted state if possible
   bool
-  queued_to_submitted(const xcmd_ptr& xcmd)
+  queued_to_submitted(xocl_cmd* xcmd)
   {
     bool retval = false;
     auto exec = xcmd->get_exec();
-    if (exec->submit(xcmd.get())) {
+    if (exec->submit(xcmd)) {
       XRT_DEBUGF("xcmd(%d) [queued->submitted]\n",xcmd->get_uid());
       xcmd->set_int_state(ERT_CMD_STATE_SUBMITTED);
       retval = true;
@@ -679,11 +916,11 @@ class xocl_scheduler
 
   // Transition command to running state if possible
   bool
-  submitted_to_running(const xcmd_ptr& xcmd)
+  submitted_to_running(xocl_cmd* xcmd)
   {
     bool retval = false;
     auto exec = xcmd->get_exec();
-    if (exec->start(xcmd.get())) {
+    if (exec->start(xcmd)) {
       XRT_DEBUGF("xcmd(%d) [submitted->running]\n",xcmd->get_uid());
       xcmd->set_int_state(ERT_CMD_STATE_RUNNING);
       retval = true;
@@ -693,11 +930,11 @@ class xocl_scheduler
 
   // Transition command to complete state if command has completed
   bool
-  running_to_complete(const xcmd_ptr& xcmd)
+  running_to_complete(xocl_cmd* xcmd)
   {
     bool retval = false;
     auto exec = xcmd->get_exec();
-    if (exec->query(xcmd.get())) {
+    if (exec->query(xcmd)) {
       XRT_DEBUGF("xcmd(%d) [running->complete]\n",xcmd->get_uid());
       xcmd->set_state(ERT_CMD_STATE_COMPLETED);
       xcmd->notify_host();
@@ -708,40 +945,80 @@ class xocl_scheduler
 
   // Free a command
   bool
-#ifdef XRT_VERBOSE
-  complete_to_free(const xcmd_ptr& xcmd)
-#else
-  complete_to_free(const xcmd_ptr&)
-#endif
+  complete_to_free(xocl_cmd* xcmd)
   {
     XRT_DEBUGF("xcmd(%d) [complete->free]\n",xcmd->get_uid());
+    delete xcmd;
     return true;
   }
 
-  // Iterate command queue and baby sit all commands
+  // Iterate command queues and baby sit all commands
   void
   iterate_cmds()
   {
-    auto end = m_command_queue.end();
-    auto nitr = m_command_queue.begin();
     m_cmd_completed = false;
-    for (auto itr=nitr; itr!=end; itr=nitr) {
-      auto& xcmd = (*itr);
-      if (xcmd->get_state() == ERT_CMD_STATE_QUEUED)
-        queued_to_submitted(xcmd);
-      if (xcmd->get_state() == ERT_CMD_STATE_SUBMITTED)
-        submitted_to_running(xcmd);
-      if (xcmd->get_state() == ERT_CMD_STATE_RUNNING)
-        running_to_complete(xcmd);
-      if (xcmd->get_state() == ERT_CMD_STATE_COMPLETED) {
-        complete_to_free(xcmd);
-        nitr = m_command_queue.erase(itr);
-        end = m_command_queue.end();
-        m_cmd_completed = true;
-        continue;
+    for (auto exec : m_cores) {
+      auto& queue = exec->get_cmd_queue();
+      xocl_cmd* prev = nullptr;
+      for (auto xcmd = queue.front(); xcmd; ) {
+        if (xcmd->get_state() == ERT_CMD_STATE_QUEUED)
+          queued_to_submitted(xcmd);
+        if (xcmd->get_state() == ERT_CMD_STATE_SUBMITTED)
+          submitted_to_running(xcmd);
+        if (xcmd->get_state() == ERT_CMD_STATE_RUNNING)
+          running_to_complete(xcmd);
+        if (xcmd->get_state() == ERT_CMD_STATE_COMPLETED) {
+          auto next = queue.erase(prev, xcmd);
+          complete_to_free(xcmd);
+          --m_num_active;
+          m_cmd_completed = true;
+          xcmd = next;
+          continue;
+        }
+
+        prev = xcmd;
+        xcmd = xcmd->next;
       }
+    }
+
+    if (xrt_core::config::get_adaptive_polling()) {
+      m_predicted = time_type::max();
+      for (auto exec : m_cores)
+        m_predicted = std::min(m_predicted, exec->predicted_completion());
+    }
+  }
+
+  // Wait for predicted completion of a running command.
+  //
+  // Sleep until just before predicted completion, or poll right away
+  // if completion is near.  Without a prediction or if a command is
+  // overdue, sleep for a fraction of the time waited so far.
+  //
+  // The scheduler wakes up later than requested, by tens of
+  // microseconds depending on the system, so it sleeps that much
+  // less before a predicted completion.
+  void
+  adaptive_wait(std::unique_lock<std::mutex>& lk)
+  {
+    auto now = clock_type::now();
+    auto early = SPIN_WINDOW + m_wake_latency;
+    time_type until;
+    if (m_predicted == time_type::max())
+      until = now + MAX_SLEEP;
+    else if (m_predicted > now + early)
+      until = std::min(m_predicted - early, now + MAX_SLEEP);
+    else if (m_predicted + SPIN_WINDOW > now)
+      return; // spin
+    else
+      until = now + std::min<clock_type::duration>((now - m_predicted) / 8, MAX_SLEEP);
+
+    m_sleeping = true;
+    bool woken = m_work.wait_until(lk, until, [this] { return m_stop || m_num_pending; });
+    m_sleeping = false;
 
-      nitr = ++itr;
+    if (!woken) {
+      auto late = std::max(clock_type::now() - until, clock_type::duration(0));
+      m_wake_latency += (late - m_wake_latency) / 8;
     }
   }
 
@@ -750,17 +1027,22 @@ class xocl_scheduler
   wait()
   {
     std::unique_lock<std::mutex> lk(m_mutex);
-    while (!m_stop && !s_num_pending && m_command_queue.empty())
+    m_sleeping = true;
+    while (!m_stop && !m_num_pending && !m_num_active)
       m_work.wait(lk);
+    m_sleeping = false;
 
     if (m_stop) {
-      if (!m_command_queue.empty() || s_num_pending)
+      if (m_num_active || m_num_pending)
         throw std::runtime_error("software scheduler stopping while there are active commands");
     }
 
-    if (s_num_pending || m_cmd_completed)
+    if (m_num_pending || m_cmd_completed)
       return;
 
+    if (xrt_core::config::get_adaptive_polling())
+      return adaptive_wait(lk);
+
     // Sleep if no new pending commands or no running command have completed
     // throttle polling for cu completion
     if (auto us = xrt_core::config::get_polling_throttle())
@@ -773,52 +1055,112 @@ class xocl_scheduler
   loop()
   {
     wait();
+    std::lock_guard<std::mutex> lk(m_cores_mutex);
     queue_cmds();
     iterate_cmds();
   }
 
+  // Run the scheduler until it is stopped
+  void
+  run()
+  {
+    while (!m_stop)
+      loop();
+  }
+
 public:
 
-  // Wake up the scheduler if it is waiting
+  // Add an execution core to be managed by this scheduler
   void
-  notify()
+  add_exec_core(exec_core* exec)
   {
-    m_work.notify_one();
+    std::lock_guard<std::mutex> lk(m_cores_mutex);
+    m_cores.push_back(exec);
   }
 
-  // Run the scheduler until it is stopped
+  // Remove an execution core from this scheduler
   void
-  run()
+  remove_exec_core(exec_core* exec)
   {
-    while (!m_stop)
-      loop();
+    std::lock_guard<std::mutex> lk(m_cores_mutex);
+    m_cores.erase(std::remove(m_cores.begin(), m_cores.end(), exec), m_cores.end());
+  }
+
+  // Notify the scheduler of new pending commands
+  //
+  // The scheduler is woken up if it is waiting
+  void
+  notify(int count = 1)
+  {
+    m_num_pending += count;
+    if (m_sleeping) {
+      std::lock_guard<std::mutex> lk(m_mutex);
+      m_work.notify_one();
+    }
   }
 
-  // Stop the scheduler
+  // Start the scheduler thread
+  void
+  start()
+  {
+    m_stop = false;
+    m_thread = xrt_core::thread([this] { run(); });
+  }
+
+  // Stop the scheduler and wait for its thread to exit
   void
   stop()
   {
-    std::lock_guard<std::mutex> lk(m_mutex);
-    m_stop = true;
-    m_work.notify_one();
+    {
+      std::lock_guard<std::mutex> lk(m_mutex);
+      m_stop = true;
+      m_work.notify_one();
+    }
+    if (m_thread.joinable())
+      m_thread.join();
   }
 
 };
 
 ////////////////////////////////////////////////////////////////
-// One static scheduler currently on a single thread
+// By default one static scheduler on a single thread manages all
+// devices.  With Runtime.sws_thread_per_device each device gets its
+// own scheduler and scheduler thread.
 static xocl_scheduler s_global_scheduler;
-static std::thread s_scheduler_thread;
+static std::map<const xrt_core::device*, std::unique_ptr<xocl_scheduler>> s_device_scheduler;
+static std::mutex s_device_scheduler_mutex;
 static bool s_running=false;
 
 // Each device has a execution core
 static std::map<const xrt_core::device*, std::unique_ptr<exec_core>> s_device_exec_core;
 
-// Thread routine for scheduler loop
+// Log execution time histograms of all CUs in an execution core
 static void
-scheduler_loop()
+log_cu_histograms(const exec_core* exec)
+{
+  for (size_type cuidx = 0; cuidx < exec->get_num_cus(); ++cuidx) {
+    std::string msg = "sws cu(" + std::to_string(cuidx) + ") latency histogram (log2 us):";
+    for (auto count : exec->get_cu_histogram(cuidx))
+      msg.append(" ").append(std::to_string(count));
+    xrt_core::message::send(xrt_core::message::severity_level::XRT_INFO, "XRT", msg);
+  }
+}
+
+// Get the scheduler that manages argument device, create and start a
+// new one if necessary
+static xocl_scheduler*
+get_scheduler(const xrt_core::device* xdev)
 {
-  s_global_scheduler.run();
+  if (!xrt_core::config::get_sws_thread_per_device())
+    return &s_global_scheduler;
+
+  std::lock_guard<std::mutex> lk(s_device_scheduler_mutex);
+  auto& scheduler = s_device_scheduler[xdev];
+  if (!scheduler) {
+    scheduler = std::make_unique<xocl_scheduler>();
+    scheduler->start();
+  }
+  return scheduler.get();
 }
 
 } // namespace
@@ -831,13 +1173,43 @@ schedule(xrt_core::command* cmd)
   auto device = cmd->get_device();
 
   auto& exec = s_device_exec_core[device];
-  auto xcmd = xocl_cmd::create(exec.get(),cmd);
-  auto scheduler = exec->get_scheduler();
+  auto xcmd = new xocl_cmd(exec.get(),cmd);
+  exec->push_pending(xcmd);
+  exec->get_scheduler()->notify();
+}
+
+void
+schedule(xrt_core::command** cmds, size_t count)
+{
+  // push each run of consecutive commands for same device as one list
+  size_t first = 0;
+  for (size_t idx = 1; idx <= count; ++idx) {
+    if (idx < count && cmds[idx]->get_device() == cmds[first]->get_device())
+      continue;
+
+    auto& exec = s_device_exec_core[cmds[first]->get_device()];
+    xocl_cmd* head = nullptr;
+    xocl_cmd* tail = nullptr;
+    for (auto cidx = first; cidx < idx; ++cidx) {
+      auto xcmd = new xocl_cmd(exec.get(),cmds[cidx]);
+      xcmd->next = head;
+      head = xcmd;
+      if (!tail)
+        tail = xcmd;
+    }
+    exec->push_pending(head, tail);
+    exec->get_scheduler()->notify(static_cast<int>(idx - first));
+    first = idx;
+  }
+}
 
-  std::lock_guard<std::mutex> lk(s_pending_mutex);
-  s_pending_cmds.push_back(xcmd);
-  ++s_num_pending;
-  scheduler->notify();
+std::vector<uint64_t>
+get_cu_latency_histogram(const xrt_core::device* device, unsigned int cuidx)
+{
+  auto itr = s_device_exec_core.find(device);
+  if (itr == s_device_exec_core.end())
+    throw std::runtime_error("sws: device not initialized");
+  return itr->second->get_cu_histogram(cuidx);
 }
 
 void
@@ -846,7 +1218,7 @@ start()
   if (s_running)
     throw std::runtime_error("software command scheduler is already started");
 
-  s_scheduler_thread = std::move(xrt_core::thread(scheduler_loop));
+  s_global_scheduler.start();
   s_running = true;
 }
 
@@ -857,7 +1229,16 @@ stop()
     return;
 
   s_global_scheduler.stop();
-  s_scheduler_thread.join();
+
+  {
+    std::lock_guard<std::mutex> lk(s_device_scheduler_mutex);
+    for (auto& e : s_device_scheduler)
+      e.second->stop();
+  }
+
+  if (xrt_core::config::get_adaptive_polling())
+    for (auto& e : s_device_exec_core)
+      log_cu_histograms(e.second.get());
 
   s_running = false;
 }
@@ -889,10 +1270,16 @@ init(xrt_core::device* xdev)
   // create execution core for this device
   cu_trace_enabled = xrt_core::config::get_profile();
 
-  s_device_exec_core.erase(xdev);
-  s_device_exec_core.insert
-    (std::make_pair
-     (xdev,std::make_unique<exec_core>(xdev,&s_global_scheduler,slots,amap)));
+  auto itr = s_device_exec_core.find(xdev);
+  if (itr != s_device_exec_core.end()) {
+    itr->second->get_scheduler()->remove_exec_core(itr->second.get());
+    s_device_exec_core.erase(itr);
+  }
+
+  auto scheduler = get_scheduler(xdev);
+  auto exec = std::make_unique<exec_core>(xdev,scheduler,slots,amap);
+  scheduler->add_exec_core(exec.get());
+  s_device_exec_core.insert(std::make_pair(xdev,std::move(exec)));
 }
 
 }} // sws,xrt
@@ -23,15 +23,21 @@
 
 #include "bo.h"
 #include "device_int.h"
+#include "enqueue.h"
 #include "kernel_int.h"
+#include "core/common/config_reader.h"
 #include "core/common/device.h"
 #include "core/common/memalign.h"
+#include "core/common/memfill.h"
 #include "core/common/message.h"
 #include "core/common/query_requests.h"
 #include "core/common/system.h"
 #include "core/common/unistd.h"
 
+#include <exception>
+#include <functional>
 #include <map>
+#include <mutex>
 #include <set>
 
 #ifdef _WIN32
@@ -70,6 +76,44 @@ is_aligned_ptr(void* p)
   return p && (reinterpret_cast<uintptr_t>(p) % get_alignment())==0;
 }
 
+// Fills smaller than this are done on the host, larger fills seed
+// this much on the host and replicate it with device side copies
+constexpr size_t device_fill_seed_size = 1024 * 1024;
+
+// Devices on which a device side copy failed, with the xclbin that
+// was loaded at the time.  Fills of buffers on these devices go
+// straight to the host path until another xclbin is loaded.
+struct no_device_copy
+{
+  std::weak_ptr<xrt_core::device> device;
+  xrt_core::uuid xclbin;
+};
+static std::mutex s_no_device_copy_mutex;
+static std::map<const xrt_core::device*, no_device_copy> s_no_device_copy;
+
+static bool
+is_device_copy_unavailable(const std::shared_ptr<xrt_core::device>& device)
+{
+  std::lock_guard<std::mutex> lk(s_no_device_copy_mutex);
+  auto itr = s_no_device_copy.find(device.get());
+  if (itr == s_no_device_copy.end())
+    return false;
+
+  // a closed device at the same address, or a new xclbin
+  if (itr->second.device.lock() != device || itr->second.xclbin != device->get_xclbin_uuid()) {
+    s_no_device_copy.erase(itr);
+    return false;
+  }
+  return true;
+}
+
+static void
+set_device_copy_unavailable(const std::shared_ptr<xrt_core::device>& device)
+{
+  std::lock_guard<std::mutex> lk(s_no_device_copy_mutex);
+  s_no_device_copy[device.get()] = {device, device->get_xclbin_uuid()};
+}
+
 inline void
 send_exception_message(const char* msg)
 {
@@ -150,6 +194,12 @@ public:
     return device.get();
   }
 
+  const std::shared_ptr<xrt_core::device>&
+  get_core_device() const
+  {
+    return device;
+  }
+
   xclBufferExportHandle
   export_buffer() const
   {
@@ -192,9 +242,8 @@ public:
 
     // try copying with m2m
     try {
-      auto m2m = xrt_core::device_query<xrt_core::query::m2m>(get_device());
-      if (xrt_core::query::m2m::to_bool(m2m)) {
-        device->copy_bo(get_handle(), src->get_handle(), sz, dst_offset, src_offset);
+      if (has_m2m()) {
+        copy_on_device(src, sz, src_offset, dst_offset, true);
         return;
       }
     }
@@ -203,8 +252,7 @@ public:
 
     // try copying with kdma
     try {
-      xrt_core::kernel_int::copy_bo_with_kdma
-        (device, sz, get_handle(), dst_offset, src->get_handle(), src_offset);
+      copy_on_device(src, sz, src_offset, dst_offset, false);
       return;
     }
     catch (const std::exception& ex) {
@@ -216,13 +264,103 @@ public:
     copy_through_host(src, sz, src_offset, dst_offset);
   }
 
+  void
+  fill(const void* pattern, size_t pattern_size, size_t sz, size_t offset)
+  {
+    if (!pattern_size)
+      throw xrt_core::system_error(EINVAL, "pattern size must be a positive number");
+    if (sz + offset > size)
+      throw xrt_core::system_error(EINVAL, "filling past buffer size");
+
+    auto hbuf = static_cast<char*>(get_hbuf());
+    if (!hbuf)
+      throw xrt_core::system_error(EINVAL, "No host side buffer in buffer");
+    hbuf += offset;
+
+    // try filling on device by replicating a host filled seed, the
+    // host buffer is filled as well so that it matches the device
+    // and a later sync to device does not overwrite the fill
+    auto seed = device_fill_seed_size - device_fill_seed_size % pattern_size;
+    if (seed && sz > 2 * seed && !is_device_copy_unavailable(device)) {
+      xrt_core::fill(hbuf, pattern, pattern_size, seed);
+      sync(XCL_BO_SYNC_BO_TO_DEVICE, seed, offset);
+      bool filled = fill_on_device(seed, sz, offset);
+
+      // seed is a multiple of pattern size
+      xrt_core::fill(hbuf + seed, pattern, pattern_size, sz - seed);
+      if (!filled)
+        // revert to filling through host, seed is already on device
+        sync(XCL_BO_SYNC_BO_TO_DEVICE, sz - seed, offset + seed);
+      return;
+    }
+
+    // fill through host
+    xrt_core::fill(hbuf, pattern, pattern_size, sz);
+    sync(XCL_BO_SYNC_BO_TO_DEVICE, sz, offset);
+  }
+
+  // Double the filled region with device side copies until sz bytes
+  // are filled.  Returns false if the device cannot copy, in which
+  // case the device is remembered as not capable of copying.
+  bool
+  fill_on_device(size_t filled, size_t sz, size_t offset)
+  {
+    auto seed = filled;
+    bool m2m = has_m2m();
+    try {
+      while (filled < sz) {
+        auto count = std::min(filled, sz - filled);
+        copy_on_device(this, count, offset, offset + filled, m2m);
+        filled += count;
+      }
+      return true;
+    }
+    catch (const std::exception& ex) {
+      // first copy failed, the device cannot copy
+      if (filled == seed)
+        set_device_copy_unavailable(device);
+      auto fmt = boost::format("Reverting to host fill of buffer (%s)") % ex.what();
+      xrt_core::message::send(xrt_core::message::severity_level::XRT_WARNING, "XRT",  fmt.str());
+    }
+    return false;
+  }
+
+  bool
+  has_m2m() const
+  {
+    try {
+      auto m2m = xrt_core::device_query<xrt_core::query::m2m>(get_device());
+      return xrt_core::query::m2m::to_bool(m2m);
+    }
+    catch (const std::exception&) {
+    }
+    return false;
+  }
+
+  // Copy on device with m2m or kdma.  Offsets are relative to this
+  // and src buffer, sub buffers share the handle of their parent so
+  // their offset into the parent is added.
+  void
+  copy_on_device(const bo_impl* src, size_t sz, size_t src_offset, size_t dst_offset, bool m2m)
+  {
+    dst_offset += get_offset();
+    src_offset += src->get_offset();
+    if (m2m)
+      device->copy_bo(get_handle(), src->get_handle(), sz, dst_offset, src_offset);
+    else
+      xrt_core::kernel_int::copy_bo_with_kdma
+        (device, sz, get_handle(), dst_offset, src->get_handle(), src_offset);
+  }
+
   void
   copy_with_export(const bo_impl* src, size_t sz, size_t src_offset, size_t dst_offset)
   {
     // export bo from other device and create an import bo to copy from
     auto src_export_handle = src->export_buffer();
     auto src_import_bo = xrt::bo(device->get_user_handle(), src_export_handle);
-    copy(src_import_bo.get_handle().get(), sz, src_offset, dst_offset);
+
+    // the import is of the parent buffer of a sub buffer
+    copy(src_import_bo.get_handle().get(), sz, src_offset + src->get_offset(), dst_offset);
   }
 
   void
@@ -584,6 +722,155 @@ sub_buffer(const std::shared_ptr<xrt::bo_impl>& parent, size_t size, size_t offs
   return std::make_shared<xrt::buffer_sub>(parent, size, offset);
 }
 
+// class sync_engine - Transfers the chunks of asynchronous buffer syncs
+//
+// There is one engine per device.  The engine's event queue is
+// serviced by one event handler per DMA channel, such that chunks of
+// the same or different buffers are transferred concurrently.
+//
+// An engine is removed when its device has been closed, next time an
+// engine is looked up.  It is not removed by the device destructor,
+// because the last reference to the device may be released by one of
+// the engine's own handler threads, which cannot join itself.
+class sync_engine
+{
+  std::weak_ptr<xrt_core::device> m_device;
+  xrt::event_queue m_queue;
+  std::vector<xrt::event_handler> m_handlers;
+
+  static unsigned int
+  get_num_channels(const xrt_core::device* device)
+  {
+    if (auto channels = xrt_core::config::get_bo_sync_channels())
+      return channels;
+
+    try {
+      auto channels = xrt_core::device_query<xrt_core::query::dma_threads_raw>(device);
+      if (!channels.empty())
+        return static_cast<unsigned int>(channels.size());
+    }
+    catch (const std::exception&) {
+    }
+    return 2;
+  }
+
+public:
+  explicit
+  sync_engine(const std::shared_ptr<xrt_core::device>& device)
+    : m_device(device)
+  {
+    auto channels = get_num_channels(device.get());
+    for (unsigned int i = 0; i < channels; ++i)
+      m_handlers.emplace_back(m_queue);
+  }
+
+  xrt::event_queue&
+  get_queue()
+  {
+    return m_queue;
+  }
+
+  // Engine of argument device, which the caller keeps open while
+  // it uses the engine.  Engines of closed devices are removed,
+  // including a stale engine of a closed device that was allocated
+  // at the same address as argument device.
+  static sync_engine*
+  get(const std::shared_ptr<xrt_core::device>& device)
+  {
+    static std::mutex mutex;
+    static std::map<const xrt_core::device*, std::unique_ptr<sync_engine>> engines;
+    std::vector<std::unique_ptr<sync_engine>> closed;
+    std::lock_guard<std::mutex> lk(mutex);
+    for (auto itr = engines.begin(); itr != engines.end(); ) {
+      if (itr->second->m_device.expired()) {
+        closed.push_back(std::move(itr->second));
+        itr = engines.erase(itr);
+      }
+      else
+        ++itr;
+    }
+
+    auto& engine = engines[device.get()];
+    if (!engine)
+      engine = std::make_unique<sync_engine>(device);
+    return engine.get();
+  }
+};
+
+// class sync_request - Asynchronous waitable for one async_sync
+//
+// Counts the outstanding chunks of a transfer and notifies the
+// enqueued event when the last chunk completes.  The first error,
+// if any, is passed on to the event.
+class sync_request
+{
+  struct state
+  {
+    std::mutex mutex;
+    size_t remaining;
+    size_t bytes = 0;
+    std::exception_ptr error;
+    std::shared_ptr<xrt::event_impl> event;
+    std::function<void(size_t)> progress;
+  };
+  std::shared_ptr<state> m_state;
+
+  void
+  notify(std::unique_lock<std::mutex>& lk) const
+  {
+    auto event = std::move(m_state->event);
+    auto error = m_state->error;
+    lk.unlock();
+    if (error)
+      xrt_core::enqueue::done(event.get(), error);
+    else
+      xrt_core::enqueue::done(event.get());
+  }
+
+public:
+  sync_request(size_t chunks, const std::function<void(size_t)>& progress)
+    : m_state(std::make_shared<state>())
+  {
+    m_state->remaining = chunks;
+    m_state->progress = progress;
+  }
+
+  // Called when the enqueued event for this request is executed
+  void
+  set_event(const std::shared_ptr<xrt::event_impl>& event) const
+  {
+    std::unique_lock<std::mutex> lk(m_state->mutex);
+    m_state->event = event;
+    if (!m_state->remaining)
+      notify(lk);
+  }
+
+  // Called by the transfer thread when a chunk is done
+  void
+  chunk_done(size_t bytes, std::exception_ptr eptr) const
+  {
+    std::unique_lock<std::mutex> lk(m_state->mutex);
+    m_state->bytes += bytes;
+    if (eptr && !m_state->error)
+      m_state->error = eptr;
+    auto total = m_state->bytes;
+    if (--m_state->remaining) {
+      lk.unlock();
+      if (m_state->progress)
+        m_state->progress(total);
+      return;
+    }
+
+    if (m_state->progress) {
+      lk.unlock();
+      m_state->progress(total);
+      lk.lock();
+    }
+    if (m_state->event)
+      notify(lk);
+  }
+};
+
 static xclDeviceHandle
 get_xcl_device_handle(xrtDeviceHandle dhdl)
 {
@@ -619,6 +906,14 @@ address(xrtBufferHandle handle)
 ////////////////////////////////////////////////////////////////
 namespace xrt {
 
+// sync_request is an asynchronous waitable, it notifies the
+// enqueued event when the transfer completes.
+template <>
+struct callable_traits<sync_request>
+{
+  enum { is_async = true };
+};
+
 bo::
 bo(xclDeviceHandle dhdl, void* userptr, size_t sz, bo::flags flags, memory_group grp)
   : handle(alloc(dhdl, userptr, sz, static_cast<xrtBufferFlags>(flags), grp))
@@ -695,6 +990,47 @@ copy(const bo& src, size_t sz, size_t src_offset, size_t dst_offset)
   handle->copy(src.handle.get(), sz, src_offset, dst_offset);
 }
 
+event_queue::event
+bo::
+async_sync(xclBOSyncDirection dir, size_t sz, size_t offset,
+           const std::function<void(size_t)>& progress)
+{
+  if (sz + offset > size())
+    throw xrt_core::system_error(EINVAL, "syncing past buffer size");
+
+  auto boh = handle;
+  auto& queue = sync_engine::get(boh->get_core_device())->get_queue();
+  size_t chunk = xrt_core::config::get_bo_sync_chunk_size();
+  if (!chunk)
+    chunk = sz;
+
+  auto chunks = sz ? (sz + chunk - 1) / chunk : 0;
+  sync_request request(chunks, progress);
+
+  // chunks are picked up by the transfer threads in order
+  for (size_t done = 0; done < sz; done += chunk) {
+    auto count = std::min(chunk, sz - done);
+    queue.enqueue([boh, dir, count, done, offset, request] {
+      try {
+        boh->sync(dir, count, offset + done);
+        request.chunk_done(count, nullptr);
+      }
+      catch (...) {
+        request.chunk_done(count, std::current_exception());
+      }
+    });
+  }
+
+  return queue.enqueue([request] { return request; });
+}
+
+void
+bo::
+fill(const void* pattern, size_t pattern_size, size_t sz, size_t offset)
+{
+  handle->fill(pattern, pattern_size, sz, offset);
+}
+
 } // xrt
 
 ////////////////////////////////////////////////////////////////
@@ -923,6 +1259,23 @@ xrtBOCopy(xrtBufferHandle dhdl, xrtBufferHandle shdl, size_t sz, size_t dst_offs
   }
 }
 
+int
+xrtBOFill(xrtBufferHandle bhdl, const void* pattern, size_t pattern_size, size_t size, size_t offset)
+{
+  try {
+    auto boh = get_boh(bhdl);
+    boh->fill(pattern, pattern_size, size, offset);
+    return 0;
+  }
+  catch (const xrt_core::error& ex) {
+    xrt_core::send_exception_message(ex.what());
+    return errno = ex.get();
+  }
+  catch (const std::exception& ex) {
+    send_exception_message(ex.what());
+    return errno = 0;
+  }
+}
 
 uint64_t
 xrtBOAddress(xrtBufferHandle bhdl)
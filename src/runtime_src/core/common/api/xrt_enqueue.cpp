@@ -20,7 +20,14 @@
 #define XRT_CORE_COMMON_SOURCE // in same dll as core_common
 #include "core/include/experimental/xrt_enqueue.h"
 
+#include "enqueue.h"
+#include "core/include/experimental/xrt_device.h"
+#include "core/common/config_reader.h"
 #include "core/common/debug.h"
+#include "core/common/device.h"
+#include "core/common/message.h"
+#include "core/common/query_requests.h"
+#include "core/common/thread.h"
 
 #include <memory>
 #include <vector>
@@ -31,6 +38,10 @@
 #include <algorithm>
 #include <thread>
 #include <mutex>
+#include <exception>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
 
 #ifdef _WIN32
 # pragma warning( disable : 4244 )
@@ -42,6 +53,8 @@ namespace {
 
 namespace xrt {
 
+class event_handler_pool_impl;
+
 // class event_impl - insulated implementation of an xrt::event
 //
 // Objects of event_impl are attached to asynchronous waitable
@@ -61,6 +74,8 @@ class event_impl : public std::enable_shared_from_this<event_impl>
   event_queue::task m_task;
   event_queue_impl* m_event_queue = nullptr;
   std::vector<event_impl*> m_chain;
+  std::vector<std::function<void()>> m_callbacks;
+  std::exception_ptr m_exception;
   unsigned int m_wait_count = 0;
   unsigned int m_uid = 0;
   bool m_done = false;
@@ -127,6 +142,33 @@ public:
   void
   done();
 
+  // Mark this event complete with an error.  The exception
+  // is rethrown to anyone waiting for the event.
+  void
+  done(std::exception_ptr eptr)
+  {
+    {
+      std::lock_guard<std::mutex> lk(m_mutex);
+      m_exception = eptr;
+    }
+    done();
+  }
+
+  // Call argument function when this event completes, or
+  // immediately if already complete.
+  void
+  add_callback(std::function<void()> fcn)
+  {
+    {
+      std::lock_guard<std::mutex> lk(m_mutex);
+      if (!m_done) {
+        m_callbacks.push_back(std::move(fcn));
+        return;
+      }
+    }
+    fcn();
+  }
+
   // Wait for the completion of this event
   void
   wait()
@@ -134,6 +176,8 @@ public:
     std::unique_lock<std::mutex> lk(m_mutex);
     while (!m_done)
       m_wait_done.wait(lk);
+    if (m_exception)
+      std::rethrow_exception(m_exception);
   }
 
   // Allow clients of event_impl* to retrieve the associated
@@ -208,6 +252,16 @@ class event_queue_impl
   std::set<std::shared_ptr<event_impl>, event_cmp> m_events; // enqueued events
   std::mutex m_mutex;
   std::condition_variable m_work;
+  std::atomic<event_handler_pool_impl*> m_pool {nullptr};    // pool servicing the queue
+  std::atomic<unsigned int> m_pool_users {0};                // submits using m_pool
+
+  // Count a submit using m_pool for the duration of a scope
+  struct pool_user
+  {
+    std::atomic<unsigned int>& m_users;
+    explicit pool_user(std::atomic<unsigned int>& users) : m_users(users) { ++m_users; }
+    ~pool_user() { --m_users; }
+  };
 
 public:
   // Enqueue an event and try submit it.
@@ -221,15 +275,31 @@ public:
     event->submit(this);
   }
 
-  // Submit argument event by inserting it in the queue that is
-  // serviced by event handlers.  Notify the handlers that work
-  // is ready.
+  // Submit argument event for execution, see definition below
   void
-  submit(event_impl* ev)
+  submit(event_impl* ev);
+
+  // Attach an event handler pool.  Events submitted after
+  // the pool is attached are executed by the pool.
+  void
+  attach(event_handler_pool_impl* pool)
   {
-    std::lock_guard<std::mutex> lk(m_mutex);
-    m_queue.push(ev);
-    m_work.notify_one();
+    event_handler_pool_impl* expected = nullptr;
+    if (!m_pool.compare_exchange_strong(expected, pool))
+      throw std::runtime_error("event queue is already serviced by an event handler pool");
+  }
+
+  // Detach the event handler pool.  Events submitted after the
+  // pool is detached go to the task queue.  The function returns
+  // when no submit is using the pool any longer, pairing with the
+  // user count in submit() such that either submit sees the pool
+  // is detached or this function sees the submit in progress.
+  void
+  detach()
+  {
+    m_pool = nullptr;
+    while (m_pool_users)
+      std::this_thread::yield();
   }
 
   // Upon completion, the event is removed from the ownership
@@ -278,6 +348,342 @@ public:
   }
 };
   
+// class ready_queue - bounded lock free queue of events ready to execute
+//
+// Multiple producers and multiple consumers.  Each cell carries a
+// sequence number that tells producers and consumers whether the cell
+// is free or holds an event for the current lap around the ring.
+class ready_queue
+{
+  struct cell
+  {
+    std::atomic<size_t> sequence;
+    event_impl* event;
+  };
+
+  std::vector<cell> m_cells;
+  size_t m_mask;
+  alignas(64) std::atomic<size_t> m_push_pos {0};
+  alignas(64) std::atomic<size_t> m_pop_pos {0};
+
+public:
+  // @size: capacity, must be a power of 2
+  explicit
+  ready_queue(size_t size)
+    : m_cells(size), m_mask(size - 1)
+  {
+    for (size_t i = 0; i < size; ++i)
+      m_cells[i].sequence.store(i, std::memory_order_relaxed);
+  }
+
+  // Return: false if the queue is full
+  bool
+  push(event_impl* ev)
+  {
+    auto pos = m_push_pos.load(std::memory_order_relaxed);
+    while (true) {
+      auto& c = m_cells[pos & m_mask];
+      auto seq = c.sequence.load(std::memory_order_acquire);
+      auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+      if (diff == 0) {
+        if (m_push_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          c.event = ev;
+          c.sequence.store(pos + 1, std::memory_order_release);
+          return true;
+        }
+      }
+      else if (diff < 0)
+        return false;
+      else
+        pos = m_push_pos.load(std::memory_order_relaxed);
+    }
+  }
+
+  // Return: nullptr if the queue is empty
+  event_impl*
+  pop()
+  {
+    auto pos = m_pop_pos.load(std::memory_order_relaxed);
+    while (true) {
+      auto& c = m_cells[pos & m_mask];
+      auto seq = c.sequence.load(std::memory_order_acquire);
+      auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+      if (diff == 0) {
+        if (m_pop_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          auto ev = c.event;
+          c.sequence.store(pos + m_mask + 1, std::memory_order_release);
+          return ev;
+        }
+      }
+      else if (diff < 0)
+        return nullptr;
+      else
+        pos = m_pop_pos.load(std::memory_order_relaxed);
+    }
+  }
+
+  bool
+  empty() const
+  {
+    return m_push_pos.load() == m_pop_pos.load();
+  }
+};
+
+// class event_handler_pool_impl - insulated implementation of xrt::event_handler_pool
+//
+// Events submitted by one of the pool's own threads, which is the case
+// for events chained to an event executed by the pool, go to that
+// thread's ready queue.  Other events go to a shared ready queue.  An
+// idle thread looks at its own queue, then the shared queue, then
+// steals from the other threads before going to sleep.
+//
+// Ready queues are bounded, events that do not fit are kept in a
+// locked overflow queue.
+class event_handler_pool_impl
+{
+  static constexpr size_t queue_size = 1024;
+  static constexpr unsigned int spin_count = 64;
+
+  struct worker
+  {
+    event_handler_pool_impl* pool;
+    unsigned int index;
+    ready_queue queue;
+    std::thread thread;
+
+    worker(event_handler_pool_impl* p, unsigned int i)
+      : pool(p), index(i), queue(queue_size)
+    {}
+  };
+
+  static thread_local worker* t_worker;
+
+  event_queue m_retain;            // retain ownership of event queue
+  event_queue_impl* m_event_queue; // convienience
+  ready_queue m_shared;
+  std::vector<std::unique_ptr<worker>> m_workers;
+
+  std::mutex m_overflow_mutex;
+  std::deque<event_impl*> m_overflow;
+  std::atomic<size_t> m_overflow_size {0};
+
+  std::atomic<bool> m_stop {false};
+  std::atomic<unsigned int> m_sleepers {0};
+  std::mutex m_mutex;
+  std::condition_variable m_work;
+
+  event_impl*
+  pop_overflow()
+  {
+    if (!m_overflow_size)
+      return nullptr;
+    std::lock_guard<std::mutex> lk(m_overflow_mutex);
+    if (m_overflow.empty())
+      return nullptr;
+    auto ev = m_overflow.front();
+    m_overflow.pop_front();
+    --m_overflow_size;
+    return ev;
+  }
+
+  event_impl*
+  get_work(worker* w)
+  {
+    if (auto ev = w->queue.pop())
+      return ev;
+    if (auto ev = m_shared.pop())
+      return ev;
+    if (auto ev = pop_overflow())
+      return ev;
+
+    // steal, starting with the next worker
+    auto count = m_workers.size();
+    for (size_t i = 1; i < count; ++i)
+      if (auto ev = m_workers[(w->index + i) % count]->queue.pop())
+        return ev;
+    return nullptr;
+  }
+
+  bool
+  has_work() const
+  {
+    if (!m_shared.empty() || m_overflow_size)
+      return true;
+    for (auto& w : m_workers)
+      if (!w->queue.empty())
+        return true;
+    return false;
+  }
+
+  // Wake a sleeping thread, if any.  The fence orders the preceding
+  // push before the check for sleepers, pairing with the fence in
+  // sleep() such that either the sleeper sees the work or this
+  // function sees the sleeper.
+  void
+  wake()
+  {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!m_sleepers)
+      return;
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_work.notify_one();
+  }
+
+  void
+  sleep()
+  {
+    std::unique_lock<std::mutex> lk(m_mutex);
+    ++m_sleepers;
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!m_stop && !has_work())
+      m_work.wait(lk);
+    --m_sleepers;
+  }
+
+  // Thread run routine that consumes and executes events
+  // that are ready to be executed.
+  void
+  run(worker* w)
+  {
+    t_worker = w;
+    unsigned int idle = 0;
+    while (true) {
+      if (auto ev = get_work(w)) {
+        idle = 0;
+        ev->execute();
+        continue;
+      }
+
+      // Stop only once the queues are drained
+      if (m_stop)
+        break;
+
+      if (++idle < spin_count) {
+        std::this_thread::yield();
+        continue;
+      }
+
+      idle = 0;
+      sleep();
+    }
+    t_worker = nullptr;
+  }
+
+  static unsigned int
+  get_num_threads(unsigned int threads, const std::vector<unsigned int>& cpus)
+  {
+    if (threads)
+      return threads;
+    if (!cpus.empty())
+      return static_cast<unsigned int>(cpus.size());
+    if (auto value = xrt_core::config::get_event_handler_threads())
+      return value;
+    return std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  // Stop and join the threads that were started.  The threads
+  // execute the events left in the ready queues, and the events
+  // they make ready, before exiting.
+  void
+  stop()
+  {
+    m_stop = true;
+    {
+      std::lock_guard<std::mutex> lk(m_mutex);
+      m_work.notify_all();
+    }
+    for (auto& w : m_workers)
+      if (w->thread.joinable())
+        w->thread.join();
+  }
+
+public:
+  // Construct pool and retain ownership of event queue.  The pool
+  // is attached to the event queue once all threads are running.
+  // Failure to pin a thread to the requested cpus is not an error.
+  event_handler_pool_impl(const event_queue& q, unsigned int threads, const std::vector<unsigned int>& cpus)
+    : m_retain(q)
+    , m_event_queue(q.get_impl())
+    , m_shared(queue_size)
+  {
+    threads = get_num_threads(threads, cpus);
+    for (unsigned int i = 0; i < threads; ++i)
+      m_workers.emplace_back(std::make_unique<worker>(this, i));
+
+    try {
+      for (auto& w : m_workers) {
+        w->thread = std::thread(&event_handler_pool_impl::run, this, w.get());
+        try {
+          xrt_core::set_cpu_affinity(w->thread, cpus);
+        }
+        catch (const std::exception& ex) {
+          xrt_core::message::send(xrt_core::message::severity_level::XRT_WARNING, "XRT",
+                                  std::string("event_handler_pool thread is not pinned: ") + ex.what());
+        }
+      }
+      m_event_queue->attach(this);
+    }
+    catch (...) {
+      stop();
+      throw;
+    }
+  }
+
+  // Destruct pool after executing the events in the pool and
+  // detaching it from the event queue, which waits for submits in
+  // progress.  Events submitted by other threads after the pool
+  // threads have stopped are handed back to the task queue of the
+  // event queue, which is serviced by any event_handler of the queue.
+  ~event_handler_pool_impl()
+  {
+    stop();
+    m_event_queue->detach();
+
+    while (auto ev = m_shared.pop())
+      m_event_queue->submit(ev);
+    while (auto ev = pop_overflow())
+      m_event_queue->submit(ev);
+    for (auto& w : m_workers)
+      while (auto ev = w->queue.pop())
+        m_event_queue->submit(ev);
+  }
+
+  // Submit an event that is ready to execute
+  void
+  submit(event_impl* ev)
+  {
+    auto w = t_worker;
+    if (!(w && w->pool == this && w->queue.push(ev)) && !m_shared.push(ev)) {
+      std::lock_guard<std::mutex> lk(m_overflow_mutex);
+      m_overflow.push_back(ev);
+      ++m_overflow_size;
+    }
+    wake();
+  }
+};
+
+thread_local event_handler_pool_impl::worker* event_handler_pool_impl::t_worker = nullptr;
+
+// Submit argument event by inserting it in the queue that is
+// serviced by event handlers, or by handing it to the pool
+// servicing this queue.  Notify the handlers that work is ready.
+void
+event_queue_impl::
+submit(event_impl* ev)
+{
+  {
+    pool_user user(m_pool_users);
+    if (auto pool = m_pool.load()) {
+      pool->submit(ev);
+      return;
+    }
+  }
+
+  std::lock_guard<std::mutex> lk(m_mutex);
+  m_queue.push(ev);
+  m_work.notify_one();
+}
+
 // See comment block in event::impl::submit() declaration.
 bool
 event_impl::
@@ -299,15 +705,20 @@ done()
   XRT_DEBUGF("event_impl::done(%d)\n", m_uid);
 
   // Must only change done in critical section
+  std::vector<std::function<void()>> callbacks;
   {
     std::lock_guard<std::mutex> lk(m_mutex);
     m_done = true;
     m_wait_done.notify_all();
+    callbacks.swap(m_callbacks);
   }
 
   for (auto& ev : m_chain)
     ev->submit();
 
+  for (auto& fcn : callbacks)
+    fcn();
+
   m_event_queue->remove(this);
 }
 
@@ -379,6 +790,12 @@ done(xrt::event_impl* ev)
   ev->done();
 }
 
+void
+done(xrt::event_impl* ev, std::exception_ptr eptr)
+{
+  ev->done(eptr);
+}
+
 }} // namespace enqueue, xrt_core
 
 ////////////////////////////////////////////////////////////////
@@ -421,10 +838,46 @@ wait() const
     m_impl->wait();
 }
 
+void
+event_queue::
+event::
+add_callback(std::function<void()> fcn) const
+{
+  if (m_impl)
+    m_impl->add_callback(std::move(fcn));
+  else
+    fcn();
+}
+
 event_handler::
 event_handler(const event_queue& q)
   : m_impl(std::make_shared<event_handler_impl>(q))
 {
 }
+
+event_handler_pool::
+event_handler_pool(const event_queue& q, unsigned int threads)
+  : m_impl(std::make_shared<event_handler_pool_impl>(q, threads, std::vector<unsigned int>()))
+{
+}
+
+event_handler_pool::
+event_handler_pool(const event_queue& q, unsigned int threads, const std::vector<unsigned int>& cpus)
+  : m_impl(std::make_shared<event_handler_pool_impl>(q, threads, cpus))
+{
+}
+
+event_handler_pool::
+event_handler_pool(const event_queue& q, unsigned int threads, const device& device)
+{
+  std::vector<unsigned int> cpus;
+  try {
+    auto cpulist = xrt_core::device_query<xrt_core::query::pcie_local_cpulist>(device.get_handle());
+    cpus = xrt_core::parse_cpu_list(cpulist);
+  }
+  catch (const std::exception&) {
+  }
+  m_impl = std::make_shared<event_handler_pool_impl>(q, threads, cpus);
+}
   
 } // xrt
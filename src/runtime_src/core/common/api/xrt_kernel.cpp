@@ -22,7 +22,9 @@
 #include "core/include/experimental/xrt_kernel.h"
 
 #include "command.h"
+#include "command_template.h"
 #include "exec.h"
+#include "handle_table.h"
 #include "bo.h"
 #include "device_int.h"
 #include "enqueue.h"
@@ -43,7 +45,6 @@
 #include <chrono>
 #include <cstdarg>
 #include <cstdlib>
-#include <map>
 #include <memory>
 #include <mutex>
 #include <stdexcept>
@@ -209,24 +210,27 @@ value_to_uint32_vector(ValueType value)
 // What's worse is that not all data members are in all shims
 struct device_type
 {
+  // Cache enough exec buffers to fill all ERT command queue slots
+  static constexpr unsigned int exec_buffer_cache_size = 128;
+
   std::shared_ptr<xrt_core::device> core_device;
   xrt_core::bo_cache exec_buffer_cache;
 
   device_type(xrtDeviceHandle dhdl)
     : core_device(xrt_core::device_int::get_core_device(dhdl))
-    , exec_buffer_cache(core_device->get_device_handle(), 128)
+    , exec_buffer_cache(core_device->get_device_handle(), exec_buffer_cache_size)
   {}
 
   device_type(const std::shared_ptr<xrt_core::device>& cdev)
     : core_device(cdev)
-    , exec_buffer_cache(core_device->get_device_handle(), 128)
+    , exec_buffer_cache(core_device->get_device_handle(), exec_buffer_cache_size)
   {}
 
   template <typename CommandType>
-  xrt_core::bo_cache::cmd_bo<CommandType>
+  xrt_core::bo_cache::managed_bo<CommandType>
   create_exec_buf()
   {
-    return exec_buffer_cache.alloc<CommandType>();
+    return exec_buffer_cache.alloc_managed<CommandType>();
   }
 
   xrt_core::device*
@@ -342,7 +346,7 @@ private:
 class kernel_command : public xrt_core::command
 {
 public:
-  using execbuf_type = xrt_core::bo_cache::cmd_bo<ert_start_kernel_cmd>;
+  using execbuf_type = xrt_core::bo_cache::managed_bo<ert_start_kernel_cmd>;
   using callback_function_type = std::function<void(ert_cmd_state)>;
   using callback_list = std::vector<callback_function_type>;
 
@@ -360,8 +364,6 @@ public:
   ~kernel_command()
   {
     XRT_DEBUGF("kernel_command::~kernel_command(%d)\n", m_uid);
-    // This is problematic, bo_cache should return managed BOs
-    m_device->exec_buffer_cache.release(m_execbuf);
   }
 
   /**
@@ -431,6 +433,32 @@ public:
     m_event = event;
   }
 
+  // set_completion_handler() - one-shot notification of completion
+  //
+  // @fcn:  Function to call with the final state of the cmd
+  //
+  // The function is called once, from notify() when the cmd
+  // completes, or immediately if the cmd is already complete.  The
+  // handler is cleared when called and is not called for subsequent
+  // executions of the cmd.  Unlike callbacks, which persist, this is
+  // used by one-time waiters such as coroutine awaitables.
+  void
+  set_completion_handler(std::function<void(ert_cmd_state)> fcn) const
+  {
+    ert_cmd_state state;
+    {
+      std::lock_guard<std::mutex> lk(m_mutex);
+      if (!m_done) {
+        m_completion = std::move(fcn);
+        return;
+      }
+      state = static_cast<ert_cmd_state>(get_ert_packet()->state);
+    }
+
+    // lock must not be held while calling the handler
+    fcn(state);
+  }
+
   /**
    * Run registered callbacks.
    */
@@ -460,18 +488,25 @@ public:
       (*cb)(state);
   }
 
+  /**
+   * Mark the command as submitted, must precede scheduling
+   */
+  void
+  prepare_run()
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    if (!m_done)
+      throw std::runtime_error("bad command state, can't launch");
+    m_done = false;
+  }
+
   /**
    * Submit the command for execution
    */
   void
   run()
   {
-    {
-      std::lock_guard<std::mutex> lk(m_mutex);
-      if (!m_done)
-        throw std::runtime_error("bad command state, can't launch");
-      m_done = false;
-    }
+    prepare_run();
     xrt_core::exec::schedule(this);
   }
 
@@ -506,7 +541,7 @@ public:
   virtual ert_packet*
   get_ert_packet() const
   {
-    return reinterpret_cast<ert_packet*>(m_execbuf.second);
+    return reinterpret_cast<ert_packet*>(m_execbuf.get());
   }
 
   virtual xrt_core::device*
@@ -518,23 +553,29 @@ public:
   virtual xclBufferHandle
   get_exec_bo() const
   {
-    return m_execbuf.first;
+    return m_execbuf.get_handle();
   }
 
   virtual void
   notify(ert_cmd_state s)
   {
     bool complete = false;
+    std::function<void(ert_cmd_state)> completion;
     if (s>=ERT_CMD_STATE_COMPLETED) {
       std::lock_guard<std::mutex> lk(m_mutex);
       XRT_DEBUGF("kernel_command::notify() m_uid(%d) m_state(%d)\n", m_uid, s);
       complete = m_done = true;
       if (m_event)
         xrt_core::enqueue::done(m_event.get());
+      completion = std::move(m_completion);
+      m_completion = nullptr;
       m_exec_done.notify_all();  // CAN THIS BE MOVED TO END AFTER CALLBACKS?
     }
 
     if (complete) {
+      if (completion)
+        completion(s);
+
       run_callbacks(s);
 
       // Clear the event if any.  This must be last since if used, it
@@ -547,6 +588,7 @@ public:
 private:
   device_type* m_device = nullptr;
   mutable std::shared_ptr<xrt::event_impl> m_event;
+  mutable std::function<void(ert_cmd_state)> m_completion;
   execbuf_type m_execbuf; // underlying execution buffer
   unsigned int m_uid = 0;
   bool m_done = false;
@@ -697,6 +739,11 @@ private:
   xarg arg;       // argument meta data from xclbin
   int32_t grpid;  // memory bank group id
 
+  // Location of argument value in command payload, computed once
+  // per kernel based on control protocol
+  size_t payload_offset = 0; // word offset of value in payload
+  size_t payload_words = 0;  // number of words of value in payload
+
   std::unique_ptr<iarg> content;
 
 public:
@@ -708,11 +755,14 @@ public:
   {}
 
   argument(argument&& rhs)
-    : arg(std::move(rhs.arg)), grpid(rhs.grpid), content(std::move(rhs.content))
+    : arg(std::move(rhs.arg)), grpid(rhs.grpid)
+    , payload_offset(rhs.payload_offset), payload_words(rhs.payload_words)
+    , content(std::move(rhs.content))
   {}
 
   argument(xrt_core::device* dev, xarg&& karg, int32_t grp)
     : arg(std::move(karg)), grpid(grp)
+    , payload_offset(arg.offset / sizeof(uint32_t)), payload_words(arg.size / sizeof(uint32_t))
   {
     // Determine type
     switch (arg.type) {
@@ -780,6 +830,27 @@ public:
     return content->set(setter, *this, args);
   }
 
+  // Copy argument value to its precomputed location in the command
+  // payload.  No lookup or protocol dispatch, this is the hot path
+  // for setting arguments of a run.
+  void
+  set_payload(uint32_t* data, const arg_range<uint32_t>& value) const
+  {
+    xrt_core::command_template::set_payload(data, payload_offset, payload_words, value.begin(), value.size());
+  }
+
+  void
+  set_payload_offset(size_t offset)
+  { payload_offset = offset; }
+
+  bool
+  is_global() const
+  { return arg.type == xarg::argtype::global; }
+
+  bool
+  is_scalar() const
+  { return arg.type == xarg::argtype::scalar; }
+
   void
   set_fa_desc_offset(size_t offset)
   { arg.fa_desc_offset = offset; }
@@ -848,6 +919,7 @@ class kernel_impl
   size_t fa_output_entry_bytes = 0;    // Fast adapter output desc bytes
   size_t num_cumasks = 1;              // Required number of command cu masks
   uint32_t protocol = 0;               // Default opcode
+  std::vector<uint32_t> cmd_template;  // Precomputed command packet
 
   // Compute data for FAST_ADAPTER descriptor use (see ert_fa.h)
   //
@@ -874,6 +946,7 @@ class kernel_impl
 
       ++fa_num_inputs;
       arg.set_fa_desc_offset(desc_offset);
+      arg.set_payload_offset(xrt_core::command_template::fa_payload_offset(desc_offset));
       desc_offset += arg.size() + sizeof(ert_fa_desc_entry);
       fa_input_entry_bytes += arg.size();
     }
@@ -885,6 +958,7 @@ class kernel_impl
 
       ++fa_num_outputs;
       arg.set_fa_desc_offset(desc_offset);
+      arg.set_payload_offset(xrt_core::command_template::fa_payload_offset(desc_offset));
       desc_offset += arg.size() + sizeof(ert_fa_desc_entry);
       fa_output_entry_bytes += arg.size();
     }
@@ -961,42 +1035,28 @@ class kernel_impl
     return ctrl;
   }
 
+  // Precompute the command packet used by all runs of this kernel
+  //
+  // Runs of the kernel copy this template into their exec buffer and
+  // subsequently only patch argument values.
   void
-  encode_compute_units(kernel_command* cmd)
+  build_command_template()
   {
-    auto ecmd = cmd->get_ert_cmd<ert_packet*>();
-    std::fill(ecmd->data, ecmd->data + num_cumasks, 0);
-
-    for (size_t cu_idx = 0; cu_idx < 128; ++cu_idx) {
-      if (!cumask.test(cu_idx))
-        continue;
-      auto mask_idx = cu_idx / 32;
-      auto idx_in_mask = cu_idx - mask_idx * 32;
-      ecmd->data[mask_idx] |= (1 << idx_in_mask);
+    if (protocol != FAST_ADAPTER) {
+      cmd_template = xrt_core::command_template::build(cumask, num_cumasks, regmap_size, nullptr);
+      return;
     }
-  }
 
-  void
-  initialize_command_header(ert_start_kernel_cmd* kcmd)
-  {
-    kcmd->extra_cu_masks = num_cumasks - 1;  //  -1 for mandatory mask
-    kcmd->count = num_cumasks + regmap_size;
-    kcmd->opcode = (protocol == FAST_ADAPTER) ? ERT_START_FA : ERT_START_CU;
-    kcmd->type = ERT_CU;
-  }
-
-  void
-  initialize_fadesc(uint32_t* data)
-  {
-    auto desc = reinterpret_cast<ert_fa_descriptor*>(data);
-    desc->status = ERT_FA_ISSUED; // somewhat misleading
-    desc->num_input_entries = fa_num_inputs;
-    desc->input_entry_bytes = fa_input_entry_bytes;
-    desc->num_output_entries = fa_num_outputs;
-    desc->output_entry_bytes = fa_output_entry_bytes;
+    xrt_core::command_template::fa_desc fa;
+    fa.num_inputs = fa_num_inputs;
+    fa.num_outputs = fa_num_outputs;
+    fa.input_entry_bytes = fa_input_entry_bytes;
+    fa.output_entry_bytes = fa_output_entry_bytes;
+    for (auto& arg : args)
+      fa.args.push_back({arg.fa_desc_offset(), arg.offset(), arg.size()});
+    cmd_template = xrt_core::command_template::build(cumask, num_cumasks, regmap_size, &fa);
   }
 
-
 public:
   // kernel_type - constructor
   //
@@ -1059,22 +1119,54 @@ public:
 
     // amend args with computed data based on kernel protocol
     amend_args();
+
+    // command packet shared by all runs of this kernel
+    build_command_template();
+
+    // populate exec buffer cache so runs of this kernel can be
+    // created without allocating exec buffers, two per CU allows
+    // each CU to have a command queued while another is running
+    device->exec_buffer_cache.prewarm(static_cast<unsigned int>(2 * ips.size()));
   }
 
-  // Initialize kernel command and return pointer to payload
-  // after mandatory static data.
+  // Initialize kernel command from precomputed template and return
+  // pointer to payload after mandatory static data.
   uint32_t*
   initialize_command(kernel_command* cmd)
   {
     auto kcmd = cmd->get_ert_cmd<ert_start_kernel_cmd*>();
-    initialize_command_header(kcmd);
-    encode_compute_units(cmd);
-    auto data = kcmd->data + kcmd->extra_cu_masks;
+    return xrt_core::command_template::initialize(cmd_template, kcmd);
+  }
 
-    if (kcmd->opcode == ERT_START_FA)
-      initialize_fadesc(data);
+  // Validate host side argument types against kernel meta data.
+  // Used by typed kernels to validate arguments once at construction
+  // such that arguments can subsequently be set without checks.
+  void
+  validate_args(const xrt::detail::arg_info* info, size_t count) const
+  {
+    size_t num_args = 0;
+    for (auto& arg : args) {
+      if (arg.index() == argument::no_index)
+        break;
+      ++num_args;
+    }
 
-    return data;
+    if (count != num_args)
+      throw std::runtime_error
+        ("Kernel '" + name + "' has " + std::to_string(num_args)
+         + " arguments, typed kernel specifies " + std::to_string(count));
+
+    for (size_t idx = 0; idx < count; ++idx) {
+      auto& arg = args[idx];
+      if (info[idx].global && !arg.is_global())
+        throw std::runtime_error("Kernel argument '" + arg.name() + "' is not a global argument");
+      if (!info[idx].global && !arg.is_scalar())
+        throw std::runtime_error("Kernel argument '" + arg.name() + "' is not a scalar argument");
+      if (!info[idx].global && info[idx].size != arg.size())
+        throw std::runtime_error
+          ("Bad size '" + std::to_string(info[idx].size) + "' for kernel argument '"
+           + arg.name() + "', expected '" + std::to_string(arg.size()) + "'");
+    }
   }
 
   IP_CONTROL
@@ -1160,10 +1252,10 @@ public:
 // its own execution buffer (ert command object)
 class run_impl
 {
-  // Helper hierarchy to set argument value per control protocol type
-  // The @data member is the payload to be populated with argument
-  // value.  The interpretation of the payload depends on the control
-  // protocol.
+  // Helper to set argument value from va_list.  The @data member is
+  // the payload to be populated with argument value.  The argument
+  // knows its location in the payload regardless of control protocol,
+  // see kernel_impl::build_command_template()
   struct arg_setter : argument::setter
   {
     uint32_t* data;
@@ -1172,60 +1264,19 @@ class run_impl
       : data(d)
     {}
 
-    virtual void
-    set_arg_value(const argument& arg, const arg_range<uint32_t>& value) = 0;
-  };
-
-  // AP_CTRL_HS, AP_CTRL_CHAIN
-  struct hs_arg_setter : arg_setter
-  {
-    hs_arg_setter(uint32_t* data)
-      : arg_setter(data)
-    {}
-
-    virtual void
-    set_arg_value(const argument& arg, const arg_range<uint32_t>& value)
-    {
-      auto cmdidx = arg.offset() / 4;
-      auto count = std::min(arg.size() / sizeof(uint32_t), value.size());
-      std::copy_n(value.begin(), count, data + cmdidx);
-    }
-  };
-
-  // FAST_ADAPTER
-  struct fa_arg_setter : arg_setter
-  {
-    fa_arg_setter(uint32_t* data)
-      : arg_setter(data)
-    {}
-
     virtual void
     set_arg_value(const argument& arg, const arg_range<uint32_t>& value)
     {
-      auto desc = reinterpret_cast<ert_fa_descriptor*>(data);
-      auto desc_entry = reinterpret_cast<ert_fa_desc_entry*>(desc->data + arg.fa_desc_offset() / sizeof(uint32_t));
-      desc_entry->arg_offset = arg.offset();
-      desc_entry->arg_size = arg.size();
-      auto count = std::min(arg.size() / sizeof(uint32_t), value.size());
-      std::copy_n(value.begin(), count, desc_entry->arg_value);
+      arg.set_payload(data, value);
     }
   };
 
-  std::unique_ptr<arg_setter>
-  make_arg_setter()
-  {
-    if (kernel->get_ip_control_protocol() == FAST_ADAPTER)
-      return std::make_unique<fa_arg_setter>(data);
-    else
-      return std::make_unique<hs_arg_setter>(data);
-  }
-  
   using callback_function_type = std::function<void(ert_cmd_state)>;
   std::shared_ptr<kernel_impl> kernel;    // shared ownership
   xrt_core::device* core_device;          // convenience, in scope of kernel
   std::shared_ptr<kernel_command> cmd;    // underlying command object
   uint32_t* data;                         // command argument data payload @0x0
-  std::unique_ptr<arg_setter> arg_setter; // helper to populate payload data
+  arg_setter setter;                      // helper to populate payload data
 
 public:
   void
@@ -1249,6 +1300,13 @@ public:
     cmd->set_event(event);
   }
 
+  // set_completion_handler() - one-shot notification of completion
+  void
+  set_completion_handler(std::function<void(ert_cmd_state)> fcn) const
+  {
+    cmd->set_completion_handler(std::move(fcn));
+  }
+
   // run_type() - constructor
   //
   // @krnl:  kernel object to run
@@ -1257,7 +1315,7 @@ public:
     , core_device(kernel->get_core_device()) // cache core device
     , cmd(std::make_shared<kernel_command>(kernel->get_device()))
     , data(kernel->initialize_command(cmd.get()))
-    , arg_setter(make_arg_setter())
+    , setter(data)
   {}
 
   kernel_impl*
@@ -1276,7 +1334,7 @@ public:
   void
   set_arg_value(const argument& arg, const arg_range<uint32_t>& value)
   {
-    arg_setter->set_arg_value(arg, value);
+    arg.set_payload(data, value);
   }
 
   void
@@ -1288,7 +1346,7 @@ public:
   void
   set_arg(const argument& arg, std::va_list* args)
   {
-    arg.set(arg_setter.get(), args);
+    arg.set(&setter, args);
   }
 
   void
@@ -1312,6 +1370,18 @@ public:
     set_arg_value(arg, value, bytes);
   }
 
+  // set_args() - set first @count arguments from host values
+  //
+  // The argument values must have been validated against the kernel
+  // meta data, see kernel_impl::validate_args()
+  void
+  set_args(const void* const* values, size_t count)
+  {
+    auto& args = kernel->get_args();
+    for (size_t idx = 0; idx < count; ++idx)
+      args[idx].set_payload(data, arg_range<uint32_t>{values[idx], args[idx].size()});
+  }
+
   void
   get_arg_at_index(size_t index, uint32_t* out, size_t bytes)
   {
@@ -1340,6 +1410,16 @@ public:
     cmd->run();
   }
 
+  // prepare_start() - prepare run object for batched scheduling
+  kernel_command*
+  prepare_start()
+  {
+    cmd->prepare_run();
+    auto pkt = cmd->get_ert_packet();
+    pkt->state = ERT_CMD_STATE_NEW;
+    return cmd.get();
+  }
+
   // wait() - wait for execution to complete
   ert_cmd_state
   wait(const std::chrono::milliseconds& timeout_ms) const
@@ -1465,28 +1545,28 @@ namespace {
 // weak_ptr, the cache would hold on to the device until static global
 // destruction and long after application calls xclClose on the
 // xrtDeviceHandle.
-static std::map<xrtDeviceHandle, std::weak_ptr<device_type>> devices;
+static xrt_core::handle_table<xrtDeviceHandle, std::weak_ptr<device_type>> devices;
 
 // Active kernels per xrtKernelOpen/Close.  This is a mapping from
 // xrtKernelHandle to the corresponding kernel object.  The
 // xrtKernelHandle is the address of the kernel object.  This is
 // shared ownership as application can close a kernel handle before
 // closing an xrtRunHandle that references same kernel.
-static std::map<void*, std::shared_ptr<xrt::kernel_impl>> kernels;
+static xrt_core::handle_table<void*, std::shared_ptr<xrt::kernel_impl>> kernels;
 
 // Active runs.  This is a mapping from xrtRunHandle to corresponding
 // run object.  The xrtRunHandle is the address of the run object.
 // This is unique ownership as only the host application holds on to a
 // run object, e.g. the run object is desctructed immediately when it
 // is closed.
-static std::map<void*, std::unique_ptr<xrt::run_impl>> runs;
+static xrt_core::handle_table<void*, std::unique_ptr<xrt::run_impl>> runs;
 
 // Run updates, if used are tied to existing runs and removed
 // when run is closed.
-static std::map<const xrt::run_impl*, std::unique_ptr<xrt::run_update_type>> run_updates;
+static xrt_core::handle_table<const xrt::run_impl*, std::unique_ptr<xrt::run_update_type>> run_updates;
 
-// Mutex to protect access to maps
-static std::mutex map_mutex;
+// The tables are sharded by handle such that C API calls from
+// multiple threads on different handles do not contend on a lock.
 
 // get_device() - get a device object from an xrtDeviceHandle
 //
@@ -1499,16 +1579,15 @@ static std::mutex map_mutex;
 static std::shared_ptr<device_type>
 get_device(xrtDeviceHandle dhdl)
 {
-  std::lock_guard<std::mutex> lk(map_mutex);
-  auto itr = devices.find(dhdl);
-  std::shared_ptr<device_type> device = (itr != devices.end())
-    ? (*itr).second.lock()
-    : nullptr;
-  if (!device) {
-    device = std::shared_ptr<device_type>(new device_type(dhdl));
-    xrt_core::exec::init(device->get_core_device());
-    devices.emplace(std::make_pair(dhdl, device));
-  }
+  std::shared_ptr<device_type> device;
+  devices.update(dhdl, [&](std::weak_ptr<device_type>& entry) {
+    device = entry.lock();
+    if (!device) {
+      device = std::shared_ptr<device_type>(new device_type(dhdl));
+      xrt_core::exec::init(device->get_core_device());
+      entry = device;
+    }
+  });
   return device;
 }
 
@@ -1517,16 +1596,15 @@ get_device(const std::shared_ptr<xrt_core::device>& core_device)
 {
   auto dhdl = core_device.get();
 
-  std::lock_guard<std::mutex> lk(map_mutex);
-  auto itr = devices.find(dhdl);
-  std::shared_ptr<device_type> device = (itr != devices.end())
-    ? (*itr).second.lock()
-    : nullptr;
-  if (!device) {
-    device = std::shared_ptr<device_type>(new device_type(core_device));
-    xrt_core::exec::init(device->get_core_device());
-    devices.emplace(std::make_pair(dhdl, device));
-  }
+  std::shared_ptr<device_type> device;
+  devices.update(dhdl, [&](std::weak_ptr<device_type>& entry) {
+    device = entry.lock();
+    if (!device) {
+      device = std::shared_ptr<device_type>(new device_type(core_device));
+      xrt_core::exec::init(device->get_core_device());
+      entry = device;
+    }
+  });
   return device;
 }
 
@@ -1543,10 +1621,10 @@ get_device(const xrt::device& xdev)
 static std::shared_ptr<xrt::kernel_impl>
 get_kernel(xrtKernelHandle khdl)
 {
-  auto itr = kernels.find(khdl);
-  if (itr == kernels.end())
+  auto kernel = kernels.get(khdl);
+  if (!kernel)
     throw xrt_core::error(-EINVAL, "Unknown kernel handle");
-  return (*itr).second;
+  return kernel;
 }
 
 // get_run() - get a run object from an xrtRunHandle
@@ -1555,21 +1633,22 @@ get_kernel(xrtKernelHandle khdl)
 static xrt::run_impl*
 get_run(xrtRunHandle rhdl)
 {
-  auto itr = runs.find(rhdl);
-  if (itr == runs.end())
+  auto run = runs.find(rhdl);
+  if (!run)
     throw xrt_core::error(-EINVAL, "Unknown run handle");
-  return (*itr).second.get();
+  return (*run).get();
 }
 
 static xrt::run_update_type*
 get_run_update(xrt::run_impl* run)
 {
-  auto itr = run_updates.find(run);
-  if (itr == run_updates.end()) {
-    auto ret = run_updates.emplace(std::make_pair(run,std::make_unique<xrt::run_update_type>(run)));
-    itr = ret.first;
-  }
-  return (*itr).second.get();
+  xrt::run_update_type* update = nullptr;
+  run_updates.update(run, [&](std::unique_ptr<xrt::run_update_type>& entry) {
+    if (!entry)
+      entry = std::make_unique<xrt::run_update_type>(run);
+    update = entry.get();
+  });
+  return update;
 }
 
 static xrt::run_update_type*
@@ -1590,17 +1669,15 @@ xrtKernelOpen(xrtDeviceHandle dhdl, const xuid_t xclbin_uuid, const char *name,
   auto device = get_device(dhdl);
   auto kernel = std::make_shared<xrt::kernel_impl>(device, xclbin_uuid, name, am);
   auto handle = kernel.get();
-  kernels.emplace(std::make_pair(handle,std::move(kernel)));
+  kernels.emplace(handle, std::move(kernel));
   return handle;
 }
 
 void
 xrtKernelClose(xrtKernelHandle khdl)
 {
-  auto itr = kernels.find(khdl);
-  if (itr == kernels.end())
+  if (!kernels.erase(khdl))
     throw xrt_core::error(-EINVAL, "Unknown kernel handle");
-  kernels.erase(itr);
 }
 
 xrtRunHandle
@@ -1609,7 +1686,7 @@ xrtRunOpen(xrtKernelHandle khdl)
   auto kernel = get_kernel(khdl);
   auto run = std::make_unique<xrt::run_impl>(kernel);
   auto handle = run.get();
-  runs.emplace(std::make_pair(handle,std::move(run)));
+  runs.emplace(handle, std::move(run));
   return handle;
 }
 
@@ -1617,11 +1694,7 @@ void
 xrtRunClose(xrtRunHandle rhdl)
 {
   auto run = get_run(rhdl);
-  {
-    auto itr = run_updates.find(run);
-    if (itr != run_updates.end())
-      run_updates.erase(itr);
-  }
+  run_updates.erase(run);
   runs.erase(run);
 }
 
@@ -1744,6 +1817,13 @@ set_arg_at_index(int index, const xrt::bo& glb)
   handle->set_arg_at_index(index, glb);
 }
 
+void
+run::
+set_args(const void* const* values, size_t count)
+{
+  handle->set_args(values, count);
+}
+
 void
 run::
 update_arg_at_index(int index, const void* value, size_t bytes)
@@ -1778,6 +1858,48 @@ set_event(const std::shared_ptr<event_impl>& event) const
   handle->set_event(event);
 }
 
+void
+run::
+set_completion_handler(std::function<void(ert_cmd_state)> fcn) const
+{
+  handle->set_completion_handler(std::move(fcn));
+}
+
+void
+run_list::
+start()
+{
+  std::vector<xrt_core::command*> cmds;
+  cmds.reserve(runs.size());
+  try {
+    for (auto& r : runs)
+      cmds.push_back(r.get_handle()->prepare_start());
+  }
+  catch (const std::exception& ex) {
+    // runs prepared prior to the failing one must still be scheduled,
+    // the caller is told how many to wait for
+    auto prepared = cmds.size();
+    try {
+      xrt_core::exec::schedule(cmds.data(), prepared);
+    }
+    catch (const xrt_core::exec::schedule_error& sex) {
+      throw run_list::start_error
+        (sex.submitted(), "run_list start failed at run " + std::to_string(sex.submitted()) + ": " + sex.what());
+    }
+    throw run_list::start_error
+      (prepared, "run_list start failed at run " + std::to_string(prepared) + ": " + ex.what());
+  }
+
+  // runs that could not be submitted are aborted by the scheduler
+  try {
+    xrt_core::exec::schedule(cmds.data(), cmds.size());
+  }
+  catch (const xrt_core::exec::schedule_error& ex) {
+    throw run_list::start_error
+      (ex.submitted(), "run_list start failed at run " + std::to_string(ex.submitted()) + ": " + ex.what());
+  }
+}
+
 kernel::
 kernel(const xrt::device& xdev, const xrt::uuid& xclbin_id, const std::string& name, cu_access_mode mode)
   : handle(std::make_shared<kernel_impl>
@@ -1819,6 +1941,13 @@ offset(int argno) const
   return handle->arg_offset(argno);
 }
 
+void
+kernel::
+validate_args(const detail::arg_info* info, size_t count) const
+{
+  handle->validate_args(info, count);
+}
+
 } // namespace xrt
 
 ////////////////////////////////////////////////////////////////
@@ -67,6 +67,20 @@ public:
     return event;
   }
 
+  std::vector<pipeline::stage_stats>
+  get_stage_stats() const
+  {
+    std::vector<pipeline::stage_stats> stats;
+    for (auto& s : m_stages) {
+      auto& c = s.get_counters();
+      stats.push_back({c.executions, c.queued,
+                       std::chrono::nanoseconds(c.wait_ns),
+                       std::chrono::nanoseconds(c.latency_ns),
+                       std::chrono::nanoseconds(c.max_latency_ns)});
+    }
+    return stats;
+  }
+
   const pipeline::stage&
   add_stage(pipeline::stage&& s)
   {
@@ -102,6 +116,13 @@ add_stage(pipeline::stage&& s)
   return m_impl->add_stage(std::move(s));
 }
 
+std::vector<pipeline::stage_stats>
+pipeline::
+get_stage_stats() const
+{
+  return m_impl->get_stage_stats();
+}
+
 
   
   
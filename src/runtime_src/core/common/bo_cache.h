@@ -21,9 +21,13 @@
 #include "device.h"
 #include "ert.h"
 
+#include <algorithm>
+#include <array>
+#include <functional>
 #include <vector>
 #include <utility>
 #include <mutex>
+#include <thread>
 
 #ifdef _WIN32
 # pragma warning( push )
@@ -32,37 +36,101 @@
 
 namespace xrt_core {
 
-// Create a cache of CMD BO objects -- for now only used for M2M -- to reduce
-// the overhead of BO life cycle management.
+// Create a cache of CMD BO objects to reduce the overhead of BO life
+// cycle management.
+//
+// The cache is split into shards each with its own lock.  A thread
+// allocates from and releases to the shard selected by its thread id,
+// and falls back to the other shards before allocating a new BO, so
+// threads churning commands concurrently rarely contend on a lock.
 class bo_cache {
 public:
   // Helper typedef for std::pair. Note the elements are const so that the
   // pair is immutable. The clients should not change the contents of cmd_bo.
   template <typename CommandType>
   using cmd_bo = std::pair<const xclBufferHandle, CommandType *const>;
+
+  // Managed CMD BO that is returned to the cache when destructed.
+  // The managed BO must not outlive the cache from which it was
+  // allocated.
+  template <typename CommandType>
+  class managed_bo
+  {
+    bo_cache* m_cache;
+    xclBufferHandle m_handle;
+    CommandType* m_cmd;
+
+  public:
+    managed_bo(bo_cache* cache, const cmd_bo<CommandType>& bo)
+      : m_cache(cache), m_handle(bo.first), m_cmd(bo.second)
+    {}
+
+    managed_bo(managed_bo&& rhs)
+      : m_cache(rhs.m_cache), m_handle(rhs.m_handle), m_cmd(rhs.m_cmd)
+    {
+      rhs.m_cache = nullptr;
+    }
+
+    managed_bo(const managed_bo&) = delete;
+    managed_bo& operator=(const managed_bo&) = delete;
+    managed_bo& operator=(managed_bo&&) = delete;
+
+    ~managed_bo()
+    {
+      if (m_cache)
+        m_cache->release_impl(std::make_pair(m_handle, static_cast<void *>(m_cmd)));
+    }
+
+    xclBufferHandle
+    get_handle() const
+    {
+      return m_handle;
+    }
+
+    CommandType*
+    get() const
+    {
+      return m_cmd;
+    }
+  };
+
 private:
 
   // We are really allocating a page size as that is what xocl/zocl do. Note on
   // POWER9 pagesize maybe more than 4K, xocl would upsize the allocation to the
   // correct pagesize. unmap always unmaps the full page.
   static const size_t mBOSize = 4096;
+  static const size_t mNumShards = 8;
+
+  struct shard {
+    std::vector<cmd_bo<void>> mCmdBOCache;
+    std::mutex mCacheMutex;
+  };
+
   std::shared_ptr<device> mDevice;
   // Maximum number of BOs that can be cached in the pool. Value of 0 indicates
   // caching should be disabled.
   const unsigned int mCacheMaxSize;
-  std::vector<cmd_bo<void>> mCmdBOCache;
-  std::mutex mCacheMutex;
+  // Number of shards in use, never more shards than cached BOs
+  const size_t mActiveShards;
+  // Maximum number of BOs cached per shard
+  const size_t mShardMaxSize;
+  std::array<shard, mNumShards> mShards;
 
 public:
  bo_cache(xclDeviceHandle handle, unsigned int max_size)
    : mDevice(get_userpf_device(handle)), mCacheMaxSize(max_size)
+   , mActiveShards(std::max<size_t>(1, std::min<size_t>(mNumShards, max_size)))
+   , mShardMaxSize((max_size + mActiveShards - 1) / mActiveShards)
   {}
 
   ~bo_cache()
   {
-    std::lock_guard<std::mutex> lock(mCacheMutex);
-    for (auto& bo : mCmdBOCache)
-      destroy(bo);
+    for (auto& sh : mShards) {
+      std::lock_guard<std::mutex> lock(sh.mCacheMutex);
+      for (auto& bo : sh.mCmdBOCache)
+        destroy(bo);
+    }
   }
 
   template<typename T>
@@ -73,6 +141,13 @@ public:
     return std::make_pair(bo.first, static_cast<T *>(bo.second));
   }
 
+  template<typename T>
+  managed_bo<T>
+  alloc_managed()
+  {
+    return managed_bo<T>(this, alloc<T>());
+  }
+
   template<typename T>
   void
   release(cmd_bo<T>& bo)
@@ -80,17 +155,45 @@ public:
     release_impl(std::make_pair(bo.first, static_cast<void *>(bo.second)));
   }
 
+  // Populate the cache with up to count BOs so that subsequent
+  // allocations do not incur BO allocation and mapping
+  void
+  prewarm(unsigned int count)
+  {
+    count = std::min(count, mCacheMaxSize);
+    for (size_t idx = 0; idx < mActiveShards && count; ++idx) {
+      auto& sh = mShards[idx];
+      std::lock_guard<std::mutex> lock(sh.mCacheMutex);
+      while (count && sh.mCmdBOCache.size() < mShardMaxSize) {
+        auto execHandle = mDevice->alloc_bo(mBOSize, XCL_BO_FLAGS_EXECBUF);
+        sh.mCmdBOCache.push_back(std::make_pair(execHandle, mDevice->map_bo(execHandle, true)));
+        --count;
+      }
+    }
+  }
+
 private:
+  size_t
+  get_shard_index() const
+  {
+    return std::hash<std::thread::id>()(std::this_thread::get_id()) % mActiveShards;
+  }
+
   cmd_bo<void>
   alloc_impl()
   {
     if (mCacheMaxSize) {
-      // If caching is enabled first look up in the BO cache
-      std::lock_guard<std::mutex> lock(mCacheMutex);
-      if (!mCmdBOCache.empty()) {
-        auto bo = mCmdBOCache.back();
-        mCmdBOCache.pop_back();
-        return bo;
+      // If caching is enabled first look up in the BO cache starting
+      // with the shard of this thread
+      auto first = get_shard_index();
+      for (size_t idx = 0; idx < mActiveShards; ++idx) {
+        auto& sh = mShards[(first + idx) % mActiveShards];
+        std::lock_guard<std::mutex> lock(sh.mCacheMutex);
+        if (!sh.mCmdBOCache.empty()) {
+          auto bo = sh.mCmdBOCache.back();
+          sh.mCmdBOCache.pop_back();
+          return bo;
+        }
       }
     }
 
@@ -103,10 +206,14 @@ private:
   {
     if (mCacheMaxSize) {
       // If caching is enabled and BO cache is not fully populated add this the cache
-      std::lock_guard<std::mutex> lock(mCacheMutex);
-      if (mCmdBOCache.size() < mCacheMaxSize) {
-        mCmdBOCache.push_back(bo);
-        return;
+      auto first = get_shard_index();
+      for (size_t idx = 0; idx < mActiveShards; ++idx) {
+        auto& sh = mShards[(first + idx) % mActiveShards];
+        std::lock_guard<std::mutex> lock(sh.mCacheMutex);
+        if (sh.mCmdBOCache.size() < mShardMaxSize) {
+          sh.mCmdBOCache.push_back(bo);
+          return;
+        }
       }
     }
     destroy(bo);
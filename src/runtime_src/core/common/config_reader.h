@@ -235,6 +235,58 @@ get_aie_trace_buffer_size()
   return value;
 }
 
+/**
+ * Maximum number of trace events held in host memory by the profiling
+ * database.  0 means unbounded.  When set, events are written out
+ * incrementally by a background thread.  Every flush starts a new
+ * trace file, so the start and end of an event (an API call, a
+ * kernel execution) can be written to different files.  The end
+ * event still refers to its start by event id, but a file read on
+ * its own has unmatched ends and starts at its boundaries.
+ */
+inline unsigned int
+get_trace_event_limit()
+{
+  static unsigned int value = detail::get_uint_value("Debug.trace_event_limit", 0);
+  return value;
+}
+
+/**
+ * What to do with new trace events when trace_event_limit is reached
+ * before the events could be written out: "none" keeps them, "newest"
+ * drops them.
+ */
+inline std::string
+get_trace_drop_policy()
+{
+  static std::string value = detail::get_string_value("Debug.trace_drop_policy", "none");
+  return value;
+}
+
+/**
+ * Format of the trace files written by the profiling plugins: "csv"
+ * or "binary".  Binary traces are converted to csv with
+ * xdp_trace_convert.  AIE trace files are always text.
+ */
+inline std::string
+get_trace_file_format()
+{
+  static std::string value = detail::get_string_value("Debug.trace_file_format", "csv");
+  return value;
+}
+
+/**
+ * How API and compute unit statistics are kept for summaries:
+ * "streaming" keeps a fixed size latency histogram per API and compute
+ * unit, "full" additionally keeps the start and end time of every call.
+ */
+inline std::string
+get_statistics_mode()
+{
+  static std::string value = detail::get_string_value("Debug.statistics_mode", "streaming");
+  return value;
+}
+
 inline bool
 get_profile_api()
 {
@@ -300,6 +352,50 @@ get_verbosity()
   return value;
 }
 
+/**
+ * Write runtime_log messages from a background thread so that callers
+ * do not wait for console, file or syslog output
+ */
+inline bool
+get_runtime_log_async()
+{
+  static bool value = detail::get_bool_value("Runtime.runtime_log_async",false);
+  return value;
+}
+
+/**
+ * Messages queued for the runtime_log_async writer thread
+ */
+inline unsigned int
+get_runtime_log_queue_size()
+{
+  static unsigned int value = detail::get_uint_value("Runtime.runtime_log_queue_size",4096);
+  return value;
+}
+
+/**
+ * What runtime_log_async does with messages when its queue is full.
+ * "block" waits for the writer thread, "drop" drops the message and
+ * "count" drops it and logs how many messages were dropped.
+ */
+inline std::string
+get_runtime_log_overflow()
+{
+  static std::string value = detail::get_string_value("Runtime.runtime_log_overflow","count");
+  return value;
+}
+
+/**
+ * Identical runtime_log_async messages written per second; repeats
+ * beyond that are counted and logged as one message. 0 = no limit
+ */
+inline unsigned int
+get_runtime_log_rate_limit()
+{
+  static unsigned int value = detail::get_uint_value("Runtime.runtime_log_rate_limit",10);
+  return value;
+}
+
 inline unsigned int
 get_dma_threads()
 {
@@ -314,6 +410,29 @@ get_polling_throttle()
   return value;
 }
 
+/**
+ * Let the software scheduler (sws) learn the expected execution time
+ * of each CU and poll for completion only near the predicted time,
+ * otherwise sleep.  Overrides Runtime.polling_throttle.
+ */
+inline bool
+get_adaptive_polling()
+{
+  static bool value = detail::get_bool_value("Runtime.adaptive_polling",false);
+  return value;
+}
+
+/**
+ * Run the software scheduler (sws) with one scheduler thread per
+ * device rather than one thread shared by all devices.
+ */
+inline bool
+get_sws_thread_per_device()
+{
+  static bool value = detail::get_bool_value("Runtime.sws_thread_per_device",false);
+  return value;
+}
+
 inline std::string
 get_hal_logging()
 {
@@ -355,6 +474,28 @@ get_xma_cpu_mode()
   return value;
 }
 
+/**
+ * Enable xma automatic placement. Sessions created with cu_index = -1
+ * go to the least loaded CU of the kernel named by cu_name
+ */
+inline bool
+get_xma_auto_placement()
+{
+  static bool value = detail::get_bool_value("Runtime.xma_auto_placement",false);
+  return value;
+}
+
+/**
+ * Cost model weights for xma automatic placement, e.g.
+ * "session=0.25,busy=1,cmds=0.5,device=0.1". Unlisted weights keep their default
+ */
+inline std::string
+get_xma_placement_cost()
+{
+  static std::string value = detail::get_string_value("Runtime.xma_placement_cost","");
+  return value;
+}
+
 inline bool
 get_enable_flat()
 {
@@ -461,6 +602,27 @@ get_multiprocess()
   return value;
 }
 
+/**
+ * Root of the PCI sysfs tree with the devices and drivers directories.
+ * Point to a copy of the tree to run tools and tests without a device.
+ */
+inline std::string
+get_sysfs_root()
+{
+  static std::string value = detail::get_string_value("Runtime.sysfs_root","/sys/bus/pci");
+  return value;
+}
+
+/**
+ * Cache resolved sysfs paths, open sysfs files and static sysfs values
+ */
+inline bool
+get_sysfs_cache()
+{
+  static bool value = detail::get_bool_value("Runtime.sysfs_cache",true);
+  return value;
+}
+
 /**
  * Set to false if host code uses post xcl style buffer handles with
  * new kernel API variadic arguments.  This affects how the kernel
@@ -473,6 +635,39 @@ get_xrt_bo()
   return value;
 }
 
+/**
+ * Size in bytes of the chunks that xrt::bo::async_sync splits a
+ * transfer into.  Chunks are transferred concurrently.
+ */
+inline unsigned int
+get_bo_sync_chunk_size()
+{
+  static unsigned int value = detail::get_uint_value("Runtime.bo_sync_chunk_size", 8 * 1024 * 1024);
+  return value;
+}
+
+/**
+ * Number of concurrent transfers used by xrt::bo::async_sync.  The
+ * default (0) uses one per DMA channel of the device.
+ */
+inline unsigned int
+get_bo_sync_channels()
+{
+  static unsigned int value = detail::get_uint_value("Runtime.bo_sync_channels", 0);
+  return value;
+}
+
+/**
+ * Number of threads in an xrt::event_handler_pool when not specified
+ * by the application.  The default (0) uses one per hardware thread.
+ */
+inline unsigned int
+get_event_handler_threads()
+{
+  static unsigned int value = detail::get_uint_value("Runtime.event_handler_threads", 0);
+  return value;
+}
+
 inline bool
 get_feature_toggle(const std::string& feature)
 {
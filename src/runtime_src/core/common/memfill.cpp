@@ -0,0 +1,143 @@
+/**
+ * Copyright (C) 2020 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#define XRT_CORE_COMMON_SOURCE
+#include "memfill.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#if defined(__SSE2__)
+# include <emmintrin.h>
+#endif
+
+namespace {
+
+// Size of the expanded pattern block.  Must be a multiple of 16 so
+// that it can be stored with aligned 128-bit stores.
+constexpr size_t line_size = 64;
+constexpr size_t max_block_size = 4096;
+
+// Fills larger than this bypass the cache
+constexpr size_t streaming_threshold = 4 * 1024 * 1024;
+
+// Fills larger than this are split across threads
+constexpr size_t parallel_threshold = 64 * 1024 * 1024;
+constexpr unsigned int max_fill_threads = 8;
+
+size_t
+gcd(size_t a, size_t b)
+{
+  while (b) {
+    auto t = a % b;
+    a = b;
+    b = t;
+  }
+  return a;
+}
+
+// Fill dst with the pattern, starting at byte 'phase' of the pattern
+void
+fill_phase(char* dst, const char* pattern, size_t pattern_size, size_t phase, size_t size)
+{
+  // Smallest block that holds a whole number of patterns and cache lines
+  auto block_size = pattern_size / gcd(pattern_size, line_size) * line_size;
+  if (block_size > max_block_size) {
+    // Patterns this large are copied as is
+    while (size) {
+      auto sz = std::min(size, pattern_size - phase);
+      std::memcpy(dst, pattern + phase, sz);
+      dst += sz;
+      size -= sz;
+      phase = 0;
+    }
+    return;
+  }
+
+  // Bytes up to the first 16 byte aligned address
+  auto head = std::min(size, (16 - reinterpret_cast<uintptr_t>(dst) % 16) % 16);
+  for (size_t i = 0; i < head; ++i) {
+    *dst++ = pattern[phase++];
+    if (phase == pattern_size)
+      phase = 0;
+  }
+  size -= head;
+
+  alignas(line_size) char block[max_block_size];
+  for (size_t i = 0; i < block_size; ++i) {
+    block[i] = pattern[phase++];
+    if (phase == pattern_size)
+      phase = 0;
+  }
+
+  auto end = dst + (size - size % block_size);
+#if defined(__SSE2__)
+  if (size >= streaming_threshold) {
+    auto src = reinterpret_cast<const __m128i*>(block);
+    auto count = block_size / sizeof(__m128i);
+    for (; dst != end; dst += block_size) {
+      auto out = reinterpret_cast<__m128i*>(dst);
+      for (size_t i = 0; i < count; ++i)
+        _mm_stream_si128(out + i, _mm_load_si128(src + i));
+    }
+    _mm_sfence();
+  }
+#endif
+  for (; dst != end; dst += block_size)
+    std::memcpy(dst, block, block_size);
+
+  std::memcpy(dst, block, size % block_size);
+}
+
+} // namespace
+
+namespace xrt_core {
+
+void
+fill(void* dst, const void* pattern, size_t pattern_size, size_t size)
+{
+  if (!size || !pattern_size)
+    return;
+
+  auto out = static_cast<char*>(dst);
+  auto in = static_cast<const char*>(pattern);
+
+  unsigned int nthreads = 1;
+  if (size >= parallel_threshold)
+    nthreads = std::max(1u, std::min(max_fill_threads, std::thread::hardware_concurrency()));
+
+  if (nthreads == 1) {
+    fill_phase(out, in, pattern_size, 0, size);
+    return;
+  }
+
+  // Split on cache line boundaries, each thread picks up the pattern
+  // where the previous range left off
+  auto chunk = (size / nthreads + line_size - 1) / line_size * line_size;
+  std::vector<std::thread> workers;
+  for (size_t offset = chunk; offset < size; offset += chunk) {
+    auto sz = std::min(chunk, size - offset);
+    workers.emplace_back(fill_phase, out + offset, in, pattern_size, offset % pattern_size, sz);
+  }
+  fill_phase(out, in, pattern_size, 0, std::min(chunk, size));
+  for (auto& worker : workers)
+    worker.join();
+}
+
+} // xrt_core
@@ -0,0 +1,44 @@
+/**
+ * Copyright (C) 2020 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef xrtcore_memfill_h_
+#define xrtcore_memfill_h_
+
+#include "config.h"
+#include <cstddef>
+
+namespace xrt_core {
+
+/**
+ * fill() - Fill host memory with a repeated pattern
+ *
+ * @dst:          Memory to fill
+ * @pattern:      Pattern to repeat
+ * @pattern_size: Size of pattern in bytes
+ * @size:         Number of bytes to fill
+ *
+ * The pattern is expanded once into a cache line sized block which
+ * is then stored repeatedly.  Large fills bypass the cache and are
+ * split across multiple threads.  If @size is not a multiple of
+ * @pattern_size, the last instance of the pattern is truncated.
+ */
+XRT_CORE_COMMON_EXPORT
+void
+fill(void* dst, const void* pattern, size_t pattern_size, size_t size);
+
+} // xrt_core
+
+#endif
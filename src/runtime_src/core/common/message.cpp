@@ -21,10 +21,17 @@
 #include "config_reader.h"
 
 #include <map>
+#include <unordered_map>
 #include <fstream>
 #include <iostream>
 #include <thread>
 #include <mutex>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <cstdlib>
+#include <ctime>
 #include <climits>
 #ifdef __GNUC__
 # include <unistd.h>
@@ -87,6 +94,32 @@ get_exe_path()
 
 using severity_level = xrt_core::message::severity_level;
 
+// Same format as xrt_core::timestamp() for a given time
+static std::string
+format_time(std::chrono::system_clock::time_point time)
+{
+  auto t = std::chrono::system_clock::to_time_t(time);
+  std::tm tm;
+#ifdef _WIN32
+  gmtime_s(&tm, &t);
+#else
+  gmtime_r(&t, &tm);
+#endif
+  char buf[64] = {0};
+  return std::strftime(buf, sizeof(buf), "%c GMT", &tm)
+    ? buf : "Time conversion failed";
+}
+
+// Message as sent, with the time and thread of the sender
+struct record
+{
+  severity_level level;
+  std::string tag;
+  std::string msg;
+  std::chrono::system_clock::time_point time;
+  std::thread::id tid;
+};
+
 //--
 class message_dispatch
 {
@@ -94,8 +127,14 @@ public:
   message_dispatch() {}
   virtual ~message_dispatch() {}
   static message_dispatch* make_dispatcher(const std::string& choice);
+  static message_dispatch* make_sink(const std::string& choice);
 public:
   virtual void send(severity_level l, const char* tag, const char* msg) = 0;
+
+  // Used by async_dispatch: write may buffer the record until flush
+  virtual void write(const record& r)
+  { send(r.level, r.tag.c_str(), r.msg.c_str()); }
+  virtual void flush() {}
 };
 
 //--
@@ -114,7 +153,11 @@ public:
   console_dispatch();
   virtual ~console_dispatch() {}
   virtual void send(severity_level l, const char* tag, const char* msg) override;
+  virtual void write(const record& r) override;
+  virtual void flush() override;
 private:
+  std::mutex mutex;
+  std::string pending;
   std::map<severity_level, const char*> severityMap = {
     { severity_level::XRT_EMERGENCY, "EMERGENCY: "},
     { severity_level::XRT_ALERT,     "ALERT: "},
@@ -163,8 +206,13 @@ public:
   file_dispatch(const std::string& file);
   virtual ~file_dispatch();
   virtual void send(severity_level l, const char* tag, const char* msg) override;
+  virtual void write(const record& r) override;
+  virtual void flush() override;
 private:
+  std::mutex mutex;
   std::ofstream handle;
+  std::time_t last_time = 0;
+  std::string last_timestamp;
   std::map<severity_level, const char*> severityMap = {
     { severity_level::XRT_EMERGENCY, "EMERGENCY: "},
     { severity_level::XRT_ALERT,     "ALERT: "},
@@ -177,10 +225,381 @@ private:
   };
 };
 
+//--
+// Bounded queue of records with many producers and one consumer.
+// Producers claim a cell with a CAS on the enqueue position, so a
+// sender never waits for another sender or for the consumer.
+class record_ring
+{
+public:
+  explicit
+  record_ring(size_t size)
+  {
+    size_t capacity = 2;
+    while (capacity < size)
+      capacity <<= 1;
+    cells.reset(new cell[capacity]);
+    mask = capacity - 1;
+    for (size_t i = 0; i < capacity; ++i)
+      cells[i].seq.store(i, std::memory_order_relaxed);
+    enqueue_pos.store(0, std::memory_order_relaxed);
+    dequeue_pos.store(0, std::memory_order_relaxed);
+  }
+
+  // Record is moved into the queue on success
+  bool
+  push(record& r)
+  {
+    cell* c;
+    size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+    for (;;) {
+      c = &cells[pos & mask];
+      size_t seq = c->seq.load(std::memory_order_acquire);
+      auto dif = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+      if (dif == 0) {
+        if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+          break;
+      }
+      else if (dif < 0)
+        return false; // full
+      else
+        pos = enqueue_pos.load(std::memory_order_relaxed);
+    }
+    c->rec = std::move(r);
+    c->seq.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer only
+  bool
+  pop(record& r)
+  {
+    size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+    cell* c = &cells[pos & mask];
+    if (c->seq.load(std::memory_order_acquire) != pos + 1)
+      return false; // empty or record not yet written
+    r = std::move(c->rec);
+    c->seq.store(pos + mask + 1, std::memory_order_release);
+    dequeue_pos.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool
+  empty() const
+  {
+    size_t pos = dequeue_pos.load(std::memory_order_acquire);
+    return cells[pos & mask].seq.load(std::memory_order_acquire) != pos + 1;
+  }
+
+  // Records pushed so far
+  size_t
+  pushed() const
+  {
+    return enqueue_pos.load();
+  }
+
+private:
+  struct cell
+  {
+    std::atomic<size_t> seq;
+    record rec;
+  };
+  std::unique_ptr<cell[]> cells;
+  size_t mask;
+  // Keep producer and consumer positions on separate cache lines
+  char pad0[64];
+  std::atomic<size_t> enqueue_pos;
+  char pad1[64];
+  std::atomic<size_t> dequeue_pos;
+};
+
+//--
+// Queues messages for a writer thread that writes them to the sink in
+// batches with one flush per batch.  Messages with severity critical
+// or higher are written before send returns.  Queued messages are
+// written at exit; messages sent after that are written synchronously.
+class async_dispatch : public message_dispatch
+{
+public:
+  enum class overflow_policy { block, drop, count };
+
+  async_dispatch(message_dispatch* s, size_t queue_size,
+                 overflow_policy p, unsigned int limit);
+  virtual ~async_dispatch();
+  virtual void send(severity_level l, const char* tag, const char* msg) override;
+  // Wait until messages sent so far are written
+  virtual void flush() override;
+  // Write queued messages and stop the writer thread
+  void stop();
+
+private:
+  // Writer thread
+  void run();
+  void emit(record& r);
+  void report_repeats(bool all, std::chrono::system_clock::time_point now);
+  void report_dropped();
+  void wake();
+
+  struct repeat
+  {
+    std::chrono::system_clock::time_point window;
+    unsigned int count = 0;
+    uint64_t suppressed = 0;
+    record last;
+  };
+
+  static const size_t max_batch = 256;
+
+  std::unique_ptr<message_dispatch> sink;
+  record_ring ring;
+  overflow_policy policy;
+  unsigned int rate_limit;
+
+  std::atomic<uint64_t> dropped {0};
+  std::atomic<uint64_t> written {0};
+  std::atomic<unsigned int> flush_waiters {0};
+  std::atomic<bool> sleeping {false};
+  std::atomic<bool> stopping {false};
+  std::atomic<bool> stopped {false};
+
+  std::mutex mutex;
+  std::condition_variable work_cv;
+  std::condition_variable flush_cv;
+  std::mutex stop_mutex;
+  std::thread writer;
+
+  // Writer thread only: identical messages in the current second
+  std::unordered_map<std::string, repeat> repeats;
+  std::chrono::system_clock::time_point last_sweep;
+};
+
+async_dispatch::
+async_dispatch(message_dispatch* s, size_t queue_size,
+               overflow_policy p, unsigned int limit)
+  : sink(s), ring(queue_size), policy(p), rate_limit(limit)
+{
+  writer = std::thread(&async_dispatch::run, this);
+}
+
+async_dispatch::
+~async_dispatch()
+{
+  stop();
+}
+
+void
+async_dispatch::
+wake()
+{
+  {
+    std::lock_guard<std::mutex> lk(mutex);
+  }
+  work_cv.notify_one();
+}
+
+void
+async_dispatch::
+send(severity_level l, const char* tag, const char* msg)
+{
+  if (stopped) {
+    sink->send(l, tag, msg);
+    return;
+  }
+
+  record r {l, tag, msg, std::chrono::system_clock::now(), std::this_thread::get_id()};
+  if (!ring.push(r)) {
+    if (policy != overflow_policy::block) {
+      ++dropped;
+      return;
+    }
+    while (!ring.push(r)) {
+      if (stopped) {
+        sink->send(l, tag, msg);
+        return;
+      }
+      wake();
+      std::this_thread::yield();
+    }
+  }
+
+  if (sleeping)
+    wake();
+  if (l <= severity_level::XRT_CRITICAL)
+    flush();
+}
+
+void
+async_dispatch::
+flush()
+{
+  uint64_t target = ring.pushed();
+  wake();
+  std::unique_lock<std::mutex> lk(mutex);
+  ++flush_waiters;
+  flush_cv.wait(lk, [this, target] { return written >= target || stopped; });
+  --flush_waiters;
+}
+
+void
+async_dispatch::
+stop()
+{
+  std::lock_guard<std::mutex> slk(stop_mutex);
+  if (!writer.joinable())
+    return;
+  stopping = true;
+  wake();
+  writer.join();
+
+  // Messages queued after the writer thread took its last look
+  std::lock_guard<std::mutex> lk(mutex);
+  stopped = true;
+  record r;
+  while (ring.pop(r))
+    sink->write(r);
+  report_dropped();
+  sink->flush();
+  flush_cv.notify_all();
+}
+
+void
+async_dispatch::
+emit(record& r)
+{
+  if (!rate_limit) {
+    sink->write(r);
+    return;
+  }
+
+  std::string key = r.tag;
+  key += '\0';
+  key += r.msg;
+  key += static_cast<char>(r.level);
+  auto& rep = repeats[key];
+  if (rep.count == 0 || r.time - rep.window >= std::chrono::seconds(1)) {
+    if (rep.suppressed) {
+      rep.last.msg = "Last message repeated " + std::to_string(rep.suppressed) + " times: " + rep.last.msg;
+      sink->write(rep.last);
+      rep.suppressed = 0;
+    }
+    rep.window = r.time;
+    rep.count = 0;
+  }
+  if (++rep.count <= rate_limit) {
+    sink->write(r);
+  }
+  else {
+    ++rep.suppressed;
+    rep.last = std::move(r);
+  }
+}
+
+void
+async_dispatch::
+report_repeats(bool all, std::chrono::system_clock::time_point now)
+{
+  for (auto itr = repeats.begin(); itr != repeats.end();) {
+    auto& rep = itr->second;
+    if (!all && now - rep.window < std::chrono::seconds(1)) {
+      ++itr;
+      continue;
+    }
+    if (rep.suppressed) {
+      rep.last.msg = "Last message repeated " + std::to_string(rep.suppressed) + " times: " + rep.last.msg;
+      sink->write(rep.last);
+    }
+    itr = repeats.erase(itr);
+  }
+  last_sweep = now;
+}
+
+void
+async_dispatch::
+report_dropped()
+{
+  auto num = dropped.exchange(0);
+  if (!num || policy != overflow_policy::count)
+    return;
+  record r {severity_level::XRT_WARNING, "XRT",
+            std::to_string(num) + " messages dropped, runtime_log queue is full",
+            std::chrono::system_clock::now(), std::this_thread::get_id()};
+  sink->write(r);
+}
+
+void
+async_dispatch::
+run()
+{
+  record r;
+  while (true) {
+    size_t num = 0;
+    while (num < max_batch && ring.pop(r)) {
+      emit(r);
+      ++num;
+    }
+
+    auto now = std::chrono::system_clock::now();
+    if (!repeats.empty() && (num == 0 || now - last_sweep >= std::chrono::seconds(1)))
+      report_repeats(false, now);
+    report_dropped();
+    sink->flush();
+
+    if (num) {
+      written += num;
+      if (flush_waiters) {
+        std::lock_guard<std::mutex> lk(mutex);
+        flush_cv.notify_all();
+      }
+      continue;
+    }
+
+    if (stopping)
+      break;
+
+    std::unique_lock<std::mutex> lk(mutex);
+    sleeping = true;
+    if (ring.empty() && !stopping)
+      work_cv.wait_for(lk, std::chrono::milliseconds(100));
+    sleeping = false;
+  }
+  report_repeats(true, std::chrono::system_clock::now());
+  sink->flush();
+}
+
+static async_dispatch* async_dispatcher = nullptr;
+
+static void
+stop_async_dispatch()
+{
+  if (async_dispatcher)
+    async_dispatcher->stop();
+}
+
 //-------
 message_dispatch*
 message_dispatch::
 make_dispatcher(const std::string& choice)
+{
+  auto sink = make_sink(choice);
+  if (!xrt_core::config::get_runtime_log_async() || dynamic_cast<null_dispatch*>(sink))
+    return sink;
+
+  auto overflow = xrt_core::config::get_runtime_log_overflow();
+  auto policy = async_dispatch::overflow_policy::count;
+  if (overflow == "block")
+    policy = async_dispatch::overflow_policy::block;
+  else if (overflow == "drop")
+    policy = async_dispatch::overflow_policy::drop;
+
+  async_dispatcher = new async_dispatch(sink, xrt_core::config::get_runtime_log_queue_size(),
+                                        policy, xrt_core::config::get_runtime_log_rate_limit());
+  std::atexit(stop_async_dispatch);
+  return async_dispatcher;
+}
+
+message_dispatch*
+message_dispatch::
+make_sink(const std::string& choice)
 {
   if( (choice == "null") || (choice == ""))
     return new null_dispatch;
@@ -229,13 +648,35 @@ void
 file_dispatch::
 send(severity_level l, const char* tag, const char* msg)
 {
-  static std::mutex mutex;
   std::lock_guard<std::mutex> lk(mutex);
   handle << "[" << xrt_core::timestamp() <<"] [" << tag << "] Tid: "
          << std::this_thread::get_id() << ", " << " " << severityMap[l]
          << msg << std::endl;
 }
 
+void
+file_dispatch::
+write(const record& r)
+{
+  auto t = std::chrono::system_clock::to_time_t(r.time);
+  if (t != last_time) {
+    last_time = t;
+    last_timestamp = format_time(r.time);
+  }
+  std::lock_guard<std::mutex> lk(mutex);
+  handle << "[" << last_timestamp <<"] [" << r.tag << "] Tid: "
+         << r.tid << ", " << " " << severityMap[r.level]
+         << r.msg << "\n";
+}
+
+void
+file_dispatch::
+flush()
+{
+  std::lock_guard<std::mutex> lk(mutex);
+  handle.flush();
+}
+
 //console ops
 console_dispatch::
 console_dispatch()
@@ -255,12 +696,36 @@ void
 console_dispatch::
 send(severity_level l, const char* tag, const char* msg)
 {
-  static std::mutex mutex;
   std::lock_guard<std::mutex> lk(mutex);
   std::cerr << "[" << tag << "] " << severityMap[l]
             << msg << std::endl;
 }
 
+void
+console_dispatch::
+write(const record& r)
+{
+  // std::cerr is unbuffered, so a batch is written with one call
+  pending += "[";
+  pending += r.tag;
+  pending += "] ";
+  pending += severityMap[r.level];
+  pending += r.msg;
+  pending += "\n";
+}
+
+void
+console_dispatch::
+flush()
+{
+  if (pending.empty())
+    return;
+  std::lock_guard<std::mutex> lk(mutex);
+  std::cerr.write(pending.data(), pending.size());
+  std::cerr.flush();
+  pending.clear();
+}
+
 } //end unnamed namespace
 
 namespace xrt_core { namespace message {
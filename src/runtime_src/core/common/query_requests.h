@@ -52,6 +52,7 @@ enum class key_type
   pcie_express_lane_width,
   pcie_express_lane_width_max,
   pcie_bdf,
+  pcie_local_cpulist,
 
   edge_vendor,
 
@@ -384,6 +385,23 @@ struct edge_vendor : request
   }
 };
 
+// CPUs close to the device, in sysfs cpu list format
+struct pcie_local_cpulist : request
+{
+  using result_type = std::string;
+  static const key_type key = key_type::pcie_local_cpulist;
+  static const char* name() { return "local_cpulist"; }
+
+  virtual boost::any
+  get(const device*) const = 0;
+
+  static std::string
+  to_string(const result_type& value)
+  {
+    return value;
+  }
+};
+
 struct dma_threads_raw : request
 {
   using result_type = std::vector<std::string>;
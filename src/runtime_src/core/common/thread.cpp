@@ -132,6 +132,23 @@ set_cpu_affinity(std::thread& thread)
   }
 }
 
+static void
+set_cpu_affinity(std::thread& thread, const std::vector<unsigned int>& cpus)
+{
+  if (cpus.empty())
+    return;
+
+  cpu_set_t cpuset;
+  CPU_ZERO(&cpuset);
+  for (auto cpu : cpus)
+    if (cpu < CPU_SETSIZE)
+      CPU_SET(cpu,&cpuset);
+
+  if (pthread_setaffinity_np(thread.native_handle(),sizeof(cpu_set_t),&cpuset)) {
+    throw std::runtime_error("error calling pthread_setaffinity_np");
+  }
+}
+
 #else
 
 static void
@@ -144,6 +161,11 @@ set_cpu_affinity(std::thread&)
 {
 }
 
+static void
+set_cpu_affinity(std::thread&, const std::vector<unsigned int>&)
+{
+}
+
 #endif
 
 } // platform_specific
@@ -166,4 +188,26 @@ void set_cpu_affinity(std::thread& thread)
 
 } // detail
 
+void
+set_cpu_affinity(std::thread& thread, const std::vector<unsigned int>& cpus)
+{
+  ::platform_specific::set_cpu_affinity(thread, cpus);
+}
+
+std::vector<unsigned int>
+parse_cpu_list(const std::string& cpus)
+{
+  std::vector<unsigned int> result;
+  using tokenizer=boost::tokenizer<boost::char_separator<char> >;
+  boost::char_separator<char> sep(", \n");
+  for (auto& tok : tokenizer(cpus,sep)) {
+    auto dash = tok.find('-');
+    auto first = std::stoul(tok.substr(0,dash));
+    auto last = (dash == std::string::npos) ? first : std::stoul(tok.substr(dash+1));
+    for (auto cpu = first; cpu <= last; ++cpu)
+      result.push_back(static_cast<unsigned int>(cpu));
+  }
+  return result;
+}
+
 } // xrt_core
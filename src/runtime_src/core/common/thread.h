@@ -18,7 +18,9 @@
 #define xrt_core_common_thread_h_
 
 #include "config.h"
+#include <string>
 #include <thread>
+#include <vector>
 
 namespace xrt_core { 
 
@@ -43,6 +45,22 @@ set_cpu_affinity(std::thread& thread);
 
 }
 
+/**
+ * Pin a thread to the specified cpus
+ *
+ * An empty list of cpus leaves the affinity of the thread unchanged.
+ */
+XRT_CORE_COMMON_EXPORT
+void
+set_cpu_affinity(std::thread& thread, const std::vector<unsigned int>& cpus);
+
+/**
+ * Parse a cpu list such as "0-3,8,10-11" as used by sysfs
+ */
+XRT_CORE_COMMON_EXPORT
+std::vector<unsigned int>
+parse_cpu_list(const std::string& cpus);
+
 /**
  * Construct a thread and set policy according to sdaccel.ini
  * 
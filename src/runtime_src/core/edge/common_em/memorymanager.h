@@ -19,6 +19,8 @@
 
 #include <mutex>
 #include <list>
+#include <map>
+#include <set>
 #include <cassert>
 #include <algorithm>
 
@@ -27,19 +29,26 @@
 
 namespace xclemulation
 {
+    // Free blocks are kept in two indexes: by address, to merge a freed
+    // block with its neighbours, and by (size, address), to find the
+    // smallest block that fits an allocation.  Adjacent free blocks are
+    // always merged on free, so alloc, free and lookup are O(log n).
     class MemoryManager 
     {
+        // start address -> size
+        typedef std::map<uint64_t, uint64_t> BlockMap;
+        // (size, start address)
+        typedef std::set<std::pair<uint64_t, uint64_t> > SizeIndex;
+
         std::mutex mMemManagerMutex;
-        std::list<std::pair<uint64_t, uint64_t> > mFreeBufferList;
-        std::list<std::pair<uint64_t, uint64_t> > mBusyBufferList;
+        BlockMap mFreeBuffers;
+        SizeIndex mFreeBySize;
+        BlockMap mBusyBuffers;
         uint64_t mSize;
         uint64_t mStart;
         uint64_t mAlignment;
-        const unsigned mCoalesceThreshold;
         uint64_t mFreeSize;
 
-        typedef std::list<std::pair<uint64_t, uint64_t> > PairList;
-
     public:
         static const uint64_t mNull = 0xffffffffffffffffull;
 
@@ -58,8 +67,9 @@ namespace xclemulation
         std::pair<uint64_t, uint64_t>lookup(uint64_t buf);
 
     private:
-        void coalesce();
-        PairList::iterator find(uint64_t buf);
+        void addFree(uint64_t buf, uint64_t size);
+        void insertFree(uint64_t buf, uint64_t size);
+        void eraseFree(BlockMap::iterator i);
     };
 }
 
@@ -0,0 +1,71 @@
+/**
+ * Copyright (C) 2020 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef __XCLHOST_RPC_MUTEX__
+#define __XCLHOST_RPC_MUTEX__
+
+#include <condition_variable>
+#include <mutex>
+
+namespace xclemulation {
+
+  // Serializes RPC calls over the socket to the device process.
+  //
+  // Large buffer copies are split into many bulk RPC calls, each of
+  // which acquires the mutex with lock_bulk().  A bulk caller cannot
+  // acquire the mutex while a control call (lock()) is waiting, so
+  // register accesses and other control calls from other threads are
+  // issued between two chunks of a copy rather than after all of it.
+  // Bulk callers from several threads alternate chunk by chunk.
+  class rpc_mutex
+  {
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+    bool mLocked = false;
+    unsigned int mControlWaiters = 0;
+
+  public:
+    // Acquire for a control call
+    void lock()
+    {
+      std::unique_lock<std::mutex> lk(mMutex);
+      ++mControlWaiters;
+      mCondition.wait(lk, [this] { return !mLocked; });
+      --mControlWaiters;
+      mLocked = true;
+    }
+
+    // Acquire for one chunk of a bulk data transfer
+    void lock_bulk()
+    {
+      std::unique_lock<std::mutex> lk(mMutex);
+      mCondition.wait(lk, [this] { return !mLocked && !mControlWaiters; });
+      mLocked = true;
+    }
+
+    void unlock()
+    {
+      {
+        std::lock_guard<std::mutex> lk(mMutex);
+        mLocked = false;
+      }
+      mCondition.notify_all();
+    }
+  };
+
+}
+
+#endif
@@ -21,6 +21,7 @@
 #include "config.h"
 #include "em_defines.h"
 #include "memorymanager.h"
+#include "rpc_mutex.h"
 #include "rpc_messages.pb.h"
 
 #include "xclperf.h"
@@ -188,7 +189,7 @@ namespace xclcpuemhal2 {
       std::string dec2bin(uint32_t n);
       std::string dec2bin(uint32_t n, unsigned bits);
 
-      std::mutex mtx;
+      xclemulation::rpc_mutex mtx;
       unsigned int message_size;
       bool simulator_started;
 
@@ -22,6 +22,8 @@
 #include "xrt_mem.h"
 
 #ifdef __cplusplus
+# include "experimental/xrt_enqueue.h"
+# include <functional>
 # include <memory>
 #endif
 
@@ -280,6 +282,49 @@ public:
     sync(dir, size(), 0);
   }
 
+  /**
+   * async_sync() - Asynchronously synchronize buffer content with device side
+   *
+   * @param dir
+   *  To device or from device
+   * @param sz
+   *  Size of data to synchronize
+   * @param offset
+   *  Offset within the BO
+   * @param progress
+   *  Optional callback called with the number of bytes synchronized
+   *  so far each time part of the transfer completes
+   * @return
+   *  Event that completes when all bytes have been synchronized
+   *
+   * The transfer is split into chunks of Runtime.bo_sync_chunk_size
+   * bytes which are transferred concurrently, one per DMA channel of
+   * the device.  Transfers of other buffers are interleaved with the
+   * chunks of this transfer.  The returned event can be waited on or
+   * used as a dependency for enqueued operations.  Waiting on the
+   * event throws if any part of the transfer failed.
+   *
+   * The progress callback is called from a transfer thread.
+   */
+  XCL_DRIVER_DLLESPEC
+  xrt::event_queue::event
+  async_sync(xclBOSyncDirection dir, size_t sz, size_t offset,
+             const std::function<void(size_t)>& progress = nullptr);
+
+  /**
+   * async_sync() - Asynchronously synchronize buffer content with device side
+   *
+   * @param dir
+   *  To device or from device
+   * @return
+   *  Event that completes when the entire buffer has been synchronized
+   */
+  xrt::event_queue::event
+  async_sync(xclBOSyncDirection dir)
+  {
+    return async_sync(dir, size(), 0);
+  }
+
   /**
    * map() - Map the host side buffer into application
    *
@@ -405,6 +450,40 @@ public:
     copy(src, src.size());
   }
 
+  /**
+   * fill() - Fill BO content with a repeated pattern
+   *
+   * @param pattern
+   *  Pattern to fill with
+   * @param pattern_size
+   *  Size of pattern in bytes
+   * @param sz
+   *  Number of bytes to fill
+   * @param offset
+   *  Offset into this buffer to start filling
+   *
+   * The filled region is written to both the host backing buffer
+   * and device memory.  Large fills are replicated on the device
+   * when it supports buffer copies.  Throws if pattern_size is 0 or
+   * sz + offset is out of bounds.
+   */
+  XCL_DRIVER_DLLESPEC
+  void
+  fill(const void* pattern, size_t pattern_size, size_t sz, size_t offset=0);
+
+  /**
+   * fill() - Fill BO content with a repeated value
+   *
+   * @param pattern
+   *  Value to fill the entire buffer with
+   */
+  template <typename PatternType>
+  void
+  fill(const PatternType& pattern)
+  {
+    fill(&pattern, sizeof(PatternType), size());
+  }
+
 public:
   /// @cond
   std::shared_ptr<bo_impl>
@@ -599,6 +678,23 @@ XCL_DRIVER_DLLESPEC
 int
 xrtBOCopy(xrtBufferHandle dst, xrtBufferHandle src, size_t sz, size_t dst_offset, size_t src_offset);
 
+/**
+ * xrtBOFill() - Fill BO content with a repeated pattern
+ *
+ * @bhdl:          Buffer handle
+ * @pattern:       Pattern to fill with
+ * @pattern_size:  Size of pattern in bytes
+ * @size:          Number of bytes to fill
+ * @offset:        Offset into buffer to start filling
+ * Return:         0 on success or appropriate error number
+ *
+ * The filled region is written to device memory.  It is an error if
+ * pattern_size is 0 bytes or size + offset is out of bounds.
+ */
+XCL_DRIVER_DLLESPEC
+int
+xrtBOFill(xrtBufferHandle bhdl, const void* pattern, size_t pattern_size, size_t size, size_t offset);
+
 /// @endcond  
 #ifdef __cplusplus
 }
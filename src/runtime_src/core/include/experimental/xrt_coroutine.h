@@ -0,0 +1,252 @@
+/*
+ * Copyright (C) 2020, Xilinx Inc - All rights reserved
+ * Xilinx Runtime (XRT) Experimental APIs
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef _XRT_COROUTINE_H_
+#define _XRT_COROUTINE_H_
+
+#include "experimental/xrt_bo.h"
+#include "experimental/xrt_enqueue.h"
+#include "experimental/xrt_kernel.h"
+
+#if defined(__cplusplus) && __cplusplus >= 202002L && defined(__cpp_impl_coroutine)
+# include <condition_variable>
+# include <coroutine>
+# include <deque>
+# include <mutex>
+
+namespace xrt { namespace coro {
+
+/**
+ * class run_loop - Executor that resumes coroutines on the calling thread
+ *
+ * Awaitables in this file post the handle of a suspended coroutine to
+ * an executor when the awaited operation completes.  An executor is
+ * any object with a thread safe ``post(std::coroutine_handle<>)``
+ * function.
+ *
+ * The run_loop resumes posted coroutines on the threads that call
+ * run(), so a single thread can drive any number of outstanding
+ * operations.
+ */
+class run_loop
+{
+  std::mutex m_mutex;
+  std::condition_variable m_work;
+  std::deque<std::coroutine_handle<>> m_queue;
+  bool m_stop = false;
+
+public:
+  /**
+   * post() - Schedule a coroutine for resumption
+   *
+   * Called from the thread that completes an awaited operation.
+   */
+  void
+  post(std::coroutine_handle<> handle)
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_queue.push_back(handle);
+    m_work.notify_one();
+  }
+
+  /**
+   * run() - Resume posted coroutines until stop() is called
+   *
+   * Coroutines posted before stop() is called are resumed before
+   * run() returns.
+   */
+  void
+  run()
+  {
+    while (true) {
+      std::coroutine_handle<> handle;
+      {
+        std::unique_lock<std::mutex> lk(m_mutex);
+        while (m_queue.empty() && !m_stop)
+          m_work.wait(lk);
+        if (m_queue.empty())
+          return;
+        handle = m_queue.front();
+        m_queue.pop_front();
+      }
+      handle.resume();
+    }
+  }
+
+  /**
+   * stop() - Make run() return once there is no more work
+   */
+  void
+  stop()
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_stop = true;
+    m_work.notify_all();
+  }
+};
+
+/**
+ * class run_awaitable - Awaitable for completion of an xrt::run
+ *
+ * The completion of the run is hooked through
+ * xrt::run::set_completion_handler(), no thread waits for the run.
+ * The result of the co_await expression is the final state of the run.
+ */
+template <typename Executor>
+class run_awaitable
+{
+  xrt::run m_run;
+  Executor& m_executor;
+  ert_cmd_state m_state = ERT_CMD_STATE_NEW;
+
+public:
+  run_awaitable(const xrt::run& run, Executor& executor)
+    : m_run(run), m_executor(executor)
+  {}
+
+  bool
+  await_ready() const noexcept
+  {
+    return false;
+  }
+
+  void
+  await_suspend(std::coroutine_handle<> handle)
+  {
+    m_run.set_completion_handler([this, handle](ert_cmd_state state) {
+        m_state = state;
+        m_executor.post(handle);
+      });
+  }
+
+  ert_cmd_state
+  await_resume() const noexcept
+  {
+    return m_state;
+  }
+};
+
+/**
+ * class event_awaitable - Awaitable for completion of an xrt::event
+ *
+ * The co_await expression throws if the operation associated with
+ * the event failed.
+ */
+template <typename Executor>
+class event_awaitable
+{
+  xrt::event m_event;
+  Executor& m_executor;
+
+public:
+  event_awaitable(const xrt::event& event, Executor& executor)
+    : m_event(event), m_executor(executor)
+  {}
+
+  bool
+  await_ready() const noexcept
+  {
+    return false;
+  }
+
+  void
+  await_suspend(std::coroutine_handle<> handle)
+  {
+    m_event.add_callback([this, handle] { m_executor.post(handle); });
+  }
+
+  void
+  await_resume() const
+  {
+    // complete at this point, rethrows error if any
+    m_event.wait();
+  }
+};
+
+/**
+ * wait() - Await completion of a started run
+ *
+ * @run:      Run object that has been started
+ * @executor: Executor that resumes the awaiting coroutine
+ */
+template <typename Executor>
+run_awaitable<Executor>
+wait(const xrt::run& run, Executor& executor)
+{
+  return run_awaitable<Executor>(run, executor);
+}
+
+/**
+ * start() - Start a run and await its completion
+ *
+ * @run:      Run object with arguments set
+ * @executor: Executor that resumes the awaiting coroutine
+ */
+template <typename Executor>
+run_awaitable<Executor>
+start(xrt::run& run, Executor& executor)
+{
+  run.start();
+  return run_awaitable<Executor>(run, executor);
+}
+
+/**
+ * wait() - Await completion of an event
+ *
+ * @event:    Event returned from an asynchronous operation
+ * @executor: Executor that resumes the awaiting coroutine
+ */
+template <typename Executor>
+event_awaitable<Executor>
+wait(const xrt::event& event, Executor& executor)
+{
+  return event_awaitable<Executor>(event, executor);
+}
+
+/**
+ * sync() - Asynchronously sync a buffer and await completion
+ *
+ * @bo:       Buffer to sync
+ * @dir:      To device or from device
+ * @sz:       Size of data to synchronize
+ * @offset:   Offset within the BO
+ * @executor: Executor that resumes the awaiting coroutine
+ *
+ * See xrt::bo::async_sync()
+ */
+template <typename Executor>
+event_awaitable<Executor>
+sync(xrt::bo& bo, xclBOSyncDirection dir, size_t sz, size_t offset, Executor& executor)
+{
+  return event_awaitable<Executor>(bo.async_sync(dir, sz, offset), executor);
+}
+
+/**
+ * sync() - Asynchronously sync an entire buffer and await completion
+ */
+template <typename Executor>
+event_awaitable<Executor>
+sync(xrt::bo& bo, xclBOSyncDirection dir, Executor& executor)
+{
+  return event_awaitable<Executor>(bo.async_sync(dir), executor);
+}
+
+}} // coro, xrt
+
+#endif // C++20 coroutines
+
+#endif
@@ -171,10 +171,23 @@ public:
      * This function is deliberately not virtual to derived's
      * std::future. Base class may be sliced off from derived and
      * manages completion in implementation.
+     *
+     * Throws if the asynchronous operation associated with the
+     * event completed with an error.
      */
     void
     wait() const;
 
+    /**
+     * add_callback() - Call a function when the event completes
+     *
+     * The function is called once, from the thread that completes
+     * the event, or immediately if the event is already complete.
+     * The function must not block.
+     */
+    void
+    add_callback(std::function<void()> fcn) const;
+
     static void
     notify(event_impl*);
 
@@ -353,6 +366,63 @@ private:
   std::shared_ptr<event_handler_impl> m_impl;
 };
 
+/**
+ * class event_handler_pool - Pool of asynchronous event handlers
+ *
+ * An event handler pool is a consumer of an event queue that executes
+ * tasks on multiple threads.  Each thread has its own queue of ready
+ * tasks; tasks made ready by a thread, for example the next stage of
+ * a pipeline, are queued on that thread and idle threads steal tasks
+ * from busy ones.
+ *
+ * An event queue can be serviced by at most one pool, and should not
+ * also be serviced by event handlers.  Like an event handler, the pool
+ * shares ownership of the event queue.
+ *
+ * When the pool is destroyed, it executes the tasks that are ready
+ * before its threads exit.  Tasks that become ready afterwards are
+ * left in the event queue for event handlers created later.
+ */
+class device;
+class event_handler_pool_impl;
+class event_handler_pool
+{
+public:
+  /**
+   * event_handler_pool() - Construct and assign event_queue
+   *
+   * @q       : Event queue producing work for this pool
+   * @threads : Number of threads, Runtime.event_handler_threads or
+   *            the number of hardware threads if 0
+   */
+  explicit
+  event_handler_pool(const event_queue& q, unsigned int threads = 0);
+
+  /**
+   * event_handler_pool() - Construct pool with threads pinned to cpus
+   *
+   * @q       : Event queue producing work for this pool
+   * @threads : Number of threads, the number of cpus if 0
+   * @cpus    : The cpus the threads of the pool can run on
+   */
+  event_handler_pool(const event_queue& q, unsigned int threads, const std::vector<unsigned int>& cpus);
+
+  /**
+   * event_handler_pool() - Construct pool with threads local to a device
+   *
+   * @q       : Event queue producing work for this pool
+   * @threads : Number of threads, the number of local cpus if 0
+   * @device  : Device whose local cpus (NUMA node) the threads run on
+   *
+   * The threads are not pinned if the device does not report its
+   * local cpus.
+   */
+  event_handler_pool(const event_queue& q, unsigned int threads, const device& device);
+
+private:
+  std::shared_ptr<event_handler_pool_impl> m_impl;
+};
+
 /**
  * xrt::event - Alias for event_queue::event
  */
@@ -29,7 +29,12 @@
 # include <chrono>
 # include <cstdint>
 # include <functional>
+# include <array>
 # include <memory>
+# include <stdexcept>
+# include <string>
+# include <type_traits>
+# include <utility>
 # include <vector>
 #endif
 
@@ -56,6 +61,41 @@ namespace xrt {
 class kernel;
 class event_impl;
 
+/// @cond
+namespace detail {
+
+// Host side description of a kernel argument type, used to validate
+// the argument types of a typed_kernel against the kernel meta data.
+struct arg_info
+{
+  size_t size;   // size in bytes of a scalar argument
+  bool global;   // argument is a global buffer
+};
+
+// Map a typed_kernel argument type to its arg_info and to the
+// address of the value to copy into the command.
+template <typename ArgType>
+struct typed_arg
+{
+  static_assert(std::is_trivially_copyable<ArgType>::value,
+                "Scalar kernel argument type must be trivially copyable");
+
+  static constexpr arg_info
+  info()
+  {
+    return {sizeof(ArgType), false};
+  }
+
+  static const void*
+  value(const ArgType& arg, uint64_t&)
+  {
+    return &arg;
+  }
+};
+
+} // detail
+/// @endcond
+
 /*!
  * @class run 
  *
@@ -182,6 +222,23 @@ class run
   void
   set_event(const std::shared_ptr<event_impl>& event) const;
 
+  /**
+   * set_completion_handler() - Add one-shot completion notification
+   *
+   * @param fcn
+   *   Function called with the state of the run when it completes
+   *
+   * The function is called once, when the current execution of the
+   * run completes, or immediately if the run is already complete.  It
+   * is called from the thread that processes command completion and
+   * must not block.  Unlike add_callback(), the function is not kept
+   * for subsequent executions of the run.  This function is used by
+   * the awaitable adapters in xrt_coroutine.h.
+   */
+  XCL_DRIVER_DLLESPEC
+  void
+  set_completion_handler(std::function<void(ert_cmd_state)> fcn) const;
+
   /**
    * operator bool() - Check if run handle is valid
    *
@@ -317,12 +374,21 @@ public:
   }
 
 private:
+  template <typename ...Args>
+  friend class typed_kernel;
+
   std::shared_ptr<run_impl> handle;
 
   XCL_DRIVER_DLLESPEC
   void
   set_arg_at_index(int index, const void* value, size_t bytes);
 
+  // Set the first count arguments without validation, the values
+  // have been validated by typed_kernel
+  XCL_DRIVER_DLLESPEC
+  void
+  set_args(const void* const* values, size_t count);
+
   XCL_DRIVER_DLLESPEC
   void
   set_arg_at_index(int index, const xrt::bo&);
@@ -343,6 +409,125 @@ private:
     set_arg(++argno, std::forward<Args>(args)...);
   }
 };
+
+/*!
+ * @class run_list
+ *
+ * @brief
+ * xrt::run_list is a list of run objects that are started together
+ *
+ * @details
+ * The runs in a list can be of the same or of different kernels.
+ * Starting a run list submits all runs to the command scheduler in
+ * one operation, which amortizes the per-run submission overhead
+ * when many small runs are started at the same time.
+ *
+ * A run list can be re-used to start the same runs again.
+ */
+class run_list
+{
+ public:
+  /*!
+   * @class start_error
+   *
+   * @brief
+   * Exception thrown by start() when a run in the list cannot be started
+   *
+   * @details
+   * Runs before the failing run have been started and are in flight
+   * when the exception is thrown, the failing run and all runs after
+   * it have not been started.  started() is the number of runs that
+   * were started, which is also the index of the failing run.
+   *
+   * A run that failed to start because it was already running is not
+   * affected.  Runs that were prepared but could not be submitted to
+   * the device end in state ERT_CMD_STATE_ABORT, waiting on them
+   * returns and they can be started again.
+   */
+  class start_error : public std::runtime_error
+  {
+    size_t m_started;
+  public:
+    start_error(size_t started, const std::string& what)
+      : std::runtime_error(what), m_started(started)
+    {}
+
+    /**
+     * started() - Number of runs started before the failure
+     */
+    size_t
+    started() const
+    {
+      return m_started;
+    }
+  };
+
+  /**
+   * run_list() - Construct empty run list
+   */
+  run_list()
+  {}
+
+  /**
+   * add() - Add a run to the list
+   *
+   * @param r
+   *  Run object with all arguments set
+   */
+  void
+  add(const run& r)
+  {
+    runs.push_back(r);
+  }
+
+  /**
+   * start() - Start execution of all runs in the list
+   *
+   * This function is asynchronous, ``wait()`` must be used to wait
+   * for the runs to complete.  It is an error to start a run that is
+   * already running.
+   *
+   * If a run cannot be started, the runs before it in the list are
+   * still started and start_error is thrown with the number of
+   * started runs.  The caller can wait for exactly those runs, or
+   * use ``wait()`` on the list, which does not block on runs that
+   * were not started by this call.
+   */
+  XCL_DRIVER_DLLESPEC
+  void
+  start();
+
+  /**
+   * wait() - Wait for all runs in the list to complete
+   */
+  void
+  wait() const
+  {
+    for (auto& r : runs)
+      r.wait();
+  }
+
+  /**
+   * size() - Number of runs in the list
+   */
+  size_t
+  size() const
+  {
+    return runs.size();
+  }
+
+  /**
+   * clear() - Remove all runs from the list
+   */
+  void
+  clear()
+  {
+    runs.clear();
+  }
+
+ private:
+  std::vector<run> runs;
+};
  
 
 /*!
@@ -496,12 +681,167 @@ public:
   {
     return handle;
   }
+
+  // Throws if the argument types do not match the kernel arguments
+  XCL_DRIVER_DLLESPEC
+  void
+  validate_args(const detail::arg_info* info, size_t count) const;
   /// @endcond
 
 private:
   std::shared_ptr<kernel_impl> handle;
 };
 
+/// @cond
+namespace detail {
+
+template <>
+struct typed_arg<xrt::bo>
+{
+  static constexpr arg_info
+  info()
+  {
+    return {sizeof(uint64_t), true};
+  }
+
+  static const void*
+  value(const xrt::bo& bo, uint64_t& addr)
+  {
+    addr = bo.address();
+    return &addr;
+  }
+};
+
+} // detail
+/// @endcond
+
+/*!
+ * @class typed_kernel
+ *
+ * @brief
+ * xrt::typed_kernel is a kernel with a compile time argument signature
+ *
+ * @details
+ * The template arguments are the host types of the kernel arguments
+ * in argument index order, where ``xrt::bo`` is used for global
+ * arguments.  The argument types are validated against the kernel
+ * meta data once when the typed kernel is constructed.  Setting the
+ * arguments of a run is subsequently a copy of each argument value
+ * into its precomputed location in the run's command, without lookup
+ * or validation of the individual arguments.
+ *
+ * @code
+ *  xrt::typed_kernel<xrt::bo, xrt::bo, int> vadd(device, uuid, "vadd");
+ *  auto run = vadd(in, out, 1024);
+ *  run.wait();
+ * @endcode
+ *
+ * Kernels with stream arguments cannot be typed.
+ */
+template <typename ...Args>
+class typed_kernel
+{
+  static constexpr size_t num_args = sizeof...(Args);
+
+  kernel m_kernel;
+
+  template <size_t ...Idx>
+  void
+  set_args(run& r, std::index_sequence<Idx...>, const Args&... args)
+  {
+    std::array<uint64_t, num_args> addrs;  // storage for global arg addresses
+    const std::array<const void*, num_args> values
+      {{detail::typed_arg<Args>::value(args, addrs[Idx])...}};
+    (void) addrs; // unused for kernels without arguments
+    r.set_args(values.data(), num_args);
+  }
+
+ public:
+  /**
+   * typed_kernel() - Construct from an existing kernel
+   *
+   * @param krnl
+   *  Kernel whose arguments must match the template arguments
+   *
+   * Throws if the kernel arguments do not match the template
+   * arguments in number, kind (scalar or global), or size.
+   */
+  explicit
+  typed_kernel(kernel krnl)
+    : m_kernel(std::move(krnl))
+  {
+    const std::array<detail::arg_info, num_args> info {{detail::typed_arg<Args>::info()...}};
+    m_kernel.validate_args(info.data(), num_args);
+  }
+
+  /**
+   * typed_kernel() - Constructor from a device and xclbin
+   *
+   * See ``xrt::kernel`` constructor for arguments.
+   */
+  typed_kernel(const xrt::device& device, const xrt::uuid& xclbin_id, const std::string& name,
+               kernel::cu_access_mode mode = kernel::cu_access_mode::shared)
+    : typed_kernel(kernel(device, xclbin_id, name, mode))
+  {}
+
+  /**
+   * operator() - Invoke the kernel function
+   *
+   * @param args
+   *  Kernel arguments
+   * @return
+   *  Run object representing this kernel function invocation
+   */
+  run
+  operator() (const Args&... args)
+  {
+    run r(m_kernel);
+    start(r, args...);
+    return r;
+  }
+
+  /**
+   * set_args() - Set all arguments of a run of this kernel
+   *
+   * @param r
+   *  Run object constructed from this kernel
+   * @param args
+   *  Kernel arguments
+   */
+  void
+  set_args(run& r, const Args&... args)
+  {
+    set_args(r, std::index_sequence_for<Args...>{}, args...);
+  }
+
+  /**
+   * start() - Set all arguments of a run of this kernel and start it
+   *
+   * @param r
+   *  Run object constructed from this kernel
+   * @param args
+   *  Kernel arguments
+   *
+   * Use this API to re-use an existing run object, which avoids
+   * construction of the run and its command.
+   */
+  void
+  start(run& r, const Args&... args)
+  {
+    set_args(r, args...);
+    r.start();
+  }
+
+  /**
+   * get_kernel() - Underlying untyped kernel
+   */
+  const kernel&
+  get_kernel() const
+  {
+    return m_kernel;
+  }
+};
+
 /// @cond
 // Specialization from xrt_enqueue.h for run objects, which
 // are asynchronous waitable objects.
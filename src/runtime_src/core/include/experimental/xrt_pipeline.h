@@ -23,6 +23,9 @@
 #include "experimental/xrt_enqueue.h"
 
 #ifdef __cplusplus
+# include <atomic>
+# include <chrono>
+# include <cstdint>
 # include <memory>
 # include <vector>
 # include <tuple>
@@ -60,6 +63,43 @@ class pipeline
 {
   friend class pipeline_impl;
 
+  using clock = std::chrono::steady_clock;
+
+  // struct stage_counters - shared by a stage and its enqueued instances
+  struct stage_counters
+  {
+    std::atomic<uint64_t> executions {0};
+    std::atomic<uint64_t> queued {0};
+    std::atomic<uint64_t> wait_ns {0};
+    std::atomic<uint64_t> latency_ns {0};
+    std::atomic<uint64_t> max_latency_ns {0};
+  };
+
+  // class stage_timer - records one execution of a stage function
+  class stage_timer
+  {
+    stage_counters& m_counters;
+    clock::time_point m_start;
+
+  public:
+    stage_timer(stage_counters& c, clock::time_point enqueued)
+      : m_counters(c), m_start(clock::now())
+    {
+      --m_counters.queued;
+      m_counters.wait_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(m_start - enqueued).count();
+    }
+
+    ~stage_timer()
+    {
+      uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - m_start).count();
+      m_counters.latency_ns += ns;
+      auto max = m_counters.max_latency_ns.load();
+      while (ns > max && !m_counters.max_latency_ns.compare_exchange_weak(max, ns))
+        ;
+      ++m_counters.executions;
+    }
+  };
+
   // class stage - holds a stage function, which can be enqueued in an
   // xrt::event_queue
   class stage
@@ -67,7 +107,8 @@ class pipeline
     struct stage_holder
     {
       virtual xrt::event
-      enqueue(xrt::event_queue& q, const std::vector<xrt::event>& deps) = 0;
+      enqueue(xrt::event_queue& q, const std::vector<xrt::event>& deps,
+              const std::shared_ptr<stage_counters>& counters) = 0;
     };
 
     template <typename Callable>
@@ -78,32 +119,70 @@ class pipeline
         : m_held(std::move(c))
       {}
 
+      // The stage function is wrapped to record the time it spends
+      // waiting to execute and executing.  Asynchronous stage
+      // functions are timed until they return their waitable.
       xrt::event
-      enqueue(xrt::event_queue& q, const std::vector<xrt::event>& deps)
+      enqueue(xrt::event_queue& q, const std::vector<xrt::event>& deps,
+              const std::shared_ptr<stage_counters>& counters)
       {
-        return q.enqueue_with_waitlist(m_held, deps);
+        auto held = m_held;
+        auto enqueued = clock::now();
+        ++counters->queued;
+        return q.enqueue_with_waitlist([held, counters, enqueued]() mutable {
+            stage_timer timer(*counters, enqueued);
+            return held();
+          }, deps);
       }
     };
 
     std::unique_ptr<stage_holder> m_content;
+    std::shared_ptr<stage_counters> m_counters;
 
   public:
     stage() : m_content(nullptr)
     {}
 
-    stage(stage&& rhs) : m_content(std::move(rhs.m_content))
+    stage(stage&& rhs)
+      : m_content(std::move(rhs.m_content)), m_counters(std::move(rhs.m_counters))
     {}
 
     template <typename Callable>
     stage(Callable&& c)
       : m_content(new stage_type<Callable>(std::forward<Callable>(c)))
+      , m_counters(std::make_shared<stage_counters>())
     {}
 
     xrt::event
     enqueue(xrt::event_queue& q, const std::vector<xrt::event>& deps)
     {
-      return m_content->enqueue(q, deps);
+      return m_content->enqueue(q, deps, m_counters);
     }
+
+    const stage_counters&
+    get_counters() const
+    {
+      return *m_counters;
+    }
+  };
+
+public:
+  /**
+   * struct stage_stats - Execution statistics of a pipeline stage
+   *
+   * @executions:  Number of times the stage function has executed
+   * @queued:      Number of enqueued stage instances not yet started
+   * @wait:        Total time from enqueue to start of stage function
+   * @latency:     Total execution time of the stage function
+   * @max_latency: Longest execution time of the stage function
+   */
+  struct stage_stats
+  {
+    uint64_t executions;
+    uint64_t queued;
+    std::chrono::nanoseconds wait;
+    std::chrono::nanoseconds latency;
+    std::chrono::nanoseconds max_latency;
   };
 
 
@@ -118,7 +197,8 @@ public:
    * knowledge of the stage functions properties, it is important to
    * ensure that the event queue has sufficient event handlers.  For
    * example, two synchronous stages might execute concurrently,
-   * but only if the event queue has at least two handlers.
+   * but only if the event queue has at least two handlers, or is
+   * serviced by an xrt::event_handler_pool with multiple threads.
    */
   pipeline(const xrt::event_queue& q);
 
@@ -166,6 +246,14 @@ public:
     return execute();
   }
 
+  /**
+   * get_stage_stats() - Execution statistics for each stage
+   *
+   * Return: Statistics in the order the stages were added
+   */
+  std::vector<stage_stats>
+  get_stage_stats() const;
+
   /**
    * define the control flow graph -- todo
    */
@@ -22,6 +22,9 @@
 #define AQUIRE_MUTEX() \
 mtx.lock(); \
 
+#define AQUIRE_BULK_MUTEX() \
+mtx.lock_bulk(); \
+
 #define RELEASE_MUTEX() \
 mtx.unlock();
 
@@ -31,6 +34,13 @@ mtx.unlock();
     func_name##_response r_msg; \
     AQUIRE_MUTEX()
 
+//Bulk data transfers yield to pending control calls between chunks
+#define RPC_PROLOGUE_BULK(func_name) \
+    unix_socket* _s_inst = sock; \
+    func_name##_call c_msg; \
+    func_name##_response r_msg; \
+    AQUIRE_BULK_MUTEX()
+
 #define SERIALIZE_AND_SEND_MSG(func_name)\
      unsigned c_len = c_msg.ByteSize(); \
     buf_size = alloc_void(c_len); \
@@ -294,7 +304,7 @@ mtx.unlock();
    // return ret;
 
 #define xclCopyBufferHost2Device_RPC_CALL(func_name,dev_handle,dest,src,size,seek,space) \
-    RPC_PROLOGUE(func_name); \
+    RPC_PROLOGUE_BULK(func_name); \
     xclCopyBufferHost2Device_SET_PROTOMESSAGE(func_name,dev_handle,dest,src,size,seek,space); \
     SERIALIZE_AND_SEND_MSG(func_name)\
     xclCopyBufferHost2Device_SET_PROTO_RESPONSE(); \
@@ -319,7 +329,7 @@ mtx.unlock();
     //return ret;
 
 #define xclCopyBufferDevice2Host_RPC_CALL(func_name,dev_handle,dest,src,size,skip,space) \
-    RPC_PROLOGUE(func_name); \
+    RPC_PROLOGUE_BULK(func_name); \
     xclCopyBufferDevice2Host_SET_PROTOMESSAGE(func_name,dev_handle,dest,src,size,skip,space); \
     SERIALIZE_AND_SEND_MSG(func_name)\
     xclCopyBufferDevice2Host_SET_PROTO_RESPONSE(dest); \
@@ -78,6 +78,7 @@ namespace xclemulation{
     mLegacyErt = ERTMODE::NONE;
     mCuBaseAddrForce=-1;
     mIsSharedFmodel=true;
+    mSharedMemTransport=false;
     mTimeOutScale=TIMEOUT_SCALE::NA;
     mIsPlatformDataAvailable = false;
   }
@@ -192,6 +193,10 @@ namespace xclemulation{
       {
         mIsSharedFmodel=getBoolValue(value,true);
       }
+      else if(name == "shared_memory_transport")
+      {
+        setSharedMemTransport(getBoolValue(value,false));
+      }
       else if(name == "keep_run_dir")
       {
         setKeepRunDir(getBoolValue(value,true));
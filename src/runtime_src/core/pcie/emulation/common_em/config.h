@@ -182,6 +182,7 @@ namespace xclemulation{
       inline void setLauncherArgs(std::string & _mLauncherArgs) { mLauncherArgs = _mLauncherArgs;    }
       inline void setSystemDPA(bool _isDPAEnabled)              { mSystemDPA    = _isDPAEnabled;     }
       inline void setLegacyErt(ERTMODE _legacyErt)              { mLegacyErt    = _legacyErt;        }
+      inline void setSharedMemTransport(bool _shmTransport)     { mSharedMemTransport = _shmTransport; }
       
       inline bool isDiagnosticsEnabled()        const { return mDiagnostics;    }
       inline bool isUMRChecksEnabled()          const { return mUMRChecks;      }
@@ -210,6 +211,7 @@ namespace xclemulation{
       inline ERTMODE getLegacyErt() const         { return mLegacyErt;              }
       inline long long getCuBaseAddrForce() const         { return mCuBaseAddrForce;              }
       inline bool isSharedFmodel() const         {return mIsSharedFmodel; } 
+      inline bool isSharedMemTransport() const   {return mSharedMemTransport; }
       inline TIMEOUT_SCALE getTimeOutScale() const    {return mTimeOutScale;}
 
       inline void setIsPlatformEnabled(bool isPlatformDataAvailable) {mIsPlatformDataAvailable = isPlatformDataAvailable; }
@@ -245,6 +247,7 @@ namespace xclemulation{
       ERTMODE mLegacyErt;
       long long mCuBaseAddrForce;
       bool      mIsSharedFmodel;
+      bool      mSharedMemTransport;
       bool mIsPlatformDataAvailable;
       TIMEOUT_SCALE mTimeOutScale;
       config();
@@ -16,13 +16,15 @@
 
 #include "memorymanager.h"
 
+#include <iterator>
+
 namespace xclemulation {
   MemoryManager::MemoryManager(uint64_t size, uint64_t start,
       unsigned alignment,std::string& tag ) : mSize(size), mStart(start), mAlignment(alignment), mTag(tag),
-  mCoalesceThreshold(4), mFreeSize(0)
+  mFreeSize(0)
   {
     assert(start % alignment == 0);
-    mFreeBufferList.push_back(std::make_pair(mStart, mSize));
+    insertFree(mStart, mSize);
     mFreeSize = mSize;
   }
 
@@ -76,100 +78,84 @@ namespace xclemulation {
 	    }
     }
 
-    for (PairList::iterator i = mFreeBufferList.begin(), e = mFreeBufferList.end(); i != e; ++i) 
-    {
-      if (i->second < size)
-        continue;
-      result = i->first;
-      if (i->second > size) 
-      {
-        // Resize the existing entry in freelist
-        i->first += size;
-        i->second -= size;
-      }
-      else 
-      {
-        // remove the exact match found
-        mFreeBufferList.erase(i);
-      }
-      mBusyBufferList.push_back(std::make_pair(result, size));
-      mFreeSize -= size;
-      break;
+    // Best fit, lowest address first among equal sizes
+    SizeIndex::iterator i = mFreeBySize.lower_bound(std::make_pair(static_cast<uint64_t>(size), static_cast<uint64_t>(0)));
+    if (i == mFreeBySize.end())
+      return result;
+
+    result = i->second;
+    const uint64_t blockSize = i->first;
+    eraseFree(mFreeBuffers.find(result));
+    if (blockSize > size) {
+      // The remainder cannot have a free neighbour: the block below is
+      // the one just allocated and free blocks are never adjacent
+      insertFree(result + size, blockSize - size);
     }
+    mBusyBuffers.insert(std::make_pair(result, static_cast<uint64_t>(size)));
+    mFreeSize -= size;
     return result;
   }
 
   void MemoryManager::free(uint64_t buf)
   {
     std::lock_guard<std::mutex> lock(mMemManagerMutex);
-    PairList::iterator i = find(buf);
-    if (i == mBusyBufferList.end())
+    BlockMap::iterator i = mBusyBuffers.find(buf);
+    if (i == mBusyBuffers.end())
       return;
     mFreeSize += i->second;
-    mFreeBufferList.push_back(std::make_pair(i->first, i->second));
-    mBusyBufferList.erase(i);
-    if (mFreeBufferList.size() > mCoalesceThreshold) {
-      coalesce();
-    }
+    addFree(i->first, i->second);
+    mBusyBuffers.erase(i);
   }
 
-
-  void MemoryManager::coalesce()
+  void MemoryManager::addFree(uint64_t buf, uint64_t size)
   {
-    // First sort the free buffers and then attempt to coalesce the neighbors
-    mFreeBufferList.sort();
-
-    PairList::iterator curr = mFreeBufferList.begin();
-    PairList::iterator next = curr;
-    ++next;
-    PairList::iterator last = mFreeBufferList.end();
-    while (next != last) {
-      if ((curr->first + curr->second) != next->first) {
-        // Non contiguous blocks
-        curr = next;
-        ++next;
-        continue;
+    // Merge with the free block that ends at buf, if any
+    BlockMap::iterator next = mFreeBuffers.lower_bound(buf);
+    if (next != mFreeBuffers.begin()) {
+      BlockMap::iterator prev = std::prev(next);
+      if (prev->first + prev->second == buf) {
+        buf = prev->first;
+        size += prev->second;
+        eraseFree(prev);
       }
-      // Coalesce curr and next
-      curr->second += next->second;
-      mFreeBufferList.erase(next);
-      next = curr;
-      ++next;
     }
+
+    // Merge with the free block that starts where this one ends, if any
+    if (next != mFreeBuffers.end() && (buf + size) == next->first) {
+      size += next->second;
+      eraseFree(next);
+    }
+
+    insertFree(buf, size);
   }
 
+  void MemoryManager::insertFree(uint64_t buf, uint64_t size)
+  {
+    mFreeBuffers.insert(std::make_pair(buf, size));
+    mFreeBySize.insert(std::make_pair(size, buf));
+  }
 
-  MemoryManager::PairList::iterator MemoryManager::find(uint64_t buf)
+  void MemoryManager::eraseFree(BlockMap::iterator i)
   {
-#if GCC_VERSION >= 40800
-    PairList::iterator i = std::find_if(mBusyBufferList.begin(), mBusyBufferList.end(), [&] (const PairList::value_type& s)
-        { return s.first == buf; });
-#else
-    PairList::iterator i = mBusyBufferList.begin();
-    PairList::iterator last  = mBusyBufferList.end();
-    while(i != last) {
-      if (i->first == buf)
-        break;
-      ++i;
-    }
-#endif
-    return i;
+    mFreeBySize.erase(std::make_pair(i->second, i->first));
+    mFreeBuffers.erase(i);
   }
 
   void MemoryManager::reset()
   {
     std::lock_guard<std::mutex> lock(mMemManagerMutex);
-    mFreeBufferList.clear();
-    mBusyBufferList.clear();
-    mFreeBufferList.push_back(std::make_pair(mStart, mSize));
-    mFreeSize = 0;
+    mFreeBuffers.clear();
+    mFreeBySize.clear();
+    mBusyBuffers.clear();
+    insertFree(mStart, mSize);
+    mFreeSize = mSize;
   }
 
   std::pair<uint64_t, uint64_t> MemoryManager::lookup(uint64_t buf)
   {
     std::lock_guard<std::mutex> lock(mMemManagerMutex);
-    PairList::iterator i = find(buf);
-    if (i != mBusyBufferList.end())
+    BlockMap::iterator i = mBusyBuffers.find(buf);
+    if (i != mBusyBuffers.end())
       return *i;
     // Compiler bug -- Some versions of GCC C++11 compiler do not
     // like mNull directly inside std::make_pair, so capture mNull
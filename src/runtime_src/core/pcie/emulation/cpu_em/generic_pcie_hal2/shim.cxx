@@ -864,6 +864,16 @@ namespace xclcpuemhal2 {
     src = (unsigned char*)src + seek;
     dest += seek;
 
+    // Device memory shared with device process, no RPC needed.  The
+    // lock keeps the buffer mapped until the copy is done
+    {
+      std::shared_lock<std::shared_timed_mutex> lk(mSharedMemoryMtx);
+      if (auto shm = getSharedMemory(dest, size)) {
+        std::memcpy(shm, src, size);
+        return size;
+      }
+    }
+
     void *handle = this;
 
     unsigned int messageSize = get_messagesize();
@@ -901,6 +911,17 @@ namespace xclcpuemhal2 {
       launchTempProcess();
     }
     src += skip;
+
+    // Device memory shared with device process, no RPC needed.  The
+    // lock keeps the buffer mapped until the copy is done
+    {
+      std::shared_lock<std::shared_timed_mutex> lk(mSharedMemoryMtx);
+      if (auto shm = getSharedMemory(src, size)) {
+        std::memcpy(dest, shm, size);
+        return size;
+      }
+    }
+
     void *handle = this;
 
     unsigned int messageSize = get_messagesize();
@@ -1190,6 +1211,11 @@ uint64_t CpuemShim::xoclCreateBo(xclemulation::xocl_create_bo* info)
   xobj->flags=info->flags;
   /* check whether buffer is p2p or not*/
   bool noHostMemory = xclemulation::no_host_memory(xobj.get()) || xclemulation::xocl_bo_host_only(xobj.get());
+  // With shared memory transport all buffers are requested as file
+  // backed so host and device process share the device memory
+  bool sharedMemory = xclemulation::config::getInstance()->isSharedMemTransport() && !noHostMemory;
+  if (sharedMemory)
+    noHostMemory = true;
   std::string sFileName("");
   xobj->base = xclAllocDeviceBuffer2(size,XCL_MEM_DEVICE_RAM,ddr,noHostMemory,sFileName);
   xobj->filename = sFileName;
@@ -1203,6 +1229,11 @@ uint64_t CpuemShim::xoclCreateBo(xclemulation::xocl_create_bo* info)
     return xclemulation::MemoryManager::mNull;
   }
 
+  // Device process without file backed buffers falls back to socket
+  // transport, otherwise the buffer is accessed through its mapping
+  if (sharedMemory && !xobj->filename.empty())
+    mapSharedMemory(xobj.get());
+
   info->handle = mBufferCount;
   mXoclObjMap[mBufferCount++] = xobj.release();
   return 0;
@@ -1222,6 +1253,63 @@ unsigned int CpuemShim::xclAllocBO(size_t size, int unused, unsigned flags)
 }
 /***************************************************************************************/
 
+/******************************** Shared memory transport ******************************/
+void* CpuemShim::mapSharedMemory(xclemulation::drm_xocl_bo* bo)
+{
+  int fd = open(bo->filename.c_str(), (O_CREAT | O_RDWR), 0666);
+  if (fd == -1)
+    return nullptr;
+
+  if (ftruncate(fd, bo->size) == -1) {
+    close(fd);
+    return nullptr;
+  }
+
+  void* data = mmap(0, bo->size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED)
+    return nullptr;
+
+  bo->buf = data;
+  std::lock_guard<std::shared_timed_mutex> lk(mSharedMemoryMtx);
+  mSharedMemoryMap[bo->base] = std::make_pair(data, bo->size);
+  return data;
+}
+
+void CpuemShim::unmapSharedMemory(xclemulation::drm_xocl_bo* bo)
+{
+  std::lock_guard<std::shared_timed_mutex> lk(mSharedMemoryMtx);
+  auto itr = mSharedMemoryMap.find(bo->base);
+  if (itr == mSharedMemoryMap.end())
+    return;
+
+  munmap(itr->second.first, itr->second.second);
+  mSharedMemoryMap.erase(itr);
+  bo->buf = nullptr;
+}
+
+// Host address of device memory range if the range is within one
+// shared memory buffer, nullptr otherwise.  The caller holds a lock
+// on mSharedMemoryMtx while it uses the returned address
+void* CpuemShim::getSharedMemory(uint64_t address, size_t size)
+{
+  if (mSharedMemoryMap.empty())
+    return nullptr;
+
+  auto itr = mSharedMemoryMap.upper_bound(address);
+  if (itr == mSharedMemoryMap.begin())
+    return nullptr;
+
+  --itr;
+  auto base = itr->first;
+  auto& region = itr->second;
+  if (address + size > base + region.second)
+    return nullptr;
+
+  return static_cast<char*>(region.first) + (address - base);
+}
+/***************************************************************************************/
+
 /******************************** xclAllocUserPtrBO ************************************/
 unsigned int CpuemShim::xclAllocUserPtrBO(void *userptr, size_t size, unsigned flags)
 {
@@ -1399,6 +1487,11 @@ void *CpuemShim::xclMapBO(unsigned int boHandle, bool write)
     return nullptr;
   }
 
+  if (mSharedMemoryMap.count(bo->base)) {
+    PRINTENDFUNC;
+    return bo->buf;
+  }
+
   std::string sFileName = bo->filename;
   if(!sFileName.empty() )
   {
@@ -1441,6 +1534,8 @@ int CpuemShim::xclUnmapBO(unsigned int boHandle, void* addr)
 {
   std::lock_guard<std::mutex> lk(mApiMtx);
   auto bo = xclGetBoByHandle(boHandle);
+  if (bo && mSharedMemoryMap.count(bo->base))
+    return 0; // unmapped when BO is freed
   return bo ? munmap(addr,bo->size) : -1;
 }
 
@@ -1461,6 +1556,13 @@ int CpuemShim::xclSyncBO(unsigned int boHandle, xclBOSyncDirection dir, size_t s
     return -1;
   }
 
+  // Mapped shared memory is the device memory, nothing to sync
+  if (!bo->userptr && mSharedMemoryMap.count(bo->base))
+  {
+    PRINTENDFUNC;
+    return 0;
+  }
+
   int returnVal = 0;
   if(dir == XCL_BO_SYNC_BO_TO_DEVICE)
   {
@@ -1498,6 +1600,7 @@ void CpuemShim::xclFreeBO(unsigned int boHandle)
   xclemulation::drm_xocl_bo* bo = (*it).second;;
   if(bo)
   {
+    unmapSharedMemory(bo);
     xclFreeDeviceBuffer(bo->base);
     mXoclObjMap.erase(it);
   }
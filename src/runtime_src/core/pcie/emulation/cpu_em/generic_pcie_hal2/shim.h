@@ -21,6 +21,7 @@
 #include "config.h"
 #include "em_defines.h"
 #include "memorymanager.h"
+#include "rpc_mutex.h"
 #include "rpc_messages.pb.h"
 
 #include "xclperf.h"
@@ -41,6 +42,7 @@
 #include <fcntl.h>
 #include <thread>
 #include <tuple>
+#include <shared_mutex>
 #include <sys/wait.h>
 #ifndef _WINDOWS
 #include <dlfcn.h>
@@ -87,6 +89,12 @@ namespace xclcpuemhal2 {
 
 
       xclemulation::drm_xocl_bo* xclGetBoByHandle(unsigned int boHandle);
+
+      // Shared memory transport, device memory of a BO is a file
+      // mapped by both this shim and the device process
+      void* mapSharedMemory(xclemulation::drm_xocl_bo* bo);
+      void unmapSharedMemory(xclemulation::drm_xocl_bo* bo);
+      void* getSharedMemory(uint64_t address, size_t size);
       inline unsigned short xocl_ddr_channel_count();
       inline unsigned long long xocl_ddr_channel_size();
       // HAL2 RELATED member functions end
@@ -195,7 +203,7 @@ namespace xclcpuemhal2 {
       std::string dec2bin(uint32_t n);
       std::string dec2bin(uint32_t n, unsigned bits);
 
-      std::mutex mtx;
+      xclemulation::rpc_mutex mtx;
       unsigned int message_size;
       bool simulator_started;
 
@@ -243,6 +251,12 @@ namespace xclcpuemhal2 {
       std::map<int, xclemulation::drm_xocl_bo*> mXoclObjMap;
       static unsigned int mBufferCount;
       static std::map<int, std::tuple<std::string,int,void*> > mFdToFileNameMap;
+      // device address -> (host mapping, size) of shared memory BOs.
+      // Changed with mApiMtx and mSharedMemoryMtx held; host/device
+      // copies, which are not serialized by mApiMtx, hold a shared
+      // lock on mSharedMemoryMtx for the lookup and the copy
+      std::map<uint64_t, std::pair<void*,uint64_t> > mSharedMemoryMap;
+      std::shared_timed_mutex mSharedMemoryMtx;
       // HAL2 RELATED member variables end
       std::list<std::tuple<uint64_t ,void*, std::map<uint64_t , uint64_t> > > mReqList;
       uint64_t mReqCounter;
@@ -16,15 +16,27 @@
 
 #include "mem_model.h"
 
+#include <fcntl.h>
+#include <sys/mman.h>
+
 mem_model::~ mem_model()
 {
   serialize();
+  for (auto region : mRegions)
+  {
+    if (region)
+      munmap(region, REGIONSIZE);
+  }
+  if (mFd != -1)
+    close(mFd);
 }
 
 mem_model::mem_model(std::string deviceName):
+  mFd(-1),
   mDeviceName(deviceName),
   module_name("dr_wrapper_dr_i_sdaccel_generic_pcie_0.sdaccel_generic_pcie_model.ddrx_top_tlm_model_0.axi_app_tlm_model_0")
 {
+  open_backing_file();
 }
 
   unsigned int mem_model::writeDevMem(uint64_t offset, const void* src, unsigned int size)
@@ -37,15 +49,14 @@ mem_model::mem_model(std::string deviceName):
       while(written_bytes < size){
           uint64_t src_offset = written_bytes;
 
-          unsigned char* page_ptr  = get_page(addr);
-          uint64_t       page_addr = addr & ~(-1 << ADDRBITS);
+          unsigned char* region_ptr  = get_region(addr, true);
+          uint64_t       region_addr = addr & (REGIONSIZE - 1);
 
-          unsigned char* dest_buf_ptr = page_ptr + page_addr;
+          unsigned char* dest_buf_ptr = region_ptr + region_addr;
           unsigned char* src_buf_ptr  = (unsigned char*)(src)      + src_offset;
 
           uint64_t remaining_bytes_to_write = size - written_bytes;
-          uint64_t unaligned_bytes_in_addr = (addr & ~(-1 << ADDRBITS));
-          uint64_t bytes_upto_next_alignment = (0x1 << ADDRBITS) - unaligned_bytes_in_addr;
+          uint64_t bytes_upto_next_alignment = REGIONSIZE - region_addr;
 
           uint64_t buf_size = 0;
           if(bytes_upto_next_alignment > remaining_bytes_to_write)
@@ -84,15 +95,13 @@ mem_model::mem_model(std::string deviceName):
 	  while(read_bytes < size){
 		  uint64_t dest_offset = read_bytes;
 
-		  unsigned char* page_ptr  = get_page(addr);
-		  uint64_t       page_addr = addr & ~(-1 << ADDRBITS);
+		  unsigned char* region_ptr  = get_region(addr, false);
+		  uint64_t       region_addr = addr & (REGIONSIZE - 1);
 
-		  unsigned char* src_buf_ptr = page_ptr + page_addr;
 		  unsigned char* dest_buf_ptr  = (unsigned char*)(dest)      + dest_offset;
 
 		  uint64_t remaining_bytes_to_read = size - read_bytes;
-		  uint64_t unaligned_bytes_in_addr = (addr & ~(-1 << ADDRBITS));
-		  uint64_t bytes_upto_next_alignment = (0x1 << ADDRBITS) - unaligned_bytes_in_addr;
+		  uint64_t bytes_upto_next_alignment = REGIONSIZE - region_addr;
 
 		  uint64_t buf_size = 0;
 		  if(bytes_upto_next_alignment > remaining_bytes_to_read)
@@ -101,7 +110,12 @@ mem_model::mem_model(std::string deviceName):
 		  }else{
 			  buf_size = bytes_upto_next_alignment;
 		  }
-	  memcpy(dest_buf_ptr,src_buf_ptr,buf_size);
+		  // Memory that was never written reads back as zero without
+		  // giving the region space in the backing file
+		  if (region_ptr)
+			  memcpy(dest_buf_ptr,region_ptr + region_addr,buf_size);
+		  else
+			  memset(dest_buf_ptr,0,buf_size);
 		  read_bytes += buf_size;
 		  addr += buf_size;
 	  }
@@ -118,66 +132,116 @@ mem_model::mem_model(std::string deviceName):
 
 	  return 0;
   }
-  unsigned char* mem_model::get_page(uint64_t offset) {
-	  uint64_t page_idx = offset >> ADDRBITS;
-	  std::string file_name = get_mem_file_name(page_idx);
-	  if(pageCache.size() > N_1MBARRAYS)
-	  {
-		  std::cerr << "Out of Memory. DDR model does not support this much of memory\n";
-		  exit(1);
-	  } else {
-      FILE* pFile = NULL;
-		  if(pageCache.find(page_idx) != pageCache.end())
-		  {
-			  return pageCache[page_idx];
-		  } else if(((pFile = fopen(file_name.c_str(),"r")) != NULL)) {
-			  int fhandle = fileno(pFile);
-
-			  if (deserialize_msg.ParseFromFileDescriptor(fhandle) == false)
-        {
-          fclose(pFile);
-          exit(1);
-        }
-			  pageCache[page_idx] = new unsigned char[PAGESIZE];
-
-			  memcpy(pageCache[page_idx],deserialize_msg.data().c_str(),PAGESIZE);
-			  fclose(pFile);
-			  return pageCache[page_idx];
-		  } else {
-			  pageCache[page_idx] = new unsigned char[PAGESIZE];
-			  return pageCache[page_idx];
-		  }
-	  }
+
+  unsigned char* mem_model::get_region(uint64_t offset, bool create) {
+    uint64_t region_idx = offset >> REGIONBITS;
+    if (region_idx >= (1ULL << (ADDRBITS_MAX - REGIONBITS)))
+    {
+      std::cerr << "Out of Memory. DDR model does not support address 0x" << std::hex << offset << std::dec << "\n";
+      exit(1);
+    }
+
+    std::lock_guard<std::mutex> lk(mRegionLock);
+    if (region_idx < mRegions.size() && mRegions[region_idx])
+      return mRegions[region_idx];
+    if (!create)
+      return nullptr;
+
+    if (region_idx >= mRegions.size())
+      mRegions.resize(region_idx + 1, nullptr);
+    uint64_t slot = mSlots.size();
+    mRegions[region_idx] = map_slot(slot);
+    mSlots.push_back(region_idx);
+    return mRegions[region_idx];
+  }
+
+  unsigned char* mem_model::map_slot(uint64_t slot) {
+    // Growing the file only extends its logical size, the new region is
+    // a hole until it is written
+    off_t end = static_cast<off_t>((slot + 1) * REGIONSIZE);
+    struct stat statBuf;
+    if (fstat(mFd, &statBuf) == -1 || (statBuf.st_size < end && ftruncate(mFd, end) == -1))
+    {
+      std::cerr << "Unable to grow DDR model backing file " << mFileName << ": " << strerror(errno) << "\n";
+      exit(1);
+    }
+
+    void* region = mmap(nullptr, REGIONSIZE, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_NORESERVE, mFd, static_cast<off_t>(slot * REGIONSIZE));
+    if (region == MAP_FAILED)
+    {
+      std::cerr << "Unable to map DDR model backing file " << mFileName << ": " << strerror(errno) << "\n";
+      exit(1);
+    }
+    return static_cast<unsigned char*>(region);
+  }
+
+  void mem_model::open_backing_file() {
+    mFileName = get_mem_file_name(".mem");
+    mIndexFileName = get_mem_file_name(".idx");
+
+    // The index records which region lives in each slot of the backing
+    // file.  Without it, any existing contents cannot be placed and the
+    // file is started afresh.
+    std::vector<uint64_t> slots;
+    int idxFd = open(mIndexFileName.c_str(), O_RDONLY);
+    if (idxFd != -1)
+    {
+      uint64_t region_idx = 0;
+      while (read(idxFd, &region_idx, sizeof(region_idx)) == sizeof(region_idx))
+        slots.push_back(region_idx);
+      close(idxFd);
+    }
+
+    int flags = O_RDWR | O_CREAT;
+    if (slots.empty())
+      flags |= O_TRUNC;
+    mFd = open(mFileName.c_str(), flags, 0644);
+    if (mFd == -1)
+    {
+      std::cerr << "Unable to open DDR model backing file " << mFileName << ": " << strerror(errno) << "\n";
+      exit(1);
+    }
+
+    for (auto region_idx : slots)
+    {
+      if (region_idx >= (1ULL << (ADDRBITS_MAX - REGIONBITS)))
+        break;
+      if (region_idx >= mRegions.size())
+        mRegions.resize(region_idx + 1, nullptr);
+      if (mRegions[region_idx])
+        break;
+      mRegions[region_idx] = map_slot(mSlots.size());
+      mSlots.push_back(region_idx);
+    }
   }
 
+  void mem_model::sync() {
+    std::lock_guard<std::mutex> lk(mRegionLock);
+    for (auto region_idx : mSlots)
+      msync(mRegions[region_idx], REGIONSIZE, MS_SYNC);
+
+    int idxFd = open(mIndexFileName.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (idxFd != -1)
+    {
+      if (!mSlots.empty())
+      {
+        ssize_t bytes = static_cast<ssize_t>(mSlots.size() * sizeof(uint64_t));
+        if (write(idxFd, mSlots.data(), bytes) != bytes)
+          std::cerr << "Unable to write DDR model index file " << mIndexFileName << "\n";
+      }
+      fsync(idxFd);
+      close(idxFd);
+    }
+    if (mFd != -1)
+      fsync(mFd);
+  }
 
   void mem_model::serialize() {
-     FILE *pFile;
-     int fhandle;
-     for (pageCacheItr=pageCache.begin(); pageCacheItr != pageCache.end(); ++pageCacheItr)
-     {
-        std::string file_name = get_mem_file_name(pageCacheItr->first);
-        pFile = fopen(file_name.c_str(),"w+");
-        if(!pFile)
-          continue;
-        fhandle = fileno(pFile);
-        if(fhandle == -1)
-        {
-          fclose(pFile);
-          exit(1);
-        }
-
-        serialize_msg.set_data(reinterpret_cast<const char*>(pageCacheItr->second),PAGESIZE);
-        if(serialize_msg.SerializeToFileDescriptor(fhandle) == false)
-        {
-          fclose(pFile);
-          exit(1);
-        }
-        fclose(pFile);
-     }
+    sync();
   }
 
- std::string mem_model::get_mem_file_name(uint64_t pageIdx)
+ std::string mem_model::get_mem_file_name(const std::string& suffix)
  {
    std::string file_name("");
    std::string user("");
@@ -199,11 +263,9 @@ mem_model::mem_model(std::string deviceName):
      int rV = system(mkdirCommand.str().c_str());
      if(rV == -1) {std::cout<<"unable to open/create mem file"<<std::endl;}
    }
-    file_name = file_path + module_name + "_" + std::to_string(pageIdx);
+    file_name = file_path + module_name + suffix;
 #ifdef DEBUGMSG
       cout<<"ddr fmodel file_name: "<< file_name<<endl;
 #endif
     return file_name;
  }
-
-
@@ -22,34 +22,53 @@
 #include <string.h> // memcpy
 #include <sstream> // memcpy
 #include <stdlib.h> //realloc
-#include <map> //realloc
+#include <cerrno>
+#include <mutex>
+#include <string>
+#include <vector>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
 
-#include "rpc_messages.pb.h"
-
 #define ONE_KB (0x400)
 #define ONE_MB (ONE_KB * ONE_KB)
-#define PAGESIZE (ONE_MB)
-#define ADDRBITS (20)
-#define N_1MBARRAYS 4096
+#define ONE_GB (ONE_MB * ONE_KB)
+
+// Device memory is backed by a single sparse file which is mapped into
+// the process in regions of (1 << REGIONBITS) bytes.  A region is only
+// given space in the file (and mapped) the first time it is touched, and
+// untouched parts of a region are file holes that read back as zero.
+#define REGIONBITS (30)
+#define REGIONSIZE (1ULL << REGIONBITS)
+// Highest device address the model can represent
+#define ADDRBITS_MAX (48)
 
 class mem_model{
 public:
 unsigned int writeDevMem(uint64_t offset, const void* src, unsigned int size);
 unsigned int readDevMem(uint64_t offset, void* dest, unsigned int size);
 
+// Flush all device memory to the backing file.  The contents are
+// restored by the next mem_model created for the same device.
+void sync();
+
 protected:
 private:
-  unsigned char* get_page(uint64_t offset);
-  std::string get_mem_file_name(uint64_t pageIdx);
-  std::map<uint64_t,unsigned char*> pageCache;
-  std::map<uint64_t,unsigned char*>::iterator pageCacheItr;
-
-  ddr_mem_msg serialize_msg;
-  ddr_mem_msg deserialize_msg;
+  unsigned char* get_region(uint64_t offset, bool create);
+  unsigned char* map_slot(uint64_t slot);
+  std::string get_mem_file_name(const std::string& suffix);
+  void open_backing_file();
   void serialize();
+
+  // Flat table from region index (address >> REGIONBITS) to its mapping
+  std::vector<unsigned char*> mRegions;
+  // Region index held by each slot of the backing file, in file order
+  std::vector<uint64_t> mSlots;
+  std::mutex mRegionLock;
+
+  int mFd;
+  std::string mFileName;
+  std::string mIndexFileName;
   std::string mDeviceName;
   std::string module_name;
 public:
@@ -58,5 +77,3 @@ public:
 };
 
 #endif
-
-
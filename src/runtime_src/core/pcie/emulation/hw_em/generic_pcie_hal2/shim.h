@@ -22,6 +22,7 @@
 #include "config.h"
 #include "em_defines.h"
 #include "memorymanager.h"
+#include "rpc_mutex.h"
 #include "rpc_messages.pb.h"
 
 #include "xclperf.h"
@@ -294,7 +295,7 @@ using addr_type = uint64_t;
       std::map<uint64_t , std::ofstream*> mOffsetInstanceStreamMap;
 
       //mutex to control parellel RPC calls
-      std::mutex mtx;
+      xclemulation::rpc_mutex mtx;
       std::mutex mApiMtx;
       std::vector<Event> list_of_events[XAIM_MAX_NUMBER_SLOTS];
       unsigned int tracecount_calls;
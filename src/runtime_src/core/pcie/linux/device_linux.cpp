@@ -267,6 +267,7 @@ initialize_query_table()
   emplace_sysfs_get<query::pcie_link_speed_max>         ("", "link_speed_max");
   emplace_sysfs_get<query::pcie_express_lane_width>     ("", "link_width");
   emplace_sysfs_get<query::pcie_express_lane_width_max> ("", "link_width_max");
+  emplace_sysfs_get<query::pcie_local_cpulist>          ("", "local_cpulist");
   emplace_sysfs_get<query::dma_threads_raw>             ("dma", "channel_stat_raw");
   emplace_sysfs_get<query::rom_vbnv>                    ("rom", "VBNV");
   emplace_sysfs_get<query::rom_ddr_bank_size_gb>        ("rom", "ddr_bank_size");
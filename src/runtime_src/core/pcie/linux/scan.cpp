@@ -35,6 +35,7 @@
 #include <boost/filesystem/fstream.hpp>
 #include "xclbin.h"
 #include "scan.h"
+#include "sysfs.h"
 #include "core/common/utils.h"
 
 #define RENDER_NM       "renderD"
@@ -45,54 +46,6 @@ namespace {
 namespace bfs = boost::filesystem;
 
 
-static std::string
-get_name(const std::string& dir, const std::string& subdir)
-{
-  std::string line;
-  std::ifstream ifs(dir + "/" + subdir + "/name");
-
-  if (ifs.is_open())
-    std::getline(ifs, line);
-
-  return line;
-}
-
-// Helper to find subdevice directory name
-// Assumption: all subdevice's sysfs directory name starts with subdevice name!!
-static int
-get_subdev_dir_name(const std::string& dir, const std::string& subDevName, std::string& subdir)
-{
-  DIR *dp;
-  size_t sub_nm_sz = subDevName.size();
-
-  subdir = "";
-  if (subDevName.empty())
-    return 0;
-
-  int ret = -ENOENT;
-  dp = opendir(dir.c_str());
-  if (dp) {
-    struct dirent *entry;
-    while ((entry = readdir(dp))) {
-      std::string nm = get_name(dir, entry->d_name);
-      if (!nm.empty()) {
-        if (nm != subDevName)
-          continue;
-      } else if(strncmp(entry->d_name, subDevName.c_str(), sub_nm_sz) ||
-                entry->d_name[sub_nm_sz] != '.') {
-        continue;
-      }
-      // found it
-      subdir = entry->d_name;
-      ret = 0;
-      break;
-    }
-    closedir(dp);
-  }
-
-  return ret;
-}
-
 static bool
 is_admin()
 {
@@ -167,201 +120,6 @@ wordcopy(void *dst, const void* src, size_t bytes)
 
 namespace pcidev {
 
-namespace sysfs {
-
-static const std::string dev_root = "/sys/bus/pci/devices/";
-static const std::string drv_root = "/sys/bus/pci/drivers/";
-
-static std::string
-get_path(const std::string& name, const std::string& subdev, const std::string& entry)
-{
-  std::string subdir;
-  if (get_subdev_dir_name(dev_root + name, subdev, subdir) != 0)
-    return "";
-
-  auto path = dev_root;
-  path += name;
-  path += "/";
-  path += subdir;
-  path += "/";
-  path += entry;
-  return path;
-}
-
-static std::fstream
-open_path(const std::string& path, std::string& err, bool write, bool binary)
-{
-  std::fstream fs;
-  std::ios::openmode mode = write ? std::ios::out : std::ios::in;
-
-  if (binary)
-    mode |= std::ios::binary;
-
-  err.clear();
-  fs.open(path, mode);
-  if (!fs.is_open()) {
-    std::stringstream ss;
-    ss << "Failed to open " << path << " for "
-       << (binary ? "binary " : "")
-       << (write ? "writing" : "reading") << ": "
-       << strerror(errno) << std::endl;
-    err = ss.str();
-  }
-  return fs;
-}
-
-static std::fstream
-open(const std::string& name,
-     const std::string& subdev, const std::string& entry,
-     std::string& err, bool write, bool binary)
-{
-  std::fstream fs;
-  auto path = get_path(name, subdev, entry);
-
-  if (path.empty()) {
-    std::stringstream ss;
-    ss << "Failed to find subdirectory for " << subdev
-       << " under " << dev_root + name << std::endl;
-    err = ss.str();
-  } else {
-    fs = open_path(path, err, write, binary);
-  }
-
-  return fs;
-}
-
-static void
-get(const std::string& name,
-    const std::string& subdev, const std::string& entry,
-    std::string& err, std::vector<std::string>& sv)
-{
-  std::fstream fs = open(name, subdev, entry, err, false, false);
-  if (!err.empty())
-    return;
-
-  sv.clear();
-  std::string line;
-  while (std::getline(fs, line))
-    sv.push_back(line);
-}
-
-static void
-get(const std::string& name,
-    const std::string& subdev, const std::string& entry,
-    std::string& err, std::vector<uint64_t>& iv)
-{
-  iv.clear();
-
-  std::vector<std::string> sv;
-  get(name, subdev, entry, err, sv);
-  if (!err.empty())
-    return;
-
-  for (auto& s : sv) {
-    if (s.empty()) {
-      std::stringstream ss;
-      ss << "Reading " << get_path(name, subdev, entry) << ", ";
-      ss << "can't convert empty string to integer" << std::endl;
-      err = ss.str();
-      break;
-    }
-    char* end = nullptr;
-    auto n = std::strtoull(s.c_str(), &end, 0);
-    if (*end != '\0') {
-      std::stringstream ss;
-      ss << "Reading " << get_path(name, subdev, entry) << ", ";
-      ss << "failed to convert string to integer: " << s << std::endl;
-      err = ss.str();
-      break;
-    }
-    iv.push_back(n);
-  }
-}
-
-static void
-get(const std::string& name,
-    const std::string& subdev, const std::string& entry,
-    std::string& err, std::string& s)
-{
-  std::vector<std::string> sv;
-  get(name, subdev, entry, err, sv);
-  if (!sv.empty())
-    s = sv[0];
-  else
-    s = ""; // default value
-}
-
-static void
-get(const std::string& name,
-    const std::string& subdev, const std::string& entry,
-    std::string& err, std::vector<char>& buf)
-{
-  std::fstream fs = open(name, subdev, entry, err, false, true);
-  if (!err.empty())
-    return;
-
-  buf.clear();
-  buf.insert(std::end(buf),std::istreambuf_iterator<char>(fs),
-             std::istreambuf_iterator<char>());
-}
-
-static void
-put(const std::string& name,
-    const std::string& subdev, const std::string& entry,
-    std::string& err, const std::string& input)
-{
-  std::fstream fs = open(name, subdev, entry, err, true, false);
-  if (!err.empty())
-    return;
-  fs << input;
-  fs.flush();
-  if (!fs.good()) {
-    std::stringstream ss;
-    ss << "Failed to write " << get_path(name, subdev, entry) << ": "
-       << strerror(errno) << std::endl;
-    err = ss.str();
-  }
-}
-
-static void
-put(const std::string& name,
-    const std::string& subdev, const std::string& entry,
-    std::string& err, const std::vector<char>& buf)
-{
-  std::fstream fs = open(name, subdev, entry, err, true, true);
-  if (!err.empty())
-    return;
-
-  fs.write(buf.data(), buf.size());
-  fs.flush();
-  if (!fs.good()) {
-    std::stringstream ss;
-    ss << "Failed to write " << get_path(name, subdev, entry) << ": "
-       << strerror(errno) << std::endl;
-    err = ss.str();
-  }
-}
-
-static void
-put(const std::string& name,
-    const std::string& subdev, const std::string& entry,
-    std::string& err, const unsigned int& input)
-{
-  std::fstream fs = open(name, subdev, entry, err, true, false);
-  if (!err.empty())
-    return;
-  fs << input;
-  fs.flush();
-  if (!fs.good()) {
-    std::stringstream ss;
-    ss << "Failed to write " << get_path(name, subdev, entry) << ": "
-       << strerror(errno) << std::endl;
-    err = ss.str();
-  }
-}
-
-} // sysfs
-
 static bool is_in_use(std::vector<std::shared_ptr<pci_device>>& vec)
 {
   for (auto& d : vec)
@@ -413,6 +171,14 @@ sysfs_get(const std::string& subdev, const std::string& entry,
 }
 
 
+void
+pci_device::
+sysfs_get_batch(const std::string& subdev, const std::vector<std::string>& entries,
+                std::vector<std::string>& errs, std::vector<std::string>& values)
+{
+  sysfs::get_batch(sysfs_name, subdev, entries, errs, values);
+}
+
 void
 pci_device::
 sysfs_put(const std::string& subdev, const std::string& entry,
@@ -516,10 +282,10 @@ pci_device(const std::string& drv_name, const std::string& sysfs) : sysfs_name(s
   if (is_mgmt())
     sysfs_get("", "instance", err, instance, static_cast<uint32_t>(INVALID_ID));
   else
-    instance = get_render_value(sysfs::dev_root + sysfs + "/drm");
+    instance = get_render_value(sysfs::dev_root() + sysfs + "/drm");
 
   sysfs_get<int>("", "userbar", err, user_bar, 0);
-  user_bar_size = bar_size(sysfs::dev_root + sysfs, user_bar);
+  user_bar_size = bar_size(sysfs::dev_root() + sysfs, user_bar);
   sysfs_get<bool>("", "ready", err, is_ready, false);
 }
 
@@ -790,6 +556,15 @@ public:
       throw std::runtime_error("sysfs_get_cv(" + subdev + "/" + entry + ") is not supported");
     }
   }
+  void sysfs_get_batch(const std::string& subdev, const std::vector<std::string>& entries,
+    std::vector<std::string>& errs, std::vector<std::string>& values)
+  {
+    // Entries may map to different v2 subdevices
+    errs.resize(entries.size());
+    values.resize(entries.size());
+    for (size_t i = 0; i < entries.size(); i++)
+      sysfs_get(subdev, entries[i], errs[i], values[i]);
+  }
   void sysfs_put(const std::string& subdev, const std::string& entry,
     std::string& err, const std::string& input)
   {
@@ -944,6 +719,7 @@ public:
 
     user_list.clear();
     mgmt_list.clear();
+    sysfs::flush();
 
     rescan_nolock("xclmgmt");
     rescan_nolock("xocl");
@@ -978,7 +754,7 @@ public:
 private:
   void rescan_nolock(const std::string driver)
   {
-    const std::string drvpath = sysfs::drv_root + driver;
+    const std::string drvpath = sysfs::drv_root() + driver;
     if(!bfs::exists(drvpath))
       return;
 
@@ -1198,6 +974,10 @@ shutdown(std::shared_ptr<pci_device> mgmt_dev, bool remove_user, bool remove_mgm
     return -ETIMEDOUT;
   }
 
+  // Sysfs nodes of both functions were removed and created again
+  sysfs::flush(udev->sysfs_name);
+  sysfs::flush(mgmt_dev->sysfs_name);
+
   if (!remove_user && !remove_mgmt)
     return 0;
 
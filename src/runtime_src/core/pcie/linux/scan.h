@@ -107,6 +107,11 @@ public:
   virtual void
   sysfs_get(const std::string& subdev, const std::string& entry,
             std::string& err, std::vector<char>& buf);
+  // First line of many entries of one subdevice; errs and values are
+  // indexed like entries
+  virtual void
+  sysfs_get_batch(const std::string& subdev, const std::vector<std::string>& entries,
+                  std::vector<std::string>& errs, std::vector<std::string>& values);
   template <typename T>
   void
   sysfs_get(const std::string& subdev, const std::string& entry,
@@ -0,0 +1,659 @@
+/**
+ * Copyright (C) 2016-2020 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "sysfs.h"
+#include "core/common/config_reader.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <unordered_map>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+// Files kept open for pread; least recently used are closed first
+const size_t max_open_files = 256;
+
+static std::string
+get_name(const std::string& dir, const std::string& subdir)
+{
+  std::string line;
+  std::ifstream ifs(dir + "/" + subdir + "/name");
+
+  if (ifs.is_open())
+    std::getline(ifs, line);
+
+  return line;
+}
+
+// Helper to find subdevice directory name
+// Assumption: all subdevice's sysfs directory name starts with subdevice name!!
+static int
+get_subdev_dir_name(const std::string& dir, const std::string& subDevName, std::string& subdir)
+{
+  DIR *dp;
+  size_t sub_nm_sz = subDevName.size();
+
+  subdir = "";
+  if (subDevName.empty())
+    return 0;
+
+  int ret = -ENOENT;
+  dp = opendir(dir.c_str());
+  if (dp) {
+    struct dirent *entry;
+    while ((entry = readdir(dp))) {
+      std::string nm = get_name(dir, entry->d_name);
+      if (!nm.empty()) {
+        if (nm != subDevName)
+          continue;
+      } else if(strncmp(entry->d_name, subDevName.c_str(), sub_nm_sz) ||
+                entry->d_name[sub_nm_sz] != '.') {
+        continue;
+      }
+      // found it
+      subdir = entry->d_name;
+      ret = 0;
+      break;
+    }
+    closedir(dp);
+  }
+
+  return ret;
+}
+
+struct open_file
+{
+  int fd;
+
+  explicit
+  open_file(int f) : fd(f)
+  {}
+
+  ~open_file()
+  {
+    ::close(fd);
+  }
+};
+
+struct cached_value
+{
+  clock_type::time_point expires;
+  std::string data;
+};
+
+struct cached_file
+{
+  std::shared_ptr<open_file> file;
+  std::list<std::string>::iterator lru;
+};
+
+// Entries whose values do not change until the device is reset
+static const char* static_entries[][2] = {
+  { "", "vendor" },
+  { "", "device" },
+  { "", "subsystem_vendor" },
+  { "", "subsystem_device" },
+  { "", "class" },
+  { "", "userbar" },
+  { "rom", "VBNV" },
+  { "rom", "FPGA" },
+  { "rom", "ddr_bank_size" },
+  { "rom", "ddr_bank_count_max" },
+  { "rom", "timestamp" },
+  { "rom", "uuid" },
+  { "rom", "raw" },
+};
+
+struct sysfs_cache
+{
+  std::mutex mutex;
+  std::string root;
+  bool enabled;
+
+  // name/subdev -> subdev dir name
+  std::unordered_map<std::string, std::string> subdirs;
+  // path -> open file
+  std::unordered_map<std::string, cached_file> files;
+  std::list<std::string> lru;
+  // path -> value
+  std::unordered_map<std::string, cached_value> values;
+  // subdev/entry -> time to live of value
+  std::unordered_map<std::string, std::chrono::milliseconds> ttls;
+
+  sysfs_cache()
+    : root(xrt_core::config::get_sysfs_root())
+    , enabled(xrt_core::config::get_sysfs_cache())
+  {
+    for (auto& e : static_entries)
+      ttls[std::string(e[0]) + "/" + e[1]] = std::chrono::milliseconds::max();
+  }
+
+  std::string
+  dev_root() const
+  {
+    return root + "/devices/";
+  }
+
+  void
+  erase_file(const std::string& path)
+  {
+    auto itr = files.find(path);
+    if (itr == files.end())
+      return;
+    lru.erase(itr->second.lru);
+    files.erase(itr);
+  }
+
+  // Drop everything under prefix
+  void
+  flush(const std::string& prefix)
+  {
+    for (auto itr = subdirs.begin(); itr != subdirs.end();) {
+      if ((dev_root() + itr->first).compare(0, prefix.size(), prefix) == 0)
+        itr = subdirs.erase(itr);
+      else
+        ++itr;
+    }
+    for (auto itr = files.begin(); itr != files.end();) {
+      if (itr->first.compare(0, prefix.size(), prefix) == 0) {
+        lru.erase(itr->second.lru);
+        itr = files.erase(itr);
+      } else {
+        ++itr;
+      }
+    }
+    for (auto itr = values.begin(); itr != values.end();) {
+      if (itr->first.compare(0, prefix.size(), prefix) == 0)
+        itr = values.erase(itr);
+      else
+        ++itr;
+    }
+  }
+};
+
+static sysfs_cache&
+cache()
+{
+  static sysfs_cache c;
+  return c;
+}
+
+static std::string
+subdir_key(const std::string& name, const std::string& subdev)
+{
+  return name + "/" + subdev;
+}
+
+static std::chrono::milliseconds
+get_ttl(sysfs_cache& c, const std::string& subdev, const std::string& entry)
+{
+  std::lock_guard<std::mutex> l(c.mutex);
+  if (!c.enabled)
+    return std::chrono::milliseconds::zero();
+  auto itr = c.ttls.find(subdev + "/" + entry);
+  return itr == c.ttls.end() ? std::chrono::milliseconds::zero() : itr->second;
+}
+
+// Directory of subdev of device name with trailing '/', same as what
+// get_path has always returned for an empty entry
+static int
+get_dir(const std::string& name, const std::string& subdev, std::string& dir)
+{
+  auto& c = cache();
+  std::string dev_root;
+  {
+    std::lock_guard<std::mutex> l(c.mutex);
+    dev_root = c.dev_root();
+    if (c.enabled) {
+      auto itr = c.subdirs.find(subdir_key(name, subdev));
+      if (itr != c.subdirs.end()) {
+        dir = dev_root + name + "/" + itr->second + "/";
+        return 0;
+      }
+    }
+  }
+
+  std::string subdir;
+  int ret = get_subdev_dir_name(dev_root + name, subdev, subdir);
+  if (ret != 0)
+    return ret;
+
+  if (c.enabled) {
+    // Not found results are not cached as subdevices come and go with xclbins
+    std::lock_guard<std::mutex> l(c.mutex);
+    c.subdirs[subdir_key(name, subdev)] = subdir;
+  }
+  dir = dev_root + name + "/" + subdir + "/";
+  return 0;
+}
+
+// Forget where subdev of name and its files are after a failed read
+static void
+drop(const std::string& name, const std::string& subdev, const std::string& path)
+{
+  auto& c = cache();
+  std::lock_guard<std::mutex> l(c.mutex);
+  c.subdirs.erase(subdir_key(name, subdev));
+  c.erase_file(path);
+}
+
+static std::shared_ptr<open_file>
+get_file(const std::string& path, int& error)
+{
+  auto& c = cache();
+  if (c.enabled) {
+    std::lock_guard<std::mutex> l(c.mutex);
+    auto itr = c.files.find(path);
+    if (itr != c.files.end()) {
+      c.lru.splice(c.lru.begin(), c.lru, itr->second.lru);
+      return itr->second.file;
+    }
+  }
+
+  int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    error = errno;
+    return nullptr;
+  }
+  auto file = std::make_shared<open_file>(fd);
+
+  if (c.enabled) {
+    std::lock_guard<std::mutex> l(c.mutex);
+    auto itr = c.files.find(path);
+    if (itr != c.files.end())
+      return itr->second.file;
+    c.lru.push_front(path);
+    c.files[path] = { file, c.lru.begin() };
+    if (c.files.size() > max_open_files)
+      c.erase_file(c.lru.back());
+  }
+  return file;
+}
+
+// Read whole file from offset 0, which makes sysfs generate the value again.
+// Returns false with err set if the file can not be opened or read.
+static bool
+read_path(const std::string& path, std::chrono::milliseconds ttl,
+          std::string& data, std::string& err)
+{
+  auto& c = cache();
+  if (ttl != std::chrono::milliseconds::zero()) {
+    std::lock_guard<std::mutex> l(c.mutex);
+    auto itr = c.values.find(path);
+    if (itr != c.values.end() && clock_type::now() < itr->second.expires) {
+      data = itr->second.data;
+      return true;
+    }
+  }
+
+  int error = 0;
+  auto file = get_file(path, error);
+  if (!file) {
+    std::stringstream ss;
+    ss << "Failed to open " << path << " for reading: "
+       << strerror(error) << std::endl;
+    err = ss.str();
+    return false;
+  }
+
+  data.clear();
+  char buf[4096];
+  off_t offset = 0;
+  ssize_t n;
+  while ((n = ::pread(file->fd, buf, sizeof(buf), offset)) > 0) {
+    data.append(buf, n);
+    offset += n;
+  }
+  if (n < 0) {
+    std::stringstream ss;
+    ss << "Failed to read " << path << ": " << strerror(errno) << std::endl;
+    err = ss.str();
+    return false;
+  }
+
+  if (ttl != std::chrono::milliseconds::zero()) {
+    auto expires = (ttl == std::chrono::milliseconds::max())
+      ? clock_type::time_point::max()
+      : clock_type::now() + ttl;
+    std::lock_guard<std::mutex> l(c.mutex);
+    c.values[path] = { expires, data };
+  }
+  return true;
+}
+
+static void
+read(const std::string& name,
+     const std::string& subdev, const std::string& entry,
+     std::string& err, std::string& data)
+{
+  err.clear();
+  auto ttl = get_ttl(cache(), subdev, entry);
+  for (int retry = 0; ; retry++) {
+    std::string dir;
+    if (get_dir(name, subdev, dir) != 0) {
+      std::stringstream ss;
+      ss << "Failed to find subdirectory for " << subdev
+         << " under " << pcidev::sysfs::dev_root() + name << std::endl;
+      err = ss.str();
+      return;
+    }
+    auto path = dir + entry;
+    if (read_path(path, ttl, data, err))
+      return;
+    // The subdevice may have been removed and created again
+    drop(name, subdev, path);
+    if (retry > 0 || !cache().enabled)
+      return;
+    err.clear();
+  }
+}
+
+// Same as reading with std::getline
+static void
+split_lines(const std::string& data, std::vector<std::string>& sv)
+{
+  sv.clear();
+  size_t pos = 0;
+  while (pos < data.size()) {
+    auto end = data.find('\n', pos);
+    if (end == std::string::npos) {
+      sv.push_back(data.substr(pos));
+      break;
+    }
+    sv.push_back(data.substr(pos, end - pos));
+    pos = end + 1;
+  }
+}
+
+static std::fstream
+open_path(const std::string& path, std::string& err, bool write, bool binary)
+{
+  std::fstream fs;
+  std::ios::openmode mode = write ? std::ios::out : std::ios::in;
+
+  if (binary)
+    mode |= std::ios::binary;
+
+  err.clear();
+  fs.open(path, mode);
+  if (!fs.is_open()) {
+    std::stringstream ss;
+    ss << "Failed to open " << path << " for "
+       << (binary ? "binary " : "")
+       << (write ? "writing" : "reading") << ": "
+       << strerror(errno) << std::endl;
+    err = ss.str();
+  }
+  return fs;
+}
+
+static std::fstream
+open_for_write(const std::string& name,
+               const std::string& subdev, const std::string& entry,
+               std::string& err, bool binary)
+{
+  std::fstream fs;
+  auto path = pcidev::sysfs::get_path(name, subdev, entry);
+
+  if (path.empty()) {
+    std::stringstream ss;
+    ss << "Failed to find subdirectory for " << subdev
+       << " under " << pcidev::sysfs::dev_root() + name << std::endl;
+    err = ss.str();
+  } else {
+    fs = open_path(path, err, true, binary);
+    // Value written may be read back
+    auto& c = cache();
+    std::lock_guard<std::mutex> l(c.mutex);
+    c.values.erase(path);
+  }
+
+  return fs;
+}
+
+template <typename T>
+static void
+write(const std::string& name,
+      const std::string& subdev, const std::string& entry,
+      std::string& err, const T& input)
+{
+  std::fstream fs = open_for_write(name, subdev, entry, err, false);
+  if (!err.empty())
+    return;
+  fs << input;
+  fs.flush();
+  if (!fs.good()) {
+    std::stringstream ss;
+    ss << "Failed to write " << pcidev::sysfs::get_path(name, subdev, entry) << ": "
+       << strerror(errno) << std::endl;
+    err = ss.str();
+  }
+}
+
+} // namespace
+
+namespace pcidev { namespace sysfs {
+
+std::string
+get_root()
+{
+  auto& c = cache();
+  std::lock_guard<std::mutex> l(c.mutex);
+  return c.root;
+}
+
+void
+set_root(const std::string& root)
+{
+  auto& c = cache();
+  std::lock_guard<std::mutex> l(c.mutex);
+  c.root = root;
+  c.flush("");
+}
+
+std::string
+dev_root()
+{
+  return get_root() + "/devices/";
+}
+
+std::string
+drv_root()
+{
+  return get_root() + "/drivers/";
+}
+
+std::string
+get_path(const std::string& name, const std::string& subdev, const std::string& entry)
+{
+  std::string dir;
+  if (get_dir(name, subdev, dir) != 0)
+    return "";
+  return dir + entry;
+}
+
+void
+get(const std::string& name,
+    const std::string& subdev, const std::string& entry,
+    std::string& err, std::vector<std::string>& sv)
+{
+  std::string data;
+  read(name, subdev, entry, err, data);
+  if (!err.empty())
+    return;
+  split_lines(data, sv);
+}
+
+void
+get(const std::string& name,
+    const std::string& subdev, const std::string& entry,
+    std::string& err, std::vector<uint64_t>& iv)
+{
+  iv.clear();
+
+  std::vector<std::string> sv;
+  get(name, subdev, entry, err, sv);
+  if (!err.empty())
+    return;
+
+  for (auto& s : sv) {
+    if (s.empty()) {
+      std::stringstream ss;
+      ss << "Reading " << get_path(name, subdev, entry) << ", ";
+      ss << "can't convert empty string to integer" << std::endl;
+      err = ss.str();
+      break;
+    }
+    char* end = nullptr;
+    auto n = std::strtoull(s.c_str(), &end, 0);
+    if (*end != '\0') {
+      std::stringstream ss;
+      ss << "Reading " << get_path(name, subdev, entry) << ", ";
+      ss << "failed to convert string to integer: " << s << std::endl;
+      err = ss.str();
+      break;
+    }
+    iv.push_back(n);
+  }
+}
+
+void
+get(const std::string& name,
+    const std::string& subdev, const std::string& entry,
+    std::string& err, std::string& s)
+{
+  std::vector<std::string> sv;
+  get(name, subdev, entry, err, sv);
+  if (!sv.empty())
+    s = sv[0];
+  else
+    s = ""; // default value
+}
+
+void
+get(const std::string& name,
+    const std::string& subdev, const std::string& entry,
+    std::string& err, std::vector<char>& buf)
+{
+  std::string data;
+  read(name, subdev, entry, err, data);
+  if (!err.empty())
+    return;
+
+  buf.assign(data.begin(), data.end());
+}
+
+void
+get_batch(const std::string& name, const std::string& subdev,
+          const std::vector<std::string>& entries,
+          std::vector<std::string>& errs, std::vector<std::string>& values)
+{
+  errs.assign(entries.size(), "");
+  values.assign(entries.size(), "");
+
+  // Subdevice is resolved once for all entries
+  std::string dir;
+  bool found = (get_dir(name, subdev, dir) == 0);
+  auto& c = cache();
+  std::vector<std::string> sv;
+  for (size_t i = 0; i < entries.size(); i++) {
+    std::string data;
+    if (!found || !read_path(dir + entries[i], get_ttl(c, subdev, entries[i]), data, errs[i])) {
+      // Retry and report errors like a single get
+      get(name, subdev, entries[i], errs[i], values[i]);
+      found = (get_dir(name, subdev, dir) == 0);
+      continue;
+    }
+    split_lines(data, sv);
+    if (!sv.empty())
+      values[i] = sv[0];
+  }
+}
+
+void
+put(const std::string& name,
+    const std::string& subdev, const std::string& entry,
+    std::string& err, const std::string& input)
+{
+  write(name, subdev, entry, err, input);
+}
+
+void
+put(const std::string& name,
+    const std::string& subdev, const std::string& entry,
+    std::string& err, const std::vector<char>& buf)
+{
+  std::fstream fs = open_for_write(name, subdev, entry, err, true);
+  if (!err.empty())
+    return;
+
+  fs.write(buf.data(), buf.size());
+  fs.flush();
+  if (!fs.good()) {
+    std::stringstream ss;
+    ss << "Failed to write " << get_path(name, subdev, entry) << ": "
+       << strerror(errno) << std::endl;
+    err = ss.str();
+  }
+}
+
+void
+put(const std::string& name,
+    const std::string& subdev, const std::string& entry,
+    std::string& err, const unsigned int& input)
+{
+  write(name, subdev, entry, err, input);
+}
+
+void
+set_ttl(const std::string& subdev, const std::string& entry, std::chrono::milliseconds ttl)
+{
+  auto& c = cache();
+  std::lock_guard<std::mutex> l(c.mutex);
+  c.ttls[subdev + "/" + entry] = ttl;
+  if (ttl == std::chrono::milliseconds::zero()) {
+    // Values cached with the old time to live are no longer valid
+    auto suffix = "/" + entry;
+    for (auto itr = c.values.begin(); itr != c.values.end();) {
+      auto& path = itr->first;
+      if (path.size() >= suffix.size() &&
+          path.compare(path.size() - suffix.size(), suffix.size(), suffix) == 0)
+        itr = c.values.erase(itr);
+      else
+        ++itr;
+    }
+  }
+}
+
+void
+flush(const std::string& name)
+{
+  auto& c = cache();
+  std::lock_guard<std::mutex> l(c.mutex);
+  c.flush(name.empty() ? c.dev_root() : c.dev_root() + name + "/");
+}
+
+}} // sysfs, pcidev
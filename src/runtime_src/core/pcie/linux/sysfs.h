@@ -0,0 +1,100 @@
+/**
+ * Copyright (C) 2020 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+#ifndef _XCL_PCIE_SYSFS_H_
+#define _XCL_PCIE_SYSFS_H_
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+// sysfs access for pcidev::pci_device
+//
+// Entries are addressed by pci device name (dir name under devices),
+// subdevice name and entry name.  To keep repeated queries cheap:
+//  - the subdevice directory of a device is resolved once
+//  - files are kept open and read with pread, up to a limit
+//  - values of static entries (pci ids, rom info) are cached for their
+//    time to live, see set_ttl()
+// Caching is disabled with Runtime.sysfs_cache=false.  All caches of a
+// device must be flushed when its sysfs nodes are removed (hot reset).
+namespace pcidev { namespace sysfs {
+
+// Root of pci sysfs tree, Runtime.sysfs_root.  Changing it flushes all caches
+std::string
+get_root();
+
+void
+set_root(const std::string& root);
+
+// <root>/devices/ and <root>/drivers/
+std::string
+dev_root();
+
+std::string
+drv_root();
+
+// Empty string if the subdevice is not found
+std::string
+get_path(const std::string& name, const std::string& subdev, const std::string& entry);
+
+void
+get(const std::string& name, const std::string& subdev, const std::string& entry,
+    std::string& err, std::vector<std::string>& sv);
+
+void
+get(const std::string& name, const std::string& subdev, const std::string& entry,
+    std::string& err, std::vector<uint64_t>& iv);
+
+void
+get(const std::string& name, const std::string& subdev, const std::string& entry,
+    std::string& err, std::string& s);
+
+void
+get(const std::string& name, const std::string& subdev, const std::string& entry,
+    std::string& err, std::vector<char>& buf);
+
+// First line of each entry of one subdevice.  errs and values are
+// indexed like entries.
+void
+get_batch(const std::string& name, const std::string& subdev,
+          const std::vector<std::string>& entries,
+          std::vector<std::string>& errs, std::vector<std::string>& values);
+
+void
+put(const std::string& name, const std::string& subdev, const std::string& entry,
+    std::string& err, const std::string& input);
+
+void
+put(const std::string& name, const std::string& subdev, const std::string& entry,
+    std::string& err, const std::vector<char>& buf);
+
+void
+put(const std::string& name, const std::string& subdev, const std::string& entry,
+    std::string& err, const unsigned int& input);
+
+// How long a value read from entry of subdev is served from cache.
+// Zero, the default for entries other than static ones, reads every time.
+void
+set_ttl(const std::string& subdev, const std::string& entry, std::chrono::milliseconds ttl);
+
+// Drop cached paths, values and open files of device name, or of all
+// devices if name is empty
+void
+flush(const std::string& name = "");
+
+}} // sysfs, pcidev
+
+#endif
@@ -26,9 +26,12 @@ namespace xdp {
   bool VPDatabase::live ;
 
   VPDatabase::VPDatabase() :
-    stats(this), staticdb(this), dyndb(this), numDevices(0)
+    stats(this), staticdb(this), dyndb(this), numDevices(0),
+    flushRequested(false), flushStop(false)
   {
     VPDatabase::live = true ;
+    if (dyndb.isBounded())
+      startFlushThread() ;
   }
 
   // The database and all the plugins are singletons and can be
@@ -37,6 +40,10 @@ namespace xdp {
   //  time the library is loaded and removing it if it is destroyed first.
   VPDatabase::~VPDatabase()
   {
+    // No background flush may run while the remaining plugins
+    //  write their final files
+    stopFlushThread() ;
+
     // The only plugins that should still be in this vector are ones
     //  that have not been destroyed yet.
     for (auto p : plugins)
@@ -94,8 +101,69 @@ namespace xdp {
     return true ;
   }
 
+  void VPDatabase::startFlushThread()
+  {
+    flushThread = std::thread([this] { flushLoop() ; }) ;
+  }
+
+  void VPDatabase::stopFlushThread()
+  {
+    {
+      std::lock_guard<std::mutex> lock(flushLock) ;
+      flushStop = true ;
+    }
+    flushCond.notify_one() ;
+    if (flushThread.joinable())
+      flushThread.join() ;
+  }
+
+  void VPDatabase::flushLoop()
+  {
+    std::unique_lock<std::mutex> lock(flushLock) ;
+    while (true)
+    {
+      flushCond.wait(lock, [this] { return flushRequested || flushStop ; }) ;
+      if (flushStop)
+	return ;
+      flushRequested = false ;
+      lock.unlock() ;
+      flushTraces() ;
+      lock.lock() ;
+    }
+  }
+
+  // Requests that arrive after the flush thread has been stopped
+  //  are ignored.  The final write picks up the events instead.
+  void VPDatabase::requestFlush()
+  {
+    {
+      std::lock_guard<std::mutex> lock(flushLock) ;
+      if (flushStop)
+	return ;
+      flushRequested = true ;
+    }
+    flushCond.notify_one() ;
+  }
+
+  void VPDatabase::flushTraces()
+  {
+    std::lock_guard<std::mutex> lock(pluginLock) ;
+
+    dyndb.markFlush() ;
+    for (auto p : plugins)
+    {
+      try {
+	p->flushTraces() ;
+      }
+      catch (...) {
+      }
+    }
+    dyndb.releaseFlushed() ;
+  }
+
   void VPDatabase::broadcast(MessageType msg, void* blob)
   {
+    std::lock_guard<std::mutex> lock(pluginLock) ;
     for (auto p : plugins)
     {
       p->broadcast(msg, blob) ;
@@ -20,6 +20,9 @@
 #include <vector>
 #include <list>
 #include <map>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
 
 #include "xdp/profile/database/statistics_database.h"
 #include "xdp/profile/database/static_info_database.h"
@@ -56,11 +59,25 @@ namespace xdp {
     //  portions of the database are reset and when the database is
     //  destroyed at the end of execution.
     std::list<XDPPlugin*> plugins ;
+    std::mutex pluginLock ;
 
     // A map of Device SysFs Path to Device Id
     std::map<std::string, uint64_t> devices;
     uint64_t numDevices;
 
+    // Bounded memory mode.  The flush thread is started by the
+    //  constructor when Debug.trace_event_limit is set and is joined
+    //  by the destructor before the final files are written.
+    std::thread flushThread ;
+    std::mutex flushLock ;
+    std::condition_variable flushCond ;
+    bool flushRequested ;
+    bool flushStop ;
+
+    void startFlushThread() ;
+    void stopFlushThread() ;
+    void flushLoop() ;
+
   private:
     VPDatabase() ;
 
@@ -76,9 +93,19 @@ namespace xdp {
     inline VPStaticDatabase&     getStaticInfo()  { return staticdb ; }
     inline VPDynamicDatabase&    getDynamicInfo() { return dyndb ; }
 
-    // Functions that plugins call on startup and destruction
-    inline void registerPlugin(XDPPlugin* p)   { plugins.push_back(p) ; }
-    inline void unregisterPlugin(XDPPlugin* p) { plugins.remove(p) ; }
+    // Functions that plugins call on startup and destruction.
+    //  A plugin must unregister before it writes its final files so
+    //  that a background flush cannot use its writers at the same time.
+    inline void registerPlugin(XDPPlugin* p)
+      { std::lock_guard<std::mutex> lock(pluginLock) ; plugins.push_back(p) ; }
+    inline void unregisterPlugin(XDPPlugin* p)
+      { std::lock_guard<std::mutex> lock(pluginLock) ; plugins.remove(p) ; }
+
+    // Bounded memory mode.  requestFlush wakes a background thread
+    //  that calls flushTraces, which has every plugin's trace writers
+    //  write the events currently held and then releases them.
+    XDP_EXPORT void requestFlush() ;
+    XDP_EXPORT void flushTraces() ;
 
     XDP_EXPORT uint64_t addDevice(const std::string&);
     XDP_EXPORT uint64_t getDeviceId(const std::string&);
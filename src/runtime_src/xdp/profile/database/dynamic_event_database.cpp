@@ -20,23 +20,37 @@
 #include "xdp/profile/database/dynamic_event_database.h"
 #include "xdp/profile/database/events/device_events.h"
 
+#include "core/common/config_reader.h"
+#include "core/common/message.h"
+
+#include <algorithm>
 #include <iostream>
+#include <set>
 
 namespace xdp {
+
+  static std::atomic<uint64_t> nextInstanceId(1) ;
   
   VPDynamicDatabase::VPDynamicDatabase(VPDatabase* d) :
-    db(d), eventId(1), stringId(1)
+    db(d), instanceId(nextInstanceId++), eventId(1), stringId(1),
+    eventLimit(xrt_core::config::get_trace_event_limit()),
+    dropNewest(xrt_core::config::get_trace_drop_policy() == "newest"),
+    numEvents(0), numDropped(0), flushPending(false), flushMarked(false)
   {
-    // For low overhead profiling, we will reserve space for 
-    //  a set number of events.  This won't change HAL or OpenCL 
-    //  profiling either.
-    hostEvents.reserve(100);
   }
 
   VPDynamicDatabase::~VPDynamicDatabase()
   {
     std::lock_guard<std::mutex> lock(dbLock) ;
 
+    if (numDropped > 0)
+    {
+      std::string msg = std::to_string(numDropped) +
+	" trace events were dropped because Debug.trace_event_limit was reached" ;
+      xrt_core::message::send(xrt_core::message::severity_level::XRT_WARNING,
+			      "XRT", msg) ;
+    }
+
     for(auto mapEntry : aieTraceData) {
       for(auto info : mapEntry.second) {
         delete info;
@@ -45,29 +59,127 @@ namespace xdp {
     }
     aieTraceData.clear();
 
-    for (auto event : hostEvents) {
-      delete event;
+    // Host events are destroyed along with their thread buffers
+    hostBuffers.clear() ;
+
+    for (auto& device : deviceEvents) {
+      for (auto event : device.second.events) {
+	    delete event;
+      }
+      device.second.events.clear();
+    }
+
+    for (auto event : retiredEvents) {
+      delete event ;
     }
+  }
+
+  HostEventBuffer* VPDynamicDatabase::getThreadBuffer()
+  {
+    // Each thread remembers the last buffer it used and which
+    //  database that buffer belongs to
+    struct ThreadCache
+    {
+      uint64_t owner = 0 ;
+      HostEventBuffer* buffer = nullptr ;
+    } ;
+    static thread_local ThreadCache cache ;
+
+    if (cache.owner == instanceId)
+      return cache.buffer ;
 
-    for (auto device : deviceEvents) {
-      for (auto multimapEntry : device.second) {
-	    delete multimapEntry.second;
+    std::lock_guard<std::mutex> lock(hostBuffersLock) ;
+    HostEventBuffer* buffer = nullptr ;
+    for (auto& b : hostBuffers)
+    {
+      if (b->getOwner() == std::this_thread::get_id())
+      {
+	buffer = b.get() ;
+	break ;
       }
-      device.second.clear();
     }
+    if (buffer == nullptr)
+    {
+      hostBuffers.emplace_back(new HostEventBuffer) ;
+      buffer = hostBuffers.back().get() ;
+    }
+
+    cache.owner = instanceId ;
+    cache.buffer = buffer ;
+    return buffer ;
   }
 
   void VPDynamicDatabase::addHostEvent(VTFEvent* event)
+  {
+    getThreadBuffer()->append(event, false) ;
+  }
+
+  bool VPDynamicDatabase::admitEvent()
+  {
+    uint64_t held = numEvents.load() ;
+    if (held >= eventLimit / 2 && !flushPending.exchange(true))
+      db->requestFlush() ;
+
+    if (dropNewest && held >= eventLimit)
+    {
+      ++numDropped ;
+      return false ;
+    }
+    ++numEvents ;
+    return true ;
+  }
+
+  void VPDynamicDatabase::retireEvent(VTFEvent* event)
   {
     std::lock_guard<std::mutex> lock(dbLock) ;
+    retiredEvents.push_back(event) ;
+  }
+
+  std::vector<VTFEvent*> VPDynamicDatabase::mergeHostEvents()
+  {
+    std::vector<VTFEvent*> events ;
 
-    hostEvents.push_back(event) ;
+    std::lock_guard<std::mutex> lock(hostBuffersLock) ;
+    for (auto& buffer : hostBuffers)
+    {
+      // Each buffer is already in timestamp order, so merge it
+      //  with everything collected so far
+      size_t middle = events.size() ;
+      if (flushMarked)
+      {
+	auto mark = hostMarks.find(buffer.get()) ;
+	if (mark == hostMarks.end())
+	  continue ;
+	buffer->collect(events, mark->second) ;
+      }
+      else
+      {
+	buffer->collect(events) ;
+      }
+      std::inplace_merge(events.begin(), events.begin() + middle,
+			 events.end(), VTFEventSorter()) ;
+    }
+    return events ;
   }
 
   void VPDynamicDatabase::addDeviceEvent(uint64_t deviceId, VTFEvent* event)
   {
     std::lock_guard<std::mutex> lock(dbLock) ;
-    deviceEvents[deviceId].emplace(event->getTimestamp(), event) ;
+    DeviceEventList& list = deviceEvents[deviceId] ;
+    if (!list.events.empty() &&
+	event->getTimestamp() < list.events.back()->getTimestamp())
+      list.sorted = false ;
+    list.events.push_back(event) ;
+  }
+
+  void VPDynamicDatabase::sortDeviceEvents(DeviceEventList& list)
+  {
+    // Stable so that events with equal timestamps stay in the
+    //  order they were added
+    if (list.sorted) return ;
+    std::stable_sort(list.events.begin(), list.events.end(),
+		     VTFEventSorter()) ;
+    list.sorted = true ;
   }
 
   void VPDynamicDatabase::addEvent(VTFEvent* event)
@@ -75,6 +187,14 @@ namespace xdp {
     if (event == nullptr) return ;
     event->setEventId(eventId++) ;
 
+    // The caller may still refer to a dropped event, so it is only
+    //  deleted after the next flush
+    if (eventLimit != 0 && !admitEvent())
+    {
+      retireEvent(event) ;
+      return ;
+    }
+
     if (event->isDeviceEvent())
     {
       addDeviceEvent(event->getDevice(), event) ;
@@ -111,13 +231,13 @@ namespace xdp {
 
   void VPDynamicDatabase::markStart(uint64_t functionID, uint64_t eventID)
   {
-    std::lock_guard<std::mutex> lock(dbLock) ;
+    std::lock_guard<std::mutex> lock(startLock) ;
     startMap[functionID] = eventID ;
   }
 
   uint64_t VPDynamicDatabase::matchingStart(uint64_t functionID)
   {
-    std::lock_guard<std::mutex> lock(dbLock) ;
+    std::lock_guard<std::mutex> lock(startLock) ;
     if (startMap.find(functionID) != startMap.end())
     {
       uint64_t value = startMap[functionID] ;
@@ -129,30 +249,52 @@ namespace xdp {
 
   uint64_t VPDynamicDatabase::addString(const std::string& value)
   {
-    if (stringTable.find(value) == stringTable.end())
+    HostEventBuffer* buffer = getThreadBuffer() ;
+
+    uint64_t id = 0 ;
+    if (buffer->findString(value, id))
+      return id ;
+
     {
-      stringTable[value] = stringId++ ;
+      std::lock_guard<std::mutex> lock(stringLock) ;
+      if (stringTable.find(value) == stringTable.end())
+      {
+	stringTable[value] = stringId++ ;
+      }
+      id = stringTable[value] ;
     }
-    return stringTable[value] ;
+    buffer->cacheString(value, id) ;
+    return id ;
   }
 
   // This needs to be sped up significantly.
   std::vector<VTFEvent*> VPDynamicDatabase::filterEvents(std::function<bool(VTFEvent*)> filter)
   {
-    std::lock_guard<std::mutex> lock(dbLock) ;
     std::vector<VTFEvent*> collected ;
 
     // For now, go through both host events and device events.
-    for (auto e : hostEvents)
+    for (auto e : mergeHostEvents())
     {
       if (filter(e)) collected.push_back(e) ;
     }
 
-    for (auto dev : deviceEvents)
+    std::lock_guard<std::mutex> lock(dbLock) ;
+
+    for (auto& dev : deviceEvents)
     {
-      for (auto multiMapEntry : dev.second)
+      size_t count = dev.second.events.size() ;
+      if (flushMarked)
+      {
+	count = deviceMarks.count(dev.first) ? deviceMarks[dev.first] : 0 ;
+      }
+      else
+      {
+	sortDeviceEvents(dev.second) ;
+      }
+      for (size_t i = 0 ; i < count ; ++i)
       {
-	if (filter(multiMapEntry.second)) collected.push_back(multiMapEntry.second) ;
+	VTFEvent* e = dev.second.events[i] ;
+	if (filter(e)) collected.push_back(e) ;
       }
     }
 
@@ -161,27 +303,97 @@ namespace xdp {
 
   std::vector<VTFEvent*> VPDynamicDatabase::getHostEvents()
   {
-    std::vector<VTFEvent*> events;
-    for(auto e : hostEvents) {
-      events.push_back(e);
-    }
-    return events;
+    return mergeHostEvents() ;
   }
 
   std::vector<VTFEvent*> VPDynamicDatabase::getDeviceEvents(uint64_t deviceId)
   {
+    std::lock_guard<std::mutex> lock(dbLock) ;
     std::vector<VTFEvent*> events;
     if(deviceEvents.find(deviceId) == deviceEvents.end()) {
       return events;
     }
-    for(auto multiMapEntry : deviceEvents[deviceId]) {
-      events.push_back(multiMapEntry.second);
+    DeviceEventList& list = deviceEvents[deviceId] ;
+    size_t count = list.events.size() ;
+    if (flushMarked) {
+      count = deviceMarks.count(deviceId) ? deviceMarks[deviceId] : 0 ;
+    }
+    else {
+      sortDeviceEvents(list) ;
     }
+    events.assign(list.events.begin(), list.events.begin() + count) ;
     return events;
   }
 
+  void VPDynamicDatabase::markFlush()
+  {
+    {
+      std::lock_guard<std::mutex> lock(hostBuffersLock) ;
+      hostMarks.clear() ;
+      for (auto& buffer : hostBuffers)
+	hostMarks[buffer.get()] = buffer->end() ;
+    }
+
+    std::lock_guard<std::mutex> lock(dbLock) ;
+    deviceMarks.clear() ;
+    for (auto& dev : deviceEvents)
+    {
+      // Events added after this point may have earlier timestamps,
+      //  but they are only written in the next flush
+      sortDeviceEvents(dev.second) ;
+      deviceMarks[dev.first] = dev.second.events.size() ;
+    }
+    flushMarked = true ;
+  }
+
+  void VPDynamicDatabase::releaseFlushed()
+  {
+    uint64_t released = 0 ;
+    {
+      std::lock_guard<std::mutex> lock(hostBuffersLock) ;
+      for (auto& mark : hostMarks)
+	released += mark.first->release(mark.second) ;
+      hostMarks.clear() ;
+    }
+
+    std::lock_guard<std::mutex> lock(dbLock) ;
+
+    // Device start events that have not been matched with an end
+    //  event yet are still referenced and must be kept
+    std::set<VTFEvent*> pending ;
+    for (auto& starts : deviceEventStartMap)
+      pending.insert(starts.second.begin(), starts.second.end()) ;
+
+    std::vector<VTFEvent*> retained ;
+    for (auto& mark : deviceMarks)
+    {
+      std::deque<VTFEvent*>& events = deviceEvents[mark.first].events ;
+      for (size_t i = 0 ; i < mark.second ; ++i)
+      {
+	if (pending.count(events[i])) retained.push_back(events[i]) ;
+	else                          delete events[i] ;
+      }
+      events.erase(events.begin(), events.begin() + mark.second) ;
+      released += mark.second ;
+    }
+    deviceMarks.clear() ;
+
+    for (auto e : retiredEvents)
+    {
+      if (pending.count(e)) retained.push_back(e) ;
+      else                  delete e ;
+    }
+    retiredEvents.swap(retained) ;
+
+    flushMarked = false ;
+    numEvents -= released ;
+    flushPending = false ;
+  }
+
   void VPDynamicDatabase::dumpStringTable(std::ofstream& fout)
   {
+    std::lock_guard<std::mutex> lock(stringLock) ;
+
     // Windows compilation fails unless c_str() is used
     for (auto s : stringTable)
     {
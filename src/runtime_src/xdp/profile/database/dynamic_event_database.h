@@ -19,12 +19,16 @@
 
 #include <map>
 #include <list>
+#include <deque>
 #include <mutex>
+#include <atomic>
+#include <memory>
 #include <vector>
 #include <fstream>
 #include <functional>
 
 #include "xdp/profile/database/events/vtf_event.h"
+#include "xdp/profile/database/host_event_buffer.h"
 
 #include "xdp/config.h"
 
@@ -61,16 +65,28 @@ namespace xdp {
     typedef std::map<double, std::string> CounterNames ;
 
   private:
-    // For host events, we are guaranteed that all of the timestamps
-    //  will come in sequential order.  For this, we can use 
-    //  a simple vector.  For low overhead profiling, we can provide
-    //  capability to have this be preallocated.
-    std::vector<VTFEvent*> hostEvents ;
+    // For host events, each thread records into its own buffer and
+    //  the timestamps within one buffer come in sequential order.
+    //  The buffers are merged by timestamp only when the host events
+    //  are read out.
+    std::vector<std::unique_ptr<HostEventBuffer>> hostBuffers ;
+    std::mutex hostBuffersLock ;
+
+    // Distinguishes this database from any other instance in the
+    //  per-thread buffer cache
+    uint64_t instanceId ;
 
     // Every device will have its own set of events.  Since the actual
     //  hardware might shuffle the order of events we have to make sure
-    //  that this set of events is ordered based on timestamp.
-    std::map<uint64_t, std::multimap<double, VTFEvent*>> deviceEvents;
+    //  that this set of events is ordered based on timestamp.  Events
+    //  almost always arrive in order, so they are appended and only
+    //  sorted (stably) when an out of order event was added.
+    struct DeviceEventList
+    {
+      std::deque<VTFEvent*> events ;
+      bool sorted = true ;
+    } ;
+    std::map<uint64_t, DeviceEventList> deviceEvents;
 
     // For all plugins that read counters, we will store that information
     //  here.
@@ -81,11 +97,12 @@ namespace xdp {
 
     // A unique event id for every event added to the database.
     //  It starts with 1 so we can use 0 as an indicator of NULL
-    uint64_t eventId ;
+    std::atomic<uint64_t> eventId ;
 
     // Data structure for matching start events with end events, 
     //  as in API calls.  This will match a function ID to event IDs.
     std::map<uint64_t, uint64_t> startMap ;
+    std::mutex startLock ;
 
     // For device events
     std::map<uint64_t, std::list<VTFEvent*>> deviceEventStartMap;
@@ -96,8 +113,11 @@ namespace xdp {
     // In order to reduce memory overhead, instead of each event holding
     //  strings, each event will instead point to a unique
     //  instance of that string
+    //  Each thread caches the strings it has looked up, so the lock
+    //  is only taken the first time a thread sees a string.
     std::map<std::string, uint64_t> stringTable ;
     uint64_t stringId ;
+    std::mutex stringLock ;
 
     // Since events can be logged from multiple threads simultaneously,
     //  we have to maintain exclusivity
@@ -105,9 +125,42 @@ namespace xdp {
 
     std::map<uint64_t, uint64_t> traceIDMap;
 
+    // Bounded memory mode.  When eventLimit is nonzero, the events
+    //  held in the database are written out and released by a background
+    //  thread once half of the limit is reached.  If dropNewest is set,
+    //  events that arrive while the limit is reached are discarded.
+    uint64_t eventLimit ;
+    bool dropNewest ;
+    std::atomic<uint64_t> numEvents ;
+    std::atomic<uint64_t> numDropped ;
+    std::atomic<bool> flushPending ;
+
+    // While a flush is in progress, readers only see the events that
+    //  were recorded before the flush started.  Those are released
+    //  once the flush has completed.
+    std::atomic<bool> flushMarked ;
+    std::map<HostEventBuffer*, HostEventBuffer::Position> hostMarks ;
+    std::map<uint64_t, size_t> deviceMarks ;
+
+    // Events that were dropped, or released while still registered
+    //  as a device event start, are kept until they can be safely deleted
+    std::vector<VTFEvent*> retiredEvents ;
+
     void addHostEvent(VTFEvent* event) ;
     void addDeviceEvent(uint64_t deviceId, VTFEvent* event) ;
 
+    // Account for a new event in bounded mode.  Returns false if
+    //  the event should be dropped.
+    XDP_EXPORT bool admitEvent() ;
+    void retireEvent(VTFEvent* event) ;
+    void sortDeviceEvents(DeviceEventList& list) ;
+
+    // Get (or create) the calling thread's host event buffer
+    XDP_EXPORT HostEventBuffer* getThreadBuffer() ;
+
+    // All host events from all threads, ordered by timestamp
+    std::vector<VTFEvent*> mergeHostEvents() ;
+
   public:
     XDP_EXPORT VPDynamicDatabase(VPDatabase* d) ;
     XDP_EXPORT ~VPDynamicDatabase() ;
@@ -115,6 +168,30 @@ namespace xdp {
     // Add an event in sorted order in the database
     XDP_EXPORT void addEvent(VTFEvent* event) ;
 
+    // Construct a host event of type T in the calling thread's event
+    //  arena and add it to the database.  This avoids a heap allocation
+    //  and any locking for each recorded event.
+    //  Returns nullptr if the event was dropped in bounded memory mode.
+    template <typename T, typename... Args>
+    T* createHostEvent(Args&&... args)
+    {
+      if (eventLimit != 0 && !admitEvent())
+	return nullptr ;
+      HostEventBuffer* buffer = getThreadBuffer() ;
+      T* event = buffer->create<T>(std::forward<Args>(args)...) ;
+      event->setEventId(eventId++) ;
+      buffer->append(event, true) ;
+      return event ;
+    }
+
+    // Bounded memory mode.  A flush first marks the events currently
+    //  in the database, then has the writers write them out, and then
+    //  releases the marked events.
+    inline bool isBounded() const { return eventLimit != 0 ; }
+    XDP_EXPORT void markFlush() ;
+    XDP_EXPORT void releaseFlushed() ;
+    inline uint64_t getNumDropped() const { return numDropped ; }
+
     // For API events, find the event id of the start event for an end event
     XDP_EXPORT void markStart(uint64_t functionID, uint64_t eventID) ;
     XDP_EXPORT uint64_t matchingStart(uint64_t functionID) ;
@@ -39,17 +39,22 @@ namespace xdp {
   }
 
   void DeviceEventCreatorFromTrace::createDeviceEvents(xclTraceResultsVector& traceVector)
+  {
+    createDeviceEvents(traceVector.mArray, traceVector.mLength);
+  }
+
+  void DeviceEventCreatorFromTrace::createDeviceEvents(const xclTraceResults* samples, uint64_t count)
   {
     // Create Device Events and log them : do what is done in TraceParser::logTrace
-    if(traceVector.mLength == 0)
+    if(count == 0)
       return;
 
     if(!VPDatabase::alive()) {
       return;
     }
     uint64_t timestamp = 0;
-    for(unsigned int i=0; i < traceVector.mLength; i++) {
-      auto& trace = traceVector.mArray[i];
+    for(uint64_t i=0; i < count; i++) {
+      auto& trace = samples[i];
       
       timestamp = trace.Timestamp;
 
@@ -89,6 +94,7 @@ namespace xdp {
             if(cuStarts[s].empty()) {
               continue;
             }
+            logComputeUnitExecution(cuId, cuStarts[s].front().deviceTimestamp, timestamp);
             cuStarts[s].pop_front();
             event = new KernelEvent(e->getEventId(), hostTimestamp, KERNEL, deviceId, s, cuId);
             event->setDeviceTimestamp(timestamp);
@@ -99,7 +105,7 @@ namespace xdp {
             event->setDeviceTimestamp(timestamp);
             db->getDynamicInfo().addEvent(event);
             db->getDynamicInfo().markDeviceEventStart(trace.TraceID, event);
-            cuStarts[s].push_back(event);
+            cuStarts[s].push_back({event->getEventId(), timestamp});
             if(1 == cuStarts[s].size()) {
               traceIDs[s] = 0;	// When current CU starts, reset stall status
             }
@@ -283,7 +289,7 @@ namespace xdp {
       // start end must have created already
       // check if the memory ports on current cu has any event
 
-      VTFDeviceEvent* cuStartEvent = cuStarts[amIndex].front();
+      uint64_t cuStartId = cuStarts[amIndex].front().eventId;
       uint64_t cuLastTimestamp  = amLastTrans[amIndex];
 
       // get CU Id for the current slot
@@ -331,16 +337,29 @@ namespace xdp {
       }
       // Warning : "Incomplete CU profile trace detected. Timeline trace will have approximate CU End."
 
-      // end event
+      // end event.  The end is approximate, so the execution is not
+      // included in the compute unit latency statistics.
       cuStarts[amIndex].pop_front();
       
       double hostTimestamp = convertDeviceToHostTimestamp(cuLastTimestamp);
-      KernelEvent* event = new KernelEvent(cuStartEvent->getEventId(), hostTimestamp, KERNEL, deviceId, amIndex, cuId);
+      KernelEvent* event = new KernelEvent(cuStartId, hostTimestamp, KERNEL, deviceId, amIndex, cuId);
       event->setDeviceTimestamp(cuLastTimestamp);
       db->getDynamicInfo().addEvent(event); 
     }
   }
 
+  // Record the execution time of a compute unit, in ns, in the
+  // statistics database for the summary
+  void DeviceEventCreatorFromTrace::logComputeUnitExecution(int32_t cuId, uint64_t startTimestamp, uint64_t endTimestamp)
+  {
+    ComputeUnitInstance* cu = db->getStaticInfo().getCU(deviceId, cuId);
+    if(!cu || endTimestamp < startTimestamp) {
+      return;
+    }
+    double executionTime = clockTrainSlope * (double)(endTimestamp - startTimestamp);
+    db->getStats().logComputeUnitExecution(cu->getName(), executionTime);
+  }
+
   // Complete training to convert device timestamp to host time domain
   // NOTE: see description of PTP @ http://en.wikipedia.org/wiki/Precision_Time_Protocol
   // clock training relation is linear within small durations (1 sec)
@@ -31,7 +31,12 @@ class DeviceEventCreatorFromTrace
   VPDatabase* db = nullptr;
 
   std::vector<uint64_t>  traceIDs;
-  std::vector<std::list<VTFDeviceEvent*>> cuStarts;
+  // Kernel starts not yet matched with an end
+  struct CUStart {
+    uint64_t eventId;
+    uint64_t deviceTimestamp;
+  };
+  std::vector<std::list<CUStart>> cuStarts;
 
   // Last Transactions
   std::vector<uint64_t> amLastTrans;
@@ -53,6 +58,7 @@ class DeviceEventCreatorFromTrace
   double clockTrainSlope;
 
   void trainDeviceHostTimestamps(uint64_t deviceTimestamp, uint64_t hostTimestamp);
+  void logComputeUnitExecution(int32_t cuId, uint64_t startTimestamp, uint64_t endTimestamp);
   double convertDeviceToHostTimestamp(uint64_t deviceTimestamp);
 
   public :
@@ -60,6 +66,8 @@ class DeviceEventCreatorFromTrace
   virtual ~DeviceEventCreatorFromTrace() {}
 
   XDP_EXPORT void createDeviceEvents(xclTraceResultsVector& traceVector);
+  // Samples decoded straight from the trace buffer, in device order
+  XDP_EXPORT void createDeviceEvents(const xclTraceResults* samples, uint64_t count);
   XDP_EXPORT void end();
 };
 
@@ -36,6 +36,11 @@ void TraceLoggerCreatingDeviceEvents::processTraceData(xclTraceResultsVector& tr
   deviceEventCreator->createDeviceEvents(traceVector);
 }
 
+void TraceLoggerCreatingDeviceEvents::processTraceSamples(const xclTraceResults* samples, uint64_t count)
+{
+  deviceEventCreator->createDeviceEvents(samples, count);
+}
+
 void TraceLoggerCreatingDeviceEvents::endProcessTraceData(xclTraceResultsVector& traceVector)
 {
   (void)traceVector;
@@ -37,6 +37,8 @@ public:
   XDP_EXPORT
   virtual void processTraceData(xclTraceResultsVector& traceVector); 
   XDP_EXPORT
+  virtual void processTraceSamples(const xclTraceResults* samples, uint64_t count);
+  XDP_EXPORT
   virtual void endProcessTraceData(xclTraceResultsVector& traceVector); 
 };
 
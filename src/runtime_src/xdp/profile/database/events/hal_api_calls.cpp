@@ -35,6 +35,11 @@ namespace xdp {
     fout << "," << functionName << std::endl ;
   }
 
+  void HALAPICall::getTraceFields(TraceFields& fields)
+  {
+    fields.add(functionName) ;
+  }
+
   AllocBoCall::AllocBoCall(uint64_t s_id, double ts, uint64_t name) 
              : HALAPICall(s_id, ts, name)
   {
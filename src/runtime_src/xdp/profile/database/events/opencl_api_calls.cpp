@@ -37,4 +37,9 @@ namespace xdp {
     fout << "," << functionName << std::endl ;
   }
 
+  void OpenCLAPICall::getTraceFields(TraceFields& fields)
+  {
+    fields.add(functionName) ;
+  }
+
 } // end namespace xdp
@@ -38,6 +38,7 @@ namespace xdp {
     virtual bool isOpenCLAPI() { return true ; }
     virtual bool isOpenCLHostEvent() { return true ; }
     XDP_EXPORT virtual void dump(std::ofstream& fout, uint32_t bucket) ;
+    XDP_EXPORT virtual void getTraceFields(TraceFields& fields) ;
   } ;
 
 } // end namespace xdp
@@ -14,6 +14,9 @@
  * under the License.
  */
 
+#include <algorithm>
+#include <cstring>
+
 #define XDP_SOURCE
 
 #include "xdp/profile/database/events/opencl_host_events.h"
@@ -93,6 +96,11 @@ namespace xdp {
     fout << std::endl;
   }
 
+  void BufferTransfer::getTraceFields(TraceFields& fields)
+  {
+    if (0 == start_id) fields.add(size) ;
+  }
+
   LOPBufferTransfer::LOPBufferTransfer(uint64_t s_id, double ts, 
 				       VTFEventType ty) :
     VTFEvent(s_id, ts, ty), threadId(std::this_thread::get_id())
@@ -110,6 +118,15 @@ namespace xdp {
     fout << "," << std::hex << "0x" << threadId << std::dec << std::endl ;
   }
 
+  void LOPBufferTransfer::getTraceFields(TraceFields& fields)
+  {
+    // std::thread::id prints as the native thread handle, which is
+    //  the value it holds
+    uint64_t tid = 0 ;
+    std::memcpy(&tid, &threadId, std::min(sizeof(tid), sizeof(threadId))) ;
+    fields.add(tid, true) ;
+  }
+
   StreamRead::StreamRead(uint64_t s_id, double ts) :
     VTFEvent(s_id, ts, STREAM_READ)
   {
@@ -114,6 +114,7 @@ namespace xdp {
     virtual bool isHostEvent() { return true ; } 
 
     XDP_EXPORT virtual void dump(std::ofstream& fout, uint32_t bucket) ;
+    XDP_EXPORT virtual void getTraceFields(TraceFields& fields) ;
   } ;
 
   class LOPBufferTransfer : public VTFEvent
@@ -128,6 +129,7 @@ namespace xdp {
     virtual bool isLOPHostEvent() { return true ; }
 
     XDP_EXPORT virtual void dump(std::ofstream& fout, uint32_t bucket) ;
+    XDP_EXPORT virtual void getTraceFields(TraceFields& fields) ;
   } ;
 
   class StreamRead : public VTFEvent
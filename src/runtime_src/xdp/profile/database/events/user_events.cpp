@@ -40,6 +40,11 @@ namespace xdp {
     fout << std::endl ;
   }
 
+  void UserMarker::getTraceFields(TraceFields& fields)
+  {
+    if (label != 0) fields.add(label) ;
+  }
+
   UserRange::UserRange(uint64_t s_id, double ts, bool s, 
 		       uint64_t l, uint64_t tt) :
     VTFEvent(s_id, ts, USER_RANGE), isStart(s), label(l), tooltip(tt)
@@ -61,4 +66,13 @@ namespace xdp {
     fout << std::endl ;
   }
 
+  void UserRange::getTraceFields(TraceFields& fields)
+  {
+    if (isStart)
+    {
+      fields.add(label) ;
+      fields.add(tooltip) ;
+    }
+  }
+
 } // end namespace xdp
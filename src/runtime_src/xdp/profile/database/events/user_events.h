@@ -40,6 +40,7 @@ namespace xdp {
     XDP_EXPORT ~UserMarker() ;
 
     XDP_EXPORT virtual void dump(std::ofstream& fout, uint32_t bucket) ;
+    XDP_EXPORT virtual void getTraceFields(TraceFields& fields) ;
   } ;
 
   class UserRange : public VTFEvent
@@ -60,6 +61,7 @@ namespace xdp {
     XDP_EXPORT ~UserRange() ;
 
     XDP_EXPORT virtual void dump(std::ofstream& fout, uint32_t bucket) ;
+    XDP_EXPORT virtual void getTraceFields(TraceFields& fields) ;
   } ;
 
 } // end namespace xdp
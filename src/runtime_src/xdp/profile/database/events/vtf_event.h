@@ -70,6 +70,26 @@ namespace xdp {
     HAL_API_CALL         = 51,
   } ;
 
+  // The values that follow the common columns of an event's trace
+  //  line.  Used by the binary trace format, which stores these as
+  //  columns instead of formatting them.
+  struct TraceFields
+  {
+    static const unsigned int MAX_FIELDS = 4 ;
+
+    uint64_t values[MAX_FIELDS] ;
+    unsigned int count ;
+    unsigned int hexMask ; // Bit i set if field i is printed as 0x<hex>
+
+    TraceFields() : count(0), hexMask(0) { }
+    inline void add(uint64_t value, bool hex = false)
+    {
+      if (count == MAX_FIELDS) return ;
+      if (hex) hexMask |= (1u << count) ;
+      values[count++] = value ;
+    }
+  } ;
+
   class VTFEvent
   {
   private:
@@ -92,6 +112,7 @@ namespace xdp {
     // Getters and Setters
     inline double       getTimestamp()   const { return timestamp ; }
     inline uint64_t     getEventId()           { return id ; } 
+    inline uint64_t     getStartId()           { return start_id ; }
     inline void         setEventId(uint64_t i) { id = i ; }
     inline VTFEventType getEventType()         { return type; }
 
@@ -121,6 +142,11 @@ namespace xdp {
 
     virtual uint64_t getDevice() { return 0 ; } // CHECK
     XDP_EXPORT virtual void dump(std::ofstream& fout, uint32_t bucket) ;
+
+    // The fields dump() prints after the type, in the same order
+    XDP_EXPORT virtual void getTraceFields(TraceFields& fields) ;
+
+    XDP_EXPORT static const char* getTypeName(VTFEventType ty) ;
   } ;
 
   // Used so the database can sort based on timestamp order
@@ -0,0 +1,173 @@
+/**
+ * Copyright (C) 2020 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#define XDP_SOURCE
+
+#include "xdp/profile/database/host_event_buffer.h"
+
+#include <cstdint>
+
+namespace xdp {
+
+  EventArena::EventArena() : current(nullptr), remaining(0)
+  {
+  }
+
+  EventArena::~EventArena()
+  {
+    for (auto block : blocks)
+      delete [] block ;
+  }
+
+  void* EventArena::allocate(size_t size, size_t alignment)
+  {
+    uintptr_t address = reinterpret_cast<uintptr_t>(current) ;
+    size_t padding = (alignment - (address % alignment)) % alignment ;
+
+    if (current == nullptr || (size + padding) > remaining)
+    {
+      // Start a new block.  Blocks come from new[] and are
+      //  suitably aligned for any event type.
+      size_t blockSize = (size > BLOCK_SIZE) ? size : BLOCK_SIZE ;
+      current = new char[blockSize] ;
+      remaining = blockSize ;
+      padding = 0 ;
+      blocks.push_back(current) ;
+    }
+
+    char* result = current + padding ;
+    current = result + size ;
+    remaining -= (size + padding) ;
+    return result ;
+  }
+
+  HostEventBuffer::HostEventBuffer() :
+    owner(std::this_thread::get_id()), head(nullptr), headIndex(0),
+    tail(nullptr)
+  {
+  }
+
+  HostEventBuffer::~HostEventBuffer()
+  {
+    release(end()) ;
+    delete head.load() ;
+  }
+
+  void HostEventBuffer::reserve()
+  {
+    if (tail == nullptr)
+    {
+      tail = new Chunk ;
+      head.store(tail, std::memory_order_release) ;
+    }
+    else if (tail->count.load(std::memory_order_relaxed) == CHUNK_SIZE)
+    {
+      Chunk* chunk = new Chunk ;
+      tail->next.store(chunk, std::memory_order_release) ;
+      tail = chunk ;
+    }
+  }
+
+  void HostEventBuffer::append(VTFEvent* event, bool inArena)
+  {
+    reserve() ;
+
+    size_t index = tail->count.load(std::memory_order_relaxed) ;
+    tail->entries[index].event = event ;
+    tail->entries[index].inArena = inArena ;
+    tail->count.store(index + 1, std::memory_order_release) ;
+  }
+
+  HostEventBuffer::Position HostEventBuffer::end() const
+  {
+    Position position = { head.load(std::memory_order_acquire), 0 } ;
+    if (position.chunk == nullptr)
+      return position ;
+
+    Chunk* next = nullptr ;
+    while ((next = position.chunk->next.load(std::memory_order_acquire)) != nullptr)
+      position.chunk = next ;
+    position.index = position.chunk->count.load(std::memory_order_acquire) ;
+    return position ;
+  }
+
+  void HostEventBuffer::collect(std::vector<VTFEvent*>& events,
+				const Position& limit) const
+  {
+    if (limit.chunk == nullptr)
+      return ;
+
+    size_t first = headIndex ;
+    for (Chunk* chunk = head.load(std::memory_order_acquire) ;
+	 chunk != nullptr ;
+	 chunk = chunk->next.load(std::memory_order_acquire))
+    {
+      size_t last = (chunk == limit.chunk) ? limit.index :
+	chunk->count.load(std::memory_order_acquire) ;
+      for (size_t i = first ; i < last ; ++i)
+	events.push_back(chunk->entries[i].event) ;
+      if (chunk == limit.chunk)
+	break ;
+      first = 0 ;
+    }
+  }
+
+  size_t HostEventBuffer::release(const Position& limit)
+  {
+    size_t released = 0 ;
+    if (limit.chunk == nullptr)
+      return released ;
+
+    Chunk* chunk = head.load(std::memory_order_acquire) ;
+    while (chunk != nullptr)
+    {
+      size_t last = (chunk == limit.chunk) ? limit.index :
+	chunk->count.load(std::memory_order_acquire) ;
+      for (size_t i = headIndex ; i < last ; ++i)
+      {
+	Entry& entry = chunk->entries[i] ;
+	if (entry.inArena)
+	  entry.event->~VTFEvent() ;
+	else
+	  delete entry.event ;
+      }
+      released += (last - headIndex) ;
+      headIndex = last ;
+
+      // The owner may still be appending to the last chunk,
+      //  so it is never freed here
+      Chunk* next = chunk->next.load(std::memory_order_acquire) ;
+      if (chunk == limit.chunk || next == nullptr)
+	break ;
+
+      delete chunk ;
+      chunk = next ;
+      headIndex = 0 ;
+      head.store(chunk, std::memory_order_release) ;
+    }
+    return released ;
+  }
+
+  bool HostEventBuffer::findString(const std::string& value, uint64_t& id) const
+  {
+    auto iter = stringCache.find(value) ;
+    if (iter == stringCache.end())
+      return false ;
+    id = iter->second ;
+    return true ;
+  }
+
+}
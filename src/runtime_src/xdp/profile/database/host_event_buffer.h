@@ -0,0 +1,155 @@
+/**
+ * Copyright (C) 2020 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef HOST_EVENT_BUFFER_DOT_H
+#define HOST_EVENT_BUFFER_DOT_H
+
+#include <atomic>
+#include <cstddef>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "xdp/profile/database/events/vtf_event.h"
+
+#include "xdp/config.h"
+
+namespace xdp {
+
+  // A simple bump allocator.  Memory is only returned when the
+  //  arena itself is destroyed, and the arena never runs destructors
+  //  for the objects allocated in it.
+  class EventArena
+  {
+  private:
+    static const size_t BLOCK_SIZE = 64 * 1024 ;
+
+    std::vector<char*> blocks ;
+    char* current ;
+    size_t remaining ;
+
+  public:
+    XDP_EXPORT EventArena() ;
+    XDP_EXPORT ~EventArena() ;
+
+    XDP_EXPORT void* allocate(size_t size, size_t alignment) ;
+  } ;
+
+  // All host events logged by one thread.  Only the owning thread
+  //  appends to the buffer, so no lock is taken when recording an event.
+  //  Other threads may read the buffer concurrently; the number of
+  //  valid entries in each chunk is published with release semantics
+  //  after the entry is written.
+  //
+  //  Events are stored in fixed size chunks, each with its own arena,
+  //  so that events that have already been written out can be released
+  //  a chunk at a time.  Reading and releasing must be serialized by
+  //  the caller.
+  class HostEventBuffer
+  {
+  private:
+    static const size_t CHUNK_SIZE = 1024 ;
+
+    struct Entry
+    {
+      VTFEvent* event ;
+      bool inArena ;
+    } ;
+
+    struct Chunk
+    {
+      Entry entries[CHUNK_SIZE] ;
+      std::atomic<size_t> count ;
+      std::atomic<Chunk*> next ;
+      EventArena arena ;
+
+      Chunk() : count(0), next(nullptr) { }
+    } ;
+
+  public:
+    // A point in the sequence of recorded events
+    struct Position
+    {
+      Chunk* chunk ;
+      size_t index ;
+    } ;
+
+  private:
+    std::thread::id owner ;
+
+    // The oldest chunk that still holds unreleased events, and the
+    //  index of the first unreleased event in it
+    std::atomic<Chunk*> head ;
+    size_t headIndex ;
+
+    // The chunk currently being appended to.  Only used by the owner.
+    Chunk* tail ;
+
+    // Make sure the tail chunk has room for one more event
+    XDP_EXPORT void reserve() ;
+
+    // Strings this thread has already looked up in the database's
+    //  string table, so repeated lookups do not take the table lock
+    std::unordered_map<std::string, uint64_t> stringCache ;
+
+  public:
+    XDP_EXPORT HostEventBuffer() ;
+
+    // Destroys all of the events recorded in this buffer
+    XDP_EXPORT ~HostEventBuffer() ;
+
+    inline std::thread::id getOwner() const { return owner ; }
+
+    // Record an event.  Must only be called by the owning thread.
+    XDP_EXPORT void append(VTFEvent* event, bool inArena) ;
+
+    // Construct an event of type T in this buffer's arena.  The event
+    //  must be passed to append() with inArena set.
+    template <typename T, typename... Args>
+    T* create(Args&&... args)
+    {
+      reserve() ;
+      void* mem = tail->arena.allocate(sizeof(T), alignof(T)) ;
+      return new (mem) T(std::forward<Args>(args)...) ;
+    }
+
+    // The position just past the last event recorded so far.
+    //  Can be called from any thread.
+    XDP_EXPORT Position end() const ;
+
+    // Copy out all unreleased events recorded before the given
+    //  position, in the order they were recorded.
+    XDP_EXPORT void collect(std::vector<VTFEvent*>& events,
+			    const Position& limit) const ;
+    inline void collect(std::vector<VTFEvent*>& events) const
+      { collect(events, end()) ; }
+
+    // Destroy all unreleased events recorded before the given position
+    //  and free any chunks that are no longer needed.  Returns the
+    //  number of events released.
+    XDP_EXPORT size_t release(const Position& limit) ;
+
+    // Per-thread string lookups.  Must only be called by the owning thread.
+    XDP_EXPORT bool findString(const std::string& value, uint64_t& id) const ;
+    inline void cacheString(const std::string& value, uint64_t id)
+      { stringCache[value] = id ; }
+  } ;
+
+}
+
+#endif
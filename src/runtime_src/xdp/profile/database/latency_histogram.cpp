@@ -0,0 +1,168 @@
+/**
+ * Copyright (C) 2020 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#define XDP_SOURCE
+
+#include "xdp/profile/database/latency_histogram.h"
+
+#include <limits>
+
+namespace xdp {
+
+  static unsigned int mostSignificantBit(uint64_t value)
+  {
+    unsigned int bit = 0 ;
+    while (value >>= 1)
+      ++bit ;
+    return bit ;
+  }
+
+  unsigned int LatencyHistogram::bucketIndex(uint64_t value)
+  {
+    // Values smaller than two full octaves of sub-buckets map 1:1
+    if (value < (2 * SUB_BUCKETS))
+      return static_cast<unsigned int>(value) ;
+
+    unsigned int msb = mostSignificantBit(value) ;
+    if (msb >= MAX_BITS)
+      return NUM_BUCKETS - 1 ;
+
+    unsigned int shift = msb - SUB_BUCKET_BITS ;
+    return (shift + 1) * SUB_BUCKETS +
+      static_cast<unsigned int>((value >> shift) - SUB_BUCKETS) ;
+  }
+
+  uint64_t LatencyHistogram::bucketLowerBound(unsigned int index)
+  {
+    if (index < (2 * SUB_BUCKETS))
+      return index ;
+
+    unsigned int shift = (index / SUB_BUCKETS) - 1 ;
+    uint64_t subBucket = (index % SUB_BUCKETS) + SUB_BUCKETS ;
+    return subBucket << shift ;
+  }
+
+  uint64_t LatencyHistogram::bucketWidth(unsigned int index)
+  {
+    if (index < (2 * SUB_BUCKETS))
+      return 1 ;
+    return static_cast<uint64_t>(1) << ((index / SUB_BUCKETS) - 1) ;
+  }
+
+  LatencyHistogram::LatencyHistogram() :
+    buckets(NUM_BUCKETS, 0), count(0), sum(0),
+    minValue((std::numeric_limits<uint64_t>::max)()), maxValue(0)
+  {
+  }
+
+  void LatencyHistogram::record(uint64_t value)
+  {
+    ++buckets[bucketIndex(value)] ;
+    ++count ;
+    sum += value ;
+    if (value < minValue) minValue = value ;
+    if (value > maxValue) maxValue = value ;
+  }
+
+  void LatencyHistogram::merge(const LatencyHistogram& other)
+  {
+    for (unsigned int i = 0 ; i < NUM_BUCKETS ; ++i)
+      buckets[i] += other.buckets[i] ;
+    count += other.count ;
+    sum += other.sum ;
+    if (other.minValue < minValue) minValue = other.minValue ;
+    if (other.maxValue > maxValue) maxValue = other.maxValue ;
+  }
+
+  uint64_t LatencyHistogram::getPercentile(double fraction) const
+  {
+    if (count == 0)
+      return 0 ;
+
+    if (fraction < 0.0) fraction = 0.0 ;
+    if (fraction > 1.0) fraction = 1.0 ;
+
+    // The rank of the requested value, 1 based
+    uint64_t rank = static_cast<uint64_t>(fraction * count + 0.5) ;
+    if (rank == 0) rank = 1 ;
+    if (rank > count) rank = count ;
+
+    // The extremes are known exactly
+    if (rank == 1)     return minValue ;
+    if (rank == count) return maxValue ;
+
+    uint64_t seen = 0 ;
+    for (unsigned int i = 0 ; i < NUM_BUCKETS ; ++i)
+    {
+      seen += buckets[i] ;
+      if (seen < rank)
+        continue ;
+
+      uint64_t value = bucketLowerBound(i) + (bucketWidth(i) - 1) / 2 ;
+      if (value < minValue) value = minValue ;
+      if (value > maxValue) value = maxValue ;
+      return value ;
+    }
+    return maxValue ;
+  }
+
+  ConcurrentLatencyHistogram::ConcurrentLatencyHistogram() :
+    sum(0), minValue((std::numeric_limits<uint64_t>::max)()), maxValue(0)
+  {
+    for (auto& b : buckets)
+      b.store(0, std::memory_order_relaxed) ;
+  }
+
+  void ConcurrentLatencyHistogram::record(uint64_t value)
+  {
+    // Only the owning thread writes, so a load and store is enough
+    //  and avoids a locked instruction per update
+    sum.store(sum.load(std::memory_order_relaxed) + value,
+              std::memory_order_relaxed) ;
+    if (value < minValue.load(std::memory_order_relaxed))
+      minValue.store(value, std::memory_order_relaxed) ;
+    if (value > maxValue.load(std::memory_order_relaxed))
+      maxValue.store(value, std::memory_order_relaxed) ;
+    auto& bucket = buckets[LatencyHistogram::bucketIndex(value)] ;
+    bucket.store(bucket.load(std::memory_order_relaxed) + 1,
+                 std::memory_order_relaxed) ;
+  }
+
+  void ConcurrentLatencyHistogram::addTo(LatencyHistogram& merged) const
+  {
+    // Recompute the count from the buckets so that the merged
+    //  histogram stays self consistent even if a value is being
+    //  recorded while we read
+    uint64_t total = 0 ;
+    for (unsigned int i = 0 ; i < LatencyHistogram::NUM_BUCKETS ; ++i)
+    {
+      uint64_t b = buckets[i].load(std::memory_order_relaxed) ;
+      merged.buckets[i] += b ;
+      total += b ;
+    }
+    if (total == 0)
+      return ;
+
+    merged.count += total ;
+    merged.sum += sum.load(std::memory_order_relaxed) ;
+
+    uint64_t mn = minValue.load(std::memory_order_relaxed) ;
+    uint64_t mx = maxValue.load(std::memory_order_relaxed) ;
+    if (mn < merged.minValue) merged.minValue = mn ;
+    if (mx > merged.maxValue) merged.maxValue = mx ;
+  }
+
+} // end namespace xdp
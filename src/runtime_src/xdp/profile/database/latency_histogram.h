@@ -0,0 +1,100 @@
+/**
+ * Copyright (C) 2020 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef LATENCY_HISTOGRAM_DOT_H
+#define LATENCY_HISTOGRAM_DOT_H
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "xdp/config.h"
+
+namespace xdp {
+
+  // A fixed size histogram of durations with logarithmic buckets.
+  //  Every power of two range is split into 2^SUB_BUCKET_BITS linear
+  //  sub-buckets, so any recorded value is known to within 1/16th of
+  //  its magnitude regardless of how many values were recorded.
+  //  Values are in nanoseconds; anything longer than 2^MAX_BITS ns
+  //  (about 18 minutes) is counted in the last bucket.
+  //
+  //  This is the merged form used when statistics are reported.
+  class LatencyHistogram
+  {
+  public:
+    static const unsigned int SUB_BUCKET_BITS = 4 ;
+    static const unsigned int SUB_BUCKETS = 1u << SUB_BUCKET_BITS ;
+    static const unsigned int MAX_BITS = 40 ;
+    static const unsigned int NUM_BUCKETS =
+      (MAX_BITS - SUB_BUCKET_BITS + 1) * SUB_BUCKETS ;
+
+    XDP_EXPORT static unsigned int bucketIndex(uint64_t value) ;
+    XDP_EXPORT static uint64_t bucketLowerBound(unsigned int index) ;
+    XDP_EXPORT static uint64_t bucketWidth(unsigned int index) ;
+
+  private:
+    std::vector<uint64_t> buckets ;
+    uint64_t count ;
+    uint64_t sum ;
+    uint64_t minValue ;
+    uint64_t maxValue ;
+
+    friend class ConcurrentLatencyHistogram ;
+
+  public:
+    XDP_EXPORT LatencyHistogram() ;
+
+    XDP_EXPORT void record(uint64_t value) ;
+    XDP_EXPORT void merge(const LatencyHistogram& other) ;
+
+    inline uint64_t getCount() const { return count ; }
+    inline uint64_t getSum()   const { return sum ; }
+    inline uint64_t getMin()   const { return count == 0 ? 0 : minValue ; }
+    inline uint64_t getMax()   const { return maxValue ; }
+    inline double   getMean()  const
+      { return count == 0 ? 0.0 : static_cast<double>(sum) / count ; }
+
+    // The value below which the given fraction (0.0 - 1.0) of the
+    //  recorded values fall, reported as the midpoint of its bucket
+    //  and clamped to the observed minimum and maximum.
+    XDP_EXPORT uint64_t getPercentile(double fraction) const ;
+  } ;
+
+  // The recording side of a LatencyHistogram.  There must be exactly
+  //  one thread calling record(), which uses relaxed atomic stores and
+  //  no read-modify-write operations.  Any number of threads may call
+  //  addTo() concurrently to fold the current contents into a merged
+  //  histogram; they see a consistent enough view for reporting, but
+  //  values being recorded at the same time may be partially included.
+  class ConcurrentLatencyHistogram
+  {
+  private:
+    std::atomic<uint64_t> buckets[LatencyHistogram::NUM_BUCKETS] ;
+    std::atomic<uint64_t> sum ;
+    std::atomic<uint64_t> minValue ;
+    std::atomic<uint64_t> maxValue ;
+
+  public:
+    XDP_EXPORT ConcurrentLatencyHistogram() ;
+
+    XDP_EXPORT void record(uint64_t value) ;
+    XDP_EXPORT void addTo(LatencyHistogram& merged) const ;
+  } ;
+
+} // end namespace xdp
+
+#endif
@@ -14,17 +14,23 @@
  * under the License.
  */
 
+#include <atomic>
 #include <vector>
 #include <thread>
 
 #define XDP_SOURCE
 
 #include "xdp/profile/database/statistics_database.h"
+#include "core/common/config_reader.h"
 
 namespace xdp {
 
+  static std::atomic<uint64_t> nextInstanceId(1) ;
+
   VPStatisticsDatabase::VPStatisticsDatabase(VPDatabase* d) :
-    db(d), firstKernelStartTime(0.0)
+    db(d), instanceId(nextInstanceId++),
+    keepAllCalls(xrt_core::config::get_statistics_mode() == "full"),
+    firstKernelStartTime(0.0)
   {
   }
 
@@ -32,9 +38,71 @@ namespace xdp {
   {
   }
 
+  ThreadStatistics* VPStatisticsDatabase::getThreadStatistics()
+  {
+    // Each thread remembers the last accumulator it used and which
+    //  database that accumulator belongs to
+    struct ThreadCache
+    {
+      uint64_t owner = 0 ;
+      ThreadStatistics* stats = nullptr ;
+    } ;
+    static thread_local ThreadCache cache ;
+
+    if (cache.owner == instanceId)
+      return cache.stats ;
+
+    std::lock_guard<std::mutex> lock(threadStatsLock) ;
+    ThreadStatistics* stats = nullptr ;
+    for (auto& s : threadStats)
+    {
+      if (s->owner == std::this_thread::get_id())
+      {
+	stats = s.get() ;
+	break ;
+      }
+    }
+    if (stats == nullptr)
+    {
+      threadStats.emplace_back(new ThreadStatistics) ;
+      stats = threadStats.back().get() ;
+    }
+
+    cache.owner = instanceId ;
+    cache.stats = stats ;
+    return stats ;
+  }
+
+  ConcurrentLatencyHistogram*
+  VPStatisticsDatabase::getHistogram(ThreadStatistics* stats,
+				     std::unordered_map<std::string,
+				       std::unique_ptr<ConcurrentLatencyHistogram>>& table,
+				     const std::string& name)
+  {
+    // The owner is the only thread that modifies the table, so it
+    //  can look up existing entries without the lock
+    auto iter = table.find(name) ;
+    if (iter != table.end())
+      return iter->second.get() ;
+
+    std::unique_ptr<ConcurrentLatencyHistogram>
+      histogram(new ConcurrentLatencyHistogram) ;
+    ConcurrentLatencyHistogram* result = histogram.get() ;
+
+    std::lock_guard<std::mutex> lock(stats->structureLock) ;
+    table.emplace(name, std::move(histogram)) ;
+    return result ;
+  }
+
   void VPStatisticsDatabase::logFunctionCallStart(const std::string& name,
 						   double timestamp)
   {
+    ThreadStatistics* stats = getThreadStatistics() ;
+    stats->pendingStarts[name].push_back(timestamp) ;
+
+    if (!keepAllCalls)
+      return ;
+
     std::lock_guard<std::mutex> lock(dbLock) ;
 
     auto threadId = std::this_thread::get_id() ;
@@ -56,6 +124,21 @@ namespace xdp {
   void VPStatisticsDatabase::logFunctionCallEnd(const std::string& name,
 						 double timestamp)
   {
+    ThreadStatistics* stats = getThreadStatistics() ;
+    auto pending = stats->pendingStarts.find(name) ;
+    if (pending != stats->pendingStarts.end() && !pending->second.empty())
+    {
+      double start = pending->second.back() ;
+      pending->second.pop_back() ;
+
+      double duration = timestamp - start ;
+      getHistogram(stats, stats->apiCalls, name)
+	->record(duration > 0 ? static_cast<uint64_t>(duration + 0.5) : 0) ;
+    }
+
+    if (!keepAllCalls)
+      return ;
+
     std::lock_guard<std::mutex> lock(dbLock) ;
 
     auto threadId = std::this_thread::get_id() ;
@@ -91,9 +174,40 @@ namespace xdp {
     (kernelExecutionStats[kernelName]).update(executionTime) ;
   }
 
-  void VPStatisticsDatabase::logComputeUnitExecution(const std::string& /*computeUnitName*/, 
-						      double /*executionTime*/)
+  void VPStatisticsDatabase::logComputeUnitExecution(const std::string& computeUnitName, 
+						      double executionTime)
   {
+    ThreadStatistics* stats = getThreadStatistics() ;
+    getHistogram(stats, stats->computeUnits, computeUnitName)
+      ->record(executionTime > 0 ? static_cast<uint64_t>(executionTime + 0.5) : 0) ;
+  }
+
+  std::map<std::string, LatencyHistogram>
+  VPStatisticsDatabase::mergeHistograms(bool computeUnits)
+  {
+    std::map<std::string, LatencyHistogram> merged ;
+
+    std::lock_guard<std::mutex> lock(threadStatsLock) ;
+    for (auto& stats : threadStats)
+    {
+      std::lock_guard<std::mutex> structure(stats->structureLock) ;
+      auto& table = computeUnits ? stats->computeUnits : stats->apiCalls ;
+      for (auto& entry : table)
+	entry.second->addTo(merged[entry.first]) ;
+    }
+    return merged ;
+  }
+
+  std::map<std::string, LatencyHistogram>
+  VPStatisticsDatabase::getCallLatencies()
+  {
+    return mergeHistograms(false) ;
+  }
+
+  std::map<std::string, LatencyHistogram>
+  VPStatisticsDatabase::getComputeUnitLatencies()
+  {
+    return mergeHistograms(true) ;
   }
 
   void VPStatisticsDatabase::updateCounters(uint64_t /*deviceId*/,
@@ -115,26 +229,41 @@ namespace xdp {
   {
     // For each function call, across all of the threads, find out
     //  the number of calls
-    std::map<std::string, uint64_t> counts ;
-
-    for (auto c : callCount)
+    for (auto& i : getCallLatencies())
     {
-      if (counts.find(c.first.first) == counts.end())
-      {
-	counts[c.first.first] = c.second.size() ;
-      }
-      else
-      {
-	counts[c.first.first] += c.second.size() ;
-      }
+      fout << i.first << "," << i.second.getCount() << std::endl ;
     }
+  }
 
-    for (auto i : counts)
+  // Each line is name,count,min,mean,max,p50,p99,p999 with all times
+  //  in nanoseconds
+  static void dumpLatencies(std::ofstream& fout,
+			    const std::map<std::string, LatencyHistogram>& latencies)
+  {
+    for (auto& i : latencies)
     {
-      fout << i.first << "," << i.second << std::endl ;
+      const LatencyHistogram& h = i.second ;
+      fout << i.first << ","
+	   << h.getCount() << ","
+	   << h.getMin() << ","
+	   << h.getMean() << ","
+	   << h.getMax() << ","
+	   << h.getPercentile(0.5) << ","
+	   << h.getPercentile(0.99) << ","
+	   << h.getPercentile(0.999) << std::endl ;
     }
   }
 
+  void VPStatisticsDatabase::dumpCallLatencies(std::ofstream& fout)
+  {
+    dumpLatencies(fout, getCallLatencies()) ;
+  }
+
+  void VPStatisticsDatabase::dumpComputeUnitLatencies(std::ofstream& fout)
+  {
+    dumpLatencies(fout, getComputeUnitLatencies()) ;
+  }
+
   void VPStatisticsDatabase::dumpHALMemory(std::ofstream& fout)
   {
     unsigned int i = 0 ; 
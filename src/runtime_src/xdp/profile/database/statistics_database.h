@@ -21,12 +21,15 @@
 #include <mutex>
 #include <thread>
 #include <map>
+#include <memory>
+#include <unordered_map>
 #include <vector>
 #include <fstream>
 
 // For the device results structures
 #include "xclperf.h"
 
+#include "xdp/profile/database/latency_histogram.h"
 #include "xdp/config.h"
 
 namespace xdp {
@@ -81,16 +84,60 @@ namespace xdp {
     MemoryChannelStatistics channels[6] ;
   } ;
 
+  // Latency statistics recorded by a single thread.  Only the owning
+  //  thread records into the histograms, so logging a call takes no
+  //  lock and no shared cache line.  The lock only guards the maps
+  //  themselves and is taken by the owner when it sees a new name and
+  //  by whoever merges the statistics for a report.
+  struct ThreadStatistics
+  {
+    std::thread::id owner ;
+    std::mutex structureLock ;
+
+    std::unordered_map<std::string,
+                       std::unique_ptr<ConcurrentLatencyHistogram>> apiCalls ;
+    std::unordered_map<std::string,
+                       std::unique_ptr<ConcurrentLatencyHistogram>> computeUnits ;
+
+    // Start times of calls that have not ended yet.  Only touched by
+    //  the owning thread.
+    std::unordered_map<std::string, std::vector<double>> pendingStarts ;
+
+    ThreadStatistics() : owner(std::this_thread::get_id()) { }
+  } ;
+
   class VPStatisticsDatabase 
   {
   private:
     VPDatabase* db ;
 
+    // Distinguishes this database from any other instance in the
+    //  per-thread statistics cache
+    uint64_t instanceId ;
+
+    // In full mode every call's start and end time is kept in
+    //  callCount as well as the histograms
+    bool keepAllCalls ;
+
   private:
     // Statistics on API calls (OpenCL and HAL) have to be thread specific
     std::map<std::pair<std::string, std::thread::id>,
              std::vector<std::pair<double, double>>> callCount ;
 
+    // Streaming latency statistics, one accumulator per thread that
+    //  has logged anything.  Merged when a summary is written.
+    std::vector<std::unique_ptr<ThreadStatistics>> threadStats ;
+    std::mutex threadStatsLock ;
+
+    ThreadStatistics* getThreadStatistics() ;
+    ConcurrentLatencyHistogram*
+    getHistogram(ThreadStatistics* stats,
+                 std::unordered_map<std::string,
+                   std::unique_ptr<ConcurrentLatencyHistogram>>& table,
+                 const std::string& name) ;
+    std::map<std::string, LatencyHistogram>
+    mergeHistograms(bool computeUnits) ;
+
     // For HAL, each device will have four different read/write
     //  channels that need to be kept track of.
     std::map<uint64_t, DeviceMemoryStatistics> memoryStats ;
@@ -123,7 +170,12 @@ namespace xdp {
     inline const std::map<std::string, TimeStatistics>& getComputeUnitExecutionStats() 
       { return computeUnitExecutionStats ; }
 
-    // Logging Functions
+    // Latency statistics merged across all threads, in nanoseconds
+    XDP_EXPORT std::map<std::string, LatencyHistogram> getCallLatencies() ;
+    XDP_EXPORT std::map<std::string, LatencyHistogram> getComputeUnitLatencies() ;
+
+    // Logging Functions.  Timestamps and execution times are in
+    //  nanoseconds.
     XDP_EXPORT void logFunctionCallStart(const std::string& name, 
 					 double timestamp) ;
     XDP_EXPORT void logFunctionCallEnd(const std::string& name, 
@@ -147,6 +199,8 @@ namespace xdp {
 
     // Helper functions for printing out summary information temporarily
     XDP_EXPORT void dumpCallCount(std::ofstream& fout) ;
+    XDP_EXPORT void dumpCallLatencies(std::ofstream& fout) ;
+    XDP_EXPORT void dumpComputeUnitLatencies(std::ofstream& fout) ;
     XDP_EXPORT void dumpHALMemory(std::ofstream& fout) ;    
   } ;
 }
@@ -65,6 +65,7 @@ public:
      * IP should support word packing if we want to support 512 bit words
      */
     virtual void parseTraceBuf(void* /*buf*/, uint64_t /*size*/, xclTraceResultsVector& /*traceVector*/) {}
+    uint64_t parseTraceBuf(void* /*buf*/, uint64_t /*size*/, const TracePacketDecoder::SampleSink& /*sink*/) { return 0; }
 };
 
 } //  xdp
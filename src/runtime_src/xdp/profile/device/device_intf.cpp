@@ -954,6 +954,14 @@ DeviceIntf::~DeviceIntf()
     }
   }
 
+  // Parse a trace buffer of any size, streaming samples to sink
+  uint64_t DeviceIntf::parseTraceData(void* traceData, uint64_t bytes, const TracePacketDecoder::SampleSink& sink)
+  {
+    if(!mPlTraceDma)
+      return 0;
+    return mPlTraceDma->parseTraceBuf(traceData, bytes, sink);
+  }
+
   // Reset AIE trace data movers
   void DeviceIntf::resetAIETs2mm(uint64_t index)
   {
@@ -148,6 +148,8 @@ class DeviceIntf {
     uint8_t  getTS2MmMemIndex();
     XDP_EXPORT
     void parseTraceData(void* traceData, uint64_t bytes, xclTraceResultsVector& traceVector);
+    XDP_EXPORT
+    uint64_t parseTraceData(void* traceData, uint64_t bytes, const TracePacketDecoder::SampleSink& sink);
 
     XDP_EXPORT
     void resetAIETs2mm(uint64_t index);
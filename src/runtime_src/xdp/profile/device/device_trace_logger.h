@@ -29,6 +29,8 @@ public:
   virtual ~DeviceTraceLogger() {}
 
   virtual void processTraceData(xclTraceResultsVector& traceVector) = 0; 
+  // Samples decoded in place from a trace buffer, in batches of any size
+  virtual void processTraceSamples(const xclTraceResults* samples, uint64_t count) = 0;
   virtual void endProcessTraceData(xclTraceResultsVector& traceVector) = 0; 
 };
 
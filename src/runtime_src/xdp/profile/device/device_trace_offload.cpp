@@ -188,8 +188,6 @@ void DeviceTraceOffload::read_trace_s2mm()
   config_s2mm_reader(dev_intf->getWordCountTs2mm());
   while (1) {
     auto bytes = read_trace_s2mm_partial();
-    deviceTraceLogger->processTraceData(m_trace_vector);
-    m_trace_vector = {};
 
     if (m_trbuf_sz == m_trbuf_alloc_sz && m_use_circ_buf == false)
       m_trbuf_full = true;
@@ -222,7 +220,11 @@ uint64_t DeviceTraceOffload::read_trace_s2mm_partial()
     << " µs" << std::endl;
 
   if (host_buf) {
-    dev_intf->parseTraceData(host_buf, nBytes, m_trace_vector);
+    // Decode in place, handing samples to the logger as they are produced
+    dev_intf->parseTraceData(host_buf, nBytes,
+      [this](const xclTraceResults* samples, uint64_t count) {
+        deviceTraceLogger->processTraceSamples(samples, count);
+      });
     m_trbuf_offset += nBytes;
     return nBytes;
   }
@@ -115,8 +115,9 @@ private:
 
 protected:
     bool m_initialized = false;
-    // Default dma chunk size
-    uint64_t m_trbuf_chunk_sz = MAX_TRACE_NUMBER_SAMPLES * TRACE_PACKET_SIZE;
+    // Default dma chunk size.  Samples are streamed to the logger, so
+    // this is only bounded by how much we want to sync at a time.
+    uint64_t m_trbuf_chunk_sz = TS2MM_DEF_BUF_SIZE;
     bool m_debug = false; /* Enable Output stream for log */
 
 private:
@@ -89,10 +89,7 @@ void IOCtlTraceS2MM::reset()
 
   ioctl(driver_FD, TR_S2MM_IOC_RESET);
 
-  mPacketFirstTs = 0;
-  mPartialTs = 0;
-  mModulus = 0;
-  mclockTrainingdone = false;
+  mDecoder.reset();
 }
 
 uint64_t IOCtlTraceS2MM::getWordCount()
@@ -18,6 +18,8 @@
 
 #include "xdp/profile/core/rt_profile.h"
 #include "xdp/profile/device/ocl_device_logger/profile_mngr_trace_logger.h"
+
+#include <algorithm>
  
 namespace xdp {
 
@@ -26,7 +28,8 @@ TraceLoggerUsingProfileMngr::TraceLoggerUsingProfileMngr(RTProfile* profMgr,
         : DeviceTraceLogger(),
           profileMngr(profMgr),
           deviceName(devName),
-          binaryName(binary)
+          binaryName(binary),
+          sampleVector(new xclTraceResultsVector())
 {
 }
 
@@ -38,6 +41,18 @@ void TraceLoggerUsingProfileMngr::processTraceData(xclTraceResultsVector& traceV
   profileMngr->logDeviceTrace(deviceName, binaryName, XCL_PERF_MON_MEMORY, traceVector, false);
 }
 
+void TraceLoggerUsingProfileMngr::processTraceSamples(const xclTraceResults* samples, uint64_t count)
+{
+  while (count > 0) {
+    uint64_t n = std::min<uint64_t>(count, MAX_TRACE_NUMBER_SAMPLES);
+    std::copy(samples, samples + n, sampleVector->mArray);
+    sampleVector->mLength = static_cast<unsigned int>(n);
+    profileMngr->logDeviceTrace(deviceName, binaryName, XCL_PERF_MON_MEMORY, *sampleVector, false);
+    samples += n;
+    count -= n;
+  }
+}
+
 void TraceLoggerUsingProfileMngr::endProcessTraceData(xclTraceResultsVector& traceVector)
 {
   profileMngr->logDeviceTrace(deviceName, binaryName, XCL_PERF_MON_MEMORY, traceVector, true);
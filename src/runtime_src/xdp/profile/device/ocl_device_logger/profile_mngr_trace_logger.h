@@ -17,6 +17,9 @@
 #ifndef _XDP_PROFILE_DEVICE_TRACE_LOGGER_USING_PROFILE_MNGR_H
 #define _XDP_PROFILE_DEVICE_TRACE_LOGGER_USING_PROFILE_MNGR_H
 
+#include <memory>
+#include <string>
+
 #include "xdp/config.h"
 #include "xdp/profile/device/device_trace_logger.h"
 
@@ -29,6 +32,8 @@ class TraceLoggerUsingProfileMngr : public DeviceTraceLogger
   RTProfile* profileMngr;
   std::string deviceName;
   std::string binaryName;
+  // ProfileMngr only accepts the fixed size vector
+  std::unique_ptr<xclTraceResultsVector> sampleVector;
 
 public:
 
@@ -40,6 +45,8 @@ public:
   XDP_EXPORT
   virtual void processTraceData(xclTraceResultsVector& traceVector);
   XDP_EXPORT
+  virtual void processTraceSamples(const xclTraceResults* samples, uint64_t count);
+  XDP_EXPORT
   virtual void endProcessTraceData(xclTraceResultsVector& traceVector);
 
   const std::string& getDeviceName() { return deviceName; } 
@@ -17,7 +17,6 @@
 #include "traceS2MM.h"
 #include "tracedefs.h"
 //#include "xdp/profile/core/rt_util.h"
-#include <bitset>
 #include <iomanip>
 
 namespace xdp {
@@ -89,10 +88,7 @@ void TraceS2MM::reset()
     // Fin Sw Reset
     write32(TS2MM_RST, 0x0);
 
-    mPacketFirstTs = 0;
-    mPartialTs = 0;
-    mModulus = 0;
-    mclockTrainingdone = false;
+    mDecoder.reset();
 }
 
 uint64_t TraceS2MM::getWordCount()
@@ -145,145 +141,22 @@ void TraceS2MM::showStatus()
     (*outputStream) << "INFO circular buf: " << reg_read << std::dec << std::endl;
 }
 
-inline void TraceS2MM::parsePacketClockTrain(uint64_t packet, uint64_t firstTimestamp, uint32_t mod, xclTraceResults &result)
-{
-    if (out_stream)
-        (*out_stream) << " TraceS2MM::parsePacketClockTrain " << std::endl;
-
-    uint64_t tsmask = 0x1FFFFFFFFFFF;
-    if (mod == 0) {
-      uint64_t timestamp = packet & tsmask;
-      if (timestamp >= firstTimestamp)
-        result.Timestamp = timestamp - firstTimestamp;
-      else
-        result.Timestamp = timestamp + (tsmask - firstTimestamp);
-      result.isClockTrain = 1 ;
-    }
-
-    mPartialTs = mPartialTs | (((packet >> 45) & 0xFFFF) << (16 * mod));
-
-    if (mod == 3) {
-      result.HostTimestamp = mPartialTs;
-      mPartialTs = 0;
-
-      if (out_stream) {
-        (*out_stream) << std::hex << "Clock Training sample : "
-        << result.HostTimestamp << " " << result.Timestamp
-        << std::dec << std::endl;
-      }
-    }
-}
-
-void TraceS2MM::parsePacket(uint64_t packet, uint64_t firstTimestamp, xclTraceResults &result)
+void TraceS2MM::parseTraceBuf(void* buf, uint64_t size, xclTraceResultsVector& traceVector)
 {
     if(out_stream)
-        (*out_stream) << " TraceS2MM::parsePacket " << std::endl;
-
-    result.Timestamp = (packet & 0x1FFFFFFFFFFF) - firstTimestamp;
-    result.EventType = ((packet >> 45) & 0xF) ? XCL_PERF_MON_END_EVENT :
-        XCL_PERF_MON_START_EVENT;
-    result.TraceID = (packet >> 49) & 0xFFF;
-    result.Reserved = (packet >> 61) & 0x1;
-    result.Overflow = (packet >> 62) & 0x1;
-    result.EventID = XCL_PERF_MON_HW_EVENT;
-    result.EventFlags = ((packet >> 45) & 0xF) | ((packet >> 57) & 0x10);
-    //result.isClockTrain = false;
-    result.isClockTrain = 0 ;
-    if (out_stream) {
-      static uint64_t previousTimestamp = 0;
-      auto packet_dec = std::bitset<64>(packet).to_string();
-      (*out_stream) << std::dec << std::setw(5)
-        << "  Trace sample " << ": "
-        <<  packet_dec.substr(0,19) << " : " << packet_dec.substr(19) << std::endl
-        << " Timestamp : " << result.Timestamp << "   "
-        << "Type : " << result.EventType << "   "
-        << "ID : " << result.TraceID << "   "
-        << "Pulse : " << static_cast<int>(result.Reserved) << "   "
-        << "Overflow : " << static_cast<int>(result.Overflow) << "   "
-        << "Flags : " << static_cast<int>(result.EventFlags) << "   "
-        << "Interval : " << result.Timestamp - previousTimestamp << "   "
-        << std::endl;
-        previousTimestamp = result.Timestamp;
-    }
-}
-
-uint64_t TraceS2MM::seekClockTraining(uint64_t* arr, uint64_t count)
-{
-  if(out_stream)
-      (*out_stream) << " TraceS2MM::seekClockTraining " << std::endl;
-
-  uint64_t n = 8;
-  if (mTraceFormat < 1  || mclockTrainingdone)
-    return 0;
-  if (count < n)
-    return count;
+        (*out_stream) << " TraceS2MM::parseTraceBuf " << std::endl;
 
-  count -= n;
-  for (uint64_t i=0; i <= count; i++) {
-    for (uint64_t j=i; j < i + n; j++) {
-      if (!((arr[j] >> 63) & 0x1))
-        break;
-      if (j == i+n-1)
-        return i;
-    }
-  }
-  return count;
+    mDecoder.setOutputStream(out_stream);
+    mDecoder.decode(static_cast<uint64_t*>(buf), size / TRACE_PACKET_SIZE, traceVector);
 }
 
-void TraceS2MM::parseTraceBuf(void* buf, uint64_t size, xclTraceResultsVector& traceVector)
+uint64_t TraceS2MM::parseTraceBuf(void* buf, uint64_t size, const TracePacketDecoder::SampleSink& sink)
 {
     if(out_stream)
         (*out_stream) << " TraceS2MM::parseTraceBuf " << std::endl;
 
-    uint32_t packetSizeBytes = 8;
-    uint32_t tvindex = 0;
-    traceVector.mLength = 0;
-
-    uint64_t count = size / packetSizeBytes;
-    if (count > MAX_TRACE_NUMBER_SAMPLES) {
-      count = MAX_TRACE_NUMBER_SAMPLES;
-    }
-    auto pos = static_cast<uint64_t*>(buf);
-
-    /*
-    * Seek until we find 8 clock training packets
-    * Everything before that is leftover garbage
-    * data from previous runs.
-    * This scenario occurs when trace buffer gets full.
-    */
-    uint64_t idx = seekClockTraining(pos, count);
-    // All data is garbage
-    if (idx == count)
-      return;
-
-    for (auto i = idx; i < count; i++) {
-      auto currentPacket = pos[i];
-      if (!currentPacket)
-        return;
-      // Poor man's reset
-      if (i == 0 && !mPacketFirstTs)
-        mPacketFirstTs = currentPacket & 0x1FFFFFFFFFFF;
-
-      bool isClockTrain = false;
-      if (mTraceFormat == 1) {
-        isClockTrain = ((currentPacket >> 63) & 0x1);
-      } else {
-        isClockTrain = (i < 8 && !mclockTrainingdone);
-      }
-
-      if (isClockTrain) {
-        parsePacketClockTrain(currentPacket, mPacketFirstTs, mModulus, traceVector.mArray[tvindex]);
-        tvindex  = (mModulus == 3) ? tvindex + 1 : tvindex;
-        mModulus = (mModulus == 3) ? 0 : mModulus+ 1;
-      }
-      else {
-        parsePacket(currentPacket, mPacketFirstTs, traceVector.mArray[tvindex++]);
-      }
-
-
-      traceVector.mLength = tvindex;
-    } // For i < count
-    mclockTrainingdone = true;
+    mDecoder.setOutputStream(out_stream);
+    return mDecoder.decode(static_cast<uint64_t*>(buf), size / TRACE_PACKET_SIZE, sink);
 }
 
 }   // namespace xdp
@@ -20,6 +20,7 @@
 
 #include <stdexcept>
 #include "profile_ip_access.h"
+#include "trace_packet_decoder.h"
 
 namespace xdp {
 
@@ -71,28 +72,24 @@ public:
     virtual void showProperties();
     virtual uint32_t getProperties() { return properties; }
     void parseTraceBuf(void* buf, uint64_t size, xclTraceResultsVector& traceVector);
+    /**
+     * Decode the whole buffer, passing samples to sink as they are
+     * decoded.  Returns the number of samples produced.
+     */
+    uint64_t parseTraceBuf(void* buf, uint64_t size, const TracePacketDecoder::SampleSink& sink);
 
-    void setTraceFormat(uint32_t tf) { mTraceFormat = tf; }
+    void setTraceFormat(uint32_t tf) { mDecoder.setTraceFormat(tf); }
     bool supportsCircBuf() { return major_version >= 1 && minor_version > 0;}
 
 private:
     uint8_t properties;
     uint8_t major_version;
     uint8_t minor_version;
-    uint32_t mTraceFormat = 0;
 
     void write32(uint64_t offset, uint32_t val);
 
 protected:
-    void parsePacketClockTrain(uint64_t packet, uint64_t firstTimestamp, uint32_t mod, xclTraceResults &result);
-    void parsePacket(uint64_t packet, uint64_t firstTimestamp, xclTraceResults &result);
-    uint64_t seekClockTraining(uint64_t* arr, uint64_t count);
-
-protected:
-    uint64_t mPacketFirstTs = 0;
-    bool mclockTrainingdone = false;
-    uint32_t mModulus = 0;
-    uint64_t mPartialTs = 0;
+    TracePacketDecoder mDecoder;
 };
 
 } //  xdp
@@ -0,0 +1,292 @@
+/**
+ * Copyright (C) 2020 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#define XDP_SOURCE
+
+#include "trace_packet_decoder.h"
+
+#include <algorithm>
+#include <bitset>
+#include <cstring>
+#include <iomanip>
+
+#if defined(__SSE2__) && !defined(XDP_TRACE_DECODE_NO_SIMD)
+#include <emmintrin.h>
+#define XDP_TRACE_DECODE_SSE2
+#endif
+
+namespace xdp {
+
+static const uint64_t TS_MASK = 0x1FFFFFFFFFFF;
+
+TracePacketDecoder::TracePacketDecoder()
+{
+    std::memset(&mClockTrainSample, 0, sizeof(mClockTrainSample));
+}
+
+void TracePacketDecoder::reset()
+{
+    mPacketFirstTs = 0;
+    mPartialTs = 0;
+    mModulus = 0;
+    mclockTrainingdone = false;
+    mBatchLength = 0;
+    std::memset(&mClockTrainSample, 0, sizeof(mClockTrainSample));
+}
+
+void TracePacketDecoder::flush(const SampleSink& sink)
+{
+    if (mBatchLength == 0)
+      return;
+    sink(mBatch, mBatchLength);
+    mProduced += mBatchLength;
+    mBatchLength = 0;
+}
+
+bool TracePacketDecoder::parsePacketClockTrain(uint64_t packet)
+{
+    if (mModulus == 0) {
+      std::memset(&mClockTrainSample, 0, sizeof(mClockTrainSample));
+      uint64_t timestamp = packet & TS_MASK;
+      if (timestamp >= mPacketFirstTs)
+        mClockTrainSample.Timestamp = timestamp - mPacketFirstTs;
+      else
+        mClockTrainSample.Timestamp = timestamp + (TS_MASK - mPacketFirstTs);
+      mClockTrainSample.isClockTrain = 1;
+    }
+
+    mPartialTs = mPartialTs | (((packet >> 45) & 0xFFFF) << (16 * mModulus));
+
+    if (mModulus != 3) {
+      ++mModulus;
+      return false;
+    }
+
+    mClockTrainSample.HostTimestamp = mPartialTs;
+    mPartialTs = 0;
+    mModulus = 0;
+
+    if (out_stream) {
+      (*out_stream) << std::hex << "Clock Training sample : "
+      << mClockTrainSample.HostTimestamp << " " << mClockTrainSample.Timestamp
+      << std::dec << std::endl;
+    }
+    return true;
+}
+
+inline void TracePacketDecoder::parsePacket(uint64_t packet, xclTraceResults& result)
+{
+    result.Timestamp = (packet & TS_MASK) - mPacketFirstTs;
+    result.EventType = ((packet >> 45) & 0xF) ? XCL_PERF_MON_END_EVENT :
+        XCL_PERF_MON_START_EVENT;
+    result.TraceID = (packet >> 49) & 0xFFF;
+    result.Reserved = (packet >> 61) & 0x1;
+    result.Overflow = (packet >> 62) & 0x1;
+    result.EventID = XCL_PERF_MON_HW_EVENT;
+    result.EventFlags = ((packet >> 45) & 0xF) | ((packet >> 57) & 0x10);
+    result.isClockTrain = 0;
+    result.Error = 0;
+    result.HostTimestamp = 0;
+    result.WriteAddrLen = 0;
+    result.ReadAddrLen = 0;
+    result.WriteBytes = 0;
+    result.ReadBytes = 0;
+}
+
+uint64_t TracePacketDecoder::seekClockTraining(const uint64_t* arr, uint64_t count)
+{
+  uint64_t n = 8;
+  if (mTraceFormat < 1  || mclockTrainingdone)
+    return 0;
+  if (count < n)
+    return count;
+
+  count -= n;
+  for (uint64_t i=0; i <= count; i++) {
+    for (uint64_t j=i; j < i + n; j++) {
+      if (!((arr[j] >> 63) & 0x1))
+        break;
+      if (j == i+n-1)
+        return i;
+    }
+  }
+  return count;
+}
+
+/*
+ * Decode ordinary event packets straight into the batch until an empty
+ * packet or, in trace format 1, a clock training packet.  The caller
+ * guarantees the batch has room for count samples.
+ */
+uint64_t TracePacketDecoder::decodeRun(const uint64_t* packets, uint64_t count)
+{
+    xclTraceResults* out = mBatch + mBatchLength;
+    const bool stopOnClockTrain = (mTraceFormat == 1);
+    uint64_t i = 0;
+
+#ifdef XDP_TRACE_DECODE_SSE2
+    // Two packets per step: the stop conditions are tested with one
+    // compare and movemask, and all fields are extracted with 64 bit
+    // lane shifts before being scattered into the samples
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i tsMask = _mm_set1_epi64x(static_cast<long long>(TS_MASK));
+    const __m128i firstTs = _mm_set1_epi64x(static_cast<long long>(mPacketFirstTs));
+    const __m128i flagMask = _mm_set1_epi64x(0xF);
+    const __m128i idMask = _mm_set1_epi64x(0xFFF);
+    const __m128i bitMask = _mm_set1_epi64x(0x3);
+    const __m128i flag4Mask = _mm_set1_epi64x(0x10);
+
+    for (; i + 2 <= count; i += 2) {
+      __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(packets + i));
+      // A packet is empty if both of its 32 bit halves are zero
+      int zeros = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(v, zero)));
+      int stop = ((zeros & 0x3) == 0x3) || ((zeros & 0xC) == 0xC);
+      // Bit 63 of each packet is the sign bit of its double lane
+      if (stopOnClockTrain)
+        stop |= _mm_movemask_pd(_mm_castsi128_pd(v));
+      if (stop)
+        break;
+
+      __m128i flags = _mm_and_si128(_mm_srli_epi64(v, 45), flagMask);
+      alignas(16) uint64_t ts[2], ef[2], id[2], bits[2];
+      _mm_store_si128(reinterpret_cast<__m128i*>(ts),
+                      _mm_sub_epi64(_mm_and_si128(v, tsMask), firstTs));
+      _mm_store_si128(reinterpret_cast<__m128i*>(ef),
+                      _mm_or_si128(flags, _mm_and_si128(_mm_srli_epi64(v, 57), flag4Mask)));
+      _mm_store_si128(reinterpret_cast<__m128i*>(id),
+                      _mm_and_si128(_mm_srli_epi64(v, 49), idMask));
+      _mm_store_si128(reinterpret_cast<__m128i*>(bits),
+                      _mm_and_si128(_mm_srli_epi64(v, 61), bitMask));
+
+      for (int k = 0; k < 2; ++k) {
+        auto& result = out[i + k];
+        result.Timestamp = ts[k];
+        result.EventType = (ef[k] & 0xF) ? XCL_PERF_MON_END_EVENT : XCL_PERF_MON_START_EVENT;
+        result.TraceID = static_cast<unsigned int>(id[k]);
+        result.Reserved = static_cast<unsigned char>(bits[k] & 0x1);
+        result.Overflow = static_cast<unsigned char>(bits[k] >> 1);
+        result.EventID = XCL_PERF_MON_HW_EVENT;
+        result.EventFlags = static_cast<unsigned char>(ef[k]);
+        result.isClockTrain = 0;
+        result.Error = 0;
+        result.HostTimestamp = 0;
+        result.WriteAddrLen = 0;
+        result.ReadAddrLen = 0;
+        result.WriteBytes = 0;
+        result.ReadBytes = 0;
+      }
+    }
+#endif
+
+    for (; i < count; ++i) {
+      uint64_t packet = packets[i];
+      if (!packet || (stopOnClockTrain && ((packet >> 63) & 0x1)))
+        break;
+      parsePacket(packet, out[i]);
+    }
+
+    mBatchLength += i;
+    return i;
+}
+
+uint64_t TracePacketDecoder::decode(const uint64_t* packets, uint64_t count, const SampleSink& sink)
+{
+    mProduced = 0;
+
+    /*
+    * Seek until we find 8 clock training packets
+    * Everything before that is leftover garbage
+    * data from previous runs.
+    * This scenario occurs when trace buffer gets full.
+    */
+    uint64_t idx = seekClockTraining(packets, count);
+    // All data is garbage
+    if (idx == count)
+      return 0;
+
+    for (auto i = idx; i < count; ) {
+      // Once the first timestamp is known and we are past the leading
+      // clock training of format 0, ordinary packets come in long runs
+      bool firstTsKnown = (mPacketFirstTs != 0);
+      bool positional = (mTraceFormat != 1 && i < 8 && !mclockTrainingdone);
+      if (firstTsKnown && !positional && !out_stream) {
+        if (mBatchLength == BATCH_SAMPLES)
+          flush(sink);
+        auto n = decodeRun(packets + i, std::min(count - i, BATCH_SAMPLES - mBatchLength));
+        i += n;
+        if (n || i == count)
+          continue;
+      }
+
+      auto currentPacket = packets[i];
+      if (!currentPacket) {
+        flush(sink);
+        return mProduced;
+      }
+      // Timestamps are relative to the first packet after the leftover
+      // data, whichever buffer it arrives in
+      if (!mPacketFirstTs)
+        mPacketFirstTs = currentPacket & TS_MASK;
+
+      bool isClockTrain = false;
+      if (mTraceFormat == 1) {
+        isClockTrain = ((currentPacket >> 63) & 0x1);
+      } else {
+        isClockTrain = (i < 8 && !mclockTrainingdone);
+      }
+
+      if (isClockTrain) {
+        if (parsePacketClockTrain(currentPacket))
+          nextSample(sink) = mClockTrainSample;
+      }
+      else {
+        auto& result = nextSample(sink);
+        parsePacket(currentPacket, result);
+        if (out_stream) {
+          auto packet_dec = std::bitset<64>(currentPacket).to_string();
+          (*out_stream) << std::dec << std::setw(5)
+            << "  Trace sample " << ": "
+            <<  packet_dec.substr(0,19) << " : " << packet_dec.substr(19) << std::endl
+            << " Timestamp : " << result.Timestamp << "   "
+            << "Type : " << result.EventType << "   "
+            << "ID : " << result.TraceID << "   "
+            << "Pulse : " << static_cast<int>(result.Reserved) << "   "
+            << "Overflow : " << static_cast<int>(result.Overflow) << "   "
+            << "Flags : " << static_cast<int>(result.EventFlags) << "   "
+            << std::endl;
+        }
+      }
+      ++i;
+    }
+    mclockTrainingdone = true;
+    flush(sink);
+    return mProduced;
+}
+
+void TracePacketDecoder::decode(const uint64_t* packets, uint64_t count, xclTraceResultsVector& traceVector)
+{
+    traceVector.mLength = 0;
+    if (count > MAX_TRACE_NUMBER_SAMPLES)
+      count = MAX_TRACE_NUMBER_SAMPLES;
+
+    // Every sample takes at least one packet, so the vector cannot overflow
+    decode(packets, count, [&traceVector](const xclTraceResults* samples, uint64_t n) {
+      std::copy(samples, samples + n, traceVector.mArray + traceVector.mLength);
+      traceVector.mLength += static_cast<unsigned int>(n);
+    });
+}
+
+} //  xdp
@@ -0,0 +1,113 @@
+/**
+ * Copyright (C) 2020 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef XDP_PROFILE_DEVICE_TRACE_PACKET_DECODER_H
+#define XDP_PROFILE_DEVICE_TRACE_PACKET_DECODER_H
+
+#include <cstdint>
+#include <functional>
+#include <ostream>
+
+#include "core/include/xclperf.h"
+#include "xdp/config.h"
+
+namespace xdp {
+
+/**
+ * Decoder for the 64 bit packets written by the trace S2MM data mover.
+ *
+ * Description:
+ *
+ * Packets are decoded in place from the synced trace buffer and handed
+ * to a sink in small batches, so a trace buffer of any size can be
+ * parsed without first copying it into a fixed size
+ * xclTraceResultsVector.  The decoder keeps the clock training state
+ * (first timestamp and the partially assembled host timestamp) between
+ * calls, so a buffer may be decoded in chunks of any size, including
+ * chunks that split a clock training group.
+ *
+ * Packet layout:
+ *   [44:0]  timestamp
+ *   [48:45] event flags (clock training: 16 bits of host timestamp
+ *           in [60:45])
+ *   [60:49] trace id
+ *   [61]    reserved (pulse)
+ *   [62]    overflow
+ *   [63]    clock training packet (trace format 1)
+ */
+class TracePacketDecoder {
+public:
+    typedef std::function<void(const xclTraceResults* samples, uint64_t count)> SampleSink;
+
+    // Number of samples handed to the sink at a time
+    static const uint64_t BATCH_SAMPLES = 512;
+
+    XDP_EXPORT TracePacketDecoder();
+
+    void setTraceFormat(uint32_t tf) { mTraceFormat = tf; }
+    uint32_t getTraceFormat() const { return mTraceFormat; }
+    void setOutputStream(std::ostream* os) { out_stream = os; }
+
+    // Forget all state carried between buffers.  Called whenever the
+    // data mover is reset.
+    XDP_EXPORT void reset();
+
+    /**
+     * Decode count packets and pass the samples to sink.  Decoding
+     * stops at the first empty packet.  Returns the number of samples
+     * passed to the sink.
+     */
+    XDP_EXPORT uint64_t decode(const uint64_t* packets, uint64_t count, const SampleSink& sink);
+
+    /**
+     * Decode at most MAX_TRACE_NUMBER_SAMPLES packets into traceVector,
+     * as the fixed size interface always has.
+     */
+    XDP_EXPORT void decode(const uint64_t* packets, uint64_t count, xclTraceResultsVector& traceVector);
+
+private:
+    uint32_t mTraceFormat = 0;
+    std::ostream* out_stream = nullptr;
+
+    // State carried across buffers
+    uint64_t mPacketFirstTs = 0;
+    bool mclockTrainingdone = false;
+    uint32_t mModulus = 0;
+    uint64_t mPartialTs = 0;
+    xclTraceResults mClockTrainSample;
+
+    xclTraceResults mBatch[BATCH_SAMPLES];
+    uint64_t mBatchLength = 0;
+    uint64_t mProduced = 0;
+
+    uint64_t seekClockTraining(const uint64_t* arr, uint64_t count);
+    // Returns true if packet completed a clock training sample
+    bool parsePacketClockTrain(uint64_t packet);
+    void parsePacket(uint64_t packet, xclTraceResults& result);
+    uint64_t decodeRun(const uint64_t* packets, uint64_t count);
+
+    inline xclTraceResults& nextSample(const SampleSink& sink)
+    {
+      if (mBatchLength == BATCH_SAMPLES)
+        flush(sink);
+      return mBatch[mBatchLength++];
+    }
+    void flush(const SampleSink& sink);
+};
+
+} //  xdp
+
+#endif
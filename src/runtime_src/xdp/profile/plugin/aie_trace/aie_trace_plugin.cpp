@@ -41,12 +41,12 @@ namespace xdp {
   AieTracePlugin::~AieTracePlugin()
   {
     if(VPDatabase::alive()) {
+      db->unregisterPlugin(this);
       try {
         writeAll(false);
       }
       catch(...) {
       }
-      db->unregisterPlugin(this);
     }
 
     // If the database is dead, then we must have already forced a 
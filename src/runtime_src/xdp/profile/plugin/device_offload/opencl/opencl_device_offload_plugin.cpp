@@ -60,9 +60,9 @@ namespace xdp {
     if (VPDatabase::alive())
     {
       // If we are destroyed before the database, we need to
-      //  do a final flush of our devices, then write
-      //  all of our writers, then finally unregister ourselves
-      //  from the database.
+      //  unregister ourselves from the database, do a final flush
+      //  of our devices, then finally write all of our writers.
+      db->unregisterPlugin(this) ;
       for (auto o : offloaders)
       {
 	auto offloader = std::get<0>(o.second) ;
@@ -75,7 +75,6 @@ namespace xdp {
       {
 	w->write(false) ;
       }
-      db->unregisterPlugin(this) ;
     }
 
     clearOffloaders();
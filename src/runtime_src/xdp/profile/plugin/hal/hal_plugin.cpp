@@ -60,15 +60,15 @@ namespace xdp {
   HALPlugin::~HALPlugin()
   {
     if (VPDatabase::alive()) {
-      // We were destroyed before the database, so flush our events to the 
-      //  database, write the writers, and unregister ourselves from
-      //  the database.
+      // We were destroyed before the database, so unregister ourselves
+      //  from the database, flush our events to the database, and
+      //  write the writers.
+      db->unregisterPlugin(this) ;
       try {
         writeAll(false);
       }
       catch (...) {
       }
-      db->unregisterPlugin(this) ;
     }
 
     // If the database is dead, then we must have already forced a 
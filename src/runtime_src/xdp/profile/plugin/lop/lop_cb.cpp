@@ -38,14 +38,15 @@ namespace xdp {
     if (queueAddress != 0) 
       (db->getStaticInfo()).addCommandQueueAddress(queueAddress) ;
 
-    VTFEvent* event = new OpenCLAPICall(0,
+    VTFEvent* event =
+      (db->getDynamicInfo()).createHostEvent<OpenCLAPICall>(0,
 					timestamp,
 					functionID,
 					(db->getDynamicInfo()).addString(functionName),
 					queueAddress
 					) ;
-    (db->getDynamicInfo()).addEvent(event) ;
-    (db->getDynamicInfo()).markStart(functionID, event->getEventId()) ;
+    if (event != nullptr)
+      (db->getDynamicInfo()).markStart(functionID, event->getEventId()) ;
   }
 
   static void lop_cb_log_function_end(const char* functionName,
@@ -57,12 +58,11 @@ namespace xdp {
 
     uint64_t start = (db->getDynamicInfo()).matchingStart(functionID) ;
 
-    VTFEvent* event = new OpenCLAPICall(start,
+    (db->getDynamicInfo()).createHostEvent<OpenCLAPICall>(start,
 					timestamp,
 					functionID,
 					(db->getDynamicInfo()).addString(functionName),
 					queueAddress) ;
-    (db->getDynamicInfo()).addEvent(event) ;
   }
 
   static void lop_read(unsigned int XRTEventId, bool isStart)
@@ -73,12 +73,11 @@ namespace xdp {
     uint64_t start = 0 ;
     if (!isStart) start = (db->getDynamicInfo()).matchingStart(XRTEventId) ;
 
-    VTFEvent* event = new LOPBufferTransfer(start,
+    VTFEvent* event =
+      (db->getDynamicInfo()).createHostEvent<LOPBufferTransfer>(start,
 					    timestamp,
 					    LOP_READ_BUFFER) ;
-
-    (db->getDynamicInfo()).addEvent(event) ;
-    if (isStart)
+    if (isStart && event != nullptr)
       (db->getDynamicInfo()).markStart(XRTEventId, event->getEventId()) ;
   }
 
@@ -91,11 +90,11 @@ namespace xdp {
 
     if (!isStart) start = (db->getDynamicInfo()).matchingStart(XRTEventId) ;
 
-    VTFEvent* event = new LOPBufferTransfer(start,
+    VTFEvent* event =
+      (db->getDynamicInfo()).createHostEvent<LOPBufferTransfer>(start,
 					    timestamp,
 					    LOP_WRITE_BUFFER) ;
-    (db->getDynamicInfo()).addEvent(event) ;
-    if (isStart)
+    if (isStart && event != nullptr)
       (db->getDynamicInfo()).markStart(XRTEventId, event->getEventId()) ;
   }
 
@@ -108,10 +107,9 @@ namespace xdp {
 
     if (!isStart) start = (db->getDynamicInfo()).matchingStart(XRTEventId) ;
 
-    VTFEvent* event = new LOPKernelEnqueue(start, timestamp) ;
-
-    (db->getDynamicInfo()).addEvent(event) ;
-    if (isStart)
+    VTFEvent* event =
+      (db->getDynamicInfo()).createHostEvent<LOPKernelEnqueue>(start, timestamp) ;
+    if (isStart && event != nullptr)
       (db->getDynamicInfo()).markStart(XRTEventId, event->getEventId()) ;
   }
 
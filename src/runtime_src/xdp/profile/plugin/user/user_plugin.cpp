@@ -31,13 +31,13 @@ namespace xdp {
   {
     if (VPDatabase::alive())
     {
-      // We were destroyed before the database, so write the writers
-      //  and unregister ourselves from the database
+      // We were destroyed before the database, so unregister
+      //  ourselves from the database and write the writers
+      db->unregisterPlugin(this) ;
       for (auto w : writers)
       {
 	w->write(false) ;
       }
-      db->unregisterPlugin(this) ;
     }
   }
 
@@ -67,6 +67,14 @@ namespace xdp {
     }
   }
 
+  void XDPPlugin::flushTraces()
+  {
+    for (auto w : writers)
+    {
+      if (w->isTraceWriter()) w->write(true) ;
+    }
+  }
+
   void XDPPlugin::broadcast(VPDatabase::MessageType /*msg*/, void* /*blob*/)
   {
     /*
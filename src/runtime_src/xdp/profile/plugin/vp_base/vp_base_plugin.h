@@ -51,6 +51,12 @@ namespace xdp {
     //  the plugins must make sure all of their writers dump a complete file
     XDP_EXPORT virtual void writeAll(bool openNewFiles = true) ;
 
+    // In bounded memory mode, trace writers periodically write out the
+    //  events currently in the database to a new file.  Start and end
+    //  events that straddle a flush are paired only by event id
+    //  across the two files.
+    XDP_EXPORT virtual void flushTraces() ;
+
     // Messages may be broadcast from the database to all plugins using
     //  this function
     XDP_EXPORT void broadcast(VPDatabase::MessageType msg,
@@ -33,6 +33,9 @@ namespace xdp {
       toolVersion(toolV)
 #endif
   {
+    // AIE trace is a dump of the raw trace words, which has no binary
+    //  encoding, so it stays text with Debug.trace_file_format=binary
+    setHumanReadable() ;
   }
 
   AIETraceWriter::~AIETraceWriter()
@@ -224,22 +224,22 @@ namespace xdp {
       if(KERNEL == eventType || KERNEL_STALL_EXT_MEM == eventType
                              || KERNEL_STALL_DATAFLOW == eventType
                              || KERNEL_STALL_PIPE == eventType) {
-        deviceEvent->dump(fout, cuBucketIdMap[cuId] + eventType - KERNEL);
+        writeEvent(deviceEvent, cuBucketIdMap[cuId] + eventType - KERNEL);
       } else {
         // Memory or Stream Acceses
         uint32_t monId = deviceEvent->getMonitorId();
         DeviceMemoryAccess* memoryEvent = dynamic_cast<DeviceMemoryAccess*>(e);
         if(memoryEvent) {
-          deviceEvent->dump(fout, aimBucketIdMap[monId] + eventType - KERNEL_READ);
+          writeEvent(deviceEvent, aimBucketIdMap[monId] + eventType - KERNEL_READ);
           continue;
         }
         DeviceStreamAccess* streamEvent = dynamic_cast<DeviceStreamAccess*>(e);
         if(streamEvent) {
           if(KERNEL_STREAM_READ == eventType || KERNEL_STREAM_READ_STALL == eventType
                                              || KERNEL_STREAM_READ_STARVE == eventType) {
-            deviceEvent->dump(fout, asmBucketIdMap[monId] + eventType - KERNEL_STREAM_READ);
+            writeEvent(deviceEvent, asmBucketIdMap[monId] + eventType - KERNEL_STREAM_READ);
           } else {
-            deviceEvent->dump(fout, asmBucketIdMap[monId] + eventType - KERNEL_STREAM_WRITE);
+            writeEvent(deviceEvent, asmBucketIdMap[monId] + eventType - KERNEL_STREAM_WRITE);
           }
           continue;
         }
@@ -257,6 +257,7 @@ namespace xdp {
 
   void DeviceTraceWriter::write(bool openNewFile)
   {
+    beginTrace() ;
     writeHeader() ;
     fout << std::endl ;
     writeStructure() ;
@@ -264,10 +265,13 @@ namespace xdp {
     writeStringTable() ;
     fout << std::endl ;
     writeTraceEvents() ;
+    endEvents() ;
     fout << std::endl ;
     writeDependencies() ;
     fout << std::endl ;
 
+    endTrace() ;
+
     if (openNewFile) switchFiles() ;
   }
 
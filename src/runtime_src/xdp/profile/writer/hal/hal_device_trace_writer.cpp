@@ -214,7 +214,7 @@ namespace xdp {
       if(!deviceEvent)
         continue;
       if(deviceEvent->getCUId() >= 0) {
-        deviceEvent->dump(fout, cuBucketIdMap[deviceEvent->getCUId()] + deviceEvent->getEventType() - KERNEL);
+        writeEvent(deviceEvent, cuBucketIdMap[deviceEvent->getCUId()] + deviceEvent->getEventType() - KERNEL);
       } else {
         /* Device Events which may not be directly associated with a Kernel using available metadata.
          * For example, AXI monitors for System Compiler, Slave Bridge designs.
@@ -222,7 +222,7 @@ namespace xdp {
         uint32_t monId = deviceEvent->getMonitorId();
         DeviceMemoryAccess* memoryEvent = dynamic_cast<DeviceMemoryAccess*>(e);
         if(memoryEvent) {
-          deviceEvent->dump(fout, aimBucketIdMap[monId] + deviceEvent->getEventType() - KERNEL_READ);
+          writeEvent(deviceEvent, aimBucketIdMap[monId] + deviceEvent->getEventType() - KERNEL_READ);
           continue;
         }
         DeviceStreamAccess* streamEvent = dynamic_cast<DeviceStreamAccess*>(e);
@@ -230,9 +230,9 @@ namespace xdp {
           VTFEventType eventType = deviceEvent->getEventType();
           if(KERNEL_STREAM_READ == eventType || KERNEL_STREAM_READ_STALL == eventType
                                              || KERNEL_STREAM_READ_STARVE == eventType) {
-            deviceEvent->dump(fout, asmBucketIdMap[monId] + eventType - KERNEL_STREAM_READ);
+            writeEvent(deviceEvent, asmBucketIdMap[monId] + eventType - KERNEL_STREAM_READ);
           } else {
-            deviceEvent->dump(fout, asmBucketIdMap[monId] + eventType - KERNEL_STREAM_WRITE);
+            writeEvent(deviceEvent, asmBucketIdMap[monId] + eventType - KERNEL_STREAM_WRITE);
           }
           continue;
         }
@@ -249,6 +249,7 @@ namespace xdp {
 
   void HALDeviceTraceWriter::write(bool openNewFile)
   {
+    beginTrace() ;
     writeHeader() ;
     fout << std::endl ;
     writeStructure() ;
@@ -256,10 +257,13 @@ namespace xdp {
     writeStringTable() ;
     fout << std::endl ;
     writeTraceEvents() ;
+    endEvents() ;
     fout << std::endl ;
     writeDependencies() ;
     fout << std::endl ;
 
+    endTrace() ;
+
     if (openNewFile) switchFiles() ;
   }
 
@@ -88,7 +88,7 @@ namespace xdp {
     for (auto e : HALAPIEvents)
     {
       VTFEventType eventType = e->getEventType();
-      e->dump(fout, eventTypeBucketIdMap[eventType]) ;
+      writeEvent(e, eventTypeBucketIdMap[eventType]) ;
     }
   }
 
@@ -100,6 +100,7 @@ namespace xdp {
 
   void HALHostTraceWriter::write(bool openNewFile)
   {
+    beginTrace() ;
     writeHeader() ;
     fout << std::endl ;
     writeStructure() ;
@@ -107,10 +108,13 @@ namespace xdp {
     writeStringTable() ;
     fout << std::endl ;
     writeTraceEvents() ;
+    endEvents() ;
     fout << std::endl ;
     writeDependencies() ;
     fout << std::endl ;
 
+    endTrace() ;
+
     if (openNewFile) switchFiles() ;
   }
 
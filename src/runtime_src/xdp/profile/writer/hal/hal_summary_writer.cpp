@@ -33,6 +33,14 @@ namespace xdp {
     fout << "Call Count" << std::endl ;
     (db->getStats()).dumpCallCount(fout) ;
     fout << std::endl ;
+    fout << "API Latency (ns)" << std::endl ;
+    fout << "Name,Count,Min,Mean,Max,P50,P99,P999" << std::endl ;
+    (db->getStats()).dumpCallLatencies(fout) ;
+    fout << std::endl ;
+    fout << "Compute Unit Latency (ns)" << std::endl ;
+    fout << "Name,Count,Min,Mean,Max,P50,P99,P999" << std::endl ;
+    (db->getStats()).dumpComputeUnitLatencies(fout) ;
+    fout << std::endl ;
     fout << "Memory stats" << std::endl ;
     (db->getStats()).dumpHALMemory(fout) ;
 
@@ -127,7 +127,7 @@ namespace xdp {
       {
 	bucket = enqueueBucket ;
       }
-      e->dump(fout, bucket) ;
+      writeEvent(e, bucket) ;
     }
   }
 
@@ -139,24 +139,32 @@ namespace xdp {
 
   // ************** Binary output functions ******************
 
+  // The binary format only changes how events are stored.  Everything
+  //  else is kept as the same text.
+
   void LowOverheadTraceWriter::writeBinaryHeader()
   {
+    writeHumanReadableHeader() ;
   }
 
   void LowOverheadTraceWriter::writeBinaryStructure()
   {
+    writeHumanReadableStructure() ;
   }
 
   void LowOverheadTraceWriter::writeBinaryStringTable()
   {
+    writeHumanReadableStringTable() ;
   }
 
   void LowOverheadTraceWriter::writeBinaryTraceEvents()
   {
+    writeHumanReadableTraceEvents() ;
   }
 
   void LowOverheadTraceWriter::writeBinaryDependencies()
   {
+    writeHumanReadableDependencies() ;
   }
 
   // ************** Virtual output functions ******************
@@ -197,16 +205,20 @@ namespace xdp {
     setupBuckets() ;
     //setupCommandQueueBuckets() ;
 
+    beginTrace() ;
     writeHeader() ;
-    if (humanReadable) fout << std::endl ;
+    fout << std::endl ;
     writeStructure() ;
-    if (humanReadable) fout << std::endl ;
+    fout << std::endl ;
     writeStringTable() ;
-    if (humanReadable) fout << std::endl ;
+    fout << std::endl ;
     writeTraceEvents() ;
-    if (humanReadable) fout << std::endl ;
+    endEvents() ;
+    fout << std::endl ;
     writeDependencies() ;
-    if (humanReadable) fout << std::endl ;
+    fout << std::endl ;
+
+    endTrace() ;
 
     if (openNewFile) switchFiles() ;
   }
@@ -67,7 +67,7 @@ namespace xdp {
 					 ) ;
     for (auto e : userEvents)
     {
-      e->dump(fout, bucketId) ;
+      writeEvent(e, bucketId) ;
     }
   }
 
@@ -79,6 +79,7 @@ namespace xdp {
 
   void UserEventsTraceWriter::write(bool openNewFile)
   {
+    beginTrace() ;
     writeHeader() ;
     fout << std::endl ;
     writeStructure() ;
@@ -86,9 +87,12 @@ namespace xdp {
     writeStringTable() ;
     fout << std::endl ;
     writeTraceEvents() ;
+    endEvents() ;
     fout << std::endl ;
     writeDependencies() ;
 
+    endTrace() ;
+
     if (openNewFile) switchFiles() ;
   }
 
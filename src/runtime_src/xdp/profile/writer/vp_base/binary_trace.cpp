@@ -0,0 +1,493 @@
+/**
+ * Copyright (C) 2020 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <cmath>
+#include <cstring>
+
+#define XDP_SOURCE
+
+#include "xdp/profile/writer/vp_base/binary_trace.h"
+#include "xdp/profile/database/events/vtf_event.h"
+
+namespace xdp {
+
+  // Layout of Kind::shape
+  static const uint32_t SHAPE_COUNT_MASK = 0x7 ;
+  static const uint32_t SHAPE_HEX_SHIFT  = 3 ;
+  static const uint32_t SHAPE_DEVICE     = 0x80 ;
+
+  static inline uint64_t zigzag(int64_t v)
+  {
+    return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63) ;
+  }
+
+  static inline int64_t unzigzag(uint64_t v)
+  {
+    return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1) ;
+  }
+
+  static inline void putVarint(std::vector<uint8_t>& out, uint64_t v)
+  {
+    while (v >= 0x80)
+    {
+      out.push_back(static_cast<uint8_t>(v | 0x80)) ;
+      v >>= 7 ;
+    }
+    out.push_back(static_cast<uint8_t>(v)) ;
+  }
+
+  static inline void putColumn(std::vector<uint8_t>& out,
+			       const std::vector<uint8_t>& column)
+  {
+    putVarint(out, column.size()) ;
+    out.insert(out.end(), column.begin(), column.end()) ;
+  }
+
+  static void putLength(std::ostream& out, uint64_t length)
+  {
+    char bytes[8] ;
+    for (unsigned int i = 0 ; i < 8 ; ++i)
+      bytes[i] = static_cast<char>((length >> (8 * i)) & 0xff) ;
+    out.write(bytes, 8) ;
+  }
+
+  BinaryTraceEncoder::BinaryTraceEncoder(std::ofstream& f) :
+    fout(f), textStart(-1)
+  {
+  }
+
+  BinaryTraceEncoder::~BinaryTraceEncoder()
+  {
+  }
+
+  void BinaryTraceEncoder::beginText()
+  {
+    if (textStart >= 0)
+      return ;
+
+    if (fout.tellp() == std::streampos(0))
+      fout.write(binary_trace::MAGIC, sizeof(binary_trace::MAGIC)) ;
+
+    fout.put(static_cast<char>(binary_trace::SECTION_TEXT)) ;
+    textStart = fout.tellp() ;
+    putLength(fout, 0) ;
+  }
+
+  void BinaryTraceEncoder::endText()
+  {
+    if (textStart < 0)
+      return ;
+
+    std::streamoff end = fout.tellp() ;
+    fout.seekp(textStart) ;
+    putLength(fout, static_cast<uint64_t>(end - textStart - 8)) ;
+    fout.seekp(end) ;
+    textStart = -1 ;
+  }
+
+  void BinaryTraceEncoder::writeSection(uint8_t tag,
+					const std::vector<uint8_t>& payload)
+  {
+    if (fout.tellp() == std::streampos(0))
+      fout.write(binary_trace::MAGIC, sizeof(binary_trace::MAGIC)) ;
+
+    fout.put(static_cast<char>(tag)) ;
+    putLength(fout, payload.size()) ;
+    fout.write(reinterpret_cast<const char*>(payload.data()), payload.size()) ;
+  }
+
+  void BinaryTraceEncoder::addEvent(VTFEvent* e, uint32_t bucket)
+  {
+    endText() ;
+
+    TraceFields fields ;
+    e->getTraceFields(fields) ;
+
+    uint32_t type = static_cast<uint32_t>(e->getEventType()) ;
+    uint32_t shape = fields.count | (fields.hexMask << SHAPE_HEX_SHIFT) ;
+    if (e->isDeviceEvent())
+      shape |= SHAPE_DEVICE ;
+
+    // There are only a handful of kinds in any trace, so a linear
+    //  search beats a map here
+    size_t k = 0 ;
+    for ( ; k < kinds.size() ; ++k)
+      if (kinds[k].type == type && kinds[k].shape == shape)
+	break ;
+    if (k == kinds.size())
+    {
+      if (kinds.size() == 255)
+      {
+	flushEvents() ;
+	k = 0 ;
+      }
+      kinds.emplace_back() ;
+      Kind& kind = kinds.back() ;
+      kind.type = type ;
+      kind.shape = shape ;
+      kind.name = VTFEvent::getTypeName(e->getEventType()) ;
+      kind.lastId = 0 ;
+      kind.lastTimestamp = 0 ;
+      std::memset(kind.lastFields, 0, sizeof(kind.lastFields)) ;
+    }
+    Kind& kind = kinds[k] ;
+    kindColumn.push_back(static_cast<uint8_t>(k)) ;
+
+    // Host timestamps are in ns, device timestamps in ms.  Both are
+    //  printed in ms with ns precision.
+    double ts = e->getTimestamp() ;
+    int64_t ticks = (shape & SHAPE_DEVICE) ? std::llround(ts * 1.0e6)
+                                           : std::llround(ts) ;
+
+    uint64_t id = e->getEventId() ;
+    uint64_t startId = e->getStartId() ;
+    putVarint(kind.ids, zigzag(static_cast<int64_t>(id - kind.lastId))) ;
+    putVarint(kind.startIds,
+	      startId == 0 ? 0 : zigzag(static_cast<int64_t>(id - startId)) + 1) ;
+    putVarint(kind.timestamps, zigzag(ticks - kind.lastTimestamp)) ;
+    putVarint(kind.buckets, bucket) ;
+    for (unsigned int f = 0 ; f < fields.count ; ++f)
+    {
+      putVarint(kind.fields[f],
+		zigzag(static_cast<int64_t>(fields.values[f] - kind.lastFields[f]))) ;
+      kind.lastFields[f] = fields.values[f] ;
+    }
+    kind.lastId = id ;
+    kind.lastTimestamp = ticks ;
+
+    if (kindColumn.size() == binary_trace::BLOCK_EVENTS)
+      flushEvents() ;
+  }
+
+  void BinaryTraceEncoder::flushEvents()
+  {
+    if (kindColumn.empty())
+      return ;
+
+    std::vector<uint8_t> payload ;
+    size_t estimate = kindColumn.size() ;
+    for (auto& kind : kinds)
+    {
+      estimate += kind.ids.size() + kind.startIds.size() +
+	kind.timestamps.size() + kind.buckets.size() + 64 ;
+      for (auto& f : kind.fields)
+	estimate += f.size() ;
+    }
+    payload.reserve(estimate) ;
+
+    putVarint(payload, kindColumn.size()) ;
+    putVarint(payload, kinds.size()) ;
+    for (auto& kind : kinds)
+    {
+      putVarint(payload, kind.type) ;
+      payload.push_back(static_cast<uint8_t>(kind.shape)) ;
+      putVarint(payload, kind.name.size()) ;
+      payload.insert(payload.end(), kind.name.begin(), kind.name.end()) ;
+    }
+    payload.insert(payload.end(), kindColumn.begin(), kindColumn.end()) ;
+    for (auto& kind : kinds)
+    {
+      putColumn(payload, kind.ids) ;
+      putColumn(payload, kind.startIds) ;
+      putColumn(payload, kind.timestamps) ;
+      putColumn(payload, kind.buckets) ;
+      for (unsigned int f = 0 ; f < (kind.shape & SHAPE_COUNT_MASK) ; ++f)
+	putColumn(payload, kind.fields[f]) ;
+    }
+
+    writeSection(binary_trace::SECTION_EVENTS, payload) ;
+
+    kinds.clear() ;
+    kindColumn.clear() ;
+  }
+
+  // ************** Conversion back to CSV ******************
+
+  namespace {
+
+    struct Cursor
+    {
+      const uint8_t* pos ;
+      const uint8_t* end ;
+
+      bool varint(uint64_t& v)
+      {
+	v = 0 ;
+	for (unsigned int shift = 0 ; shift < 64 ; shift += 7)
+	{
+	  if (pos == end)
+	    return false ;
+	  uint8_t byte = *pos++ ;
+	  v |= static_cast<uint64_t>(byte & 0x7f) << shift ;
+	  if ((byte & 0x80) == 0)
+	    return true ;
+	}
+	return false ;
+      }
+
+      bool column(Cursor& c)
+      {
+	uint64_t size = 0 ;
+	if (!varint(size) || size > static_cast<uint64_t>(end - pos))
+	  return false ;
+	c.pos = pos ;
+	c.end = pos + size ;
+	pos += size ;
+	return true ;
+      }
+    } ;
+
+    struct KindState
+    {
+      std::string name ;
+      uint32_t shape ;
+      uint64_t lastId ;
+      int64_t  lastTimestamp ;
+      uint64_t lastFields[4] ;
+      Cursor ids, startIds, timestamps, buckets, fields[4] ;
+    } ;
+
+    // Formatting is done by hand into one large buffer; this is the
+    //  same text the ofstream based writers produce
+    class LineBuffer
+    {
+    private:
+      std::ostream& out ;
+      std::string buffer ;
+
+    public:
+      explicit LineBuffer(std::ostream& o) : out(o)
+      {
+	buffer.reserve(2 * 1024 * 1024) ;
+      }
+      ~LineBuffer() { flush() ; }
+
+      void flush()
+      {
+	out.write(buffer.data(), buffer.size()) ;
+	buffer.clear() ;
+      }
+
+      void maybeFlush()
+      {
+	if (buffer.size() >= 1024 * 1024)
+	  flush() ;
+      }
+
+      void put(char c) { buffer.push_back(c) ; }
+      void put(const std::string& s) { buffer.append(s) ; }
+
+      void putDecimal(uint64_t v)
+      {
+	char digits[20] ;
+	int n = 0 ;
+	do { digits[n++] = static_cast<char>('0' + (v % 10)) ; v /= 10 ; }
+	while (v != 0) ;
+	while (n > 0) buffer.push_back(digits[--n]) ;
+      }
+
+      void putHex(uint64_t v)
+      {
+	static const char hex[] = "0123456789abcdef" ;
+	char digits[16] ;
+	int n = 0 ;
+	do { digits[n++] = hex[v & 0xf] ; v >>= 4 ; } while (v != 0) ;
+	buffer.append("0x") ;
+	while (n > 0) buffer.push_back(digits[--n]) ;
+      }
+
+      // Nanoseconds printed as milliseconds with six decimals
+      void putTimestamp(int64_t ns)
+      {
+	uint64_t magnitude = static_cast<uint64_t>(ns) ;
+	if (ns < 0)
+	{
+	  buffer.push_back('-') ;
+	  magnitude = ~magnitude + 1 ;
+	}
+	putDecimal(magnitude / 1000000) ;
+	buffer.push_back('.') ;
+	uint64_t fraction = magnitude % 1000000 ;
+	for (uint64_t div = 100000 ; div > 0 ; div /= 10)
+	  buffer.push_back(static_cast<char>('0' + (fraction / div) % 10)) ;
+      }
+    } ;
+
+    bool convertEvents(const std::vector<uint8_t>& payload, LineBuffer& out,
+		       std::string& error)
+    {
+      Cursor c = { payload.data(), payload.data() + payload.size() } ;
+
+      uint64_t numEvents = 0, numKinds = 0 ;
+      if (!c.varint(numEvents) || !c.varint(numKinds) || numKinds > 255)
+      {
+	error = "corrupt event block header" ;
+	return false ;
+      }
+
+      std::vector<KindState> kinds(numKinds) ;
+      for (auto& kind : kinds)
+      {
+	uint64_t type = 0, nameLength = 0 ;
+	if (!c.varint(type) || c.pos == c.end)
+	{
+	  error = "corrupt event kind" ;
+	  return false ;
+	}
+	kind.shape = *c.pos++ ;
+	if (!c.varint(nameLength) ||
+	    nameLength > static_cast<uint64_t>(c.end - c.pos))
+	{
+	  error = "corrupt event kind name" ;
+	  return false ;
+	}
+	kind.name.assign(reinterpret_cast<const char*>(c.pos), nameLength) ;
+	c.pos += nameLength ;
+	kind.lastId = 0 ;
+	kind.lastTimestamp = 0 ;
+	std::memset(kind.lastFields, 0, sizeof(kind.lastFields)) ;
+      }
+
+      if (numEvents > static_cast<uint64_t>(c.end - c.pos))
+      {
+	error = "truncated kind column" ;
+	return false ;
+      }
+      const uint8_t* kindColumn = c.pos ;
+      c.pos += numEvents ;
+
+      for (auto& kind : kinds)
+      {
+	bool ok = c.column(kind.ids) && c.column(kind.startIds) &&
+	          c.column(kind.timestamps) && c.column(kind.buckets) ;
+	for (unsigned int f = 0 ; ok && f < (kind.shape & SHAPE_COUNT_MASK) ; ++f)
+	  ok = c.column(kind.fields[f]) ;
+	if (!ok)
+	{
+	  error = "truncated event column" ;
+	  return false ;
+	}
+      }
+
+      for (uint64_t i = 0 ; i < numEvents ; ++i)
+      {
+	if (kindColumn[i] >= kinds.size())
+	{
+	  error = "event refers to unknown kind" ;
+	  return false ;
+	}
+	KindState& kind = kinds[kindColumn[i]] ;
+
+	uint64_t idDelta = 0, startId = 0, tsDelta = 0, bucket = 0 ;
+	if (!kind.ids.varint(idDelta) || !kind.startIds.varint(startId) ||
+	    !kind.timestamps.varint(tsDelta) || !kind.buckets.varint(bucket))
+	{
+	  error = "event column ended early" ;
+	  return false ;
+	}
+	kind.lastId += static_cast<uint64_t>(unzigzag(idDelta)) ;
+	kind.lastTimestamp += unzigzag(tsDelta) ;
+	if (startId != 0)
+	  startId = kind.lastId - static_cast<uint64_t>(unzigzag(startId - 1)) ;
+
+	out.putDecimal(kind.lastId) ;
+	out.put(',') ;
+	out.putDecimal(startId) ;
+	out.put(',') ;
+	out.putTimestamp(kind.lastTimestamp) ;
+	out.put(',') ;
+	out.putDecimal(bucket) ;
+	out.put(',') ;
+	out.put(kind.name) ;
+
+	unsigned int hexMask = (kind.shape >> SHAPE_HEX_SHIFT) & 0xf ;
+	for (unsigned int f = 0 ; f < (kind.shape & SHAPE_COUNT_MASK) ; ++f)
+	{
+	  uint64_t delta = 0 ;
+	  if (!kind.fields[f].varint(delta))
+	  {
+	    error = "field column ended early" ;
+	    return false ;
+	  }
+	  kind.lastFields[f] += static_cast<uint64_t>(unzigzag(delta)) ;
+	  out.put(',') ;
+	  if (hexMask & (1u << f)) out.putHex(kind.lastFields[f]) ;
+	  else                     out.putDecimal(kind.lastFields[f]) ;
+	}
+	out.put('\n') ;
+	out.maybeFlush() ;
+      }
+      return true ;
+    }
+
+  } // end anonymous namespace
+
+  bool convertBinaryTrace(std::istream& in, std::ostream& out,
+			  std::string& error)
+  {
+    char magic[sizeof(binary_trace::MAGIC)] ;
+    if (!in.read(magic, sizeof(magic)) ||
+	std::memcmp(magic, binary_trace::MAGIC, sizeof(magic)) != 0)
+    {
+      error = "not a binary trace file" ;
+      return false ;
+    }
+
+    LineBuffer lines(out) ;
+    std::vector<uint8_t> payload ;
+    while (true)
+    {
+      int tag = in.get() ;
+      if (tag == std::char_traits<char>::eof())
+	break ;
+
+      unsigned char lengthBytes[8] ;
+      if (!in.read(reinterpret_cast<char*>(lengthBytes), 8))
+      {
+	error = "truncated section header" ;
+	return false ;
+      }
+      uint64_t length = 0 ;
+      for (unsigned int i = 0 ; i < 8 ; ++i)
+	length |= static_cast<uint64_t>(lengthBytes[i]) << (8 * i) ;
+
+      payload.resize(length) ;
+      if (!in.read(reinterpret_cast<char*>(payload.data()), length))
+      {
+	error = "truncated section" ;
+	return false ;
+      }
+
+      if (tag == binary_trace::SECTION_TEXT)
+      {
+	lines.put(std::string(payload.begin(), payload.end())) ;
+	lines.maybeFlush() ;
+      }
+      else if (tag == binary_trace::SECTION_EVENTS)
+      {
+	if (!convertEvents(payload, lines, error))
+	  return false ;
+      }
+      else
+      {
+	error = "unknown section " + std::to_string(tag) ;
+	return false ;
+      }
+    }
+    return true ;
+  }
+
+} // end namespace xdp
@@ -0,0 +1,117 @@
+/**
+ * Copyright (C) 2020 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef BINARY_TRACE_DOT_H
+#define BINARY_TRACE_DOT_H
+
+#include <cstdint>
+#include <fstream>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "xdp/config.h"
+
+namespace xdp {
+
+  class VTFEvent ;
+
+  // The binary trace format holds exactly what the CSV trace writers
+  //  produce, but stores the EVENTS section in columns instead of text.
+  //
+  //  A file is the 8 byte magic followed by sections, each a one byte
+  //  tag and an 8 byte little endian payload length:
+  //
+  //    TEXT   - lines copied verbatim to the CSV (header, structure,
+  //             string table, dependencies and the section markers)
+  //    EVENTS - a block of up to BLOCK_EVENTS events
+  //
+  //  An EVENTS block starts with the number of events and a table of
+  //  event kinds (type, type name and field layout), followed by one
+  //  byte per event giving its kind so the original order can be
+  //  rebuilt.  Then, for every kind, each column is stored contiguously
+  //  with its byte length: event ids, start ids, timestamps, buckets and
+  //  one column per extra field.  Ids, timestamps and fields are zigzag
+  //  delta encoded against the previous event of the same kind and
+  //  written as LEB128 varints.  Timestamps are integer nanoseconds.
+  //  String table references are ordinary fields, so repeated function
+  //  names cost a single byte.
+  namespace binary_trace {
+    static const char MAGIC[8] = { 'X', 'D', 'P', 'V', 'T', 'F', 'B', '1' } ;
+
+    enum SectionTag {
+      SECTION_TEXT   = 1,
+      SECTION_EVENTS = 2
+    } ;
+
+    static const size_t BLOCK_EVENTS = 64 * 1024 ;
+  }
+
+  // Used by VPTraceWriter when the binary format is selected.  Text
+  //  written to the stream between beginText() and endText() becomes a
+  //  TEXT section; events passed to addEvent() are buffered and written
+  //  as EVENTS blocks of one large write per column.
+  class BinaryTraceEncoder
+  {
+  private:
+    struct Kind
+    {
+      uint32_t type ;
+      uint32_t shape ;
+      std::string name ;
+
+      // Previous values, for delta encoding
+      uint64_t lastId ;
+      int64_t  lastTimestamp ;
+      uint64_t lastFields[4] ;
+
+      std::vector<uint8_t> ids ;
+      std::vector<uint8_t> startIds ;
+      std::vector<uint8_t> timestamps ;
+      std::vector<uint8_t> buckets ;
+      std::vector<uint8_t> fields[4] ;
+    } ;
+
+    std::ofstream& fout ;
+
+    // Position of the length of the open TEXT section, or -1
+    std::streamoff textStart ;
+
+    std::vector<Kind> kinds ;
+    std::vector<uint8_t> kindColumn ;
+
+    void writeSection(uint8_t tag, const std::vector<uint8_t>& payload) ;
+
+  public:
+    XDP_EXPORT explicit BinaryTraceEncoder(std::ofstream& f) ;
+    XDP_EXPORT ~BinaryTraceEncoder() ;
+
+    XDP_EXPORT void beginText() ;
+    XDP_EXPORT void endText() ;
+
+    XDP_EXPORT void addEvent(VTFEvent* e, uint32_t bucket) ;
+    XDP_EXPORT void flushEvents() ;
+  } ;
+
+  // Convert a binary trace into the CSV the text writers would have
+  //  produced.  Returns false and sets error if the input is malformed.
+  XDP_EXPORT bool convertBinaryTrace(std::istream& in, std::ostream& out,
+				     std::string& error) ;
+
+} // end namespace xdp
+
+#endif
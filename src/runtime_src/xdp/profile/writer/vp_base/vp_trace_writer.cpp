@@ -18,6 +18,8 @@
 
 #include "xdp/profile/writer/vp_base/vp_trace_writer.h"
 #include "xdp/profile/database/database.h"
+#include "xdp/profile/database/events/vtf_event.h"
+#include "core/common/config_reader.h"
 
 namespace xdp {
 
@@ -27,14 +29,28 @@ namespace xdp {
 				 uint16_t r) :
     VPWriter(filename),
     version(v), creationTime(c), resolution(r),
-    humanReadable(true)
+    humanReadable(xrt_core::config::get_trace_file_format() != "binary")
   {
+    if (!humanReadable)
+    {
+      encoder.reset(new BinaryTraceEncoder(fout)) ;
+      setOpenMode(std::ios_base::out | std::ios_base::binary) ;
+    }
   }
 
   VPTraceWriter::~VPTraceWriter()
   {
   }
 
+  void VPTraceWriter::setHumanReadable()
+  {
+    if (humanReadable) return ;
+
+    humanReadable = true ;
+    encoder.reset() ;
+    setOpenMode(std::ios_base::out) ;
+  }
+
   void VPTraceWriter::writeHeader()
   {
     fout << "HEADER" << std::endl
@@ -52,4 +68,34 @@ namespace xdp {
          << "Trace Version," << version << std::endl; 
   }
 
+  void VPTraceWriter::beginTrace()
+  {
+    if (!humanReadable && encoder) encoder->beginText() ;
+  }
+
+  void VPTraceWriter::writeEvent(VTFEvent* e, uint32_t bucket)
+  {
+    if (!humanReadable && encoder) encoder->addEvent(e, bucket) ;
+    else                           e->dump(fout, bucket) ;
+  }
+
+  void VPTraceWriter::endEvents()
+  {
+    if (!humanReadable && encoder)
+    {
+      encoder->flushEvents() ;
+      encoder->beginText() ;
+    }
+  }
+
+  void VPTraceWriter::endTrace()
+  {
+    if (!humanReadable && encoder)
+    {
+      encoder->flushEvents() ;
+      encoder->endText() ;
+    }
+    fout.flush() ;
+  }
+
 }
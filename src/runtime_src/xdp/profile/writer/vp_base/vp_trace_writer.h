@@ -17,12 +17,16 @@
 #ifndef VP_TRACE_WRITER_DOT_H
 #define VP_TRACE_WRITER_DOT_H
 
+#include <memory>
 #include <string>
 
 #include "xdp/profile/writer/vp_base/vp_writer.h"
+#include "xdp/profile/writer/vp_base/binary_trace.h"
 #include "xdp/config.h"
 
 namespace xdp {
+
+  class VTFEvent ;
   
   class VPTraceWriter : public VPWriter
   {
@@ -46,6 +50,18 @@ namespace xdp {
     // Trace formats can either be dumped as a binary or human readable
     bool humanReadable ;
 
+    // Used instead of the events' dump() for the binary format
+    std::unique_ptr<BinaryTraceEncoder> encoder ;
+
+    // Every write() is bracketed by beginTrace() and endTrace(), and
+    //  the events are written with writeEvent() followed by endEvents().
+    //  In the binary format everything else written to fout is kept
+    //  as text.
+    XDP_EXPORT void beginTrace() ;
+    XDP_EXPORT void writeEvent(VTFEvent* e, uint32_t bucket) ;
+    XDP_EXPORT void endEvents() ;
+    XDP_EXPORT void endTrace() ;
+
     // The different types of VTF file formats supported
     virtual bool isHost()   { return false ; }
     virtual bool isDevice() { return false ; }
@@ -57,7 +73,10 @@ namespace xdp {
 			     const std::string& c, uint16_t r) ;
     XDP_EXPORT ~VPTraceWriter() ;
 
-    void setHumanReadable() { humanReadable = true ; } 
+    // Write this trace as text regardless of Debug.trace_file_format.
+    //  Only useful before anything has been written.
+    XDP_EXPORT void setHumanReadable() ;
+    virtual bool isTraceWriter() { return true ; } 
   } ;
   
 }
@@ -23,6 +23,7 @@ namespace xdp {
 
   VPWriter::VPWriter(const char* filename) : 
     basename(filename), currentFileName(filename), fileNum(1),
+    openMode(std::ios_base::out),
     db(VPDatabase::Instance()), fout(filename)
   {
   }
@@ -41,7 +42,7 @@ namespace xdp {
     ++fileNum ;
     currentFileName = std::to_string(fileNum) + std::string("-") + basename ;
 
-    fout.open(currentFileName.c_str()) ;
+    fout.open(currentFileName.c_str(), openMode) ;
   }
 
   // If we are overwriting a file that was previously written (but not
@@ -51,7 +52,13 @@ namespace xdp {
     fout.close() ;
     fout.clear() ;
 
-    fout.open(currentFileName.c_str()) ;
+    fout.open(currentFileName.c_str(), openMode) ;
+  }
+
+  void VPWriter::setOpenMode(std::ios_base::openmode mode)
+  {
+    openMode = mode ;
+    refreshFile() ;
   }
 
 }
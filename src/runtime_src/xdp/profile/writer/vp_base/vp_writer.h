@@ -42,6 +42,9 @@ namespace xdp {
     // The number of files created by this writer (in continuous offload)
     uint32_t fileNum ;
 
+    // How every file of this writer is opened
+    std::ios_base::openmode openMode ;
+
   protected:
     // Connection to the database where all the information is stored
     VPDatabase* db ;
@@ -54,11 +57,16 @@ namespace xdp {
     inline const char* getRawBasename() { return basename.c_str() ; } 
     XDP_EXPORT virtual void switchFiles() ;
     XDP_EXPORT virtual void refreshFile() ;
+
+    // Reopen the current file with a different mode.  Only useful
+    //  before anything has been written.
+    XDP_EXPORT void setOpenMode(std::ios_base::openmode mode) ;
   public:
     XDP_EXPORT VPWriter(const char* filename) ;
     XDP_EXPORT virtual ~VPWriter() ;
 
     virtual bool isRunSummaryWriter() { return false ; }
+    virtual bool isTraceWriter() { return false ; }
     virtual void write(bool openNewFile = true) = 0 ;
     virtual bool isDeviceWriter() { return false ; } 
     virtual DeviceIntf* device() { return nullptr ; } 
@@ -0,0 +1,60 @@
+/**
+ * Copyright (C) 2020 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+// Converts trace files written with Debug.trace_file_format=binary into
+// the csv trace files the viewers read.
+//
+//   xdp_trace_convert <binary trace> [<csv output>]
+//
+// Without an output file the csv is written to stdout.
+
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "xdp/profile/writer/vp_base/binary_trace.h"
+
+int main(int argc, char* argv[])
+{
+  if (argc < 2 || argc > 3) {
+    std::cerr << "Usage: " << argv[0] << " <binary trace> [<csv output>]\n" ;
+    return 1 ;
+  }
+
+  std::ifstream in(argv[1], std::ios_base::in | std::ios_base::binary) ;
+  if (!in) {
+    std::cerr << "Cannot open " << argv[1] << "\n" ;
+    return 1 ;
+  }
+
+  std::ofstream file ;
+  if (argc == 3) {
+    file.open(argv[2], std::ios_base::out | std::ios_base::binary) ;
+    if (!file) {
+      std::cerr << "Cannot open " << argv[2] << "\n" ;
+      return 1 ;
+    }
+  }
+  std::ostream& out = (argc == 3) ? file : std::cout ;
+
+  std::string error ;
+  if (!xdp::convertBinaryTrace(in, out, error)) {
+    std::cerr << argv[1] << ": " << error << "\n" ;
+    return 1 ;
+  }
+  out.flush() ;
+  return out ? 0 : 1 ;
+}
@@ -27,6 +27,7 @@
 
 #include "core/common/system.h"
 #include "core/common/device.h"
+#include "core/common/memfill.h"
 #include "core/common/query_requests.h"
 #include "core/common/xclbin_parser.h"
 
@@ -1027,11 +1028,7 @@ fill_buffer(memory* buffer, const void* pattern, size_t pattern_size, size_t off
 {
   auto boh = xocl::xocl(buffer)->get_buffer_object(this);
   char* hbuf = static_cast<char*>(map_buffer(buffer,CL_MAP_WRITE_INVALIDATE_REGION,offset,size,nullptr));
-  char* dst = hbuf;
-  for (; pattern_size <= size; size-=pattern_size, dst+=pattern_size)
-    std::memcpy(dst,pattern,pattern_size);
-  if (size)
-    std::memcpy(dst,pattern,size);
+  xrt_core::fill(hbuf,pattern,pattern_size,size);
   unmap_buffer(buffer,hbuf);
 }
 
@@ -78,6 +78,21 @@ typedef struct XmaBufferPoolObj
 
 } XmaBufferPoolObj;
 
+/**
+ * struct XmaBufferPoolStats - Usage counters of a buffer pool
+ *
+ * Hit rate of the pool is num_hits / num_allocs
+*/
+typedef struct XmaBufferPoolStats
+{
+    uint64_t num_allocs; /**< buffers handed out by the pool */
+    uint64_t num_hits; /**< allocations served with a free pooled buffer */
+    uint64_t num_bo_allocs; /**< device buffers allocated by the pool */
+    uint32_t num_buffers; /**< device buffers owned by the pool */
+    uint32_t num_free_buffers; /**< device buffers ready for reuse */
+    uint64_t pool_size; /**< bytes of device memory owned by the pool */
+} XmaBufferPoolStats;
+
 /**
  * struct XmaBufferRef - Reference counted buffer used in XmaFrame and XmaDataBuffer
  *
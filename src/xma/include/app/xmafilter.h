@@ -79,7 +79,7 @@ typedef struct XmaFilterProperties
     /** count of custom parameters for port */
     uint32_t                 param_cnt;
     int32_t         dev_index;
-    int32_t         cu_index;
+    int32_t         cu_index;//With Runtime.xma_auto_placement, value of -1 implies that XMA should select the least loaded CU of the kernel in cu_name (on any device if dev_index is -1) and then XMA will set dev_index & cu_index used
     char            *cu_name;
     int32_t         ddr_bank_index;//Used for allocating device buffers. Used only if valid index is provide (>= 0); value of -1 imples that XMA should select automatically and then XMA will set it with bank index used automatically
     int32_t         channel_id;
@@ -0,0 +1,61 @@
+/**
+ * Copyright (C) 2020 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef xma_completion_lib_h_
+#define xma_completion_lib_h_
+
+#include "lib/xmahw_lib.h"
+
+/*
+ * CU command completion engine
+ *
+ * One thread per device blocks in xclExecWait while that device has
+ * commands in flight and sleeps on a condition variable when it has
+ * none.  When xclExecWait returns, only sessions of that device with
+ * commands in flight are checked, and each session whose command
+ * finished is woken through its completion_seq and condition variables.
+ * Waiters use completion_seq (or kernel_complete_count) as the wait
+ * predicate, so a completion can not be missed between checking the
+ * command state and starting to wait.
+ */
+namespace xma_core { namespace completion {
+
+// Start one completion thread per configured device
+void start(XmaHwCfg *hwcfg);
+// Wake the completion threads so they see xma_exit, which must already
+// be set.  Called from xma_exit, so it takes no locks.
+void stop();
+
+// Called after a CU command has been submitted for the session
+void cmd_submitted(XmaHwSessionPrivate *priv);
+
+// Called by check_all_execbo (with the session execbo lock held) when
+// at least one of the session's commands has completed
+void signal_session(XmaHwSessionPrivate *priv);
+
+// Wait up to timeout_ms for a completed command to be available to
+// xma_plg_is_work_item_done.  Returns true if one is.
+bool wait_work_item(XmaHwSessionPrivate *priv, uint32_t timeout_ms);
+
+// Wait up to timeout_ms for completion_seq to move past seen_seq.
+// Returns true if it did.
+bool wait_completion(XmaHwSessionPrivate *priv, std::condition_variable& cv,
+                     uint64_t seen_seq, uint32_t timeout_ms);
+
+} // namespace completion
+} // namespace xma_core
+
+#endif
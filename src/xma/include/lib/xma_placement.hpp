@@ -0,0 +1,77 @@
+/**
+ * Copyright (C) 2020 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef xma_placement_lib_h_
+#define xma_placement_lib_h_
+
+#include "lib/xmahw_lib.h"
+#include <string>
+
+/*
+ * Automatic session placement
+ *
+ * With Runtime.xma_auto_placement enabled, a session created with
+ * cu_index = -1 is placed on the CU with the lowest cost among the CUs
+ * of the kernel named by cu_name ("kernel" or "kernel:instance"), on
+ * all devices if dev_index is -1 or else on that device only.  The cost
+ * of a CU is computed from the statistics xma_thread1 keeps for the
+ * open sessions already using it:
+ *
+ *   session * sessions on the CU
+ * + busy    * sum of session busy fractions (cmd_busy vs cmd_idle)
+ * + cmds    * sum of session average cu cmds in flight
+ * + device  * sum of session busy fractions on the whole device
+ *
+ * Weights come from Runtime.xma_placement_cost.
+ */
+namespace xma_core { namespace placement {
+
+struct cost_model
+{
+    float session;
+    float busy;
+    float cmds;
+    float device;
+
+  cost_model() {
+    session = 0.25f;
+    busy = 1.0f;
+    cmds = 0.5f;
+    device = 0.1f;
+  }
+};
+
+// Parse "name=value,..." into model; unlisted weights are not changed
+int32_t parse_cost_model(const std::string& spec, cost_model& model);
+// Cost model from Runtime.xma_placement_cost
+const cost_model& get_cost_model();
+// Runtime.xma_auto_placement
+bool enabled();
+
+// Cost of placing one more session on kernel of device
+float cu_cost(const XmaHwDevice& device, const XmaHwKernel& kernel, const cost_model& model);
+
+// Select dev_index and cu_index for a new session of the kernel named by
+// cu_name. dev_index of -1 selects from all devices.  Takes the singleton lock.
+int32_t select_cu(int32_t& dev_index, int32_t& cu_index, const char* cu_name,
+                  const cost_model& model, const std::string& prefix);
+int32_t select_cu(int32_t& dev_index, int32_t& cu_index, const char* cu_name,
+                  const std::string& prefix);
+
+} // namespace placement
+} // namespace xma_core
+
+#endif
@@ -56,7 +56,6 @@ typedef struct XmaSingleton
 
     std::atomic<bool> xma_exit;
     std::thread       xma_thread1;
-    std::thread       xma_thread2;
 
     uint32_t          reserved[4];
 
@@ -99,15 +99,18 @@ typedef struct XmaHwExecBO
   }
 } XmaHwExecBO;
 
+//One size class of a buffer pool
 typedef struct XmaBufferPool
 {
     std::list<XmaBufferObj>   buffers_busy;
     std::vector<XmaBufferObj>  buffers_free;
-    std::atomic<bool> pool_locked;
+    std::atomic<bool> pool_locked;//Use pool lock when accessing above lists
     uint64_t buffer_size;
     int32_t  bank_index;
     int32_t  dev_index;
     bool     device_only_buffer;
+    bool     pool_destroyed;//Busy buffers are freed when released
+    xclDeviceHandle dev_handle;
     std::atomic<uint32_t> num_buffers;
     std::atomic<uint32_t> num_free_buffers;
     uint32_t reserved[4];
@@ -120,6 +123,8 @@ typedef struct XmaBufferPool
    bank_index = -1;
    dev_index = -1;
    device_only_buffer = false;
+   pool_destroyed = false;
+   dev_handle = NULL;
   }
 } XmaBufferPool;
 
@@ -129,8 +134,11 @@ typedef struct XmaBufferPoolObjPrivate
     uint64_t buffer_size;
     int32_t  bank_index;
     int32_t  dev_index;
-    XmaBufferPool* pool_ptr;
+    std::vector<XmaBufferPool*> size_classes;//Largest first; owned by session buffer_pools
     bool     device_only_buffer;
+    std::atomic<uint64_t> num_allocs;
+    std::atomic<uint64_t> num_hits;
+    std::atomic<uint64_t> num_bo_allocs;
     uint32_t reserved[4];
 
   XmaBufferPoolObjPrivate() {
@@ -138,8 +146,10 @@ typedef struct XmaBufferPoolObjPrivate
    buffer_size = 0;
    bank_index = -1;
    dev_index = -1;
-   pool_ptr = nullptr;
    device_only_buffer = false;
+   num_allocs = 0;
+   num_hits = 0;
+   num_bo_allocs = 0;
   }
 } XmaBufferPoolObjPrivate;
 
@@ -167,16 +177,18 @@ typedef struct XmaHwSessionPrivate
     std::condition_variable work_item_done_1plus;//Use with xma_plg_work_item_done
     std::condition_variable execbo_is_free; //Use with xma_plg_schedule_work_item and xma_plg_schedule_cu_cmd
     std::condition_variable kernel_done_or_free;//Use with xma_plg_cu_cmd_status; CU completion is must every outstanding cmd;
+    std::atomic<uint64_t> completion_seq;//Bumped for every check which changed cmd state; wait predicate for above cond variables
     xclBufferHandle  last_execbo_handle;
 
     std::vector<uint32_t> execbo_lru;
     std::vector<uint32_t> execbo_to_check;
     bool     using_work_item_done;
     bool     using_cu_cmd_status;
+    bool     session_closed;//Set by session destroy; session stays in all_sessions_vec
     std::atomic<bool> execbo_locked;
     std::vector<XmaHwExecBO> kernel_execbos;
     int32_t    num_execbo_allocated;
-    std::list<XmaBufferPool>   buffer_pools;
+    std::list<XmaBufferPool>   buffer_pools;//Size classes of session buffer pools; Use singleton lock when adding
 
     uint32_t reserved[4];
 
@@ -185,6 +197,7 @@ typedef struct XmaHwSessionPrivate
     kernel_info = NULL;
     kernel_complete_count = 0;
     kernel_complete_total = 0;
+    completion_seq = 0;
     device = NULL;
     num_cu_cmds = 0;
     num_cu_cmds_avg = 0;
@@ -200,6 +213,7 @@ typedef struct XmaHwSessionPrivate
     num_execbo_allocated = -1;
     using_work_item_done = false;
     using_cu_cmd_status = false;
+    session_closed = false;
     slowest_element = false;
     last_execbo_handle = NULLBO;
   }
@@ -216,6 +230,7 @@ typedef struct XmaBufferObjPrivate
     std::atomic<int32_t> ref_cnt;
     bool     device_only_buffer;
     xclDeviceHandle dev_handle;
+    XmaBufferPool* pool;//Size class owning this buffer; NULL if not from a buffer pool
     uint32_t reserved[4];
 
   XmaBufferObjPrivate() {
@@ -227,6 +242,7 @@ typedef struct XmaBufferObjPrivate
    dev_handle = NULL;
    device_only_buffer = false;
    boHandle = 0;
+   pool = nullptr;
   }
 } XmaBufferObjPrivate;
 
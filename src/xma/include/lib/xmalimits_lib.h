@@ -41,6 +41,9 @@
 #define XMA_NUM_EXECBO_MODE3    8
 #define XMA_NUM_EXECBO_MODE4    64
 
+#define XMA_BUFFER_POOL_SIZE_CLASSES  4//Buffer pool size classes: buffer_size, 1/2, 1/4, 1/8
+#define XMA_BUFFER_POOL_ALIGN         4096
+
 #define XMA_CPU_MODE1           1  //Low cpu load + high performance 
 #define XMA_CPU_MODE2           2  //High cpu load + high performance
 #define XMA_CPU_MODE3           3  //Same as legacy
@@ -134,6 +134,87 @@ xma_plg_buffer_alloc_ddr(XmaSession s_handle, size_t size, bool device_only_buff
  */
 void xma_plg_buffer_free(XmaSession s_handle, XmaBufferObj b_obj);
 
+/**
+ *  xma_plg_buffer_pool_create() - Create a pool of device buffers
+ *  Buffers released to the pool are kept allocated and mapped on the
+ *  host so that per frame buffers are not allocated, mapped and page
+ *  faulted again for every frame. The pool has size classes of
+ *  buffer_size, 1/2, 1/4 and 1/8 of buffer_size so that planes of
+ *  a frame can share one pool. Buffers are allocated on the DDR bank
+ *  of the session.
+ *
+ *  @s_handle: The session handle associated with this plugin instance.
+ *  @buffer_size: Size in bytes of the largest buffer of the pool
+ *  @device_only_buffer: Allocate device only buffers without any host space
+ *  @num_buffers: Buffers of buffer_size to preallocate
+ *  @return_code:  XMA_SUCESS or XMA_ERROR.
+ *
+ *  RETURN:    BufferPoolObject on success;
+ *
+ */
+XmaBufferPoolObj xma_plg_buffer_pool_create(XmaSession s_handle, size_t buffer_size, bool device_only_buffer,
+                                            uint32_t num_buffers, int32_t* return_code);
+
+/**
+ *  xma_plg_buffer_pool_alloc() - Allocate device buffer from a pool
+ *  Returns a free pooled buffer of the smallest size class that fits
+ *  size or else allocates a new device buffer for that class.
+ *  Reference count of the buffer is set to 1. The buffer returns to
+ *  the pool when its reference count drops to zero with
+ *  @ref xma_plg_buffer_pool_free() or @ref xma_plg_add_ref_cnt().
+ *
+ *  @s_handle: The session handle associated with this plugin instance.
+ *  @b_pool:   The BufferPoolObject returned from
+ *                   @ref xma_plg_buffer_pool_create()
+ *  @size:     Size in bytes; Must not be more than buffer_size of the pool
+ *  @return_code:  XMA_SUCESS or XMA_ERROR.
+ *
+ *  RETURN:    BufferObject on success;
+ *
+ */
+XmaBufferObj xma_plg_buffer_pool_alloc(XmaSession s_handle, XmaBufferPoolObj b_pool, size_t size, int32_t* return_code);
+
+/**
+ *  xma_plg_buffer_pool_free() - Release a pooled device buffer
+ *  Drops one reference of a buffer obtained using
+ *  @ref xma_plg_buffer_pool_alloc(). The buffer returns to its pool
+ *  when no reference is left.
+ *
+ *  @s_handle:  The session handle associated with this plugin instance
+ *  @b_obj:  The BufferObject returned from
+ *                   @ref xma_plg_buffer_pool_alloc()
+ *
+ */
+void xma_plg_buffer_pool_free(XmaSession s_handle, XmaBufferObj b_obj);
+
+/**
+ *  xma_plg_buffer_pool_stats() - Query usage counters of a pool
+ *
+ *  @b_pool:   The BufferPoolObject returned from
+ *                   @ref xma_plg_buffer_pool_create()
+ *  @stats:    Counters of the pool
+ *
+ *  RETURN:     XMA_SUCCESS on success
+ * XMA_ERROR on failure
+ *
+ */
+int32_t xma_plg_buffer_pool_stats(XmaBufferPoolObj b_pool, XmaBufferPoolStats* stats);
+
+/**
+ *  xma_plg_buffer_pool_destroy() - Destroy a pool of device buffers
+ *  Frees all free buffers of the pool. Buffers still in use are freed
+ *  when they are released.
+ *
+ *  @s_handle:  The session handle associated with this plugin instance
+ *  @b_pool:   The BufferPoolObject returned from
+ *                   @ref xma_plg_buffer_pool_create()
+ *
+ *  RETURN:     XMA_SUCCESS on success
+ * XMA_ERROR on failure
+ *
+ */
+int32_t xma_plg_buffer_pool_destroy(XmaSession s_handle, XmaBufferPoolObj b_pool);
+
 /**
  *  xma_plg_buffer_write() - Write data from host to device buffer
  *  This function copies data from host memory to device memory.
@@ -0,0 +1,190 @@
+/**
+ * Copyright (C) 2020 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "lib/xma_completion.hpp"
+#include "lib/xma_utils.hpp"
+#include "lib/xmaapi.h"
+#include "app/xmaerror.h"
+#include "app/xmalogger.h"
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#define XMACOMPLETION_MOD "xmacompletion"
+
+extern XmaSingleton *g_xma_singleton;
+
+namespace xma_core { namespace completion {
+
+namespace {
+
+struct device_engine
+{
+    XmaHwDevice *device;
+    std::mutex m_mutex;
+    std::condition_variable cmd_submitted;
+    std::atomic<uint64_t> submit_seq;
+    std::thread thread;
+
+  device_engine(XmaHwDevice *dev) : device(dev), submit_seq(0) {}
+};
+
+std::vector<std::unique_ptr<device_engine>> engines;
+
+device_engine* find_engine(XmaHwDevice *device) {
+    for (auto& engine: engines) {
+        if (engine->device == device) {
+            return engine.get();
+        }
+    }
+    return nullptr;
+}
+
+//Check the sessions of this device which have cu cmds in flight.
+//Returns true if any still has cmds in flight; retry is set if a
+//session was busy and could not be checked
+bool check_device_sessions(device_engine *engine, bool& retry) {
+    bool expected = false;
+    bool desired = true;
+    bool pending = false;
+    retry = false;
+    for (auto& itr1: g_xma_singleton->all_sessions_vec) {
+        if (g_xma_singleton->xma_exit) {
+            break;
+        }
+        XmaHwSessionPrivate *priv1 = (XmaHwSessionPrivate*) itr1.hw_session.private_do_not_use;
+        if (priv1 == nullptr || priv1->device != engine->device || priv1->num_cu_cmds == 0) {
+            continue;
+        }
+        //Submitters hold the execbo lock only briefly; wait for it a
+        //little rather than rescanning every session of the device
+        expected = false;
+        int32_t tries = 0;
+        while (!priv1->execbo_locked.compare_exchange_weak(expected, desired)) {
+            expected = false;
+            if (++tries == 16) {
+                break;
+            }
+            std::this_thread::yield();
+        }
+        if (tries == 16) {
+            pending = true;
+            retry = true;
+            continue;
+        }
+        //execbo lock acquired
+
+        if (xma_core::utils::check_all_execbo(itr1) != XMA_SUCCESS) {
+            xma_logmsg(XMA_ERROR_LOG, XMACOMPLETION_MOD, "Completion check failed. Unexpected error\n");
+        }
+        if (priv1->num_cu_cmds != 0) {
+            pending = true;
+        }
+        //Release execbo lock
+        priv1->execbo_locked = false;
+    }
+    return pending;
+}
+
+void completion_thread(device_engine *engine) {
+    while (!g_xma_singleton->xma_exit) {
+        uint64_t seen = engine->submit_seq;
+        bool retry = false;
+        bool pending = check_device_sessions(engine, retry);
+        if (retry) {
+            //A session holds its execbo lock; its completion may already be in
+            std::this_thread::yield();
+            continue;
+        }
+        if (!pending) {
+            //Nothing in flight on this device; sleep until a cmd is submitted
+            std::unique_lock<std::mutex> lk(engine->m_mutex);
+            engine->cmd_submitted.wait_for(lk, std::chrono::milliseconds(100), [engine, seen] {
+                return g_xma_singleton->xma_exit || engine->submit_seq != seen;
+            });
+            continue;
+        }
+        if (g_xma_singleton->cpu_mode == XMA_CPU_MODE2) {
+            //Debug mode: sessions also poll their own execbos
+            std::this_thread::sleep_for(std::chrono::milliseconds(3));
+        } else {
+            //Returns as soon as any cmd on this device completes
+            xclExecWait(engine->device->handle, 100);
+        }
+    }
+}
+
+} // namespace
+
+void start(XmaHwCfg *hwcfg) {
+    for (XmaHwDevice& hw_device: hwcfg->devices) {
+        engines.emplace_back(new device_engine(&hw_device));
+    }
+    for (auto& engine: engines) {
+        engine->thread = std::thread(completion_thread, engine.get());
+        //Detach like xma_thread1; threads exit once xma_exit is set
+        engine->thread.detach();
+    }
+}
+
+void stop() {
+    //May be called from the signal handler, so no locks and no joins.
+    //Idle threads also recheck xma_exit every 100 ms
+    for (auto& engine: engines) {
+        engine->cmd_submitted.notify_all();
+    }
+}
+
+void cmd_submitted(XmaHwSessionPrivate *priv) {
+    device_engine *engine = find_engine(priv->device);
+    if (engine == nullptr) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lk(engine->m_mutex);
+        engine->submit_seq++;
+    }
+    engine->cmd_submitted.notify_one();
+}
+
+void signal_session(XmaHwSessionPrivate *priv) {
+    priv->completion_seq++;
+    //A waiter is now either before its predicate check or blocked in wait
+    {
+        std::lock_guard<std::mutex> lk(priv->m_mutex);
+    }
+    priv->execbo_is_free.notify_all();
+    priv->work_item_done_1plus.notify_one();//Only one thread waits for work items
+    priv->kernel_done_or_free.notify_all();
+}
+
+bool wait_work_item(XmaHwSessionPrivate *priv, uint32_t timeout_ms) {
+    std::unique_lock<std::mutex> lk(priv->m_mutex);
+    return priv->work_item_done_1plus.wait_for(lk, std::chrono::milliseconds(timeout_ms), [priv] {
+        return priv->kernel_complete_count != 0;
+    });
+}
+
+bool wait_completion(XmaHwSessionPrivate *priv, std::condition_variable& cv,
+                     uint64_t seen_seq, uint32_t timeout_ms) {
+    std::unique_lock<std::mutex> lk(priv->m_mutex);
+    return cv.wait_for(lk, std::chrono::milliseconds(timeout_ms), [priv, seen_seq] {
+        return priv->completion_seq != seen_seq || g_xma_singleton->xma_exit;
+    });
+}
+
+} // namespace completion
+} // namespace xma_core
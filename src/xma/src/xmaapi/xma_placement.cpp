@@ -0,0 +1,184 @@
+/**
+ * Copyright (C) 2020 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "lib/xma_placement.hpp"
+#include "lib/xmaapi.h"
+#include "lib/xmalimits_lib.h"
+#include "app/xmaerror.h"
+#include "app/xmalogger.h"
+#include "core/common/config_reader.h"
+#include <cstdlib>
+#include <sstream>
+
+#define XMAPLACEMENT_MOD "xmaplacement"
+
+extern XmaSingleton *g_xma_singleton;
+
+namespace xma_core { namespace placement {
+
+namespace {
+
+std::string kernel_name(const char* cu_name) {
+    std::string name(cu_name);
+    return name.substr(0, name.find(':'));
+}
+
+float session_busy(XmaHwSessionPrivate *priv1) {
+    uint32_t busy = priv1->cmd_busy;
+    uint32_t idle = priv1->cmd_idle;
+    if (busy + idle == 0) {
+        return 0;
+    }
+    return busy / (float)(busy + idle);
+}
+
+//Same as session stats of get_session_cmd_load
+float session_avg_cmds(XmaHwSessionPrivate *priv1) {
+    if (priv1->num_cu_cmds_avg != 0) {
+        return priv1->num_cu_cmds_avg / STATS_WINDOW;
+    } else if (priv1->num_samples > 0) {
+        return priv1->num_cu_cmds_avg_tmp / ((float)priv1->num_samples);
+    }
+    return 0;
+}
+
+} // namespace
+
+int32_t parse_cost_model(const std::string& spec, cost_model& model) {
+    std::stringstream ss(spec);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (item.empty()) {
+            continue;
+        }
+        auto pos = item.find('=');
+        if (pos == std::string::npos) {
+            return XMA_ERROR;
+        }
+        std::string name = item.substr(0, pos);
+        std::string value = item.substr(pos + 1);
+        char* end = nullptr;
+        float weight = std::strtof(value.c_str(), &end);
+        if (value.empty() || *end != '\0' || weight < 0) {
+            return XMA_ERROR;
+        }
+        if (name == "session") {
+            model.session = weight;
+        } else if (name == "busy") {
+            model.busy = weight;
+        } else if (name == "cmds") {
+            model.cmds = weight;
+        } else if (name == "device") {
+            model.device = weight;
+        } else {
+            return XMA_ERROR;
+        }
+    }
+    return XMA_SUCCESS;
+}
+
+const cost_model& get_cost_model() {
+    static cost_model model = [] {
+        cost_model tmp;
+        std::string spec = xrt_core::config::get_xma_placement_cost();
+        if (parse_cost_model(spec, tmp) != XMA_SUCCESS) {
+            xma_logmsg(XMA_WARNING_LOG, XMAPLACEMENT_MOD, "Invalid xma_placement_cost: %s. Using default cost model", spec.c_str());
+            tmp = cost_model();
+        }
+        return tmp;
+    }();
+    return model;
+}
+
+bool enabled() {
+    return xrt_core::config::get_xma_auto_placement();
+}
+
+float cu_cost(const XmaHwDevice& device, const XmaHwKernel& kernel, const cost_model& model) {
+    //singleton should be locked before calling this function
+    float sessions = 0;
+    float busy = 0;
+    float cmds = 0;
+    float device_busy = 0;
+    for (auto& itr1: g_xma_singleton->all_sessions_vec) {
+        XmaHwSessionPrivate *priv1 = (XmaHwSessionPrivate*) itr1.hw_session.private_do_not_use;
+        if (priv1 == nullptr || priv1->session_closed || priv1->device != &device) {
+            continue;
+        }
+        float session_busy1 = session_busy(priv1);
+        device_busy += session_busy1;
+        if (priv1->kernel_info != &kernel) {
+            continue;
+        }
+        sessions++;
+        busy += session_busy1;
+        cmds += session_avg_cmds(priv1);
+    }
+    return model.session * sessions + model.busy * busy + model.cmds * cmds + model.device * device_busy;
+}
+
+int32_t select_cu(int32_t& dev_index, int32_t& cu_index, const char* cu_name,
+                  const cost_model& model, const std::string& prefix) {
+    if (cu_name == nullptr) {
+        xma_logmsg(XMA_ERROR_LOG, prefix.c_str(),
+                   "XMA session creation failed. Automatic placement requires cu_name with the kernel name\n");
+        return XMA_ERROR;
+    }
+    std::string name = kernel_name(cu_name);
+
+    std::lock_guard<std::mutex> guard1(g_xma_singleton->m_mutex);
+    //Singleton lock acquired
+
+    XmaHwDevice* best_device = nullptr;
+    XmaHwKernel* best_kernel = nullptr;
+    float best_cost = 0;
+    for (XmaHwDevice& hw_device: g_xma_singleton->hwcfg.devices) {
+        if (dev_index >= 0 && hw_device.dev_index != (uint32_t)dev_index) {
+            continue;
+        }
+        for (XmaHwKernel& kernel: hw_device.kernels) {
+            if (kernel_name((char*)kernel.name) != name) {
+                continue;
+            }
+            float cost = cu_cost(hw_device, kernel, model);
+            //Ties go to the first CU, as with first-fit
+            if (best_kernel == nullptr || cost < best_cost) {
+                best_device = &hw_device;
+                best_kernel = &kernel;
+                best_cost = cost;
+            }
+        }
+    }
+    if (best_kernel == nullptr) {
+        xma_logmsg(XMA_ERROR_LOG, prefix.c_str(),
+                   "XMA session creation failed. No CU of kernel %s found\n", name.c_str());
+        return XMA_ERROR;
+    }
+
+    dev_index = best_device->dev_index;
+    cu_index = best_kernel->cu_index;
+    xma_logmsg(XMA_INFO_LOG, prefix.c_str(),
+               "XMA automatic placement: dev_index: %d, CU: %s, cost: %.2f\n", dev_index, best_kernel->name, best_cost);
+    return XMA_SUCCESS;
+}
+
+int32_t select_cu(int32_t& dev_index, int32_t& cu_index, const char* cu_name,
+                  const std::string& prefix) {
+    return select_cu(dev_index, cu_index, cu_name, get_cost_model(), prefix);
+}
+
+} // namespace placement
+} // namespace xma_core
@@ -16,6 +16,7 @@
 
 #include "app/xma_utils.hpp"
 #include "lib/xma_utils.hpp"
+#include "lib/xma_completion.hpp"
 #include "app/xmaerror.h"
 #include "app/xmalogger.h"
 #include "app/xmaparam.h"
@@ -543,6 +544,7 @@ int32_t check_all_execbo(XmaSession s_handle) {
 
     if (g_xma_singleton->cpu_mode == XMA_CPU_MODE2) {
         bool notify_execbo_is_free = false;
+        bool completed = false;
         if (priv1->num_cu_cmds != 0) {
             int32_t i;
             int32_t num_execbo = priv1->num_execbo_allocated;
@@ -557,6 +559,7 @@ int32_t check_all_execbo(XmaSession s_handle) {
                             priv1->kernel_complete_total++;
                         }
                         notify_execbo_is_free = true;
+                        completed = true;
                         ebo.in_use = false;
                         cu_cmd->state = ERT_CMD_STATE_MAX;
                         priv1->CU_cmds.erase(ebo.cu_cmd_id1);
@@ -574,7 +577,9 @@ int32_t check_all_execbo(XmaSession s_handle) {
             notify_execbo_is_free = true;
         }
         //In this mode schedule_work_item still waits for this
-        if (notify_execbo_is_free) {
+        if (completed) {
+            xma_core::completion::signal_session(priv1);
+        } else if (notify_execbo_is_free) {
             priv1->execbo_is_free.notify_all();
         }
     } else {
@@ -616,18 +621,18 @@ int32_t check_all_execbo(XmaSession s_handle) {
                 }
             }
 
-            if (notify_execbo_is_free) {
-                priv1->execbo_is_free.notify_all();
-            }
             if (notify_work_item_done_1plus) {
-                priv1->work_item_done_1plus.notify_one();//Unblock one thread;Though only one is used anyway
+                //Wake exactly the waiters of this session
+                xma_core::completion::signal_session(priv1);
                 if (priv1->slowest_element) {
                     std::this_thread::yield();
                 }
-            } else if (priv1->kernel_complete_count != 0) {
-                priv1->work_item_done_1plus.notify_one();//Unblock one thread;Though only one is used anyway
-                if (priv1->slowest_element) {
-                    std::this_thread::yield();
+            } else {
+                if (notify_execbo_is_free) {
+                    priv1->execbo_is_free.notify_all();
+                }
+                if (priv1->kernel_complete_count != 0) {
+                    priv1->work_item_done_1plus.notify_one();//Unblock one thread;Though only one is used anyway
                 }
             }
         } else {
@@ -247,6 +247,8 @@ xma_admin_session_destroy(XmaAdminSession *session)
     /*
     delete (XmaHwSessionPrivate*)session->base.hw_session.private_do_not_use;
     */
+    //Session stays in all_sessions_vec; exclude it from automatic placement
+    ((XmaHwSessionPrivate*)session->base.hw_session.private_do_not_use)->session_closed = true;
     session->base.hw_session.private_do_not_use = nullptr;
     session->base.plugin_data = nullptr;
     session->base.stats = NULL;
@@ -28,6 +28,7 @@
 #include "lib/xmalogger.h"
 #include "app/xma_utils.hpp"
 #include "lib/xma_utils.hpp"
+#include "lib/xma_completion.hpp"
 #include <iostream>
 #include <thread>
 #include <algorithm>
@@ -248,58 +249,6 @@ void xma_thread1() {
     xclLogMsg(NULL, XRT_INFO, "XMA-Session-Stats", "--------\n");
 }
 
-void xma_thread2() {
-    bool expected = false;
-    bool desired = true;
-    int32_t session_index = 0;
-    int32_t num_sessions = -1;
-    while (!g_xma_singleton->xma_exit) {
-        num_sessions = g_xma_singleton->all_sessions_vec.size();
-        if (num_sessions == 0) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(30));
-            continue;
-        }
-        if (session_index >= num_sessions) {
-            session_index = 0;
-        }
-        XmaHwSessionPrivate *priv2 = (XmaHwSessionPrivate*) g_xma_singleton->all_sessions_vec[session_index].hw_session.private_do_not_use;
-        if (g_xma_singleton->cpu_mode == XMA_CPU_MODE2) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(3));
-        } else {
-            xclExecWait(priv2->dev_handle, 100);
-        }
-        session_index++;
-
-        for (auto& itr1: g_xma_singleton->all_sessions_vec) {
-            if (g_xma_singleton->xma_exit) {
-                break;
-            }
-            XmaHwSessionPrivate *priv1 = (XmaHwSessionPrivate*) itr1.hw_session.private_do_not_use;
-            expected = false;
-/*
-            while (!priv1->execbo_locked.compare_exchange_weak(expected, desired)) {
-                std::this_thread::yield();
-                expected = false;
-            }
-*/
-            if (!priv1->execbo_locked.compare_exchange_weak(expected, desired)) {
-                continue;
-            }
-            //execbo lock acquired
-
-            if (xma_core::utils::check_all_execbo(itr1) != XMA_SUCCESS) {
-                xma_logmsg(XMA_ERROR_LOG, XMAAPI_MOD, "XMA thread2 failed-4. Unexpected error\n");
-                //Release execbo lock
-                priv1->execbo_locked = false;
-                continue;
-            }
-
-            //Release execbo lock
-            priv1->execbo_locked = false;
-        }
-    }
-}
-
 void xma_get_session_cmd_load() {
     xma_core::utils::get_session_cmd_load();
 }
@@ -423,10 +372,10 @@ int32_t xma_initialize(XmaXclbinParameter *devXclbins, int32_t num_parms)
     }
 
     g_xma_singleton->xma_thread1 = std::thread(xma_thread1);
-    g_xma_singleton->xma_thread2 = std::thread(xma_thread2);
     //Detach threads to let them run independently
     g_xma_singleton->xma_thread1.detach();
-    g_xma_singleton->xma_thread2.detach();
+    //CU cmd completions are handled by one thread per device
+    xma_core::completion::start(&g_xma_singleton->hwcfg);
 
     xma_init_sighandlers();
 
@@ -438,6 +387,7 @@ void xma_exit(void)
 {
     if (g_xma_singleton) {
         g_xma_singleton->xma_exit = true;
+        xma_core::completion::stop();
     }
     std::this_thread::sleep_for(std::chrono::milliseconds(100));
 }
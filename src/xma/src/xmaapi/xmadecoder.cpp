@@ -21,6 +21,7 @@
 #include "lib/xmaapi.h"
 #include "app/xma_utils.hpp"
 #include "lib/xma_utils.hpp"
+#include "lib/xma_placement.hpp"
 //#include "lib/xmahw_hal.h"
 //#include "lib/xmares.h"
 #include "app/xmalogger.h"
@@ -93,6 +94,16 @@ xma_dec_session_create(XmaDecoderProperties *dec_props)
     dev_index = dec_props->dev_index;
     cu_index = dec_props->cu_index;
     
+    if (cu_index < 0 && xma_core::placement::enabled()) {
+        //Pick the least loaded CU of the kernel; dev_index of -1 means any device
+        if (xma_core::placement::select_cu(dev_index, cu_index, dec_props->cu_name, XMA_DECODER_MOD) != XMA_SUCCESS) {
+            free(dec_session);
+            return nullptr;
+        }
+        dec_session->decoder_props.dev_index = dev_index;
+        dec_session->decoder_props.cu_index = cu_index;
+    }
+
     XmaHwCfg *hwcfg = &g_xma_singleton->hwcfg;
     if (dev_index >= hwcfg->num_devices || dev_index < 0) {
         xma_logmsg(XMA_ERROR_LOG, XMA_DECODER_MOD,
@@ -287,6 +298,8 @@ xma_dec_session_destroy(XmaDecoderSession *session)
     // Clean up the private data
     free(session->base.plugin_data);
 
+    //Session stays in all_sessions_vec; exclude it from automatic placement
+    ((XmaHwSessionPrivate*)session->base.hw_session.private_do_not_use)->session_closed = true;
     session->base.hw_session.private_do_not_use = nullptr;
     session->base.plugin_data = nullptr;
     session->base.stats = NULL;
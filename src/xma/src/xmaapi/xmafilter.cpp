@@ -21,6 +21,7 @@
 #include "lib/xmaapi.h"
 #include "app/xma_utils.hpp"
 #include "lib/xma_utils.hpp"
+#include "lib/xma_placement.hpp"
 //#include "lib/xmahw_hal.h"
 //#include "lib/xmares.h"
 #include "xmaplugin.h"
@@ -91,6 +92,16 @@ xma_filter_session_create(XmaFilterProperties *filter_props)
     dev_index = filter_props->dev_index;
     cu_index = filter_props->cu_index;
 
+    if (cu_index < 0 && xma_core::placement::enabled()) {
+        //Pick the least loaded CU of the kernel; dev_index of -1 means any device
+        if (xma_core::placement::select_cu(dev_index, cu_index, filter_props->cu_name, XMA_FILTER_MOD) != XMA_SUCCESS) {
+            free(filter_session);
+            return nullptr;
+        }
+        filter_session->props.dev_index = dev_index;
+        filter_session->props.cu_index = cu_index;
+    }
+
     XmaHwCfg *hwcfg = &g_xma_singleton->hwcfg;
     if (dev_index >= hwcfg->num_devices || dev_index < 0) {
         xma_logmsg(XMA_ERROR_LOG, XMA_FILTER_MOD,
@@ -291,6 +302,8 @@ xma_filter_session_destroy(XmaFilterSession *session)
     /*
     delete (XmaHwSessionPrivate*)session->base.hw_session.private_do_not_use;
     */
+    //Session stays in all_sessions_vec; exclude it from automatic placement
+    ((XmaHwSessionPrivate*)session->base.hw_session.private_do_not_use)->session_closed = true;
     session->base.hw_session.private_do_not_use = nullptr;
     session->base.plugin_data = nullptr;
     session->base.stats = NULL;
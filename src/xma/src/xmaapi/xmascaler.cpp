@@ -21,6 +21,7 @@
 #include "lib/xmaapi.h"
 #include "app/xma_utils.hpp"
 #include "lib/xma_utils.hpp"
+#include "lib/xma_placement.hpp"
 #include "xmaplugin.h"
 #include <bitset>
 
@@ -184,6 +185,16 @@ xma_scaler_session_create(XmaScalerProperties *sc_props)
     dev_index = sc_props->dev_index;
     cu_index = sc_props->cu_index;
 
+    if (cu_index < 0 && xma_core::placement::enabled()) {
+        //Pick the least loaded CU of the kernel; dev_index of -1 means any device
+        if (xma_core::placement::select_cu(dev_index, cu_index, sc_props->cu_name, XMA_SCALER_MOD) != XMA_SUCCESS) {
+            free(sc_session);
+            return nullptr;
+        }
+        sc_session->props.dev_index = dev_index;
+        sc_session->props.cu_index = cu_index;
+    }
+
     XmaHwCfg *hwcfg = &g_xma_singleton->hwcfg;
     if (dev_index >= hwcfg->num_devices || dev_index < 0) {
         xma_logmsg(XMA_ERROR_LOG, XMA_SCALER_MOD,
@@ -390,6 +401,8 @@ xma_scaler_session_destroy(XmaScalerSession *session)
     /*
     delete (XmaHwSessionPrivate*)session->base.hw_session.private_do_not_use;
     */
+    //Session stays in all_sessions_vec; exclude it from automatic placement
+    ((XmaHwSessionPrivate*)session->base.hw_session.private_do_not_use)->session_closed = true;
     session->base.hw_session.private_do_not_use = nullptr;
     session->base.plugin_data = nullptr;
     session->base.stats = NULL;
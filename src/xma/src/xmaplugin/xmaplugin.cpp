@@ -21,6 +21,7 @@
 #include "lib/xmaapi.h"
 #include "app/xma_utils.hpp"
 #include "lib/xma_utils.hpp"
+#include "lib/xma_completion.hpp"
 
 #include <cstdio>
 #include <iostream>
@@ -327,6 +328,10 @@ xma_plg_buffer_free(XmaSession s_handle, XmaBufferObj b_obj)
         return;
     }
     XmaBufferObjPrivate* b_obj_priv = (XmaBufferObjPrivate*) b_obj.private_do_not_touch;
+    if (b_obj_priv->pool != nullptr) {
+        xma_logmsg(XMA_ERROR_LOG, XMAPLUGIN_MOD, "xma_plg_buffer_free failed. XMABufferObj is from a buffer pool. Use xma_plg_buffer_pool_free");
+        return;
+    }
     //xclDeviceHandle dev_handle = s_handle.hw_session.dev_handle;
     xclFreeBO(b_obj_priv->dev_handle, b_obj_priv->boHandle);
     b_obj_priv->dummy = nullptr;
@@ -336,6 +341,331 @@ xma_plg_buffer_free(XmaSession s_handle, XmaBufferObj b_obj)
     delete b_obj_priv;
 }
 
+namespace {
+
+void pool_lock(XmaBufferPool* pool) {
+    bool expected = false;
+    bool desired = true;
+    while (!pool->pool_locked.compare_exchange_weak(expected, desired)) {
+        std::this_thread::yield();
+        expected = false;
+    }
+}
+
+void pool_unlock(XmaBufferPool* pool) {
+    pool->pool_locked = false;
+}
+
+int32_t check_buffer_pool(XmaBufferPoolObj* b_pool) {
+    XmaBufferPoolObjPrivate* pool_priv = (XmaBufferPoolObjPrivate*) b_pool->private_do_not_touch;
+    if (pool_priv == nullptr) {
+        xma_logmsg(XMA_ERROR_LOG, XMAPLUGIN_MOD, "xma_check_buffer_pool failed. XMABufferPoolObj failed allocation");
+        return XMA_ERROR;
+    }
+    if (pool_priv->dummy != (void*)(((uint64_t)pool_priv) | signature)) {
+        xma_logmsg(XMA_ERROR_LOG, XMAPLUGIN_MOD, "xma_check_buffer_pool failed. XMABufferPoolObj is corrupted.");
+        return XMA_ERROR;
+    }
+    return XMA_SUCCESS;
+}
+
+void free_pool_bo(XmaBufferPool* pool, XmaBufferObjPrivate* b_obj_priv) {
+    xclFreeBO(b_obj_priv->dev_handle, b_obj_priv->boHandle);
+    b_obj_priv->dummy = nullptr;
+    b_obj_priv->size = -1;
+    b_obj_priv->bank_index = -1;
+    b_obj_priv->dev_index = -1;
+    delete b_obj_priv;
+    pool->num_buffers--;
+}
+
+//Allocate a new device buffer for size class; Mapped host pages are faulted in here
+int32_t create_pool_bo(XmaBufferPool* pool, XmaBufferObj& b_obj) {
+    b_obj.data = nullptr;
+    b_obj.user_ptr = nullptr;
+    b_obj.device_only_buffer = false;
+    b_obj.private_do_not_touch = nullptr;
+    b_obj.size = pool->buffer_size;
+    b_obj.bank_index = pool->bank_index;
+    b_obj.dev_index = pool->dev_index;
+
+    xclBufferHandle b_obj_handle = 0;
+    if (create_bo(pool->dev_handle, b_obj, pool->buffer_size, pool->bank_index, pool->device_only_buffer, b_obj_handle) != XMA_SUCCESS) {
+        return XMA_ERROR;
+    }
+    if (b_obj.data != nullptr) {
+        for (uint64_t i = 0; i < pool->buffer_size; i += XMA_BUFFER_POOL_ALIGN) {
+            ((volatile uint8_t*)b_obj.data)[i] = 0;
+        }
+    }
+
+    XmaBufferObjPrivate* tmp1 = new XmaBufferObjPrivate;
+    b_obj.private_do_not_touch = (void*) tmp1;
+    tmp1->dummy = (void*)(((uint64_t)tmp1) | signature);
+    tmp1->size = pool->buffer_size;
+    tmp1->paddr = b_obj.paddr;
+    tmp1->bank_index = b_obj.bank_index;
+    tmp1->dev_index = b_obj.dev_index;
+    tmp1->boHandle = b_obj_handle;
+    tmp1->device_only_buffer = b_obj.device_only_buffer;
+    tmp1->dev_handle = pool->dev_handle;
+    tmp1->pool = pool;
+    pool->num_buffers++;
+    return XMA_SUCCESS;
+}
+
+//Return buffer with no references left to its size class
+void release_pool_bo(XmaBufferObj* b_obj) {
+    XmaBufferObjPrivate* b_obj_priv = (XmaBufferObjPrivate*) b_obj->private_do_not_touch;
+    XmaBufferPool* pool = b_obj_priv->pool;
+    XmaBufferObj tmp_obj = *b_obj;
+    tmp_obj.user_ptr = nullptr;
+    tmp_obj.size = pool->buffer_size;
+
+    pool_lock(pool);
+    if (pool->pool_destroyed) {
+        pool_unlock(pool);
+        free_pool_bo(pool, b_obj_priv);
+        return;
+    }
+    pool->buffers_free.emplace_back(tmp_obj);
+    pool->num_free_buffers++;
+    pool_unlock(pool);
+}
+
+} // namespace
+
+XmaBufferPoolObj
+xma_plg_buffer_pool_create(XmaSession s_handle, size_t buffer_size, bool device_only_buffer,
+                           uint32_t num_buffers, int32_t* return_code)
+{
+    XmaBufferPoolObj b_pool;
+    b_pool.buffer_size = 0;
+    b_pool.bank_index = -1;
+    b_pool.dev_index = -1;
+    b_pool.device_only_buffer = false;
+    b_pool.private_do_not_touch = nullptr;
+
+    if (xma_core::utils::check_xma_session(s_handle) != XMA_SUCCESS) {
+        xma_logmsg(XMA_ERROR_LOG, XMAPLUGIN_MOD, "xma_plg_buffer_pool_create failed. XMASession is corrupted.");
+        if (return_code) *return_code = XMA_ERROR;
+        return b_pool;
+    }
+    if (s_handle.session_type >= XMA_ADMIN) {
+        xma_logmsg(XMA_ERROR_LOG, XMAPLUGIN_MOD, "xma_plg_buffer_pool_create can not be used for this XMASession type");
+        if (return_code) *return_code = XMA_ERROR;
+        return b_pool;
+    }
+    if (s_handle.hw_session.bank_index < 0) {
+        xma_logmsg(XMA_ERROR_LOG, XMAPLUGIN_MOD, "xma_plg_buffer_pool_create can not be used for this XMASession as kernel not connected to any DDR");
+        if (return_code) *return_code = XMA_ERROR;
+        return b_pool;
+    }
+    if (buffer_size == 0 || buffer_size > UINT32_MAX) {
+        xma_logmsg(XMA_ERROR_LOG, XMAPLUGIN_MOD, "xma_plg_buffer_pool_create failed. Invalid buffer_size: %lu", (uint64_t)buffer_size);
+        if (return_code) *return_code = XMA_ERROR;
+        return b_pool;
+    }
+    if (!g_xma_singleton) {
+        xma_logmsg(XMA_ERROR_LOG, XMAPLUGIN_MOD, "xma_plg_buffer_pool_create: libxmaplugin can not be used without loading libxmaapi");
+        if (return_code) *return_code = XMA_ERROR;
+        return b_pool;
+    }
+    XmaHwSessionPrivate *priv1 = (XmaHwSessionPrivate*) s_handle.hw_session.private_do_not_use;
+
+    XmaBufferPoolObjPrivate* pool_priv = new XmaBufferPoolObjPrivate;
+    pool_priv->buffer_size = buffer_size;
+    pool_priv->bank_index = s_handle.hw_session.bank_index;
+    pool_priv->dev_index = s_handle.hw_session.dev_index;
+    pool_priv->device_only_buffer = device_only_buffer;
+    {
+        std::lock_guard<std::mutex> guard1(g_xma_singleton->m_mutex);
+        //Singleton lock acquired
+
+        //Size classes are rounded up to page size
+        uint64_t class_size = buffer_size;
+        for (uint32_t i = 0; i < XMA_BUFFER_POOL_SIZE_CLASSES; i++) {
+            uint64_t tmp_size = ((class_size + XMA_BUFFER_POOL_ALIGN - 1) / XMA_BUFFER_POOL_ALIGN) * XMA_BUFFER_POOL_ALIGN;
+            if (i > 0 && tmp_size >= pool_priv->size_classes.back()->buffer_size) {
+                break;
+            }
+            priv1->buffer_pools.emplace_back();
+            XmaBufferPool* pool = &priv1->buffer_pools.back();
+            pool->buffer_size = tmp_size;
+            pool->bank_index = pool_priv->bank_index;
+            pool->dev_index = pool_priv->dev_index;
+            pool->device_only_buffer = device_only_buffer;
+            pool->dev_handle = priv1->dev_handle;
+            pool_priv->size_classes.emplace_back(pool);
+            class_size = class_size / 2;
+        }
+    }
+    pool_priv->dummy = (void*)(((uint64_t)pool_priv) | signature);
+    b_pool.buffer_size = pool_priv->size_classes.front()->buffer_size;
+    b_pool.bank_index = pool_priv->bank_index;
+    b_pool.dev_index = pool_priv->dev_index;
+    b_pool.device_only_buffer = device_only_buffer;
+    b_pool.private_do_not_touch = (void*) pool_priv;
+
+    XmaBufferPool* pool = pool_priv->size_classes.front();
+    for (uint32_t i = 0; i < num_buffers; i++) {
+        XmaBufferObj b_obj;
+        if (create_pool_bo(pool, b_obj) != XMA_SUCCESS) {
+            xma_logmsg(XMA_ERROR_LOG, XMAPLUGIN_MOD, "xma_plg_buffer_pool_create failed to allocate device buffers");
+            xma_plg_buffer_pool_destroy(s_handle, b_pool);
+            b_pool.private_do_not_touch = nullptr;
+            if (return_code) *return_code = XMA_ERROR;
+            return b_pool;
+        }
+        pool->buffers_free.emplace_back(b_obj);
+        pool->num_free_buffers++;
+        pool_priv->num_bo_allocs++;
+    }
+
+    if (return_code) *return_code = XMA_SUCCESS;
+    return b_pool;
+}
+
+XmaBufferObj
+xma_plg_buffer_pool_alloc(XmaSession s_handle, XmaBufferPoolObj b_pool, size_t size, int32_t* return_code)
+{
+    XmaBufferObj b_obj;
+    b_obj.data = nullptr;
+    b_obj.size = 0;
+    b_obj.paddr = 0;
+    b_obj.bank_index = -1;
+    b_obj.dev_index = -1;
+    b_obj.user_ptr = nullptr;
+    b_obj.device_only_buffer = false;
+    b_obj.private_do_not_touch = nullptr;
+
+    if (xma_core::utils::check_xma_session(s_handle) != XMA_SUCCESS) {
+        xma_logmsg(XMA_ERROR_LOG, XMAPLUGIN_MOD, "xma_plg_buffer_pool_alloc failed. XMASession is corrupted.");
+        if (return_code) *return_code = XMA_ERROR;
+        return b_obj;
+    }
+    if (check_buffer_pool(&b_pool) != XMA_SUCCESS) {
+        if (return_code) *return_code = XMA_ERROR;
+        return b_obj;
+    }
+    XmaBufferPoolObjPrivate* pool_priv = (XmaBufferPoolObjPrivate*) b_pool.private_do_not_touch;
+    XmaBufferPool* pool = nullptr;
+    //Smallest size class that fits
+    for (auto itr = pool_priv->size_classes.rbegin(); itr != pool_priv->size_classes.rend(); itr++) {
+        if ((*itr)->buffer_size >= size) {
+            pool = *itr;
+            break;
+        }
+    }
+    if (pool == nullptr || size == 0) {
+        xma_logmsg(XMA_ERROR_LOG, XMAPLUGIN_MOD, "xma_plg_buffer_pool_alloc failed. Invalid size: %lu; Pool buffer_size is %lu",
+                   (uint64_t)size, (uint64_t)b_pool.buffer_size);
+        if (return_code) *return_code = XMA_ERROR;
+        return b_obj;
+    }
+
+    pool_priv->num_allocs++;
+    bool found = false;
+    pool_lock(pool);
+    if (!pool->buffers_free.empty()) {
+        b_obj = pool->buffers_free.back();
+        pool->buffers_free.pop_back();
+        pool->num_free_buffers--;
+        found = true;
+    }
+    pool_unlock(pool);
+
+    if (found) {
+        pool_priv->num_hits++;
+    } else {
+        if (create_pool_bo(pool, b_obj) != XMA_SUCCESS) {
+            b_obj.private_do_not_touch = nullptr;
+            if (return_code) *return_code = XMA_ERROR;
+            return b_obj;
+        }
+        pool_priv->num_bo_allocs++;
+    }
+    XmaBufferObjPrivate* b_obj_priv = (XmaBufferObjPrivate*) b_obj.private_do_not_touch;
+    b_obj_priv->ref_cnt = 1;
+
+    if (return_code) *return_code = XMA_SUCCESS;
+    return b_obj;
+}
+
+void
+xma_plg_buffer_pool_free(XmaSession s_handle, XmaBufferObj b_obj)
+{
+    if (xma_core::utils::check_xma_session(s_handle) != XMA_SUCCESS) {
+        xma_logmsg(XMA_ERROR_LOG, XMAPLUGIN_MOD, "xma_plg_buffer_pool_free failed. XMASession is corrupted.");
+        return;
+    }
+    if (xma_check_device_buffer(&b_obj) != XMA_SUCCESS) {
+        return;
+    }
+    XmaBufferObjPrivate* b_obj_priv = (XmaBufferObjPrivate*) b_obj.private_do_not_touch;
+    if (b_obj_priv->pool == nullptr) {
+        xma_logmsg(XMA_ERROR_LOG, XMAPLUGIN_MOD, "xma_plg_buffer_pool_free failed. XMABufferObj is not from a buffer pool. Use xma_plg_buffer_free");
+        return;
+    }
+    int32_t ref_cnt = --b_obj_priv->ref_cnt;
+    if (ref_cnt == 0) {
+        release_pool_bo(&b_obj);
+    } else if (ref_cnt < 0) {
+        xma_logmsg(XMA_ERROR_LOG, XMAPLUGIN_MOD, "xma_plg_buffer_pool_free failed. XMABufferObj is already free");
+        b_obj_priv->ref_cnt++;
+    }
+}
+
+int32_t
+xma_plg_buffer_pool_stats(XmaBufferPoolObj b_pool, XmaBufferPoolStats* stats)
+{
+    if (stats == nullptr || check_buffer_pool(&b_pool) != XMA_SUCCESS) {
+        return XMA_ERROR;
+    }
+    XmaBufferPoolObjPrivate* pool_priv = (XmaBufferPoolObjPrivate*) b_pool.private_do_not_touch;
+    stats->num_allocs = pool_priv->num_allocs;
+    stats->num_hits = pool_priv->num_hits;
+    stats->num_bo_allocs = pool_priv->num_bo_allocs;
+    stats->num_buffers = 0;
+    stats->num_free_buffers = 0;
+    stats->pool_size = 0;
+    for (XmaBufferPool* pool: pool_priv->size_classes) {
+        uint32_t num_buffers = pool->num_buffers;
+        stats->num_buffers += num_buffers;
+        stats->num_free_buffers += pool->num_free_buffers;
+        stats->pool_size += num_buffers * pool->buffer_size;
+    }
+    return XMA_SUCCESS;
+}
+
+int32_t
+xma_plg_buffer_pool_destroy(XmaSession s_handle, XmaBufferPoolObj b_pool)
+{
+    if (xma_core::utils::check_xma_session(s_handle) != XMA_SUCCESS) {
+        xma_logmsg(XMA_ERROR_LOG, XMAPLUGIN_MOD, "xma_plg_buffer_pool_destroy failed. XMASession is corrupted.");
+        return XMA_ERROR;
+    }
+    if (check_buffer_pool(&b_pool) != XMA_SUCCESS) {
+        return XMA_ERROR;
+    }
+    XmaBufferPoolObjPrivate* pool_priv = (XmaBufferPoolObjPrivate*) b_pool.private_do_not_touch;
+    pool_priv->dummy = nullptr;
+    //Size classes stay in session buffer_pools as busy buffers point to them
+    for (XmaBufferPool* pool: pool_priv->size_classes) {
+        std::vector<XmaBufferObj> buffers_free;
+        pool_lock(pool);
+        pool->pool_destroyed = true;
+        buffers_free.swap(pool->buffers_free);
+        pool->num_free_buffers = 0;
+        pool_unlock(pool);
+        for (XmaBufferObj& b_obj: buffers_free) {
+            free_pool_bo(pool, (XmaBufferObjPrivate*) b_obj.private_do_not_touch);
+        }
+    }
+    delete pool_priv;
+    return XMA_SUCCESS;
+}
+
 int32_t
 xma_plg_buffer_write(XmaSession s_handle,
                      XmaBufferObj  b_obj,
@@ -556,15 +886,15 @@ XmaCUCmdObj xma_plg_schedule_work_item(XmaSession s_handle,
             break;
         }
         xma_logmsg(XMA_DEBUG_LOG, XMAPLUGIN_MOD, "No available execbo found");
+        //Read before releasing the lock so that a completion in between is not missed
+        uint64_t seen_seq = priv1->completion_seq;
         priv1->execbo_locked = false;
         if (itr > 15) {
             xma_logmsg(XMA_ERROR_LOG, XMAPLUGIN_MOD, "Unable to find free execbo to use\n");
             if (return_code) *return_code = XMA_ERROR;
             return cmd_obj_error;
         }
-        std::unique_lock<std::mutex> lk(priv1->m_mutex);
-        priv1->execbo_is_free.wait(lk);
-        lk.unlock();
+        xma_core::completion::wait_completion(priv1, priv1->execbo_is_free, seen_seq, 100);
         itr++;
     }
 
@@ -672,6 +1002,8 @@ XmaCUCmdObj xma_plg_schedule_work_item(XmaSession s_handle,
     //xma_logmsg(XMA_DEBUG_LOG, XMAPLUGIN_MOD, "2. Num of cmds in-progress = %lu", priv1->CU_cmds.size());
     //Release execbo lock only after the command is fully populated and inserted in the command list
     priv1->execbo_locked = false;
+    //Wake the completion thread of this device if it is idle
+    xma_core::completion::cmd_submitted(priv1);
     if (return_code) *return_code = XMA_SUCCESS;
     return cmd_obj;
 }
@@ -782,6 +1114,8 @@ XmaCUCmdObj xma_plg_schedule_cu_cmd(XmaSession s_handle,
         if (bo_idx != -1) {
             break;
         }
+        //Read before releasing the lock so that a completion in between is not missed
+        uint64_t seen_seq = priv1->completion_seq;
         priv1->execbo_locked = false;
         xma_logmsg(XMA_DEBUG_LOG, XMAPLUGIN_MOD, "No available execbo found");
         if (itr > 15) {
@@ -789,9 +1123,7 @@ XmaCUCmdObj xma_plg_schedule_cu_cmd(XmaSession s_handle,
             if (return_code) *return_code = XMA_ERROR;
             return cmd_obj_error;
         }
-        std::unique_lock<std::mutex> lk(priv1->m_mutex);
-        priv1->execbo_is_free.wait(lk);
-        lk.unlock();
+        xma_core::completion::wait_completion(priv1, priv1->execbo_is_free, seen_seq, 100);
         itr++;
     }
 
@@ -895,6 +1227,8 @@ XmaCUCmdObj xma_plg_schedule_cu_cmd(XmaSession s_handle,
     //xma_logmsg(XMA_DEBUG_LOG, XMAPLUGIN_MOD, "2. Num of cmds in-progress = %lu", priv1->CU_cmds.size());
     //Release execbo lock only after the command is fully populated and inserted in the command list
     priv1->execbo_locked = false;
+    //Wake the completion thread of this device if it is idle
+    xma_core::completion::cmd_submitted(priv1);
     if (return_code) *return_code = XMA_SUCCESS;
     return cmd_obj;
 }
@@ -956,6 +1290,8 @@ int32_t xma_plg_cu_cmd_status(XmaSession s_handle, XmaCUCmdObj* cmd_obj_array, i
 
     std::vector<XmaCUCmdObj> cmd_vector(cmd_obj_array, cmd_obj_array+num_cu_objs);
     do {
+        //Read before checking the cmds so that a completion in between is not missed
+        uint64_t seen_seq = priv1->completion_seq;
         all_done = true;
         for (auto& cmd: cmd_vector) {
             if (s_handle.session_type < XMA_ADMIN && cmd.cu_index != kernel_tmp1->cu_index) {
@@ -993,9 +1329,7 @@ int32_t xma_plg_cu_cmd_status(XmaSession s_handle, XmaCUCmdObj* cmd_obj_array, i
             all_done = true;
         } else if (!all_done) {
             if (g_xma_singleton->cpu_mode == XMA_CPU_MODE1) {
-                std::unique_lock<std::mutex> lk(priv1->m_mutex);
-                priv1->work_item_done_1plus.wait(lk);
-                lk.unlock();
+                xma_core::completion::wait_completion(priv1, priv1->kernel_done_or_free, seen_seq, 100);
             } else if (g_xma_singleton->cpu_mode == XMA_CPU_MODE2) {
                 std::this_thread::yield();
             } else {
@@ -1086,11 +1420,9 @@ int32_t xma_plg_is_work_item_done(XmaSession s_handle, uint32_t timeout_ms)
     uint32_t tmp_num_cmds = 1;
     if (g_xma_singleton->cpu_mode == XMA_CPU_MODE1) {
         while (iter1 > 0) {
-            std::unique_lock<std::mutex> lk(priv1->m_mutex);
-            //priv1->work_item_done_1plus.wait(lk);
+            //Returns as soon as the completion thread has a done cmd for this session.
 	    //Timeout required if cu is hung; Unblock and check status again
-            priv1->work_item_done_1plus.wait_for(lk, std::chrono::milliseconds(timeout1));
-            lk.unlock();
+            xma_core::completion::wait_work_item(priv1, timeout1);
 
             tmp_num_cmds = priv1->num_cu_cmds;
             count = priv1->kernel_complete_count;
@@ -1355,8 +1687,12 @@ int32_t xma_plg_add_ref_cnt(XmaBufferObj *b_obj, int32_t num) {
         return -999;
     }
     XmaBufferObjPrivate* b_obj_priv = (XmaBufferObjPrivate*) b_obj->private_do_not_touch;
-    b_obj_priv->ref_cnt += num;
-    return b_obj_priv->ref_cnt;
+    int32_t ref_cnt = (b_obj_priv->ref_cnt += num);
+    if (ref_cnt == 0 && num < 0 && b_obj_priv->pool != nullptr) {
+        //Last reference of pooled buffer dropped
+        release_pool_bo(b_obj);
+    }
+    return ref_cnt;
 }
 
 void* xma_plg_get_dev_handle(XmaSession s_handle) {
@@ -0,0 +1,194 @@
+/**
+ * Copyright (C) 2020 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+// Measures read/write bandwidth and checkpoint time of the hw_emu
+// device memory model.  Buffers are spread over a 64GB device address
+// space the way HBM banks are, and the contents are checked after the
+// model is checkpointed and restored.
+//
+// The page-map model is a stand-in for the previous implementation: a
+// map of 1MB pages each written to its own file on checkpoint.  It does
+// not include the protobuf encoding the old model also paid for.
+
+#include "mem_model.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <memory>
+
+namespace {
+
+const uint64_t span = 64ULL * ONE_GB;
+const uint64_t banks = 32;
+const unsigned int buffer_size = 32 * ONE_MB;
+
+using clock_type = std::chrono::high_resolution_clock;
+
+double
+seconds_since(clock_type::time_point start)
+{
+  return std::chrono::duration<double>(clock_type::now() - start).count();
+}
+
+class page_map_model
+{
+  std::map<uint64_t, std::unique_ptr<unsigned char[]>> pages;
+  std::string dir;
+
+  unsigned char*
+  get_page(uint64_t idx)
+  {
+    auto& page = pages[idx];
+    if (!page) {
+      page.reset(new unsigned char[ONE_MB]);
+      memset(page.get(), 0, ONE_MB);
+    }
+    return page.get();
+  }
+
+public:
+  explicit page_map_model(std::string d) : dir(std::move(d)) {}
+
+  void
+  writeDevMem(uint64_t offset, const void* src, unsigned int size)
+  {
+    for (uint64_t done = 0; done < size;) {
+      uint64_t addr = offset + done;
+      uint64_t in_page = addr & (ONE_MB - 1);
+      uint64_t n = std::min<uint64_t>(ONE_MB - in_page, size - done);
+      memcpy(get_page(addr >> 20) + in_page, (const char*)src + done, n);
+      done += n;
+    }
+  }
+
+  void
+  readDevMem(uint64_t offset, void* dest, unsigned int size)
+  {
+    for (uint64_t done = 0; done < size;) {
+      uint64_t addr = offset + done;
+      uint64_t in_page = addr & (ONE_MB - 1);
+      uint64_t n = std::min<uint64_t>(ONE_MB - in_page, size - done);
+      memcpy((char*)dest + done, get_page(addr >> 20) + in_page, n);
+      done += n;
+    }
+  }
+
+  void
+  sync()
+  {
+    for (auto& page : pages) {
+      std::string name = dir + "/page_" + std::to_string(page.first);
+      FILE* f = fopen(name.c_str(), "w");
+      if (!f)
+        continue;
+      fwrite(page.second.get(), 1, ONE_MB, f);
+      fclose(f);
+    }
+  }
+};
+
+template <typename Model>
+void
+run(const char* name, Model& model)
+{
+  std::vector<unsigned char> buffer(buffer_size);
+  for (unsigned int i = 0; i < buffer_size; ++i)
+    buffer[i] = static_cast<unsigned char>(i * 7);
+
+  uint64_t stride = span / banks;
+  auto start = clock_type::now();
+  for (uint64_t b = 0; b < banks; ++b)
+    model.writeDevMem(b * stride, buffer.data(), buffer_size);
+  double write_time = seconds_since(start);
+
+  start = clock_type::now();
+  for (uint64_t b = 0; b < banks; ++b)
+    model.readDevMem(b * stride, buffer.data(), buffer_size);
+  double read_time = seconds_since(start);
+
+  start = clock_type::now();
+  model.sync();
+  double sync_time = seconds_since(start);
+
+  double mb = double(banks) * buffer_size / ONE_MB;
+  printf("%-10s write %8.1f MB/s  read %8.1f MB/s  checkpoint %7.3f s\n",
+         name, mb / write_time, mb / read_time, sync_time);
+}
+
+bool
+verify(mem_model& model)
+{
+  std::vector<unsigned char> buffer(buffer_size);
+  uint64_t stride = span / banks;
+  for (uint64_t b = 0; b < banks; ++b) {
+    model.readDevMem(b * stride, buffer.data(), buffer_size);
+    for (unsigned int i = 0; i < buffer_size; ++i)
+      if (buffer[i] != static_cast<unsigned char>(i * 7))
+        return false;
+  }
+
+  // Memory between the buffers was never written
+  unsigned char hole[64];
+  model.readDevMem(stride / 2, hole, sizeof(hole));
+  for (auto byte : hole)
+    if (byte)
+      return false;
+  return true;
+}
+
+}
+
+int
+main()
+{
+  printf("%llu buffers of %u MB over %llu GB\n",
+         (unsigned long long)banks, buffer_size / ONE_MB,
+         (unsigned long long)(span / ONE_GB));
+
+  {
+    mem_model model("bench");
+    run("sparse", model);
+  }
+
+  {
+    // Reopening the model for the same device restores the checkpoint
+    mem_model model("bench");
+    if (!verify(model)) {
+      printf("FAILED: restored contents do not match\n");
+      return 1;
+    }
+    printf("restored contents verified\n");
+  }
+
+  {
+    std::string dir = "/tmp/mem_model_bench_" + std::to_string(getpid());
+    std::string cmd = "mkdir -p " + dir;
+    if (system(cmd.c_str()) != 0)
+      return 1;
+    page_map_model model(dir);
+    run("page-map", model);
+    cmd = "rm -rf " + dir;
+    if (system(cmd.c_str()) != 0)
+      return 1;
+  }
+
+  std::string cmd = "rm -rf /tmp/" + std::string(getenv("USER") ? getenv("USER") : "") + "/" + std::to_string(getpid());
+  if (system(cmd.c_str()) != 0)
+    return 1;
+  return 0;
+}
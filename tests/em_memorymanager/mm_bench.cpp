@@ -0,0 +1,87 @@
+/**
+ * Copyright (C) 2020 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+// Allocator benchmark for xclemulation::MemoryManager.
+//
+// Allocates N small buffers, frees them in random order, and reports
+// the average cost per operation for increasing N.  With logarithmic
+// operations the per-operation cost should stay roughly flat.
+
+#include "memorymanager.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace {
+
+using xclemulation::MemoryManager;
+
+static double
+elapsed_ns(std::chrono::high_resolution_clock::time_point start)
+{
+  auto end = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+}
+
+static void
+bench(size_t count)
+{
+  const unsigned align = 4096;
+  MemoryManager mm(16ull * 1024 * 1024 * 1024, 0, align);
+  std::vector<uint64_t> bufs;
+  bufs.reserve(count);
+
+  std::mt19937 gen(7);
+  std::uniform_int_distribution<size_t> sz(1, 4 * align);
+
+  auto start = std::chrono::high_resolution_clock::now();
+  for (size_t i = 0; i < count; ++i) {
+    size_t size = sz(gen);
+    bufs.push_back(mm.alloc(size));
+  }
+  auto alloc_ns = elapsed_ns(start);
+
+  std::shuffle(bufs.begin(), bufs.end(), gen);
+
+  start = std::chrono::high_resolution_clock::now();
+  for (auto b : bufs)
+    mm.lookup(b);
+  auto lookup_ns = elapsed_ns(start);
+
+  start = std::chrono::high_resolution_clock::now();
+  for (auto b : bufs)
+    mm.free(b);
+  auto free_ns = elapsed_ns(start);
+
+  std::cout << count << "\t"
+            << alloc_ns / count << "\t"
+            << lookup_ns / count << "\t"
+            << free_ns / count << "\n";
+}
+
+}
+
+int
+main()
+{
+  std::cout << "buffers\talloc(ns)\tlookup(ns)\tfree(ns)\n";
+  for (size_t count = 1000; count <= 256000; count *= 2)
+    bench(count);
+  return 0;
+}
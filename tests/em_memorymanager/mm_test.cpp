@@ -0,0 +1,242 @@
+/**
+ * Copyright (C) 2020 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+// Unit tests for xclemulation::MemoryManager
+
+#include "memorymanager.h"
+
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+using xclemulation::MemoryManager;
+
+static const uint64_t KB = 1024;
+static const uint64_t MB = 1024 * KB;
+static const unsigned ALIGN = 4096;
+
+static void
+check(bool cond, const std::string& msg)
+{
+  if (!cond)
+    throw std::runtime_error(msg);
+}
+
+static uint64_t
+alloc(MemoryManager& mm, size_t size, unsigned int padding = 0)
+{
+  return mm.alloc(size, padding);
+}
+
+static void
+test_alignment()
+{
+  MemoryManager mm(16 * MB, 0x1000000, ALIGN);
+
+  size_t size = 1;
+  auto a = mm.alloc(size);
+  check(a == 0x1000000, "first alloc at start");
+  check(size == ALIGN, "size rounded up to alignment");
+
+  size = 0;
+  auto b = mm.alloc(size);
+  check(size == ALIGN, "zero size allocates one alignment unit");
+  check(b == a + ALIGN, "second alloc follows first");
+
+  size = ALIGN + 1;
+  auto c = mm.alloc(size);
+  check(size == 2 * ALIGN, "size rounded to next alignment multiple");
+  check(c % ALIGN == 0, "address aligned");
+
+  check(mm.freeSize() == 16 * MB - 4 * ALIGN, "free size accounts all allocations");
+}
+
+static void
+test_padding()
+{
+  MemoryManager mm(16 * MB, 0, ALIGN);
+
+  size_t size = ALIGN;
+  auto a = mm.alloc(size, 1);
+  check(a == 0, "padded alloc at start");
+  check(size == ALIGN, "requested size returned without padding");
+
+  auto l = mm.lookup(a);
+  check(l.first == a && l.second == 3 * ALIGN, "busy block includes padding on both sides");
+  check(mm.freeSize() == 16 * MB - 3 * ALIGN, "padding consumes free space");
+}
+
+static void
+test_lookup_and_free()
+{
+  MemoryManager mm(1 * MB, 0, ALIGN);
+
+  auto a = alloc(mm, 3 * ALIGN);
+  auto l = mm.lookup(a);
+  check(l.first == a && l.second == 3 * ALIGN, "lookup returns busy block");
+  check(MemoryManager::isNullAlloc(mm.lookup(a + ALIGN)), "lookup of interior address fails");
+
+  mm.free(a);
+  check(MemoryManager::isNullAlloc(mm.lookup(a)), "lookup after free fails");
+  check(mm.freeSize() == 1 * MB, "free restores free size");
+
+  // double free and unknown address are ignored
+  mm.free(a);
+  mm.free(0x12345);
+  check(mm.freeSize() == 1 * MB, "bogus free is ignored");
+}
+
+static void
+test_exhaustion()
+{
+  MemoryManager mm(16 * ALIGN, 0, ALIGN);
+
+  std::vector<uint64_t> bufs;
+  for (int i = 0; i < 16; ++i)
+    bufs.push_back(alloc(mm, ALIGN));
+  for (auto b : bufs)
+    check(b != MemoryManager::mNull, "alloc within capacity succeeds");
+  check(alloc(mm, ALIGN) == MemoryManager::mNull, "alloc beyond capacity fails");
+  check(mm.freeSize() == 0, "no free space left");
+
+  mm.free(bufs[5]);
+  check(alloc(mm, 2 * ALIGN) == MemoryManager::mNull, "fragmented space cannot satisfy larger alloc");
+  check(alloc(mm, ALIGN) == bufs[5], "freed hole is reused");
+}
+
+static void
+test_coalesce()
+{
+  MemoryManager mm(8 * ALIGN, 0, ALIGN);
+
+  std::vector<uint64_t> bufs;
+  for (int i = 0; i < 8; ++i)
+    bufs.push_back(alloc(mm, ALIGN));
+
+  // free in an order that exercises merging with left, right, and both
+  mm.free(bufs[1]);
+  mm.free(bufs[3]);
+  mm.free(bufs[2]);
+  check(alloc(mm, 3 * ALIGN) == bufs[1], "three adjacent blocks merge into one");
+
+  for (auto i : {0, 4, 5, 6, 7})
+    mm.free(bufs[i]);
+  check(mm.freeSize() == 5 * ALIGN, "free size after partial release");
+
+  // bufs[1..3] is still one busy block of 3 units
+  mm.free(bufs[1]);
+  check(alloc(mm, 8 * ALIGN) == 0, "whole range merges back into one block");
+}
+
+static void
+test_best_fit()
+{
+  MemoryManager mm(64 * ALIGN, 0, ALIGN);
+
+  auto a = alloc(mm, 8 * ALIGN);
+  auto s1 = alloc(mm, ALIGN);
+  auto b = alloc(mm, 2 * ALIGN);
+  auto s2 = alloc(mm, ALIGN);
+  check(s1 != MemoryManager::mNull && s2 != MemoryManager::mNull, "separator allocs");
+
+  mm.free(a);
+  mm.free(b);
+
+  // smallest block that fits is preferred over the lower address
+  check(alloc(mm, 2 * ALIGN) == b, "best fit picks the smallest block");
+  check(alloc(mm, 2 * ALIGN) == a, "next fit falls back to the larger block");
+}
+
+static void
+test_reset()
+{
+  MemoryManager mm(1 * MB, 0, ALIGN);
+  for (int i = 0; i < 10; ++i)
+    alloc(mm, 4 * KB);
+  mm.reset();
+  check(mm.freeSize() == 1 * MB, "reset restores free size");
+  check(alloc(mm, 1 * MB) == 0, "reset restores the full range");
+}
+
+static void
+test_random()
+{
+  const uint64_t total = 64 * MB;
+  MemoryManager mm(total, 0, ALIGN);
+
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<size_t> sz(1, 64 * KB);
+  std::vector<std::pair<uint64_t, uint64_t>> live;
+
+  for (int iter = 0; iter < 100000; ++iter) {
+    if (live.empty() || gen() % 3) {
+      size_t size = sz(gen);
+      auto addr = mm.alloc(size);
+      if (addr == MemoryManager::mNull)
+        continue;
+      check(addr % ALIGN == 0, "random alloc aligned");
+      check(addr + size <= total, "random alloc within range");
+      live.emplace_back(addr, size);
+    }
+    else {
+      auto idx = gen() % live.size();
+      mm.free(live[idx].first);
+      live[idx] = live.back();
+      live.pop_back();
+    }
+  }
+
+  uint64_t used = 0;
+  for (auto& b : live) {
+    auto l = mm.lookup(b.first);
+    check(l.second == b.second, "random lookup matches allocation");
+    used += b.second;
+  }
+  check(mm.freeSize() == total - used, "random free size consistent");
+
+  for (auto& b : live)
+    mm.free(b.first);
+  check(mm.freeSize() == total, "all memory released");
+  check(alloc(mm, total) == 0, "no fragmentation after releasing everything");
+}
+
+}
+
+int
+main()
+{
+  try {
+    test_alignment();
+    test_padding();
+    test_lookup_and_free();
+    test_exhaustion();
+    test_coalesce();
+    test_best_fit();
+    test_reset();
+    test_random();
+    std::cout << "PASSED TEST\n";
+    return 0;
+  }
+  catch (const std::exception& ex) {
+    std::cout << "Error: " << ex.what() << "\n";
+    std::cout << "FAILED TEST\n";
+    return 1;
+  }
+}
@@ -0,0 +1,298 @@
+/**
+ * Copyright (C) 2020 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Tests of xrt::event_handler_pool and xrt::pipeline stage statistics.
+ *
+ *  - concurrent submits from several threads, all events execute
+ *  - pool destroyed with events still queued, all queued events execute
+ *  - pool destroyed while other threads submit, every waiter returns
+ *    once the queue is serviced by an event_handler
+ *  - failure to pin threads is a warning, a second pool on a queue
+ *    throws without leaving threads behind
+ *  - pipeline::get_stage_stats() counts, queue depth and latencies
+ *
+ * A watchdog fails the test if any wait hangs.
+ */
+
+#include "core/include/experimental/xrt_enqueue.h"
+#include "core/include/experimental/xrt_pipeline.h"
+#include "core/common/message.h"
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+namespace {
+
+std::atomic<unsigned int> warnings {0};
+
+// cpu that set_cpu_affinity stub fails to pin to
+const unsigned int bad_cpu = 100000;
+
+} // namespace
+
+namespace xrt_core {
+
+namespace config { namespace detail {
+
+unsigned int
+get_uint_value(const char*, unsigned int default_value)
+{
+  return default_value;
+}
+
+}} // detail, config
+
+namespace message {
+
+void
+send(severity_level l, const char*, const char*)
+{
+  if (l == severity_level::XRT_WARNING)
+    ++warnings;
+}
+
+} // message
+
+void
+set_cpu_affinity(std::thread&, const std::vector<unsigned int>& cpus)
+{
+  for (auto cpu : cpus)
+    if (cpu == bad_cpu)
+      throw std::runtime_error("error calling pthread_setaffinity_np");
+}
+
+std::vector<unsigned int>
+parse_cpu_list(const std::string&)
+{
+  return {};
+}
+
+} // xrt_core
+
+namespace {
+
+using namespace std::chrono_literals;
+
+const int num_producers = 4;
+int errors = 0;
+
+void
+check(bool ok, const std::string& what)
+{
+  if (!ok) {
+    std::cout << "ERROR: " << what << std::endl;
+    errors++;
+  }
+}
+
+void
+watchdog(int)
+{
+  const char msg[] = "ERROR: wait did not return\nFAILED TEST\n";
+  if (::write(1, msg, sizeof(msg) - 1) < 0)
+    _exit(2);
+  _exit(1);
+}
+
+void
+spin(std::chrono::microseconds us)
+{
+  auto end = std::chrono::steady_clock::now() + us;
+  while (std::chrono::steady_clock::now() < end)
+    ;
+}
+
+// Each producer enqueues events, every other one chained to the
+// previous event of the producer
+std::vector<std::vector<xrt::event>>
+produce(xrt::event_queue& q, int events, std::atomic<int>& executed, std::chrono::microseconds work)
+{
+  std::vector<std::vector<xrt::event>> produced(num_producers);
+  std::vector<std::thread> producers;
+  for (int p = 0; p < num_producers; ++p) {
+    producers.emplace_back([&q, &produced, &executed, p, events, work] {
+      auto& evs = produced[p];
+      evs.reserve(events);
+      for (int i = 0; i < events; ++i) {
+        auto fn = [&executed, work] { spin(work); ++executed; };
+        if (i % 2 && !evs.empty())
+          evs.push_back(q.enqueue_with_waitlist(fn, {evs.back()}));
+        else
+          evs.push_back(q.enqueue(fn));
+      }
+    });
+  }
+  for (auto& t : producers)
+    t.join();
+  return produced;
+}
+
+void
+wait_all(const std::vector<std::vector<xrt::event>>& produced)
+{
+  for (auto& evs : produced)
+    for (auto& ev : evs)
+      ev.wait();
+}
+
+void
+test_concurrent_submit(int events)
+{
+  xrt::event_queue q;
+  xrt::event_handler_pool pool(q, 4);
+  std::atomic<int> executed {0};
+  auto start = std::chrono::steady_clock::now();
+  auto produced = produce(q, events, executed, 0us);
+  wait_all(produced);
+  auto us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+  check(executed == num_producers * events, "concurrent submit: all events executed");
+  std::cout << "concurrent submit: " << num_producers * events << " events in "
+            << us << " us\n";
+}
+
+// All events are submitted while the pool is attached, so they must
+// all have executed once the pool is destroyed
+void
+test_destroy_drains(int events)
+{
+  xrt::event_queue q;
+  auto pool = std::make_unique<xrt::event_handler_pool>(q, 2);
+  std::atomic<int> executed {0};
+  auto produced = produce(q, events / 10, executed, 20us);
+  int queued = num_producers * (events / 10) - executed;
+  pool.reset();
+  check(executed == num_producers * (events / 10), "destroy: queued events executed");
+  wait_all(produced);
+  std::cout << "destroy: " << queued << " queued events executed by pool destructor\n";
+}
+
+// Events submitted after the pool is detached go to the event queue,
+// which is then serviced by an event handler
+void
+test_destroy_while_submitting(int events)
+{
+  for (int round = 0; round < 20; ++round) {
+    xrt::event_queue q;
+    auto pool = std::make_unique<xrt::event_handler_pool>(q, 2);
+    std::atomic<int> executed {0};
+    std::vector<std::vector<xrt::event>> produced;
+    std::thread producer([&] { produced = produce(q, events / 20, executed, 0us); });
+    std::this_thread::sleep_for(std::chrono::microseconds(100 * round));
+    pool.reset();
+    producer.join();
+    xrt::event_handler handler(q);
+    wait_all(produced);
+    check(executed == num_producers * (events / 20), "destroy while submitting: all events executed");
+  }
+}
+
+void
+test_construction_failure()
+{
+  xrt::event_queue q;
+  auto before = warnings.load();
+  xrt::event_handler_pool pool(q, 2, std::vector<unsigned int>{bad_cpu});
+  check(warnings == before + 2, "affinity failure is a warning per thread");
+  check(q.enqueue([] { return 42; }).get() == 42, "pool with unpinned threads executes events");
+
+  bool thrown = false;
+  try {
+    xrt::event_handler_pool second(q, 2);
+  }
+  catch (const std::runtime_error&) {
+    thrown = true;
+  }
+  check(thrown, "second pool on queue throws");
+  check(q.enqueue([] { return 43; }).get() == 43, "first pool still attached");
+}
+
+void
+test_stage_stats()
+{
+  xrt::event_queue q;
+  xrt::event_handler_pool pool(q, 2);
+  xrt::pipeline p(q);
+
+  std::promise<void> gate;
+  std::shared_future<void> open = gate.get_future().share();
+  p.emplace([open] { open.wait(); std::this_thread::sleep_for(1ms); },
+            [] { std::this_thread::sleep_for(2ms); });
+
+  const int runs = 20;
+  std::vector<xrt::event> done;
+  for (int i = 0; i < runs; ++i)
+    done.push_back(p.execute());
+
+  std::this_thread::sleep_for(10ms);
+  auto stats = p.get_stage_stats();
+  check(stats.size() == 2, "stats per stage");
+  check(stats[0].executions == 0, "stage 1 blocked");
+  check(stats[0].queued >= runs - 2, "stage 1 queue depth");
+  check(stats[1].queued == runs, "stage 2 queue depth");
+
+  gate.set_value();
+  for (auto& ev : done)
+    ev.wait();
+
+  stats = p.get_stage_stats();
+  check(stats[0].executions == runs && stats[1].executions == runs, "executions counted");
+  check(stats[0].queued == 0 && stats[1].queued == 0, "queues empty");
+  check(stats[0].latency >= runs * 1ms && stats[1].latency >= runs * 2ms, "total latency");
+  check(stats[0].max_latency >= 1ms && stats[0].max_latency <= stats[0].latency, "stage 1 max latency");
+  check(stats[1].max_latency >= 2ms && stats[1].max_latency <= stats[1].latency, "stage 2 max latency");
+  check(stats[0].wait >= 10ms, "stage 1 wait includes blocked time");
+
+  for (size_t s = 0; s < stats.size(); ++s)
+    std::cout << "stage " << s << ": executions " << stats[s].executions
+              << " wait " << stats[s].wait.count() / 1000 << " us"
+              << " latency " << stats[s].latency.count() / 1000 << " us"
+              << " max " << stats[s].max_latency.count() / 1000 << " us\n";
+}
+
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+  int events = argc > 1 ? std::atoi(argv[1]) : 20000;
+
+  std::signal(SIGALRM, watchdog);
+  alarm(120);
+
+  test_concurrent_submit(events);
+  test_destroy_drains(events);
+  test_destroy_while_submitting(events);
+  test_construction_failure();
+  test_stage_stats();
+
+  if (errors) {
+    std::cout << "FAILED TEST" << std::endl;
+    return 1;
+  }
+  std::cout << "PASSED TEST" << std::endl;
+  return 0;
+}
@@ -0,0 +1,390 @@
+/**
+ * Copyright (C) 2020 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Tests of batched command submission in the kds command monitor
+ * when exec_buf fails part way through a batch.
+ *
+ *  - schedule_error reports the number of submitted commands
+ *  - submitted commands complete normally
+ *  - commands that were not submitted are aborted and notified, so
+ *    waiters return and the commands can be submitted again
+ *  - in a batch spanning two devices, commands for a device that
+ *    was never launched are aborted as well
+ *  - a failed single command submission aborts the command
+ *
+ * The device is a fake that completes every submitted command on the
+ * next exec_wait and fails the n'th exec_buf when asked to.  A
+ * watchdog fails the test if any wait hangs.
+ */
+
+#include "core/common/api/exec.h"
+#include "core/common/api/command.h"
+#include "core/common/device.h"
+#include "core/common/error.h"
+#include "core/common/thread.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+////////////////////////////////////////////////////////////////
+// Stubs for xrt_core functions used by kds.cpp
+////////////////////////////////////////////////////////////////
+namespace xrt_core {
+
+device::
+device(id_type device_id)
+  : m_device_id(device_id)
+{}
+
+device::
+~device()
+{}
+
+void
+send_exception_message(const char* msg, const char*)
+{
+  std::cout << "ERROR: " << msg << std::endl;
+}
+
+namespace detail {
+
+void
+set_thread_policy(std::thread&)
+{}
+
+void
+set_cpu_affinity(std::thread&)
+{}
+
+} // detail
+
+} // xrt_core
+
+namespace {
+
+int errors = 0;
+
+void
+check(bool ok, const std::string& what)
+{
+  if (!ok) {
+    std::cout << "ERROR: " << what << std::endl;
+    errors++;
+  }
+}
+
+void
+watchdog(int)
+{
+  const char msg[] = "ERROR: wait did not return\nFAILED TEST\n";
+  if (::write(1, msg, sizeof(msg) - 1) < 0)
+    _exit(2);
+  _exit(1);
+}
+
+class fake_device;
+
+// Start CU command on one CU, the exec bo handle is the index of
+// the command in the test
+class fake_command : public xrt_core::command
+{
+  fake_device* m_device;
+  xclBufferHandle m_handle;
+  std::vector<uint32_t> m_packet;
+  std::mutex m_mutex;
+  std::condition_variable m_cv;
+  bool m_done = true;
+
+public:
+  fake_command(fake_device* device, unsigned int handle, unsigned int cuidx)
+    : m_device(device), m_handle(handle), m_packet(4, 0)
+  {
+    auto kcmd = reinterpret_cast<ert_start_kernel_cmd*>(m_packet.data());
+    kcmd->opcode = ERT_START_CU;
+    kcmd->type = ERT_CU;
+    kcmd->count = 2;
+    kcmd->cu_mask = 1 << cuidx;
+  }
+
+  void
+  prepare()
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_done = false;
+    get_ert_packet()->state = ERT_CMD_STATE_NEW;
+  }
+
+  ert_cmd_state
+  wait()
+  {
+    std::unique_lock<std::mutex> lk(m_mutex);
+    m_cv.wait(lk, [this] { return m_done; });
+    return static_cast<ert_cmd_state>(get_ert_packet()->state);
+  }
+
+  virtual ert_packet*
+  get_ert_packet() const
+  {
+    return reinterpret_cast<ert_packet*>(const_cast<uint32_t*>(m_packet.data()));
+  }
+
+  virtual xrt_core::device*
+  get_device() const;
+
+  virtual xclBufferHandle
+  get_exec_bo() const
+  {
+    return m_handle;
+  }
+
+  virtual void
+  notify(ert_cmd_state)
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_done = true;
+    m_cv.notify_all();
+  }
+};
+
+// Device that completes submitted commands on next exec_wait
+class fake_device : public xrt_core::device
+{
+  std::mutex m_mutex;
+  std::vector<std::shared_ptr<fake_command>>* m_cmds = nullptr;
+  std::vector<fake_command*> m_running;
+  unsigned int m_calls = 0;
+  unsigned int m_fail_at = 0;
+
+public:
+  fake_device(id_type id)
+    : xrt_core::device(id)
+  {}
+
+  // Fail the n'th (1 based) exec_buf from now on, 0 to never fail
+  void
+  fail_at(std::vector<std::shared_ptr<fake_command>>& cmds, unsigned int n)
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_cmds = &cmds;
+    m_calls = 0;
+    m_fail_at = n;
+  }
+
+  virtual void
+  exec_buf(xclBufferHandle boh)
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    if (++m_calls == m_fail_at)
+      throw std::system_error(EBUSY, std::system_category(), "exec_buf failed");
+    auto cmd = (*m_cmds)[boh].get();
+    cmd->get_ert_packet()->state = ERT_CMD_STATE_RUNNING;
+    m_running.push_back(cmd);
+  }
+
+  virtual int
+  exec_wait(int) const
+  {
+    auto self = const_cast<fake_device*>(this);
+    std::lock_guard<std::mutex> lk(self->m_mutex);
+    if (m_running.empty()) {
+      std::this_thread::sleep_for(std::chrono::microseconds(100));
+      return 0;
+    }
+    for (auto cmd : m_running)
+      cmd->get_ert_packet()->state = ERT_CMD_STATE_COMPLETED;
+    self->m_running.clear();
+    return 1;
+  }
+
+  virtual handle_type get_device_handle() const { return nullptr; }
+  virtual void close_device() {}
+  virtual void open_context(const xuid_t, unsigned int, bool) {}
+  virtual void close_context(const xuid_t, unsigned int) {}
+  virtual xclBufferHandle alloc_bo(size_t, unsigned int) { return 0; }
+  virtual xclBufferHandle alloc_bo(void*, size_t, unsigned int) { return 0; }
+  virtual void free_bo(xclBufferHandle) {}
+  virtual xclBufferExportHandle export_bo(xclBufferHandle) const { return 0; }
+  virtual xclBufferHandle import_bo(xclBufferExportHandle) { return 0; }
+  virtual void copy_bo(xclBufferHandle, xclBufferHandle, size_t, size_t, size_t) {}
+  virtual void sync_bo(xclBufferHandle, xclBOSyncDirection, size_t, size_t) {}
+  virtual void* map_bo(xclBufferHandle, bool) { return nullptr; }
+  virtual void unmap_bo(xclBufferHandle, void*) {}
+  virtual void get_bo_properties(xclBufferHandle, struct xclBOProperties*) const {}
+  virtual void reg_read(uint32_t, uint32_t, uint32_t*) const {}
+  virtual void reg_write(uint32_t, uint32_t, uint32_t) {}
+  virtual void xread(uint64_t, void*, size_t) const {}
+  virtual void xwrite(uint64_t, const void*, size_t) {}
+  virtual void unmgd_pread(void*, size_t, uint64_t) {}
+  virtual void unmgd_pwrite(const void*, size_t, uint64_t) {}
+  virtual void load_xclbin(const struct axlf*) {}
+  virtual void reclock(const uint16_t*) {}
+  virtual void p2p_enable(bool) {}
+  virtual void p2p_disable(bool) {}
+
+private:
+  virtual const xrt_core::query::request&
+  lookup_query(xrt_core::query::key_type) const
+  {
+    throw std::runtime_error("no queries");
+  }
+};
+
+xrt_core::device*
+fake_command::
+get_device() const
+{
+  return m_device;
+}
+
+using command_list = std::vector<std::shared_ptr<fake_command>>;
+
+// Commands [0, split) for dev0, rest for dev1, round robin over 2 CUs
+command_list
+make_commands(fake_device* dev0, fake_device* dev1, unsigned int count, unsigned int split)
+{
+  command_list cmds;
+  for (unsigned int i = 0; i < count; ++i)
+    cmds.push_back(std::make_shared<fake_command>(i < split ? dev0 : dev1, i, i % 2));
+  return cmds;
+}
+
+// Prepare and schedule commands as one batch, return number submitted
+size_t
+schedule(command_list& cmds)
+{
+  std::vector<xrt_core::command*> batch;
+  for (auto& cmd : cmds) {
+    cmd->prepare();
+    batch.push_back(cmd.get());
+  }
+
+  try {
+    xrt_core::kds::schedule(batch.data(), batch.size());
+  }
+  catch (const xrt_core::exec::schedule_error& ex) {
+    return ex.submitted();
+  }
+  return batch.size();
+}
+
+// Every command returns from wait, [0, submitted) completed, the rest
+// aborted
+void
+check_states(command_list& cmds, size_t submitted, const std::string& what)
+{
+  for (size_t i = 0; i < cmds.size(); ++i) {
+    auto state = cmds[i]->wait();
+    auto expect = i < submitted ? ERT_CMD_STATE_COMPLETED : ERT_CMD_STATE_ABORT;
+    check(state == expect, what + ": command " + std::to_string(i) + " state " + std::to_string(state));
+  }
+}
+
+void
+test_batch_failure(fake_device* dev)
+{
+  auto cmds = make_commands(dev, dev, 8, 8);
+
+  dev->fail_at(cmds, 6);
+  auto submitted = schedule(cmds);
+  check(submitted == 5, "batch: 5 commands submitted, got " + std::to_string(submitted));
+  check_states(cmds, submitted, "batch");
+
+  // aborted commands can be submitted again
+  dev->fail_at(cmds, 0);
+  submitted = schedule(cmds);
+  check(submitted == 8, "batch resubmit: all commands submitted");
+  check_states(cmds, submitted, "batch resubmit");
+}
+
+void
+test_multi_device_failure(fake_device* dev0, fake_device* dev1)
+{
+  auto cmds = make_commands(dev0, dev1, 8, 4);
+
+  // dev1 commands are never launched
+  dev0->fail_at(cmds, 3);
+  dev1->fail_at(cmds, 0);
+  auto submitted = schedule(cmds);
+  check(submitted == 2, "first device: 2 commands submitted, got " + std::to_string(submitted));
+  check_states(cmds, submitted, "first device");
+
+  // all dev0 commands are submitted
+  dev0->fail_at(cmds, 0);
+  dev1->fail_at(cmds, 2);
+  submitted = schedule(cmds);
+  check(submitted == 5, "second device: 5 commands submitted, got " + std::to_string(submitted));
+  check_states(cmds, submitted, "second device");
+}
+
+void
+test_single_failure(fake_device* dev)
+{
+  auto cmds = make_commands(dev, dev, 1, 1);
+  dev->fail_at(cmds, 1);
+  cmds[0]->prepare();
+
+  bool thrown = false;
+  try {
+    xrt_core::kds::schedule(cmds[0].get());
+  }
+  catch (const xrt_core::exec::schedule_error&) {
+    check(false, "single: plain exception expected");
+  }
+  catch (const std::exception&) {
+    thrown = true;
+  }
+  check(thrown, "single: exec_buf failure propagated");
+  check(cmds[0]->wait() == ERT_CMD_STATE_ABORT, "single: command aborted");
+}
+
+} // namespace
+
+int
+main()
+{
+  std::signal(SIGALRM, watchdog);
+  alarm(60);
+
+  fake_device dev0(0), dev1(1);
+  xrt_core::kds::start();
+  xrt_core::kds::init(&dev0);
+  xrt_core::kds::init(&dev1);
+
+  test_batch_failure(&dev0);
+  test_multi_device_failure(&dev0, &dev1);
+  test_single_failure(&dev0);
+
+  xrt_core::kds::stop();
+
+  if (errors) {
+    std::cout << "FAILED TEST" << std::endl;
+    return 1;
+  }
+  std::cout << "PASSED TEST" << std::endl;
+  return 0;
+}
@@ -0,0 +1,271 @@
+/**
+ * Copyright (C) 2020 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Cost of xrt_core::message::send to a runtime_log file for the caller,
+ * with and without Runtime.runtime_log_async, and checks of the async
+ * dispatcher: every queued message is written at exit, critical
+ * messages are written before send returns, dropped and rate limited
+ * messages are accounted for.
+ *
+ * The dispatcher is chosen once per process, so every scenario runs in
+ * a child process with its own xrt.ini settings and the parent checks
+ * the log file after the child has exited.
+ */
+
+#include "core/common/message.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+std::map<std::string, std::string> ini;
+
+} // namespace
+
+namespace xrt_core { namespace config { namespace detail {
+
+std::string
+get_string_value(const char* key, const std::string& default_value)
+{
+  auto itr = ini.find(key);
+  return itr == ini.end() ? default_value : itr->second;
+}
+
+bool
+get_bool_value(const char* key, bool default_value)
+{
+  auto itr = ini.find(key);
+  return itr == ini.end() ? default_value : itr->second == "true";
+}
+
+unsigned int
+get_uint_value(const char* key, unsigned int default_value)
+{
+  auto itr = ini.find(key);
+  return itr == ini.end() ? default_value : std::stoul(itr->second);
+}
+
+}}}
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+using severity_level = xrt_core::message::severity_level;
+
+const char* log_file = "message_bench.log";
+const int num_threads = 4;
+
+int errors = 0;
+
+void
+check(bool ok, const std::string& what)
+{
+  if (!ok) {
+    std::cout << "ERROR: " << what << std::endl;
+    errors++;
+  }
+}
+
+struct result
+{
+  double mean_ns;
+  double p99_ns;
+};
+
+// Each thread sends unique warnings, like a fallback path hit per call
+result
+send_messages(int per_thread)
+{
+  std::vector<std::vector<int64_t>> latency(num_threads);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([t, per_thread, &latency] {
+      auto& lat = latency[t];
+      lat.reserve(per_thread);
+      for (int i = 0; i < per_thread; i++) {
+        std::string msg = "bo copy fallback, thread " + std::to_string(t) + " call " + std::to_string(i);
+        auto start = clock_type::now();
+        xrt_core::message::send(severity_level::XRT_WARNING, "XRT", msg);
+        lat.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(clock_type::now() - start).count());
+      }
+    });
+  }
+  for (auto& t : threads)
+    t.join();
+
+  std::vector<int64_t> all;
+  for (auto& lat : latency)
+    all.insert(all.end(), lat.begin(), lat.end());
+  std::sort(all.begin(), all.end());
+  double sum = 0;
+  for (auto v : all)
+    sum += v;
+  return { sum / all.size(), (double)all[all.size() * 99 / 100] };
+}
+
+std::vector<std::string>
+read_log()
+{
+  std::vector<std::string> lines;
+  std::ifstream ifs(log_file);
+  std::string line;
+  while (std::getline(ifs, line))
+    lines.push_back(line);
+  return lines;
+}
+
+size_t
+count(const std::vector<std::string>& lines, const std::string& s)
+{
+  return std::count_if(lines.begin(), lines.end(),
+                       [&s](const std::string& l) { return l.find(s) != std::string::npos; });
+}
+
+// Sum of N in lines containing "<N><what>"
+uint64_t
+sum_counts(const std::vector<std::string>& lines, const std::string& prefix, const std::string& what)
+{
+  uint64_t sum = 0;
+  for (auto& l : lines) {
+    auto pos = l.find(what);
+    if (pos == std::string::npos)
+      continue;
+    auto start = l.rfind(prefix, pos);
+    sum += std::strtoull(l.c_str() + start + prefix.size(), nullptr, 10);
+  }
+  return sum;
+}
+
+// Run scenario in a child process with settings; result comes back in a pipe
+template <typename Scenario>
+result
+run_child(const std::map<std::string, std::string>& settings, Scenario scenario)
+{
+  std::remove(log_file);
+  int fds[2];
+  if (pipe(fds) != 0)
+    std::exit(1);
+  pid_t pid = fork();
+  if (pid == 0) {
+    ::close(fds[0]);
+    ini = settings;
+    ini["Runtime.runtime_log"] = log_file;
+    ini["Runtime.verbosity"] = "7";
+    result r = scenario();
+    if (::write(fds[1], &r, sizeof(r)) != sizeof(r))
+      std::exit(1);
+    ::close(fds[1]);
+    // Normal exit: queued messages must be written by the atexit handler
+    std::exit(0);
+  }
+  ::close(fds[1]);
+  result r = {0, 0};
+  if (::read(fds[0], &r, sizeof(r)) != sizeof(r))
+    check(false, "child result");
+  ::close(fds[0]);
+  int status = 0;
+  waitpid(pid, &status, 0);
+  check(WIFEXITED(status) && WEXITSTATUS(status) == 0, "child exit");
+  return r;
+}
+
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+  int per_thread = argc > 1 ? std::atoi(argv[1]) : 25000;
+  uint64_t total = (uint64_t)per_thread * num_threads;
+
+  // Synchronous file logging, flushed per message
+  result sync = run_child({}, [per_thread] { return send_messages(per_thread); });
+  auto lines = read_log();
+  check(count(lines, "bo copy fallback") == total, "sync: all messages written");
+
+  // Asynchronous, block when full: nothing may be lost
+  result async = run_child({{"Runtime.runtime_log_async", "true"},
+                            {"Runtime.runtime_log_overflow", "block"}},
+                           [per_thread] { return send_messages(per_thread); });
+  lines = read_log();
+  check(count(lines, "bo copy fallback") == total, "async block: all messages written at exit");
+  check(count(lines, "EXE: ") == 1, "async: file header");
+
+  // Asynchronous with a small queue, counting drops
+  run_child({{"Runtime.runtime_log_async", "true"},
+             {"Runtime.runtime_log_queue_size", "64"},
+             {"Runtime.runtime_log_overflow", "count"}},
+            [per_thread] { return send_messages(per_thread); });
+  lines = read_log();
+  uint64_t written = count(lines, "bo copy fallback");
+  uint64_t dropped = sum_counts(lines, "WARNING: ", " messages dropped");
+  check(written + dropped == total, "async count: written + dropped == sent");
+
+  // Rate limit of a repeated message
+  run_child({{"Runtime.runtime_log_async", "true"},
+             {"Runtime.runtime_log_overflow", "block"},
+             {"Runtime.runtime_log_rate_limit", "10"}},
+            [per_thread] {
+              auto start = clock_type::now();
+              for (int i = 0; i < per_thread; i++)
+                xrt_core::message::send(severity_level::XRT_WARNING, "XRT", "copy_bo is not supported, falling back to copy");
+              double secs = std::chrono::duration<double>(clock_type::now() - start).count();
+              return result{secs, 0};
+            });
+  lines = read_log();
+  uint64_t repeats = sum_counts(lines, "Last message repeated ", " times: ");
+  uint64_t copies = count(lines, "copy_bo is not supported") - count(lines, "Last message repeated");
+  check(copies + repeats == (uint64_t)per_thread, "rate limit: written + repeats == sent");
+  check(copies <= 30, "rate limit: repeats suppressed");
+
+  // Critical messages are written before send returns
+  run_child({{"Runtime.runtime_log_async", "true"}}, [] {
+    xrt_core::message::send(severity_level::XRT_INFO, "XRT", "before critical");
+    xrt_core::message::send(severity_level::XRT_CRITICAL, "XRT", "device lost");
+    auto l = read_log();
+    check(count(l, "before critical") == 1 && count(l, "CRITICAL: device lost") == 1,
+          "critical message written before send returns");
+    return result{(double)errors, 0};
+  });
+
+  std::printf("%d threads x %d warnings to runtime_log file\n", num_threads, per_thread);
+  std::printf("  sync   mean %8.0f ns  p99 %8.0f ns\n", sync.mean_ns, sync.p99_ns);
+  std::printf("  async  mean %8.0f ns  p99 %8.0f ns  %5.1fx\n", async.mean_ns, async.p99_ns,
+              sync.mean_ns / async.mean_ns);
+  std::printf("  queue of 64: %lu written, %lu dropped and counted\n",
+              (unsigned long)written, (unsigned long)dropped);
+  std::printf("  rate limit 10/s: %lu of %d repeats written\n", (unsigned long)copies, per_thread);
+  check(async.mean_ns < sync.mean_ns, "async send faster than sync");
+
+  std::remove(log_file);
+  if (errors) {
+    std::cout << "FAILED TEST" << std::endl;
+    return 1;
+  }
+  std::cout << "PASSED TEST" << std::endl;
+  return 0;
+}
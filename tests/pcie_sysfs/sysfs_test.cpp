@@ -0,0 +1,378 @@
+/**
+ * Copyright (C) 2020 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Tests the pcidev sysfs layer (core/pcie/linux/sysfs.cpp) against a
+ * fake sysfs tree and compares its query cost with the old sysfs
+ * functions of scan.cpp, which resolved the subdevice directory and
+ * opened the entry with std::fstream for every query.
+ *
+ * The fake tree has a user pf with the usual number of subdevices and
+ * an xmc subdevice with the sensors the power profiling plugin polls.
+ */
+
+#include "core/pcie/linux/sysfs.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace xrt_core { namespace config { namespace detail {
+
+std::string
+get_string_value(const char*, const std::string& default_value)
+{
+  return default_value;
+}
+
+bool
+get_bool_value(const char*, bool default_value)
+{
+  return default_value;
+}
+
+}}}
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+namespace sysfs = pcidev::sysfs;
+
+const std::string dev_name = "0000:65:00.1";
+
+const char* sensors[] = {
+  "xmc_12v_aux_curr", "xmc_12v_aux_vol", "xmc_12v_pex_curr", "xmc_12v_pex_vol",
+  "xmc_vccint_curr", "xmc_vccint_vol", "xmc_3v3_pex_curr", "xmc_3v3_pex_vol",
+  "xmc_cage_temp0", "xmc_cage_temp1", "xmc_cage_temp2", "xmc_cage_temp3",
+  "xmc_dimm_temp0", "xmc_dimm_temp1", "xmc_dimm_temp2", "xmc_dimm_temp3",
+  "xmc_fan_temp", "xmc_fpga_temp", "xmc_hbm_temp", "xmc_se98_temp0",
+  "xmc_se98_temp1", "xmc_se98_temp2", "xmc_vccint_temp", "xmc_fan_rpm",
+};
+
+// Subdevices of a user pf, as found on U200/U250 shells
+const char* subdevs[] = {
+  "dma.qdma.u.16973825", "icap.u.16973825", "mailbox.u.16973825",
+  "mb_scheduler.u.16973825", "p2p.u.16973825", "rom.u.16973825",
+  "xvc_pub.u.16973825", "firewall.u.16973825", "dna.u.16973825",
+  "xmc.u.16973825", "clock_freq.u.16973825", "address_translator.u.16973825",
+  "intc.u.16973825", "drm", "msi_irqs", "power",
+};
+
+const char* pf_files[] = {
+  "config", "resource", "uevent", "subsystem_vendor", "subsystem_device",
+  "class", "userbar", "numa_node", "local_cpulist", "enable", "irq",
+};
+
+int errors = 0;
+
+void
+check(bool ok, const std::string& what)
+{
+  if (!ok) {
+    std::cout << "ERROR: " << what << std::endl;
+    errors++;
+  }
+}
+
+void
+write_file(const std::string& path, const std::string& value)
+{
+  std::ofstream ofs(path, std::ios::trunc);
+  ofs << value;
+}
+
+std::string
+make_tree()
+{
+  char tmpl[] = "/tmp/xrt_sysfs_XXXXXX";
+  std::string root = mkdtemp(tmpl);
+  mkdir((root + "/devices").c_str(), 0755);
+  mkdir((root + "/drivers").c_str(), 0755);
+  std::string dev = root + "/devices/" + dev_name;
+  mkdir(dev.c_str(), 0755);
+  for (auto s : subdevs)
+    mkdir((dev + "/" + s).c_str(), 0755);
+  for (auto f : pf_files)
+    write_file(dev + "/" + f, "0x0\n");
+  write_file(dev + "/vendor", "0x10ee\n");
+  write_file(dev + "/device", "0x5001\n");
+  write_file(dev + "/ready", "0x1\n");
+  write_file(dev + "/link_speed", "8\n");
+  write_file(dev + "/rom.u.16973825/VBNV", "xilinx_u200_xdma_201830_2\n");
+  write_file(dev + "/rom.u.16973825/uuid", "a0b1c2\nd3e4f5\n");
+  write_file(dev + "/icap.u.16973825/clock_freqs", "300\n500\n");
+  write_file(dev + "/icap.u.16973825/name", "icap\n");
+  // Directory name does not start with the subdevice name
+  mkdir((dev + "/xmc_sub").c_str(), 0755);
+  write_file(dev + "/xmc_sub/name", "xmc2\n");
+  write_file(dev + "/xmc_sub/xmc_fan_rpm", "1200\n");
+  for (unsigned int i = 0; i < sizeof(sensors) / sizeof(sensors[0]); i++)
+    write_file(dev + "/xmc.u.16973825/" + sensors[i], std::to_string(1000 + i) + "\n");
+  std::string blob(10000, '\0');
+  for (size_t i = 0; i < blob.size(); i++)
+    blob[i] = (char)(i * 7);
+  write_file(dev + "/fdt_blob", blob);
+  return root;
+}
+
+size_t
+num_open_fds()
+{
+  size_t n = 0;
+  DIR* dp = opendir("/proc/self/fd");
+  while (readdir(dp))
+    n++;
+  closedir(dp);
+  return n;
+}
+
+void
+test_layer(const std::string& root)
+{
+  std::string dev = root + "/devices/" + dev_name;
+  std::string err;
+  std::string s;
+  std::vector<std::string> sv;
+  std::vector<uint64_t> iv;
+
+  check(sysfs::get_root() == root, "root");
+  check(sysfs::dev_root() == root + "/devices/", "dev_root");
+  check(sysfs::get_path(dev_name, "xmc", "xmc_fan_rpm") == dev + "/xmc.u.16973825/xmc_fan_rpm", "path by prefix");
+  check(sysfs::get_path(dev_name, "icap", "x") == dev + "/icap.u.16973825/x", "path by name");
+  check(sysfs::get_path(dev_name, "xmc2", "x") == dev + "/xmc_sub/x", "path by name only");
+  check(sysfs::get_path(dev_name, "", "vendor") == dev + "//vendor", "path of pf entry");
+  check(sysfs::get_path(dev_name, "nosuch", "x").empty(), "path of missing subdev");
+
+  sysfs::get(dev_name, "", "vendor", err, iv);
+  check(err.empty() && iv.size() == 1 && iv[0] == 0x10ee, "integer");
+  sysfs::get(dev_name, "rom", "uuid", err, sv);
+  check(err.empty() && sv.size() == 2 && sv[1] == "d3e4f5", "lines");
+  sysfs::get(dev_name, "rom", "VBNV", err, s);
+  check(err.empty() && s == "xilinx_u200_xdma_201830_2", "string");
+  sysfs::get(dev_name, "icap", "clock_freqs", err, iv);
+  check(err.empty() && iv.size() == 2 && iv[1] == 500, "integers");
+  std::vector<char> buf;
+  sysfs::get(dev_name, "", "fdt_blob", err, buf);
+  check(err.empty() && buf.size() == 10000 && buf[9999] == (char)(9999 * 7), "binary");
+
+  sysfs::get(dev_name, "nosuch", "x", err, s);
+  check(err.find("Failed to find subdirectory for nosuch") == 0 && s.empty(), "missing subdev error");
+  sysfs::get(dev_name, "xmc", "nosuch", err, s);
+  check(err.find("Failed to open") == 0, "missing entry error");
+  sysfs::get(dev_name, "rom", "VBNV", err, iv);
+  check(err.find("failed to convert string to integer") != std::string::npos, "conversion error");
+
+  // Dynamic entries are read again from the open file
+  sysfs::get(dev_name, "xmc", "xmc_fpga_temp", err, s);
+  write_file(dev + "/xmc.u.16973825/xmc_fpga_temp", "55\n");
+  sysfs::get(dev_name, "xmc", "xmc_fpga_temp", err, s);
+  check(err.empty() && s == "55", "dynamic entry read again");
+
+  // Static entries are cached until the device is flushed
+  write_file(dev + "/vendor", "0x1d0f\n");
+  sysfs::get(dev_name, "", "vendor", err, s);
+  check(s == "0x10ee", "static entry cached");
+  sysfs::flush(dev_name);
+  sysfs::get(dev_name, "", "vendor", err, s);
+  check(s == "0x1d0f", "static entry read after flush");
+
+  // Time to live of a query
+  sysfs::set_ttl("xmc", "xmc_fan_temp", std::chrono::milliseconds(50));
+  sysfs::get(dev_name, "xmc", "xmc_fan_temp", err, s);
+  write_file(dev + "/xmc.u.16973825/xmc_fan_temp", "40\n");
+  sysfs::get(dev_name, "xmc", "xmc_fan_temp", err, s);
+  check(s == "1016", "value within ttl cached");
+  std::this_thread::sleep_for(std::chrono::milliseconds(60));
+  sysfs::get(dev_name, "xmc", "xmc_fan_temp", err, s);
+  check(s == "40", "value after ttl read again");
+
+  // Written values are read back
+  sysfs::set_ttl("xmc", "xmc_fan_temp", std::chrono::milliseconds::max());
+  sysfs::put(dev_name, "xmc", "xmc_fan_temp", err, std::string("42"));
+  check(err.empty(), "put");
+  sysfs::get(dev_name, "xmc", "xmc_fan_temp", err, s);
+  check(s == "42", "value read back after put");
+  sysfs::set_ttl("xmc", "xmc_fan_temp", std::chrono::milliseconds::zero());
+
+  // Subdevice created again with a new instance (xclbin download, reset).
+  // Files open in a removed sysfs directory fail to read, which a fake
+  // tree can not do, so read an entry not opened before.
+  sysfs::get(dev_name, "xmc", "xmc_vccint_vol", err, s);
+  rename((dev + "/xmc.u.16973825").c_str(), (dev + "/xmc.u.33554432").c_str());
+  write_file(dev + "/xmc.u.33554432/xmc_vccint_curr", "850\n");
+  sysfs::get(dev_name, "xmc", "xmc_vccint_curr", err, s);
+  check(err.empty() && s == "850", "subdev created again");
+  check(sysfs::get_path(dev_name, "xmc", "x") == dev + "/xmc.u.33554432/x", "subdev path updated");
+
+  // Batch read
+  std::vector<std::string> entries = {"xmc_fan_rpm", "nosuch", "xmc_vccint_curr"};
+  std::vector<std::string> errs, values;
+  sysfs::get_batch(dev_name, "xmc", entries, errs, values);
+  check(errs.size() == 3 && values.size() == 3, "batch sizes");
+  check(errs[0].empty() && values[0] == "1023", "batch value");
+  check(!errs[1].empty() && values[1].empty(), "batch error");
+  check(errs[2].empty() && values[2] == "850", "batch value after error");
+  sysfs::get_batch(dev_name, "nosuch", entries, errs, values);
+  check(errs[0].find("Failed to find subdirectory") == 0, "batch of missing subdev");
+
+  // Open files are limited
+  size_t fds = num_open_fds();
+  for (int i = 0; i < 400; i++) {
+    std::string entry = "entry" + std::to_string(i);
+    write_file(dev + "/xmc.u.33554432/" + entry, std::to_string(i) + "\n");
+    sysfs::get(dev_name, "xmc", entry, err, s);
+    check(err.empty() && s == std::to_string(i), "many entries");
+  }
+  check(num_open_fds() < fds + 260, "open files limited");
+  sysfs::flush();
+  check(num_open_fds() < fds, "flush closes files");
+}
+
+// Old scan.cpp query path: resolve subdevice and open the entry with
+// std::fstream for every query
+std::string
+legacy_get_name(const std::string& dir, const std::string& subdir)
+{
+  std::string line;
+  std::ifstream ifs(dir + "/" + subdir + "/name");
+  if (ifs.is_open())
+    std::getline(ifs, line);
+  return line;
+}
+
+int
+legacy_get_subdev_dir_name(const std::string& dir, const std::string& subDevName, std::string& subdir)
+{
+  size_t sub_nm_sz = subDevName.size();
+  subdir = "";
+  if (subDevName.empty())
+    return 0;
+  int ret = -ENOENT;
+  DIR* dp = opendir(dir.c_str());
+  if (dp) {
+    struct dirent *entry;
+    while ((entry = readdir(dp))) {
+      std::string nm = legacy_get_name(dir, entry->d_name);
+      if (!nm.empty()) {
+        if (nm != subDevName)
+          continue;
+      } else if (strncmp(entry->d_name, subDevName.c_str(), sub_nm_sz) ||
+                 entry->d_name[sub_nm_sz] != '.') {
+        continue;
+      }
+      subdir = entry->d_name;
+      ret = 0;
+      break;
+    }
+    closedir(dp);
+  }
+  return ret;
+}
+
+void
+legacy_get(const std::string& root, const std::string& name, const std::string& subdev,
+           const std::string& entry, std::string& err, std::string& s)
+{
+  std::string subdir;
+  std::string dev_root = root + "/devices/";
+  s = "";
+  if (legacy_get_subdev_dir_name(dev_root + name, subdev, subdir) != 0) {
+    err = "Failed to find subdirectory";
+    return;
+  }
+  std::fstream fs(dev_root + name + "/" + subdir + "/" + entry, std::ios::in);
+  if (!fs.is_open()) {
+    err = "Failed to open";
+    return;
+  }
+  std::string line;
+  if (std::getline(fs, line))
+    s = line;
+}
+
+double
+bench(const std::string& root, int mode, int rounds)
+{
+  const size_t num = sizeof(sensors) / sizeof(sensors[0]);
+  std::vector<std::string> entries(sensors, sensors + num);
+  std::vector<std::string> errs, values;
+  std::string err, s;
+  uint64_t sum = 0;
+  auto start = clock_type::now();
+  for (int r = 0; r < rounds; r++) {
+    if (mode == 2) {
+      sysfs::get_batch(dev_name, "xmc", entries, errs, values);
+      for (auto& v : values)
+        sum += std::strtoull(v.c_str(), nullptr, 0);
+      continue;
+    }
+    for (auto& e : entries) {
+      if (mode == 0)
+        legacy_get(root, dev_name, "xmc", e, err, s);
+      else
+        sysfs::get(dev_name, "xmc", e, err, s);
+      sum += std::strtoull(s.c_str(), nullptr, 0);
+    }
+    // pf entries queried with every xbutil examine
+    if (mode == 0)
+      legacy_get(root, dev_name, "", "vendor", err, s);
+    else
+      sysfs::get(dev_name, "", "vendor", err, s);
+  }
+  check(sum > 0, "bench values");
+  return std::chrono::duration<double, std::micro>(clock_type::now() - start).count() / (rounds * num);
+}
+
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+  int rounds = argc > 1 ? std::atoi(argv[1]) : 2000;
+
+  std::string root = make_tree();
+  sysfs::set_root(root);
+  test_layer(root);
+
+  double legacy_us = bench(root, 0, rounds);
+  double cached_us = bench(root, 1, rounds);
+  double batch_us = bench(root, 2, rounds);
+  std::printf("%d rounds of %zu xmc sensors, %zu subdevices\n", rounds,
+              sizeof(sensors) / sizeof(sensors[0]), sizeof(subdevs) / sizeof(subdevs[0]));
+  std::printf("  resolve + fstream  %8.2f us/query\n", legacy_us);
+  std::printf("  cached + pread     %8.2f us/query  %6.1fx\n", cached_us, legacy_us / cached_us);
+  std::printf("  batch              %8.2f us/query  %6.1fx\n", batch_us, legacy_us / batch_us);
+  check(cached_us < legacy_us && batch_us < legacy_us, "cached queries faster");
+
+  std::string cmd = "rm -rf " + root;
+  if (std::system(cmd.c_str()) != 0)
+    std::cout << "Failed to remove " << root << std::endl;
+
+  if (errors) {
+    std::cout << "FAILED TEST" << std::endl;
+    return 1;
+  }
+  std::cout << "PASSED TEST" << std::endl;
+  return 0;
+}
@@ -0,0 +1,417 @@
+/**
+ * Copyright (C) 2020 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Completion polling of the software scheduler (sws) with and without
+ * Runtime.adaptive_polling, no device required.
+ *
+ * One command at a time is run on a fake CU that completes a fixed
+ * time after it is started.  For each polling mode the bench reports
+ *  - CU register polls per command, the CPU cost of polling
+ *  - completion latency, the time from CU done until the scheduler
+ *    notifies the command, p50, p99 and max
+ * and it reads the CU latency histogram with
+ * xrt_core::sws::get_cu_latency_histogram, which must count every
+ * command.
+ *
+ * The mode is given on the command line because the configuration is
+ * read once per process:
+ *   busy      - poll continuously (the default sws behavior)
+ *   throttle  - sleep Runtime.polling_throttle us between polls
+ *   adaptive  - Runtime.adaptive_polling
+ */
+
+#include "core/common/api/exec.h"
+#include "core/common/api/command.h"
+#include "core/common/device.h"
+#include "core/common/message.h"
+#include "core/common/thread.h"
+#include "core/common/xclbin_parser.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+const uint32_t AP_START    = 0x1;
+const uint32_t AP_DONE     = 0x2;
+const uint32_t AP_IDLE     = 0x4;
+const uint32_t AP_CONTINUE = 0x10;
+
+const uint32_t cu_addr = 0x1000;
+const unsigned int throttle_us = 100;
+
+bool adaptive_polling = false;
+unsigned int polling_throttle = 0;
+
+}
+
+////////////////////////////////////////////////////////////////
+// Stubs for xrt_core functions used by sws.cpp
+////////////////////////////////////////////////////////////////
+namespace xrt_core {
+
+namespace config { namespace detail {
+
+std::string
+get_string_value(const char*, const std::string& default_value)
+{
+  return default_value;
+}
+
+bool
+get_bool_value(const char* key, bool default_value)
+{
+  if (std::strcmp(key, "Runtime.adaptive_polling") == 0)
+    return adaptive_polling;
+  return default_value;
+}
+
+unsigned int
+get_uint_value(const char* key, unsigned int default_value)
+{
+  if (std::strcmp(key, "Runtime.polling_throttle") == 0)
+    return polling_throttle;
+  return default_value;
+}
+
+}} // detail, config
+
+namespace message {
+
+void
+send(severity_level, const char*, const char*)
+{
+}
+
+} // message
+
+device::
+device(id_type device_id)
+  : m_device_id(device_id)
+{}
+
+device::
+~device()
+{}
+
+// Only checked for presence, CU addresses come from get_cus
+std::pair<const char*, size_t>
+device::
+get_axlf_section(axlf_section_kind, const uuid&) const
+{
+  static const char section[] = "<project/>";
+  return {section, sizeof(section)};
+}
+
+std::pair<size_t, size_t>
+device::
+get_ert_slots(const char*, size_t) const
+{
+  return {16, 4096};
+}
+
+namespace xclbin {
+
+std::vector<uint64_t>
+get_cus(const ip_layout*, bool)
+{
+  return {cu_addr};
+}
+
+std::vector<uint64_t>
+get_cus(const char*, size_t, bool)
+{
+  return {cu_addr};
+}
+
+} // xclbin
+
+namespace detail {
+
+void
+set_thread_policy(std::thread&)
+{}
+
+void
+set_cpu_affinity(std::thread&)
+{}
+
+} // detail
+
+} // xrt_core
+
+namespace {
+
+void
+watchdog(int)
+{
+  const char msg[] = "ERROR: command did not complete\nFAILED TEST\n";
+  if (::write(1, msg, sizeof(msg) - 1) < 0)
+    _exit(2);
+  _exit(1);
+}
+
+// CU that completes a fixed time after AP_START is written
+class fake_device : public xrt_core::device
+{
+  std::mutex m_mutex;
+  clock_type::duration m_exec_time;
+  clock_type::time_point m_done_time;
+  bool m_running = false;
+  bool m_done = false;
+
+public:
+  std::atomic<uint64_t> polls {0};
+
+  fake_device(id_type id, clock_type::duration exec_time)
+    : xrt_core::device(id), m_exec_time(exec_time)
+  {}
+
+  clock_type::time_point
+  done_time()
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    return m_done_time;
+  }
+
+  virtual void
+  xread(uint64_t, void* buffer, size_t) const
+  {
+    auto self = const_cast<fake_device*>(this);
+    std::lock_guard<std::mutex> lk(self->m_mutex);
+    ++self->polls;
+    uint32_t ctrl = 0;
+    if (m_running && clock_type::now() >= m_done_time) {
+      self->m_running = false;
+      self->m_done = true;
+    }
+    if (m_running)
+      ctrl = AP_START;
+    else if (m_done)
+      ctrl = AP_DONE | AP_IDLE;
+    std::memcpy(buffer, &ctrl, sizeof(ctrl));
+  }
+
+  virtual void
+  xwrite(uint64_t addr, const void* buffer, size_t)
+  {
+    if (addr != cu_addr)
+      return;
+    uint32_t ctrl = 0;
+    std::memcpy(&ctrl, buffer, sizeof(ctrl));
+    std::lock_guard<std::mutex> lk(m_mutex);
+    if (ctrl & AP_START) {
+      m_running = true;
+      m_done = false;
+      m_done_time = clock_type::now() + m_exec_time;
+    }
+    else if (ctrl & AP_CONTINUE) {
+      m_done = false;
+    }
+  }
+
+  virtual handle_type get_device_handle() const { return nullptr; }
+  virtual void close_device() {}
+  virtual void open_context(const xuid_t, unsigned int, bool) {}
+  virtual void close_context(const xuid_t, unsigned int) {}
+  virtual xclBufferHandle alloc_bo(size_t, unsigned int) { return 0; }
+  virtual xclBufferHandle alloc_bo(void*, size_t, unsigned int) { return 0; }
+  virtual void free_bo(xclBufferHandle) {}
+  virtual xclBufferExportHandle export_bo(xclBufferHandle) const { return 0; }
+  virtual xclBufferHandle import_bo(xclBufferExportHandle) { return 0; }
+  virtual void copy_bo(xclBufferHandle, xclBufferHandle, size_t, size_t, size_t) {}
+  virtual void sync_bo(xclBufferHandle, xclBOSyncDirection, size_t, size_t) {}
+  virtual void* map_bo(xclBufferHandle, bool) { return nullptr; }
+  virtual void unmap_bo(xclBufferHandle, void*) {}
+  virtual void get_bo_properties(xclBufferHandle, struct xclBOProperties*) const {}
+  virtual void reg_read(uint32_t, uint32_t, uint32_t*) const {}
+  virtual void reg_write(uint32_t, uint32_t, uint32_t) {}
+  virtual void unmgd_pread(void*, size_t, uint64_t) {}
+  virtual void unmgd_pwrite(const void*, size_t, uint64_t) {}
+  virtual void exec_buf(xclBufferHandle) {}
+  virtual int exec_wait(int) const { return 0; }
+  virtual void load_xclbin(const struct axlf*) {}
+  virtual void reclock(const uint16_t*) {}
+  virtual void p2p_enable(bool) {}
+  virtual void p2p_disable(bool) {}
+
+private:
+  virtual const xrt_core::query::request&
+  lookup_query(xrt_core::query::key_type) const
+  {
+    throw std::runtime_error("no queries");
+  }
+};
+
+// Start CU command for CU 0 with a 4 word register map.  Records the
+// time the scheduler notified completion.
+class fake_command : public xrt_core::command
+{
+  fake_device* m_device;
+  std::vector<uint32_t> m_packet;
+  std::mutex m_mutex;
+  std::condition_variable m_cv;
+  bool m_done = true;
+  clock_type::time_point m_notified;
+
+public:
+  explicit
+  fake_command(fake_device* device)
+    : m_device(device), m_packet(6, 0)
+  {
+    auto kcmd = reinterpret_cast<ert_start_kernel_cmd*>(m_packet.data());
+    kcmd->opcode = ERT_START_CU;
+    kcmd->type = ERT_CU;
+    kcmd->count = 5;
+    kcmd->cu_mask = 1;
+  }
+
+  void
+  prepare()
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_done = false;
+    auto kcmd = reinterpret_cast<ert_start_kernel_cmd*>(m_packet.data());
+    kcmd->state = ERT_CMD_STATE_NEW;
+    kcmd->data[0] = 0; // control register, sws sets AP_START
+  }
+
+  clock_type::time_point
+  wait()
+  {
+    std::unique_lock<std::mutex> lk(m_mutex);
+    m_cv.wait(lk, [this] { return m_done; });
+    return m_notified;
+  }
+
+  virtual ert_packet*
+  get_ert_packet() const
+  {
+    return reinterpret_cast<ert_packet*>(const_cast<uint32_t*>(m_packet.data()));
+  }
+
+  virtual xrt_core::device*
+  get_device() const
+  {
+    return m_device;
+  }
+
+  virtual xclBufferHandle
+  get_exec_bo() const
+  {
+    return 0;
+  }
+
+  virtual void
+  notify(ert_cmd_state state)
+  {
+    if (state < ERT_CMD_STATE_COMPLETED)
+      return;
+    auto now = clock_type::now();
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_notified = now;
+    m_done = true;
+    m_cv.notify_all();
+  }
+};
+
+double
+percentile(std::vector<double>& values, double p)
+{
+  std::sort(values.begin(), values.end());
+  auto idx = static_cast<size_t>(p * (values.size() - 1));
+  return values[idx];
+}
+
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+  std::string mode = argc > 1 ? argv[1] : "";
+  unsigned int runs = argc > 2 ? std::atoi(argv[2]) : 2000;
+  if (mode == "adaptive")
+    adaptive_polling = true;
+  else if (mode == "throttle")
+    polling_throttle = throttle_us;
+  else if (mode != "busy") {
+    std::cout << "usage: " << argv[0] << " busy|throttle|adaptive [runs]" << std::endl;
+    return 1;
+  }
+
+  std::signal(SIGALRM, watchdog);
+  alarm(120);
+
+  const auto exec_time = std::chrono::microseconds(200);
+  fake_device dev(0, exec_time);
+  xrt_core::sws::start();
+  xrt_core::sws::init(&dev);
+
+  auto cmd = std::make_shared<fake_command>(&dev);
+  std::vector<double> latency;
+  latency.reserve(runs);
+  for (unsigned int i = 0; i < runs; ++i) {
+    cmd->prepare();
+    xrt_core::sws::schedule(cmd.get());
+    auto notified = cmd->wait();
+    latency.push_back(std::chrono::duration<double, std::micro>(notified - dev.done_time()).count());
+  }
+
+  auto hist = xrt_core::sws::get_cu_latency_histogram(&dev, 0);
+  xrt_core::sws::stop();
+
+  double polls = static_cast<double>(dev.polls) / runs;
+  auto max = *std::max_element(latency.begin(), latency.end());
+  auto p50 = percentile(latency, 0.50);
+  auto p99 = percentile(latency, 0.99);
+  std::printf("%-9s %u runs of %d us: %9.1f polls/run, completion latency us p50 %7.1f p99 %7.1f max %7.1f\n",
+              mode.c_str(), runs, static_cast<int>(exec_time.count()), polls, p50, p99, max);
+
+  uint64_t samples = 0;
+  std::string buckets;
+  for (size_t idx = 0; idx < hist.size(); ++idx) {
+    samples += hist[idx];
+    if (hist[idx])
+      buckets += " [" + std::to_string((1u << idx) - 1) + "," + std::to_string((2u << idx) - 1)
+        + ")us:" + std::to_string(hist[idx]);
+  }
+  std::cout << "          cu(0) latency histogram" << buckets << std::endl;
+
+  if (hist.size() != 32 || samples != runs) {
+    std::cout << "ERROR: histogram has " << samples << " samples, expected " << runs
+              << "\nFAILED TEST" << std::endl;
+    return 1;
+  }
+  std::cout << "PASSED TEST" << std::endl;
+  return 0;
+}
@@ -0,0 +1,256 @@
+// Bounded memory mode of the XDP event database.
+//
+// Runs with Debug.trace_event_limit set and the Debug.trace_drop_policy
+// given on the command line ("none" or "newest").  A plugin with one
+// trace writer is registered and the first background flush is held
+// inside the writer while the application keeps recording events:
+//
+//  - "none" keeps every event past the limit, "newest" drops every
+//    event that arrives while the limit is reached
+//  - events written by the flush are released, so the final write
+//    sees each remaining event exactly once
+//  - the flush thread is joined when the database is destroyed
+//
+// A watchdog fails the test if a flush or the exit hangs.
+
+#include "xdp/profile/database/database.h"
+#include "xdp/profile/database/events/hal_api_calls.h"
+#include "xdp/profile/plugin/vp_base/vp_base_plugin.h"
+#include "xdp/profile/writer/vp_base/vp_writer.h"
+#include "core/common/message.h"
+
+#include <condition_variable>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+
+namespace {
+
+const unsigned int event_limit = 1000;
+std::string drop_policy;
+
+}
+
+namespace xrt_core {
+
+namespace config { namespace detail {
+
+std::string
+get_string_value(const char* key, const std::string& default_value)
+{
+  if (std::strcmp(key, "Debug.trace_drop_policy") == 0)
+    return drop_policy;
+  return default_value;
+}
+
+bool
+get_bool_value(const char*, bool default_value)
+{
+  return default_value;
+}
+
+unsigned int
+get_uint_value(const char* key, unsigned int default_value)
+{
+  if (std::strcmp(key, "Debug.trace_event_limit") == 0)
+    return event_limit;
+  return default_value;
+}
+
+}} // detail, config
+
+namespace message {
+
+void
+send(severity_level, const char*, const char*)
+{
+}
+
+} // message
+
+} // xrt_core
+
+namespace xdp {
+
+// No xclbin and no devices
+VPStaticDatabase::VPStaticDatabase(VPDatabase* d) : db(d), runSummary(nullptr), pid(0)
+{
+}
+
+VPStaticDatabase::~VPStaticDatabase()
+{
+}
+
+void
+VPStaticDatabase::addOpenedFile(const std::string&, const std::string&)
+{
+}
+
+} // xdp
+
+namespace {
+
+static void
+check(bool cond, const std::string& msg)
+{
+  if (!cond)
+    throw std::runtime_error(msg);
+}
+
+static void
+watchdog(int)
+{
+  const char msg[] = "ERROR: flush did not complete\nFAILED TEST\n";
+  if (::write(1, msg, sizeof(msg) - 1) < 0)
+    _exit(2);
+  _exit(1);
+}
+
+// Records the ids of the host events it writes.  A flush (write with
+// openNewFile) waits in the writer until the test opens the gate.
+class gated_writer : public xdp::VPWriter
+{
+  std::mutex mutex;
+  std::condition_variable cond;
+  bool gate_open = false;
+  bool in_flush = false;
+
+public:
+  std::set<uint64_t> written;
+  size_t flushes = 0;
+  size_t flushed = 0;
+  size_t duplicates = 0;
+
+  gated_writer(const char* file) : VPWriter(file) {}
+
+  virtual bool isTraceWriter() { return true; }
+
+  virtual void
+  write(bool openNewFile)
+  {
+    auto events = db->getDynamicInfo().getHostEvents();
+    if (openNewFile) {
+      std::unique_lock<std::mutex> lk(mutex);
+      in_flush = true;
+      cond.notify_all();
+      cond.wait(lk, [this] { return gate_open; });
+      ++flushes;
+      flushed += events.size();
+    }
+    for (auto e : events)
+      if (!written.insert(e->getEventId()).second)
+        ++duplicates;
+  }
+
+  void
+  wait_for_flush()
+  {
+    std::unique_lock<std::mutex> lk(mutex);
+    cond.wait(lk, [this] { return in_flush; });
+  }
+
+  void
+  open_gate()
+  {
+    std::lock_guard<std::mutex> lk(mutex);
+    gate_open = true;
+    cond.notify_all();
+  }
+};
+
+class test_plugin : public xdp::XDPPlugin
+{
+public:
+  gated_writer* writer;
+
+  test_plugin(const char* file) : writer(new gated_writer(file))
+  {
+    writers.push_back(writer);
+    db->registerPlugin(this);
+  }
+
+  // As a plugin does at the end of execution
+  void
+  finish()
+  {
+    db->unregisterPlugin(this);
+    writeAll(false);
+  }
+};
+
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+  if (argc != 2) {
+    std::cout << "usage: " << argv[0] << " none|newest" << std::endl;
+    return 1;
+  }
+  drop_policy = argv[1];
+
+  std::signal(SIGALRM, watchdog);
+  alarm(60);
+
+  const char* file = "bounded_trace.csv";
+  try {
+    auto db = xdp::VPDatabase::Instance();
+    auto& dyndb = db->getDynamicInfo();
+    check(dyndb.isBounded(), "bounded mode enabled");
+
+    test_plugin plugin(file);
+    auto writer = plugin.writer;
+
+    // The first flush is requested at half the limit and is held in
+    // the writer while three times the limit is recorded
+    const uint64_t total = 3 * event_limit;
+    uint64_t recorded = 0;
+    for (uint64_t i = 0; i < total; ++i) {
+      if (i == event_limit / 2 + 1)
+        writer->wait_for_flush();
+      if (dyndb.createHostEvent<xdp::HALAPICall>(0, 1000.0 * i, 1))
+        ++recorded;
+    }
+
+    uint64_t dropped = dyndb.getNumDropped();
+    if (drop_policy == "newest") {
+      check(recorded == event_limit, "newest: events recorded up to the limit, got " + std::to_string(recorded));
+      check(dropped == total - event_limit, "newest: events past the limit dropped, got " + std::to_string(dropped));
+    }
+    else {
+      check(recorded == total, "none: all events recorded, got " + std::to_string(recorded));
+      check(dropped == 0, "none: no events dropped");
+    }
+
+    // Unregistering waits for the flush to release its events
+    writer->open_gate();
+    plugin.finish();
+
+    check(writer->flushes == 1, "one flush, got " + std::to_string(writer->flushes));
+    check(writer->flushed > 0 && writer->flushed <= event_limit,
+          "flush wrote the events held at the request, got " + std::to_string(writer->flushed));
+    check(writer->duplicates == 0, "flushed events released, " + std::to_string(writer->duplicates) + " written twice");
+    check(writer->written.size() == recorded,
+          "every recorded event written once, got " + std::to_string(writer->written.size()));
+
+    std::cout << drop_policy << ": recorded " << recorded << " dropped " << dropped
+              << ", flush wrote " << writer->flushed << ", final write "
+              << writer->written.size() - writer->flushed << std::endl;
+  }
+  catch (const std::exception& ex) {
+    std::remove(file);
+    std::cout << "ERROR: " << ex.what() << "\nFAILED TEST" << std::endl;
+    return 1;
+  }
+  std::remove(file);
+
+  // The flush thread is joined by the database destructor at exit
+  std::cout << "PASSED TEST" << std::endl;
+  return 0;
+}
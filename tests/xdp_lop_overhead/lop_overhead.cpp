@@ -0,0 +1,116 @@
+/**
+ * Copyright (C) 2020 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+// Per-event overhead of low overhead profiling.
+//
+// Loads the LOP plugin the same way XRT does (dlopen/dlsym) and calls
+// the function start/end callbacks from 1 to 64 threads concurrently.
+// Reports the average wall clock cost per recorded event.  The plugin
+// writes its trace file when the process exits.
+
+#include <atomic>
+#include <chrono>
+#include <dlfcn.h>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+typedef void (*function_cb)(const char*, long long, unsigned int);
+
+static const unsigned int CALLS_PER_THREAD = 100000;
+
+static const char* names[] = {
+  "clEnqueueNDRangeKernel", "clEnqueueWriteBuffer",
+  "clEnqueueReadBuffer", "clFinish"
+};
+
+static void
+worker(function_cb start, function_cb end, unsigned int id, std::atomic<unsigned int>& ready,
+       const std::atomic<bool>& go)
+{
+  ++ready;
+  while (!go)
+    ;
+
+  // Function IDs must be unique across all threads
+  unsigned int base = id * CALLS_PER_THREAD;
+  for (unsigned int i = 0; i < CALLS_PER_THREAD; ++i) {
+    const char* name = names[i % 4];
+    start(name, 0, base + i);
+    end(name, 0, base + i);
+  }
+}
+
+static double
+run(function_cb start, function_cb end, unsigned int num_threads, unsigned int first_id)
+{
+  std::atomic<unsigned int> ready(0);
+  std::atomic<bool> go(false);
+  std::vector<std::thread> threads;
+  for (unsigned int t = 0; t < num_threads; ++t)
+    threads.emplace_back(worker, start, end, first_id + t, std::ref(ready), std::cref(go));
+
+  while (ready < num_threads)
+    std::this_thread::yield();
+
+  auto begin = std::chrono::high_resolution_clock::now();
+  go = true;
+  for (auto& t : threads)
+    t.join();
+  auto finish = std::chrono::high_resolution_clock::now();
+
+  double ns = std::chrono::duration_cast<std::chrono::nanoseconds>(finish - begin).count();
+  double events = 2.0 * CALLS_PER_THREAD * num_threads;
+
+  // Cost per event as seen by one thread
+  return ns * num_threads / events;
+}
+
+}
+
+int
+main()
+{
+  void* handle = dlopen("libxdp_lop_plugin.so", RTLD_NOW | RTLD_GLOBAL);
+  if (!handle) {
+    std::cout << "Failed to load libxdp_lop_plugin.so: " << dlerror() << "\n";
+    std::cout << "FAILED TEST\n";
+    return 1;
+  }
+
+  auto start = reinterpret_cast<function_cb>(dlsym(handle, "lop_function_start"));
+  auto end = reinterpret_cast<function_cb>(dlsym(handle, "lop_function_end"));
+  if (!start || !end) {
+    std::cout << "LOP callbacks not found in plugin\n";
+    std::cout << "FAILED TEST\n";
+    return 1;
+  }
+
+  std::cout << "threads\tns/event\n";
+  unsigned int first_id = 1;
+  for (unsigned int threads = 1; threads <= 64; threads *= 2) {
+    double cost = run(start, end, threads, first_id);
+    first_id += threads;
+    std::cout << threads << "\t" << cost << "\n";
+  }
+
+  std::cout << "PASSED TEST\n";
+  return 0;
+}
@@ -0,0 +1,227 @@
+// Compute unit latency statistics from device trace.
+//
+// Synthetic accelerator monitor trace packets for two compute units
+// are turned into events by xdp::DeviceEventCreatorFromTrace, which
+// records each compute unit execution in the statistics database.
+// The "Compute Unit Latency (ns)" rows of the HAL summary are then
+// checked against the known execution times.
+//
+// The static database normally comes from the xclbin and the device,
+// here its constructor is replaced by one that describes a device
+// with two compute units, each with an accelerator monitor.
+
+#include "xdp/profile/database/database.h"
+#include "xdp/profile/database/events/creator/device_event_from_trace.h"
+#include "xdp/profile/writer/hal/hal_summary_writer.h"
+#include "core/common/message.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace xrt_core {
+
+namespace config { namespace detail {
+
+std::string
+get_string_value(const char*, const std::string& default_value)
+{
+  return default_value;
+}
+
+bool
+get_bool_value(const char*, bool default_value)
+{
+  return default_value;
+}
+
+unsigned int
+get_uint_value(const char*, unsigned int default_value)
+{
+  return default_value;
+}
+
+}} // detail, config
+
+namespace message {
+
+void
+send(severity_level, const char*, const char*)
+{
+}
+
+} // message
+
+} // xrt_core
+
+namespace xdp {
+
+// Device 0 at 1000 MHz, so one trace cycle is one ns.  AM slot s
+// monitors CU s.
+VPStaticDatabase::VPStaticDatabase(VPDatabase* d) : db(d), runSummary(nullptr), pid(0)
+{
+  auto info = new DeviceInfo();
+  info->isReady = true;
+  info->clockRateMHz = 1000;
+  info->deviceIntf = nullptr;
+  info->cus[0] = new ComputeUnitInstance(0, "vadd:vadd_1");
+  info->cus[1] = new ComputeUnitInstance(1, "vadd:vadd_2");
+  info->amMap[0] = new Monitor(0, 0, "am_vadd_1", 0);
+  info->amMap[1] = new Monitor(0, 1, "am_vadd_2", 1);
+  deviceInfo[0] = info;
+}
+
+VPStaticDatabase::~VPStaticDatabase()
+{
+}
+
+DeviceInfo::~DeviceInfo()
+{
+}
+
+void
+VPStaticDatabase::addOpenedFile(const std::string&, const std::string&)
+{
+}
+
+ComputeUnitInstance::ComputeUnitInstance(int32_t i, const std::string& n)
+  : index(i), amId(-1)
+{
+  name = n.substr(n.find(':') + 1);
+  kernelName = n.substr(0, n.find(':'));
+}
+
+ComputeUnitInstance::~ComputeUnitInstance()
+{
+}
+
+} // xdp
+
+namespace {
+
+static void
+check(bool cond, const std::string& msg)
+{
+  if (!cond)
+    throw std::runtime_error(msg);
+}
+
+// Start or end of the CU monitored by AM slot
+static xclTraceResults
+cu_packet(unsigned int slot, uint64_t timestamp, bool start)
+{
+  xclTraceResults trace = {};
+  trace.Timestamp = timestamp;
+  trace.TraceID = MIN_TRACE_ID_AM + 16 * slot + XAM_TRACE_CU_MASK;
+  trace.EventFlags = start ? XAM_TRACE_CU_MASK : 0;
+  return trace;
+}
+
+struct row
+{
+  uint64_t count, min, max, p50, p99;
+  double mean;
+};
+
+// Rows of the named table in the summary file
+static std::map<std::string, row>
+read_table(const std::string& file, const std::string& title)
+{
+  std::ifstream ifs(file);
+  std::string line;
+  while (std::getline(ifs, line) && line != title)
+    ;
+  check(!ifs.eof(), "summary has table " + title);
+  std::getline(ifs, line);
+  check(line == "Name,Count,Min,Mean,Max,P50,P99,P999", "table header");
+
+  std::map<std::string, row> rows;
+  while (std::getline(ifs, line) && !line.empty()) {
+    std::istringstream is(line);
+    std::string name, field;
+    std::vector<std::string> fields;
+    std::getline(is, name, ',');
+    while (std::getline(is, field, ','))
+      fields.push_back(field);
+    check(fields.size() == 7, "row has 8 columns: " + line);
+    rows[name] = { std::stoull(fields[0]), std::stoull(fields[1]), std::stoull(fields[3]),
+                   std::stoull(fields[4]), std::stoull(fields[5]), std::stod(fields[2]) };
+  }
+  return rows;
+}
+
+// Relative error allowed by the histogram bucket resolution
+static bool
+close_enough(uint64_t actual, uint64_t expected)
+{
+  uint64_t diff = actual > expected ? actual - expected : expected - actual;
+  return diff * 16 <= expected + 16;
+}
+
+} // namespace
+
+int
+main()
+{
+  try {
+    xdp::DeviceEventCreatorFromTrace creator(0);
+
+    // vadd_1: 100 runs of 1000 ns, one of 50000 ns
+    // vadd_2: two overlapping (pipelined) runs of 2000 ns, 100 times
+    std::vector<xclTraceResults> trace;
+    uint64_t t = 1000;
+    for (int i = 0; i < 100; ++i) {
+      trace.push_back(cu_packet(0, t, true));
+      trace.push_back(cu_packet(1, t + 10, true));
+      trace.push_back(cu_packet(1, t + 510, true));
+      trace.push_back(cu_packet(0, t + 1000, false));
+      trace.push_back(cu_packet(1, t + 2010, false));
+      trace.push_back(cu_packet(1, t + 2510, false));
+      t += 5000;
+    }
+    trace.push_back(cu_packet(0, t, true));
+    trace.push_back(cu_packet(0, t + 50000, false));
+
+    // A start without an end is not an execution
+    trace.push_back(cu_packet(1, t + 60000, true));
+
+    creator.createDeviceEvents(trace.data(), trace.size());
+
+    const char* file = "cu_latency_summary.csv";
+    {
+      xdp::HALSummaryWriter writer(file);
+      writer.write(false);
+    }
+    auto rows = read_table(file, "Compute Unit Latency (ns)");
+    std::remove(file);
+
+    check(rows.size() == 2, "one row per compute unit");
+    auto& cu1 = rows.at("vadd_1");
+    check(cu1.count == 101, "vadd_1 count " + std::to_string(cu1.count));
+    check(close_enough(cu1.min, 1000), "vadd_1 min");
+    check(close_enough(cu1.p50, 1000), "vadd_1 p50");
+    check(close_enough(cu1.max, 50000), "vadd_1 max");
+    check(close_enough(static_cast<uint64_t>(cu1.mean), (100 * 1000 + 50000) / 101), "vadd_1 mean");
+
+    auto& cu2 = rows.at("vadd_2");
+    check(cu2.count == 200, "vadd_2 count " + std::to_string(cu2.count));
+    check(close_enough(cu2.min, 2000) && close_enough(cu2.max, 2000), "vadd_2 pipelined runs paired in order");
+    check(close_enough(cu2.p99, 2000), "vadd_2 p99");
+
+    std::cout << "vadd_1: count " << cu1.count << " p50 " << cu1.p50 << " p99 " << cu1.p99
+              << " max " << cu1.max << " ns\n";
+    std::cout << "vadd_2: count " << cu2.count << " p50 " << cu2.p50 << " p99 " << cu2.p99
+              << " max " << cu2.max << " ns\n";
+  }
+  catch (const std::exception& ex) {
+    std::cout << "ERROR: " << ex.what() << "\nFAILED TEST" << std::endl;
+    return 1;
+  }
+  std::cout << "PASSED TEST" << std::endl;
+  return 0;
+}
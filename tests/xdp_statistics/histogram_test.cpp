@@ -0,0 +1,177 @@
+/**
+ * Copyright (C) 2020 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+// Unit tests for xdp::LatencyHistogram and xdp::ConcurrentLatencyHistogram
+
+#include "xdp/profile/database/latency_histogram.h"
+
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using xdp::LatencyHistogram;
+using xdp::ConcurrentLatencyHistogram;
+
+static void
+check(bool cond, const std::string& msg)
+{
+  if (!cond)
+    throw std::runtime_error(msg);
+}
+
+// Relative error allowed by the bucket resolution
+static bool
+close_enough(uint64_t actual, uint64_t expected)
+{
+  uint64_t diff = actual > expected ? actual - expected : expected - actual;
+  return diff * LatencyHistogram::SUB_BUCKETS <= expected + LatencyHistogram::SUB_BUCKETS;
+}
+
+static void
+test_buckets()
+{
+  // Buckets are contiguous, ordered and cover every value
+  uint64_t next = 0;
+  for (unsigned int i = 0; i < LatencyHistogram::NUM_BUCKETS; ++i) {
+    check(LatencyHistogram::bucketLowerBound(i) == next, "buckets are contiguous");
+    next += LatencyHistogram::bucketWidth(i);
+  }
+
+  for (uint64_t v = 0; v < 100000; ++v) {
+    auto i = LatencyHistogram::bucketIndex(v);
+    check(LatencyHistogram::bucketLowerBound(i) <= v, "value above lower bound");
+    check(v < LatencyHistogram::bucketLowerBound(i) + LatencyHistogram::bucketWidth(i),
+          "value below upper bound");
+  }
+
+  check(LatencyHistogram::bucketIndex(~0ULL) == LatencyHistogram::NUM_BUCKETS - 1,
+        "overflow goes to last bucket");
+}
+
+static void
+test_empty()
+{
+  LatencyHistogram h;
+  check(h.getCount() == 0, "empty count");
+  check(h.getMin() == 0 && h.getMax() == 0, "empty min/max");
+  check(h.getPercentile(0.5) == 0, "empty percentile");
+}
+
+static void
+test_percentiles()
+{
+  LatencyHistogram h;
+  for (uint64_t v = 1; v <= 100000; ++v)
+    h.record(v * 10);
+
+  check(h.getCount() == 100000, "count");
+  check(h.getMin() == 10, "min");
+  check(h.getMax() == 1000000, "max");
+  check(h.getMean() == 500005.0, "mean");
+  check(close_enough(h.getPercentile(0.5), 500000), "p50");
+  check(close_enough(h.getPercentile(0.99), 990000), "p99");
+  check(close_enough(h.getPercentile(0.999), 999000), "p999");
+  check(h.getPercentile(1.0) == 1000000, "p100 is max");
+  check(h.getPercentile(0.0) == 10, "p0 is min");
+}
+
+static void
+test_merge()
+{
+  LatencyHistogram a, b, all;
+  std::mt19937_64 gen(7);
+  std::lognormal_distribution<double> dist(10.0, 1.5);
+  for (int i = 0; i < 50000; ++i) {
+    auto v = static_cast<uint64_t>(dist(gen));
+    (i % 2 ? a : b).record(v);
+    all.record(v);
+  }
+  a.merge(b);
+  check(a.getCount() == all.getCount(), "merged count");
+  check(a.getSum() == all.getSum(), "merged sum");
+  check(a.getMin() == all.getMin() && a.getMax() == all.getMax(), "merged min/max");
+  for (double p : { 0.5, 0.9, 0.99, 0.999 })
+    check(a.getPercentile(p) == all.getPercentile(p), "merged percentile");
+}
+
+static void
+test_concurrent()
+{
+  // One writer per histogram while another thread keeps merging
+  const int threads = 8;
+  const uint64_t per_thread = 200000;
+  std::vector<std::unique_ptr<ConcurrentLatencyHistogram>> hists;
+  for (int t = 0; t < threads; ++t)
+    hists.emplace_back(new ConcurrentLatencyHistogram);
+
+  std::atomic<bool> done(false);
+  std::thread reader([&] {
+    while (!done) {
+      LatencyHistogram merged;
+      for (auto& h : hists)
+        h->addTo(merged);
+      check(merged.getCount() <= threads * per_thread, "partial merge count");
+    }
+  });
+
+  std::vector<std::thread> writers;
+  for (int t = 0; t < threads; ++t)
+    writers.emplace_back([&, t] {
+      for (uint64_t v = 1; v <= per_thread; ++v)
+        hists[t]->record(v);
+    });
+  for (auto& w : writers)
+    w.join();
+  done = true;
+  reader.join();
+
+  LatencyHistogram merged;
+  for (auto& h : hists)
+    h->addTo(merged);
+  check(merged.getCount() == threads * per_thread, "final count");
+  check(merged.getMin() == 1 && merged.getMax() == per_thread, "final min/max");
+  check(merged.getSum() == threads * (per_thread * (per_thread + 1) / 2), "final sum");
+  check(close_enough(merged.getPercentile(0.5), per_thread / 2), "final p50");
+}
+
+}
+
+int
+main()
+{
+  try {
+    test_buckets();
+    test_empty();
+    test_percentiles();
+    test_merge();
+    test_concurrent();
+    std::cout << "PASSED TEST\n";
+    return 0;
+  }
+  catch (const std::exception& ex) {
+    std::cout << "Error: " << ex.what() << "\n";
+    std::cout << "FAILED TEST\n";
+    return 1;
+  }
+}
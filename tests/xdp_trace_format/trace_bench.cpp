@@ -0,0 +1,235 @@
+/**
+ * Copyright (C) 2020 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+// Writes the same synthetic trace as csv (VTFEvent::dump) and in the
+// binary format (xdp::BinaryTraceEncoder), reports throughput and file
+// size, then converts the binary trace and checks it matches the csv.
+
+#include "xdp/profile/writer/vp_base/binary_trace.h"
+#include "xdp/profile/database/events/hal_api_calls.h"
+#include "xdp/profile/database/events/opencl_host_events.h"
+#include "xdp/profile/database/events/device_events.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+static const size_t BATCH = 1000000;
+
+struct Generated
+{
+  std::unique_ptr<xdp::VTFEvent> event;
+  uint32_t bucket;
+};
+
+// Produces the same event sequence on every call: HAL API calls, buffer
+// transfers and device kernel and memory events, roughly in the mix a
+// hardware run with device trace produces
+class generator
+{
+  std::mt19937_64 gen;
+  uint64_t id = 0;
+  double host_ns = 1.6e9;
+  double device_ms = 1600.0;
+  uint64_t open_api = 0;
+  uint64_t open_api_name = 0;
+
+public:
+  generator() : gen(42) {}
+
+  void
+  next(std::vector<Generated>& out, size_t count)
+  {
+    out.clear();
+    for (size_t i = 0; i < count; ++i) {
+      auto kind = gen() % 10;
+      xdp::VTFEvent* e = nullptr;
+      uint32_t bucket = 0;
+      if (kind < 4) {
+        host_ns += 200 + gen() % 5000;
+        if (open_api == 0) {
+          open_api_name = 1 + gen() % 40;
+          e = new xdp::HALAPICall(0, host_ns, open_api_name);
+          open_api = id + 1;
+        }
+        else {
+          e = new xdp::HALAPICall(open_api, host_ns, open_api_name);
+          open_api = 0;
+        }
+        bucket = 1;
+      }
+      else if (kind < 5) {
+        host_ns += 1000 + gen() % 20000;
+        auto ty = (gen() & 1) ? xdp::READ_BUFFER : xdp::WRITE_BUFFER;
+        e = new xdp::BufferTransfer(0, host_ns, ty, 4096 * (1 + gen() % 256));
+        bucket = ty == xdp::READ_BUFFER ? 2 : 3;
+      }
+      else if (kind < 8) {
+        device_ms += (10 + gen() % 2000) / 1.0e6;
+        int32_t cu = gen() % 4;
+        e = new xdp::KernelEvent(0, device_ms, xdp::KERNEL, 0, 0, cu);
+        bucket = 10 + cu;
+      }
+      else {
+        device_ms += (10 + gen() % 500) / 1.0e6;
+        uint32_t mon = gen() % 8;
+        auto ty = (gen() & 1) ? xdp::KERNEL_READ : xdp::KERNEL_WRITE;
+        e = new xdp::DeviceMemoryAccess(0, device_ms, ty, 0, mon, 0);
+        bucket = 20 + 2 * mon + (ty - xdp::KERNEL_READ);
+      }
+      e->setEventId(++id);
+      out.push_back({ std::unique_ptr<xdp::VTFEvent>(e), bucket });
+    }
+  }
+};
+
+static const char* header =
+  "HEADER\nVTF File Version,1.0\nVTF File Type,0\n\nEVENTS\n";
+static const char* footer = "\nDEPENDENCIES\n\n";
+
+static double
+write_csv(const char* path, uint64_t events)
+{
+  generator g;
+  std::vector<Generated> batch;
+  double seconds = 0;
+
+  std::ofstream fout(path);
+  fout << header;
+  for (uint64_t done = 0; done < events; done += BATCH) {
+    g.next(batch, std::min<uint64_t>(BATCH, events - done));
+    auto start = clock_type::now();
+    for (auto& b : batch)
+      b.event->dump(fout, b.bucket);
+    seconds += std::chrono::duration<double>(clock_type::now() - start).count();
+  }
+  auto start = clock_type::now();
+  fout << footer;
+  fout.close();
+  seconds += std::chrono::duration<double>(clock_type::now() - start).count();
+  return seconds;
+}
+
+static double
+write_binary(const char* path, uint64_t events)
+{
+  generator g;
+  std::vector<Generated> batch;
+  double seconds = 0;
+
+  std::ofstream fout(path, std::ios_base::out | std::ios_base::binary);
+  xdp::BinaryTraceEncoder encoder(fout);
+  encoder.beginText();
+  fout << header;
+  for (uint64_t done = 0; done < events; done += BATCH) {
+    g.next(batch, std::min<uint64_t>(BATCH, events - done));
+    auto start = clock_type::now();
+    for (auto& b : batch)
+      encoder.addEvent(b.event.get(), b.bucket);
+    seconds += std::chrono::duration<double>(clock_type::now() - start).count();
+  }
+  auto start = clock_type::now();
+  encoder.flushEvents();
+  encoder.beginText();
+  fout << footer;
+  encoder.endText();
+  fout.close();
+  seconds += std::chrono::duration<double>(clock_type::now() - start).count();
+  return seconds;
+}
+
+static uint64_t
+file_size(const char* path)
+{
+  std::ifstream f(path, std::ios_base::in | std::ios_base::binary | std::ios_base::ate);
+  return static_cast<uint64_t>(f.tellg());
+}
+
+static bool
+same_files(const char* a, const char* b)
+{
+  std::ifstream fa(a, std::ios_base::binary), fb(b, std::ios_base::binary);
+  std::vector<char> ba(1 << 20), bb(1 << 20);
+  while (fa && fb) {
+    fa.read(ba.data(), ba.size());
+    fb.read(bb.data(), bb.size());
+    if (fa.gcount() != fb.gcount() ||
+        !std::equal(ba.begin(), ba.begin() + fa.gcount(), bb.begin()))
+      return false;
+  }
+  return fa.eof() && fb.eof();
+}
+
+}
+
+int
+main(int argc, char* argv[])
+{
+  uint64_t events = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 50000000;
+
+  const char* csv = "bench_trace.csv";
+  const char* bin = "bench_trace.bin";
+  const char* converted = "bench_trace_converted.csv";
+
+  double csv_s = write_csv(csv, events);
+  double bin_s = write_binary(bin, events);
+
+  auto start = clock_type::now();
+  {
+    std::ifstream in(bin, std::ios_base::in | std::ios_base::binary);
+    std::ofstream out(converted, std::ios_base::out | std::ios_base::binary);
+    std::string error;
+    if (!xdp::convertBinaryTrace(in, out, error)) {
+      std::cout << "Error: " << error << "\n";
+      std::cout << "FAILED TEST\n";
+      return 1;
+    }
+  }
+  double convert_s = std::chrono::duration<double>(clock_type::now() - start).count();
+
+  uint64_t csv_bytes = file_size(csv);
+  uint64_t bin_bytes = file_size(bin);
+
+  std::printf("%llu events\n", static_cast<unsigned long long>(events));
+  std::printf("  csv    : %8.2f s  %8.2f Mevents/s  %10.1f MB  %6.2f bytes/event\n",
+              csv_s, events / csv_s / 1e6, csv_bytes / 1e6, double(csv_bytes) / events);
+  std::printf("  binary : %8.2f s  %8.2f Mevents/s  %10.1f MB  %6.2f bytes/event\n",
+              bin_s, events / bin_s / 1e6, bin_bytes / 1e6, double(bin_bytes) / events);
+  std::printf("  convert: %8.2f s  %8.2f Mevents/s\n", convert_s, events / convert_s / 1e6);
+
+  bool same = same_files(csv, converted);
+  std::remove(csv);
+  std::remove(bin);
+  std::remove(converted);
+
+  if (!same) {
+    std::cout << "Error: converted trace differs from csv\n";
+    std::cout << "FAILED TEST\n";
+    return 1;
+  }
+  std::cout << "PASSED TEST\n";
+  return 0;
+}
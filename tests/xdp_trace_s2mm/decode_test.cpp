@@ -0,0 +1,389 @@
+/**
+ * Copyright (C) 2020 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+// Checks xdp::TracePacketDecoder against the original TraceS2MM parser
+// on synthetic trace buffers (or a raw trace buffer dump given on the
+// command line) and reports decode throughput.
+//
+//   decode_test.exe [packets] [raw_dump.bin trace_format]
+
+#include "xdp/profile/device/trace_packet_decoder.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+static void
+check(bool cond, const std::string& msg)
+{
+  if (!cond)
+    throw std::runtime_error(msg);
+}
+
+// The parser as it was in TraceS2MM, kept as the reference.  The one
+// change is that the first timestamp comes from the first packet after
+// any leftover data (i == idx) rather than from packet 0 of whichever
+// buffer first reaches it, which made timestamps depend on where the
+// offload happened to split the trace.
+struct reference_parser
+{
+  uint32_t mTraceFormat = 0;
+  uint64_t mPacketFirstTs = 0;
+  bool mclockTrainingdone = false;
+  uint32_t mModulus = 0;
+  uint64_t mPartialTs = 0;
+
+  void
+  parsePacketClockTrain(uint64_t packet, uint64_t firstTimestamp, uint32_t mod, xclTraceResults &result)
+  {
+    uint64_t tsmask = 0x1FFFFFFFFFFF;
+    if (mod == 0) {
+      uint64_t timestamp = packet & tsmask;
+      if (timestamp >= firstTimestamp)
+        result.Timestamp = timestamp - firstTimestamp;
+      else
+        result.Timestamp = timestamp + (tsmask - firstTimestamp);
+      result.isClockTrain = 1 ;
+    }
+    mPartialTs = mPartialTs | (((packet >> 45) & 0xFFFF) << (16 * mod));
+    if (mod == 3) {
+      result.HostTimestamp = mPartialTs;
+      mPartialTs = 0;
+    }
+  }
+
+  void
+  parsePacket(uint64_t packet, uint64_t firstTimestamp, xclTraceResults &result)
+  {
+    result.Timestamp = (packet & 0x1FFFFFFFFFFF) - firstTimestamp;
+    result.EventType = ((packet >> 45) & 0xF) ? XCL_PERF_MON_END_EVENT :
+        XCL_PERF_MON_START_EVENT;
+    result.TraceID = (packet >> 49) & 0xFFF;
+    result.Reserved = (packet >> 61) & 0x1;
+    result.Overflow = (packet >> 62) & 0x1;
+    result.EventID = XCL_PERF_MON_HW_EVENT;
+    result.EventFlags = ((packet >> 45) & 0xF) | ((packet >> 57) & 0x10);
+    result.isClockTrain = 0 ;
+  }
+
+  uint64_t
+  seekClockTraining(uint64_t* arr, uint64_t count)
+  {
+    uint64_t n = 8;
+    if (mTraceFormat < 1  || mclockTrainingdone)
+      return 0;
+    if (count < n)
+      return count;
+    count -= n;
+    for (uint64_t i=0; i <= count; i++) {
+      for (uint64_t j=i; j < i + n; j++) {
+        if (!((arr[j] >> 63) & 0x1))
+          break;
+        if (j == i+n-1)
+          return i;
+      }
+    }
+    return count;
+  }
+
+  void
+  parseTraceBuf(void* buf, uint64_t size, xclTraceResultsVector& traceVector)
+  {
+    uint32_t packetSizeBytes = 8;
+    uint32_t tvindex = 0;
+    traceVector.mLength = 0;
+    uint64_t count = size / packetSizeBytes;
+    if (count > MAX_TRACE_NUMBER_SAMPLES)
+      count = MAX_TRACE_NUMBER_SAMPLES;
+    auto pos = static_cast<uint64_t*>(buf);
+    uint64_t idx = seekClockTraining(pos, count);
+    if (idx == count)
+      return;
+    for (auto i = idx; i < count; i++) {
+      auto currentPacket = pos[i];
+      if (!currentPacket)
+        return;
+      if (i == idx && !mPacketFirstTs)
+        mPacketFirstTs = currentPacket & 0x1FFFFFFFFFFF;
+      bool isClockTrain = false;
+      if (mTraceFormat == 1)
+        isClockTrain = ((currentPacket >> 63) & 0x1);
+      else
+        isClockTrain = (i < 8 && !mclockTrainingdone);
+      if (isClockTrain) {
+        parsePacketClockTrain(currentPacket, mPacketFirstTs, mModulus, traceVector.mArray[tvindex]);
+        tvindex  = (mModulus == 3) ? tvindex + 1 : tvindex;
+        mModulus = (mModulus == 3) ? 0 : mModulus+ 1;
+      }
+      else {
+        parsePacket(currentPacket, mPacketFirstTs, traceVector.mArray[tvindex++]);
+      }
+      traceVector.mLength = tvindex;
+    }
+    mclockTrainingdone = true;
+  }
+};
+
+static bool
+same_sample(const xclTraceResults& a, const xclTraceResults& b)
+{
+  return a.EventID == b.EventID && a.EventType == b.EventType &&
+    a.Timestamp == b.Timestamp && a.Overflow == b.Overflow &&
+    a.TraceID == b.TraceID && a.Error == b.Error &&
+    a.Reserved == b.Reserved && a.isClockTrain == b.isClockTrain &&
+    a.HostTimestamp == b.HostTimestamp && a.EventFlags == b.EventFlags;
+}
+
+// A trace buffer as the data mover writes it: optional leftover
+// packets, the initial clock training, events with a clock training
+// group every few thousand packets, then zeros.  Clock training groups
+// start on multiples of 4 packets so that they never straddle the
+// 16K packet chunks the reference parser works on.
+static std::vector<uint64_t>
+make_buffer(uint32_t format, uint64_t packets, uint64_t garbage, uint64_t zeros, uint64_t seed)
+{
+  std::mt19937_64 gen(seed);
+  std::vector<uint64_t> buf;
+  buf.reserve(garbage + packets + zeros);
+
+  uint64_t ts = 0x100000000ULL + (gen() & 0xFFFFFF);
+  uint64_t host = 0x16000000000ULL;
+  auto event = [&]() {
+    ts += 1 + gen() % 300;
+    uint64_t p = ts & 0x1FFFFFFFFFFF;
+    p |= (gen() & 0xF) << 45;
+    p |= (gen() % 96) << 49;
+    p |= static_cast<uint64_t>(gen() % 64 == 0) << 61;
+    p |= static_cast<uint64_t>(gen() % 512 == 0) << 62;
+    if (format == 1)
+      p &= ~(1ULL << 63);
+    else
+      p |= (gen() & 1) << 63;
+    return p ? p : 1;
+  };
+  auto clock_group = [&]() {
+    host += 1000000 + gen() % 1000;
+    ts += 10;
+    for (uint64_t m = 0; m < 4; ++m) {
+      uint64_t p = (ts & 0x1FFFFFFFFFFF) | (((host >> (16 * m)) & 0xFFFF) << 45);
+      if (format == 1)
+        p |= 1ULL << 63;
+      buf.push_back(p);
+    }
+  };
+
+  for (uint64_t i = 0; i < garbage; ++i)
+    buf.push_back(event());
+  clock_group();
+  clock_group();
+  while (buf.size() < garbage + packets) {
+    if (format == 1 && (buf.size() % 4) == 0 && gen() % 4096 == 0)
+      clock_group();
+    else
+      buf.push_back(event());
+  }
+  buf.resize(garbage + packets);
+  buf.resize(garbage + packets + zeros, 0);
+  return buf;
+}
+
+// Decode buf in 16K packet chunks with the reference parser
+static std::vector<xclTraceResults>
+run_reference(uint32_t format, std::vector<uint64_t>& buf)
+{
+  reference_parser ref;
+  ref.mTraceFormat = format;
+  std::unique_ptr<xclTraceResultsVector> tv(new xclTraceResultsVector());
+  std::vector<xclTraceResults> out;
+  for (uint64_t off = 0; off < buf.size(); off += MAX_TRACE_NUMBER_SAMPLES) {
+    uint64_t n = std::min<uint64_t>(MAX_TRACE_NUMBER_SAMPLES, buf.size() - off);
+    std::memset(tv.get(), 0, sizeof(xclTraceResultsVector));
+    ref.parseTraceBuf(buf.data() + off, n * 8, *tv);
+    out.insert(out.end(), tv->mArray, tv->mArray + tv->mLength);
+    if (n != MAX_TRACE_NUMBER_SAMPLES || tv->mLength == 0)
+      break;
+  }
+  return out;
+}
+
+static std::vector<xclTraceResults>
+run_streaming(uint32_t format, std::vector<uint64_t>& buf, uint64_t chunk, uint64_t first = 0)
+{
+  xdp::TracePacketDecoder dec;
+  dec.setTraceFormat(format);
+  std::vector<xclTraceResults> out;
+  auto sink = [&out](const xclTraceResults* s, uint64_t n) { out.insert(out.end(), s, s + n); };
+  for (uint64_t off = 0; off < buf.size(); ) {
+    uint64_t n = std::min<uint64_t>(off == 0 && first ? first : chunk, buf.size() - off);
+    dec.decode(buf.data() + off, n, sink);
+    off += n;
+  }
+  return out;
+}
+
+static void
+compare(const std::vector<xclTraceResults>& a, const std::vector<xclTraceResults>& b,
+        const std::string& what)
+{
+  check(a.size() == b.size(), what + ": sample count " + std::to_string(a.size()) +
+        " != " + std::to_string(b.size()));
+  for (size_t i = 0; i < a.size(); ++i)
+    check(same_sample(a[i], b[i]), what + ": sample " + std::to_string(i) + " differs");
+}
+
+static void
+test_single_buffers()
+{
+  // Buffers that fit one xclTraceResultsVector: the vector interface
+  // must match the old parser exactly, including its handling of
+  // leftover data and buffers without clock training
+  std::unique_ptr<xclTraceResultsVector> expect(new xclTraceResultsVector());
+  std::unique_ptr<xclTraceResultsVector> got(new xclTraceResultsVector());
+  for (uint32_t format = 0; format <= 1; ++format) {
+    for (uint64_t seed = 0; seed < 50; ++seed) {
+      std::mt19937_64 gen(seed);
+      uint64_t packets = 1 + gen() % 6000;
+      uint64_t garbage = format == 1 ? gen() % 40 : 0;
+      auto buf = make_buffer(format, packets, garbage, gen() % 3 ? 0 : 100, seed);
+      if (seed % 7 == 0)
+        buf.resize(gen() % 9);     // too short to hold clock training
+
+      reference_parser ref;
+      ref.mTraceFormat = format;
+      xdp::TracePacketDecoder dec;
+      dec.setTraceFormat(format);
+      for (int pass = 0; pass < 2; ++pass) {
+        std::memset(expect.get(), 0, sizeof(xclTraceResultsVector));
+        std::memset(got.get(), 0, sizeof(xclTraceResultsVector));
+        ref.parseTraceBuf(buf.data(), buf.size() * 8, *expect);
+        dec.decode(buf.data(), buf.size(), *got);
+        check(expect->mLength == got->mLength, "single buffer length");
+        for (unsigned int i = 0; i < got->mLength; ++i)
+          check(same_sample(expect->mArray[i], got->mArray[i]), "single buffer sample");
+      }
+    }
+  }
+  std::cout << "  single buffers match the reference parser\n";
+}
+
+static void
+test_streaming(uint64_t packets)
+{
+  for (uint32_t format = 0; format <= 1; ++format) {
+    auto buf = make_buffer(format, packets, format == 1 ? 13 : 0, 1000, 7 + format);
+    auto expect = run_reference(format, buf);
+    compare(expect, run_streaming(format, buf, buf.size()), "whole buffer");
+    // Chunks that split clock training groups.  The initial clock
+    // training must still arrive in one buffer, as it always has.
+    compare(expect, run_streaming(format, buf, 4093), "odd chunks");
+    compare(expect, run_streaming(format, buf, 1, 64), "single packets");
+  }
+  std::cout << "  streaming decode matches the reference parser\n";
+}
+
+static void
+test_raw_dump(const char* path, uint32_t format)
+{
+  std::ifstream f(path, std::ios_base::in | std::ios_base::binary | std::ios_base::ate);
+  check(f.good(), std::string("cannot open ") + path);
+  std::vector<uint64_t> buf(static_cast<uint64_t>(f.tellg()) / 8);
+  f.seekg(0);
+  f.read(reinterpret_cast<char*>(buf.data()), buf.size() * 8);
+  auto expect = run_reference(format, buf);
+  compare(expect, run_streaming(format, buf, 1 << 17), path);
+  std::cout << "  " << path << ": " << expect.size() << " samples match\n";
+}
+
+static void
+benchmark(uint64_t packets)
+{
+  auto buf = make_buffer(1, packets, 0, 0, 99);
+  std::unique_ptr<xclTraceResultsVector> tv(new xclTraceResultsVector());
+  uint64_t sum = 0;
+
+  // Reference: 16K packet chunks into the fixed size vector, cleared
+  // before every chunk as the offload loop did
+  auto start = clock_type::now();
+  {
+    reference_parser ref;
+    ref.mTraceFormat = 1;
+    for (uint64_t off = 0; off < buf.size(); off += MAX_TRACE_NUMBER_SAMPLES) {
+      uint64_t n = std::min<uint64_t>(MAX_TRACE_NUMBER_SAMPLES, buf.size() - off);
+      *tv = {};
+      ref.parseTraceBuf(buf.data() + off, n * 8, *tv);
+      for (unsigned int i = 0; i < tv->mLength; ++i)
+        sum += tv->mArray[i].Timestamp;
+    }
+  }
+  double ref_s = std::chrono::duration<double>(clock_type::now() - start).count();
+
+  // Streaming: the whole buffer in one call
+  start = clock_type::now();
+  {
+    xdp::TracePacketDecoder dec;
+    dec.setTraceFormat(1);
+    dec.decode(buf.data(), buf.size(), [&sum](const xclTraceResults* s, uint64_t n) {
+      for (uint64_t i = 0; i < n; ++i)
+        sum -= s[i].Timestamp;
+    });
+  }
+  double str_s = std::chrono::duration<double>(clock_type::now() - start).count();
+
+  check(sum == 0, "benchmark checksum");
+  std::printf("  %llu packets: reference %.1f Mpackets/s, streaming %.1f Mpackets/s (%s)\n",
+              static_cast<unsigned long long>(packets),
+              packets / ref_s / 1e6, packets / str_s / 1e6,
+#if defined(__SSE2__) && !defined(XDP_TRACE_DECODE_NO_SIMD)
+              "sse2"
+#else
+              "scalar"
+#endif
+              );
+}
+
+}
+
+int
+main(int argc, char* argv[])
+{
+  uint64_t packets = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 4000000;
+  try {
+    test_single_buffers();
+    test_streaming(packets);
+    if (argc > 3)
+      test_raw_dump(argv[2], std::strtoul(argv[3], nullptr, 10));
+    benchmark(packets * 8);
+  }
+  catch (const std::exception& ex) {
+    std::cout << "Error: " << ex.what() << "\n";
+    std::cout << "FAILED TEST\n";
+    return 1;
+  }
+  std::cout << "PASSED TEST\n";
+  return 0;
+}
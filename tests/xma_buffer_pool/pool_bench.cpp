@@ -0,0 +1,319 @@
+/**
+ * Copyright (C) 2020 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Frame churn of XMA device buffer pools (xma_plg_buffer_pool_*)
+ * against per frame xma_plg_buffer_alloc / xma_plg_buffer_free, on a
+ * mock device.  A decoder session allocates the Y and UV planes of
+ * every output frame, fills them and hands them to a downstream stage
+ * that holds a reference for a few frames, as with zero copy frames.
+ *
+ * The mock device backs every BO with anonymous memory mapped on
+ * xclAllocBO and unmapped on xclFreeBO, so mmap, munmap and page fault
+ * costs are real.  A real device adds the BO ioctls and host page
+ * pinning to each allocation, so the speedup here is a lower bound.
+ */
+
+#include "xmaplugin.h"
+#include "lib/xmaapi.h"
+#include "lib/xmahw_lib.h"
+#include "app/xmaerror.h"
+#include "app/xmalogger.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <map>
+#include <sys/mman.h>
+
+XmaSingleton *g_xma_singleton = nullptr;
+
+void
+xma_logmsg(XmaLogLevelType, const char*, const char*, ...)
+{
+}
+
+namespace xma_core {
+std::string
+get_session_name(XmaSessionType)
+{
+  return "decoder";
+}
+namespace utils {
+void
+check_all_execbo(XmaSession)
+{
+}
+}}
+
+namespace {
+
+struct mock_bo { void* ptr; size_t size; };
+std::map<unsigned int, mock_bo> bos;
+unsigned int next_bo = 1;
+uint64_t num_bo_allocs = 0;
+
+} // namespace
+
+extern "C" {
+
+xclBufferHandle
+xclAllocBO(xclDeviceHandle, size_t size, int, unsigned int)
+{
+  void* ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (ptr == MAP_FAILED)
+    return NULLBO;
+  num_bo_allocs++;
+  bos[next_bo] = {ptr, size};
+  return next_bo++;
+}
+
+void
+xclFreeBO(xclDeviceHandle, xclBufferHandle bo)
+{
+  auto itr = bos.find(bo);
+  if (itr == bos.end()) {
+    std::cout << "FAILED TEST: double free of BO " << bo << std::endl;
+    std::exit(1);
+  }
+  munmap(itr->second.ptr, itr->second.size);
+  bos.erase(itr);
+}
+
+void*
+xclMapBO(xclDeviceHandle, xclBufferHandle bo, bool)
+{
+  return bos[bo].ptr;
+}
+
+int
+xclGetBOProperties(xclDeviceHandle, xclBufferHandle bo, struct xclBOProperties* properties)
+{
+  properties->paddr = (uint64_t)bo << 32;
+  properties->size = bos[bo].size;
+  return 0;
+}
+
+int
+xclSyncBO(xclDeviceHandle, xclBufferHandle, enum xclBOSyncDirection, size_t, size_t)
+{
+  return 0;
+}
+
+int xclExecBuf(xclDeviceHandle, xclBufferHandle) { return 0; }
+int xclExecBufWithWaitList(xclDeviceHandle, xclBufferHandle, size_t, xclBufferHandle*) { return 0; }
+int xclExecWait(xclDeviceHandle, int) { return 0; }
+int xclOpenContext(xclDeviceHandle, const xuid_t, unsigned int, bool) { return 0; }
+
+}
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+const size_t Y_SIZE = 3840 * 2160;
+const size_t UV_SIZE = Y_SIZE / 2;
+const size_t DOWNSTREAM_DEPTH = 4;
+
+int errors = 0;
+
+void
+check(bool ok, const char* what)
+{
+  if (!ok) {
+    std::cout << "ERROR: " << what << std::endl;
+    errors++;
+  }
+}
+
+XmaSession
+create_session(XmaHwSessionPrivate* priv1)
+{
+  XmaSession s_handle;
+  std::memset(&s_handle, 0, sizeof(s_handle));
+  priv1->dev_handle = (xclDeviceHandle)priv1;
+  s_handle.session_type = XMA_DECODER;
+  s_handle.hw_session.private_do_not_use = priv1;
+  s_handle.hw_session.bank_index = 0;
+  s_handle.hw_session.dev_index = 0;
+  s_handle.session_signature = (void*)(((uint64_t)priv1) | ((uint64_t)priv1->reserved));
+  return s_handle;
+}
+
+// Decoder fills the planes of a frame; downstream reads them later
+void
+fill(XmaBufferObj& b_obj, size_t size, uint32_t frame)
+{
+  for (size_t i = 0; i < size; i += 4096)
+    b_obj.data[i] = (uint8_t)frame;
+}
+
+struct frame { XmaBufferObj y; XmaBufferObj uv; };
+
+double
+run_plain(XmaSession s_handle, uint32_t frames)
+{
+  std::deque<frame> downstream;
+  auto start = clock_type::now();
+  for (uint32_t i = 0; i < frames; i++) {
+    frame f;
+    f.y = xma_plg_buffer_alloc(s_handle, Y_SIZE, false, nullptr);
+    f.uv = xma_plg_buffer_alloc(s_handle, UV_SIZE, false, nullptr);
+    fill(f.y, Y_SIZE, i);
+    fill(f.uv, UV_SIZE, i);
+    downstream.push_back(f);
+    if (downstream.size() > DOWNSTREAM_DEPTH) {
+      xma_plg_buffer_free(s_handle, downstream.front().y);
+      xma_plg_buffer_free(s_handle, downstream.front().uv);
+      downstream.pop_front();
+    }
+  }
+  for (auto& f : downstream) {
+    xma_plg_buffer_free(s_handle, f.y);
+    xma_plg_buffer_free(s_handle, f.uv);
+  }
+  return std::chrono::duration<double, std::micro>(clock_type::now() - start).count() / frames;
+}
+
+double
+run_pool(XmaSession s_handle, XmaBufferPoolObj b_pool, uint32_t frames)
+{
+  std::deque<frame> downstream;
+  auto start = clock_type::now();
+  for (uint32_t i = 0; i < frames; i++) {
+    frame f;
+    f.y = xma_plg_buffer_pool_alloc(s_handle, b_pool, Y_SIZE, nullptr);
+    f.uv = xma_plg_buffer_pool_alloc(s_handle, b_pool, UV_SIZE, nullptr);
+    fill(f.y, Y_SIZE, i);
+    fill(f.uv, UV_SIZE, i);
+    // Downstream takes a reference; decoder drops its own right away
+    xma_plg_add_ref_cnt(&f.y, 1);
+    xma_plg_add_ref_cnt(&f.uv, 1);
+    xma_plg_buffer_pool_free(s_handle, f.y);
+    xma_plg_buffer_pool_free(s_handle, f.uv);
+    downstream.push_back(f);
+    if (downstream.size() > DOWNSTREAM_DEPTH) {
+      xma_plg_add_ref_cnt(&downstream.front().y, -1);
+      xma_plg_add_ref_cnt(&downstream.front().uv, -1);
+      downstream.pop_front();
+    }
+  }
+  for (auto& f : downstream) {
+    xma_plg_add_ref_cnt(&f.y, -1);
+    xma_plg_add_ref_cnt(&f.uv, -1);
+  }
+  return std::chrono::duration<double, std::micro>(clock_type::now() - start).count() / frames;
+}
+
+void
+test_semantics(XmaSession s_handle)
+{
+  int32_t rc = XMA_ERROR;
+  XmaBufferPoolObj b_pool = xma_plg_buffer_pool_create(s_handle, Y_SIZE, false, 1, &rc);
+  check(rc == XMA_SUCCESS, "pool create");
+  check(b_pool.buffer_size == Y_SIZE, "pool buffer_size");
+
+  XmaBufferPoolStats stats;
+  xma_plg_buffer_pool_stats(b_pool, &stats);
+  check(stats.num_buffers == 1 && stats.num_free_buffers == 1, "preallocated buffers");
+
+  // Preallocated buffer serves the first allocation of buffer_size
+  XmaBufferObj y = xma_plg_buffer_pool_alloc(s_handle, b_pool, Y_SIZE, &rc);
+  check(rc == XMA_SUCCESS && y.size >= Y_SIZE && y.data != nullptr, "pool alloc");
+  xma_plg_buffer_pool_stats(b_pool, &stats);
+  check(stats.num_hits == 1 && stats.num_free_buffers == 0, "preallocated hit");
+
+  // Planes of a quarter of buffer_size come from a smaller size class
+  XmaBufferObj small = xma_plg_buffer_pool_alloc(s_handle, b_pool, Y_SIZE / 4, &rc);
+  check(rc == XMA_SUCCESS && small.size < Y_SIZE / 2 && small.size >= Y_SIZE / 4, "size class");
+
+  xma_plg_buffer_pool_alloc(s_handle, b_pool, Y_SIZE + 1, &rc);
+  check(rc == XMA_ERROR, "alloc larger than buffer_size rejected");
+
+  // Buffer stays in use while a reference is left
+  check(xma_plg_add_ref_cnt(&y, 1) == 2, "add ref");
+  xma_plg_buffer_pool_free(s_handle, y);
+  xma_plg_buffer_pool_stats(b_pool, &stats);
+  check(stats.num_free_buffers == 0, "buffer with reference not reused");
+  check(xma_plg_add_ref_cnt(&y, -1) == 0, "drop last ref");
+  xma_plg_buffer_pool_stats(b_pool, &stats);
+  check(stats.num_free_buffers == 1, "buffer returned to pool");
+
+  // Same buffer and mapping is handed out again
+  XmaBufferObj y2 = xma_plg_buffer_pool_alloc(s_handle, b_pool, Y_SIZE, &rc);
+  check(y2.private_do_not_touch == y.private_do_not_touch && y2.data == y.data, "buffer reused");
+
+  // Pooled buffers must not be freed with xma_plg_buffer_free
+  size_t live = bos.size();
+  xma_plg_buffer_free(s_handle, y2);
+  check(bos.size() == live, "xma_plg_buffer_free of pooled buffer rejected");
+
+  // Busy buffers are freed when released after destroy
+  check(xma_plg_buffer_pool_destroy(s_handle, b_pool) == XMA_SUCCESS, "pool destroy");
+  check(bos.size() == 2, "free buffers freed on destroy");
+  xma_plg_buffer_pool_free(s_handle, y2);
+  xma_plg_add_ref_cnt(&small, -1);
+  check(bos.empty(), "busy buffers freed after destroy");
+  check(xma_plg_buffer_pool_stats(b_pool, &stats) == XMA_ERROR, "destroyed pool rejected");
+}
+
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+  uint32_t frames = argc > 1 ? std::atoi(argv[1]) : 600;
+
+  g_xma_singleton = new XmaSingleton;
+  XmaHwSessionPrivate priv1;
+  XmaSession s_handle = create_session(&priv1);
+
+  test_semantics(s_handle);
+
+  num_bo_allocs = 0;
+  double plain_us = run_plain(s_handle, frames);
+  uint64_t plain_bo_allocs = num_bo_allocs;
+
+  num_bo_allocs = 0;
+  int32_t rc = XMA_ERROR;
+  XmaBufferPoolObj b_pool = xma_plg_buffer_pool_create(s_handle, Y_SIZE, false, DOWNSTREAM_DEPTH + 1, &rc);
+  check(rc == XMA_SUCCESS, "pool create");
+  double pool_us = run_pool(s_handle, b_pool, frames);
+  XmaBufferPoolStats stats;
+  xma_plg_buffer_pool_stats(b_pool, &stats);
+  xma_plg_buffer_pool_destroy(s_handle, b_pool);
+  check(bos.empty(), "all BOs freed");
+
+  double hit_rate = stats.num_allocs ? stats.num_hits / (double)stats.num_allocs : 0;
+  std::printf("%u frames of 3840x2160 NV12, downstream holds %zu frames\n", frames, DOWNSTREAM_DEPTH);
+  std::printf("  alloc/free   %9.1f us/frame  %8lu BO allocs\n", plain_us, (unsigned long)plain_bo_allocs);
+  std::printf("  buffer pool  %9.1f us/frame  %8lu BO allocs  hit rate %.1f%%  pool %.1f MB\n",
+              pool_us, (unsigned long)num_bo_allocs, hit_rate * 100, stats.pool_size / 1048576.0);
+  std::printf("  speedup      %9.1fx\n", plain_us / pool_us);
+
+  check(hit_rate > 0.95, "pool hit rate");
+  check(pool_us < plain_us, "pool faster than alloc/free");
+
+  delete g_xma_singleton;
+  if (errors) {
+    std::cout << "FAILED TEST" << std::endl;
+    return 1;
+  }
+  std::cout << "PASSED TEST" << std::endl;
+  return 0;
+}
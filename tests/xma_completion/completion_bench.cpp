@@ -0,0 +1,441 @@
+/**
+ * Copyright (C) 2020 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Frame completion latency of the XMA CU command completion engine
+ * (xma_completion.cpp) against the old xma_thread2 polling loop, on a
+ * mock device.  Each session keeps one CU command in flight, waits for
+ * it the way xma_plg_is_work_item_done does in XMA_CPU_MODE1, and
+ * records the time from the mock CU completing the command to the
+ * session waking up.
+ *
+ * The mock device completes commands after a fixed CU time and
+ * implements xclExecWait like the driver's poll: return as soon as
+ * there is an unreported completion.  check_all_execbo mirrors the
+ * XMA_CPU_MODE1 path of xma_utils.cpp, which can not be linked here.
+ */
+
+#include "lib/xma_completion.hpp"
+#include "lib/xma_utils.hpp"
+#include "lib/xmaapi.h"
+#include "app/xmaerror.h"
+#include "app/xmalogger.h"
+#include "ert.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <sys/resource.h>
+
+XmaSingleton *g_xma_singleton = nullptr;
+
+void
+xma_logmsg(XmaLogLevelType, const char*, const char*, ...)
+{
+}
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+int64_t
+now_ns()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(clock_type::now().time_since_epoch()).count();
+}
+
+const uint32_t NUM_EXECBO = 4;
+const int CU_TIME_US = 500;
+
+// Old behaviour of check_all_execbo: notify without the session mutex
+bool legacy_notify = false;
+
+struct mock_device
+{
+  std::mutex mutex;
+  std::condition_variable cu_cv;
+  std::condition_variable exec_cv;
+  struct cmd { ert_start_kernel_cmd* pkt; std::atomic<int64_t>* done_ns; int64_t due_ns; };
+  std::deque<cmd> queue;
+  uint32_t trigger = 0;
+  bool stop = false;
+  std::thread cu;
+
+  void
+  submit(ert_start_kernel_cmd* pkt, std::atomic<int64_t>* done_ns)
+  {
+    {
+      std::lock_guard<std::mutex> lk(mutex);
+      queue.push_back({pkt, done_ns, now_ns() + CU_TIME_US * 1000});
+    }
+    cu_cv.notify_one();
+  }
+
+  // Commands run concurrently on separate CUs, so each completes
+  // CU_TIME_US after it was submitted
+  void
+  run()
+  {
+    std::unique_lock<std::mutex> lk(mutex);
+    while (!stop) {
+      if (queue.empty()) {
+        cu_cv.wait(lk);
+        continue;
+      }
+      auto due = queue.front().due_ns;
+      if (now_ns() < due) {
+        cu_cv.wait_for(lk, std::chrono::nanoseconds(due - now_ns()));
+        continue;
+      }
+      auto c = queue.front();
+      queue.pop_front();
+      c.done_ns->store(now_ns());
+      c.pkt->state = ERT_CMD_STATE_COMPLETED;
+      ++trigger;
+      exec_cv.notify_all();
+    }
+  }
+
+  int
+  exec_wait(int timeout_ms)
+  {
+    std::unique_lock<std::mutex> lk(mutex);
+    if (!exec_cv.wait_for(lk, std::chrono::milliseconds(timeout_ms), [this] { return trigger != 0; }))
+      return 0;
+    --trigger;
+    return 1;
+  }
+};
+
+struct session_data
+{
+  std::vector<std::vector<char>> execbo_data;
+  std::atomic<int64_t> done_ns {0};
+  std::vector<int64_t> latency_ns;
+  uint32_t lost = 0;
+};
+
+} // namespace
+
+extern "C" int
+xclExecWait(xclDeviceHandle handle, int timeoutMilliSec)
+{
+  return static_cast<mock_device*>(handle)->exec_wait(timeoutMilliSec);
+}
+
+namespace xma_core { namespace utils {
+
+// XMA_CPU_MODE1 path of check_all_execbo in xma_utils.cpp
+int32_t
+check_all_execbo(XmaSession s_handle)
+{
+  XmaHwSessionPrivate *priv1 = (XmaHwSessionPrivate*) s_handle.hw_session.private_do_not_use;
+  bool completed = false;
+  for (auto ebo_it = priv1->execbo_to_check.begin(); ebo_it != priv1->execbo_to_check.end(); ) {
+    auto& ebo = priv1->kernel_execbos[*ebo_it];
+    auto cu_cmd = (ert_start_kernel_cmd*)ebo.data;
+    if (ebo.in_use && cu_cmd->state == ERT_CMD_STATE_COMPLETED) {
+      priv1->kernel_complete_count++;
+      priv1->kernel_complete_total++;
+      ebo.in_use = false;
+      cu_cmd->state = ERT_CMD_STATE_MAX;
+      priv1->CU_cmds.erase(ebo.cu_cmd_id1);
+      priv1->num_cu_cmds--;
+      completed = true;
+      ebo_it = priv1->execbo_to_check.erase(ebo_it);
+    } else {
+      ebo_it++;
+    }
+  }
+  if (completed) {
+    if (legacy_notify)
+      priv1->work_item_done_1plus.notify_one();
+    else
+      completion::signal_session(priv1);
+  }
+  return XMA_SUCCESS;
+}
+
+}} // utils, xma_core
+
+namespace {
+
+std::vector<std::unique_ptr<mock_device>> devices;
+std::vector<std::unique_ptr<XmaHwSessionPrivate>> privs;
+std::vector<std::unique_ptr<session_data>> sessions;
+std::atomic<bool> legacy_stop {false};
+size_t num_active = 0;
+
+void
+lock_execbo(XmaHwSessionPrivate* priv1)
+{
+  bool expected = false;
+  while (!priv1->execbo_locked.compare_exchange_weak(expected, true)) {
+    std::this_thread::yield();
+    expected = false;
+  }
+}
+
+// Submission as in xma_plg_schedule_work_item
+void
+submit(size_t s, bool notify_engine)
+{
+  auto priv1 = privs[s].get();
+  lock_execbo(priv1);
+  for (uint32_t i = 0; i < NUM_EXECBO; i++) {
+    auto& ebo = priv1->kernel_execbos[i];
+    if (ebo.in_use)
+      continue;
+    auto cu_cmd = (ert_start_kernel_cmd*)ebo.data;
+    cu_cmd->state = ERT_CMD_STATE_NEW;
+    ebo.in_use = true;
+    ebo.cu_cmd_id1++;
+    priv1->CU_cmds.emplace(ebo.cu_cmd_id1, XmaCUCmdObjPrivate{});
+    priv1->execbo_to_check.emplace_back(i);
+    priv1->num_cu_cmds++;
+    static_cast<mock_device*>(priv1->dev_handle)->submit(cu_cmd, &sessions[s]->done_ns);
+    break;
+  }
+  priv1->execbo_locked = false;
+  if (notify_engine)
+    xma_core::completion::cmd_submitted(priv1);
+}
+
+// Waits as in the XMA_CPU_MODE1 path of xma_plg_is_work_item_done
+bool
+wait_done_legacy(XmaHwSessionPrivate* priv1)
+{
+  for (int iter = 0; iter < 100; iter++) {
+    std::unique_lock<std::mutex> lk(priv1->m_mutex);
+    priv1->work_item_done_1plus.wait_for(lk, std::chrono::milliseconds(10));
+    lk.unlock();
+    if (priv1->kernel_complete_count) {
+      priv1->kernel_complete_count--;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool
+wait_done(XmaHwSessionPrivate* priv1)
+{
+  for (int iter = 0; iter < 100; iter++) {
+    if (xma_core::completion::wait_work_item(priv1, 10)) {
+      priv1->kernel_complete_count--;
+      return true;
+    }
+  }
+  return false;
+}
+
+// Copy of the removed xma_thread2
+void
+xma_thread2_legacy()
+{
+  bool expected = false;
+  bool desired = true;
+  size_t session_index = 0;
+  while (!legacy_stop) {
+    size_t num_sessions = g_xma_singleton->all_sessions_vec.size();
+    if (session_index >= num_sessions)
+      session_index = 0;
+    auto priv2 = (XmaHwSessionPrivate*) g_xma_singleton->all_sessions_vec[session_index].hw_session.private_do_not_use;
+    xclExecWait(priv2->dev_handle, 100);
+    session_index++;
+
+    for (auto& itr1: g_xma_singleton->all_sessions_vec) {
+      auto priv1 = (XmaHwSessionPrivate*) itr1.hw_session.private_do_not_use;
+      expected = false;
+      if (!priv1->execbo_locked.compare_exchange_weak(expected, desired))
+        continue;
+      xma_core::utils::check_all_execbo(itr1);
+      priv1->execbo_locked = false;
+    }
+  }
+}
+
+struct result
+{
+  double mean_us;
+  double p50_us;
+  double p99_us;
+  double max_us;
+  double cpu_ms;
+  uint32_t lost;
+  size_t frames;
+};
+
+double
+cpu_ms()
+{
+  struct rusage ru;
+  getrusage(RUSAGE_SELF, &ru);
+  return (ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * 1e3 + (ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) / 1e3;
+}
+
+result
+run(bool legacy, uint32_t frames)
+{
+  legacy_notify = legacy;
+  for (auto& sd : sessions) {
+    sd->latency_ns.clear();
+    sd->lost = 0;
+  }
+
+  auto cpu_start = cpu_ms();
+  std::thread thread2;
+  if (legacy)
+    thread2 = std::thread(xma_thread2_legacy);
+
+  std::vector<std::thread> apps;
+  for (size_t s = 0; s < num_active; s++) {
+    apps.emplace_back([s, legacy, frames] {
+      auto priv1 = privs[s].get();
+      auto& sd = *sessions[s];
+      for (uint32_t f = 0; f < frames; f++) {
+        submit(s, !legacy);
+        if (!(legacy ? wait_done_legacy(priv1) : wait_done(priv1))) {
+          sd.lost++;
+          continue;
+        }
+        sd.latency_ns.push_back(now_ns() - sd.done_ns.load());
+      }
+    });
+  }
+  for (auto& t : apps)
+    t.join();
+  if (legacy) {
+    legacy_stop = true;
+    thread2.join();
+  }
+
+  result r {};
+  r.cpu_ms = cpu_ms() - cpu_start;
+  std::vector<int64_t> all;
+  for (auto& sd : sessions) {
+    all.insert(all.end(), sd->latency_ns.begin(), sd->latency_ns.end());
+    r.lost += sd->lost;
+  }
+  std::sort(all.begin(), all.end());
+  r.frames = all.size();
+  if (all.empty())
+    return r;
+  double sum = 0;
+  for (auto v : all)
+    sum += v;
+  r.mean_us = sum / all.size() / 1e3;
+  r.p50_us = all[all.size() / 2] / 1e3;
+  r.p99_us = all[all.size() * 99 / 100] / 1e3;
+  r.max_us = all.back() / 1e3;
+  return r;
+}
+
+void
+print(const char* name, const result& r)
+{
+  std::printf("%-8s frames %6zu  lost %u  wakeup latency us: mean %8.1f  p50 %8.1f  p99 %8.1f  max %8.1f  cpu %7.1f ms\n",
+              name, r.frames, r.lost, r.mean_us, r.p50_us, r.p99_us, r.max_us, r.cpu_ms);
+}
+
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+  uint32_t num_devices = 2;
+  uint32_t num_sessions = (argc > 1) ? std::atoi(argv[1]) : 40;
+  uint32_t frames = (argc > 2) ? std::atoi(argv[2]) : 200;
+  // Sessions run frames on the first busy_devices devices; each other
+  // device has one idle session, like a paused stream on a second card
+  uint32_t busy_devices = (argc > 3) ? std::atoi(argv[3]) : 1;
+  busy_devices = std::max(1u, std::min(busy_devices, num_devices));
+
+  g_xma_singleton = new XmaSingleton;
+  g_xma_singleton->cpu_mode = XMA_CPU_MODE1;
+  g_xma_singleton->hwcfg.num_devices = num_devices;
+  g_xma_singleton->hwcfg.devices.resize(num_devices);
+  for (uint32_t d = 0; d < num_devices; d++) {
+    devices.emplace_back(new mock_device);
+    g_xma_singleton->hwcfg.devices[d].handle = devices[d].get();
+    g_xma_singleton->hwcfg.devices[d].dev_index = d;
+    auto dev = devices[d].get();
+    dev->cu = std::thread([dev] { dev->run(); });
+  }
+
+  uint32_t num_idle = num_devices - busy_devices;
+  num_active = num_sessions;
+  for (uint32_t s = 0; s < num_sessions + num_idle; s++) {
+    auto dev_index = (s < num_sessions) ? s % busy_devices : busy_devices + s - num_sessions;
+    auto& hw_device = g_xma_singleton->hwcfg.devices[dev_index];
+    privs.emplace_back(new XmaHwSessionPrivate);
+    sessions.emplace_back(new session_data);
+    auto priv1 = privs.back().get();
+    priv1->device = &hw_device;
+    priv1->dev_handle = hw_device.handle;
+    priv1->kernel_execbos.resize(NUM_EXECBO);
+    priv1->num_execbo_allocated = NUM_EXECBO;
+    sessions.back()->execbo_data.resize(NUM_EXECBO, std::vector<char>(4096, 0));
+    for (uint32_t i = 0; i < NUM_EXECBO; i++)
+      priv1->kernel_execbos[i].data = sessions.back()->execbo_data[i].data();
+
+    XmaSession session {};
+    session.session_id = s;
+    session.session_type = XMA_ENCODER;
+    session.hw_session.dev_index = hw_device.dev_index;
+    session.hw_session.private_do_not_use = priv1;
+    g_xma_singleton->all_sessions_vec.push_back(session);
+  }
+
+  std::cout << num_sessions << " sessions on " << busy_devices << " mock devices, "
+            << num_idle << " idle, "
+            << frames << " frames each, " << CU_TIME_US << " us CU time" << std::endl;
+
+  auto old_r = run(true, frames);
+  print("polling", old_r);
+
+  xma_core::completion::start(&g_xma_singleton->hwcfg);
+  auto new_r = run(false, frames);
+  print("engine", new_r);
+
+  g_xma_singleton->xma_exit = true;
+  xma_core::completion::stop();
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  for (auto& dev : devices) {
+    {
+      std::lock_guard<std::mutex> lk(dev->mutex);
+      dev->stop = true;
+    }
+    dev->cu_cv.notify_all();
+    dev->cu.join();
+  }
+
+  size_t expected = size_t(num_sessions) * frames;
+  if (new_r.lost || new_r.frames != expected) {
+    std::cout << "FAILED TEST: " << new_r.lost << " frames not completed" << std::endl;
+    return 1;
+  }
+  // With every device busy the two are within scheduling noise
+  if (num_idle && new_r.mean_us > old_r.mean_us) {
+    std::cout << "FAILED TEST: completion latency did not improve" << std::endl;
+    return 1;
+  }
+  std::cout << "PASSED TEST" << std::endl;
+  return 0;
+}
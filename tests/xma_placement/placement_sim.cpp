@@ -0,0 +1,397 @@
+/**
+ * Copyright (C) 2020 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Simulates video sessions arriving at and leaving a pool of decoder CUs
+ * and compares the aggregate throughput of XMA automatic placement
+ * (xma_placement.cpp) with first-fit and round-robin placement.
+ *
+ * Time advances in 10 ms ticks, the period of xma_thread1.  Every
+ * session is a live stream with its own frame rate and CU time per
+ * frame.  A CU shares its time equally between the sessions with frames
+ * pending, and a session drops its oldest frame when more than
+ * MAX_BACKLOG are pending.  Session statistics are sampled each tick the
+ * way xma_thread1 does, so automatic placement sees the same
+ * cmd_busy/cmd_idle and average cmds it would see in XMA.
+ */
+
+#include "lib/xma_placement.hpp"
+#include "lib/xmaapi.h"
+#include "lib/xmalimits_lib.h"
+#include "app/xmaerror.h"
+#include "app/xmalogger.h"
+#include "core/common/config_reader.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <random>
+
+XmaSingleton *g_xma_singleton = nullptr;
+
+void
+xma_logmsg(XmaLogLevelType, const char*, const char*, ...)
+{
+}
+
+namespace xrt_core { namespace config { namespace detail {
+
+bool
+get_bool_value(const char*, bool default_value)
+{
+  return default_value;
+}
+
+std::string
+get_string_value(const char*, const std::string& default_value)
+{
+  return default_value;
+}
+
+}}} // detail, config, xrt_core
+
+namespace {
+
+const uint32_t NUM_DEVICES = 2;
+const uint32_t CUS_PER_DEVICE = 4;
+const double TICK_MS = 10;
+const double MAX_BACKLOG = 2;
+// First-fit packs up to this many sessions on a CU
+const uint32_t FIRST_FIT_SESSIONS = 4;
+
+struct stream_profile
+{
+  const char* name;
+  double fps;
+  double cu_ms;        // CU time per frame
+};
+
+const stream_profile profiles[] = {
+  {"2160p30", 30, 16.0},
+  {"1080p60", 60, 6.0},
+  {"1080p30", 30, 6.0},
+  {"720p30",  30, 2.5},
+};
+
+struct sim_session
+{
+  std::unique_ptr<XmaHwSessionPrivate> priv;
+  const stream_profile* profile;
+  double arrivals;     // fractional frames arrived
+  double pending;      // frames waiting, in frames
+  double done_ms;      // CU time spent on the frame in progress
+  uint64_t end_tick;
+};
+
+struct sim_result
+{
+  uint64_t offered = 0;
+  uint64_t completed = 0;
+  uint64_t dropped = 0;
+  double cu_util = 0;
+
+  double
+  throughput() const
+  {
+    return offered ? completed / (double)offered : 0;
+  }
+};
+
+enum class policy { first_fit, round_robin, load_aware };
+
+const char*
+policy_name(policy p)
+{
+  switch (p) {
+  case policy::first_fit:   return "first-fit";
+  case policy::round_robin: return "round-robin";
+  default:                  return "load-aware";
+  }
+}
+
+// Closed sessions, kept alive like in XMA
+std::vector<std::unique_ptr<XmaHwSessionPrivate>> closed;
+
+void
+setup_hwcfg()
+{
+  delete g_xma_singleton;
+  g_xma_singleton = new XmaSingleton;
+  closed.clear();
+  auto& hwcfg = g_xma_singleton->hwcfg;
+  hwcfg.num_devices = NUM_DEVICES;
+  hwcfg.devices.resize(NUM_DEVICES);
+  for (uint32_t d = 0; d < NUM_DEVICES; d++) {
+    auto& dev = hwcfg.devices[d];
+    dev.dev_index = d;
+    // A scaler CU first, which decoder sessions must never be placed on
+    std::vector<std::string> names {"scaler:scaler_1"};
+    for (uint32_t c = 0; c < CUS_PER_DEVICE; c++)
+      names.push_back("decoder:decoder_" + std::to_string(c + 1));
+    dev.kernels.resize(names.size());
+    for (size_t k = 0; k < names.size(); k++) {
+      std::strncpy((char*)dev.kernels[k].name, names[k].c_str(), MAX_KERNEL_NAME - 1);
+      dev.kernels[k].cu_index = k;
+    }
+    dev.number_of_cus = names.size();
+  }
+}
+
+// Session part of the load sampling in xma_thread1
+void
+sample_session_stats(XmaHwSessionPrivate* priv1)
+{
+  if (priv1->num_samples > STATS_WINDOW_1) {
+    priv1->cmd_busy = priv1->cmd_busy >> 1;
+    priv1->cmd_idle = priv1->cmd_idle >> 1;
+    priv1->num_cu_cmds_avg += priv1->num_cu_cmds_avg_tmp;
+    priv1->num_cu_cmds_avg = priv1->num_cu_cmds_avg >> 1;
+    priv1->num_cu_cmds_avg_tmp = 0;
+    priv1->num_samples = 0;
+    priv1->kernel_complete_total = priv1->kernel_complete_total >> 1;
+  }
+  uint32_t num_cmds = priv1->num_cu_cmds;
+  priv1->num_cu_cmds_avg_tmp += num_cmds;
+  if (num_cmds != 0) {
+    priv1->cmd_busy++;
+    priv1->num_samples++;
+  } else if (priv1->cmd_busy != 0) {
+    priv1->cmd_idle++;
+    priv1->num_samples++;
+  }
+}
+
+XmaHwKernel*
+place(policy p, std::vector<std::unique_ptr<sim_session>>& sessions, uint32_t& rr_next, XmaHwDevice*& device)
+{
+  auto& hwcfg = g_xma_singleton->hwcfg;
+  if (p == policy::load_aware) {
+    int32_t dev_index = -1;
+    int32_t cu_index = -1;
+    if (xma_core::placement::select_cu(dev_index, cu_index, "decoder", xma_core::placement::cost_model(), "sim") != XMA_SUCCESS)
+      return nullptr;
+    device = &hwcfg.devices[dev_index];
+    return &device->kernels[cu_index];
+  }
+
+  std::vector<std::pair<XmaHwDevice*, XmaHwKernel*>> cus;
+  for (auto& dev : hwcfg.devices)
+    for (auto& kernel : dev.kernels)
+      if (std::strncmp((char*)kernel.name, "decoder:", 8) == 0)
+        cus.emplace_back(&dev, &kernel);
+
+  if (p == policy::round_robin) {
+    auto& cu = cus[rr_next++ % cus.size()];
+    device = cu.first;
+    return cu.second;
+  }
+
+  // First CU with room, else the first CU
+  for (auto& cu : cus) {
+    uint32_t n = 0;
+    for (auto& s : sessions)
+      if (s->priv->kernel_info == cu.second)
+        n++;
+    if (n < FIRST_FIT_SESSIONS) {
+      device = cu.first;
+      return cu.second;
+    }
+  }
+  device = cus.front().first;
+  return cus.front().second;
+}
+
+void
+add_session(std::vector<std::unique_ptr<sim_session>>& sessions, XmaHwDevice* device, XmaHwKernel* kernel,
+            const stream_profile* profile, uint64_t end_tick)
+{
+  std::unique_ptr<sim_session> s(new sim_session);
+  s->priv.reset(new XmaHwSessionPrivate);
+  s->priv->device = device;
+  s->priv->kernel_info = kernel;
+  s->profile = profile;
+  s->arrivals = 0;
+  s->pending = 0;
+  s->done_ms = 0;
+  s->end_tick = end_tick;
+
+  XmaSession base {};
+  base.session_type = XMA_DECODER;
+  base.hw_session.dev_index = device->dev_index;
+  base.hw_session.private_do_not_use = s->priv.get();
+  g_xma_singleton->all_sessions_vec.push_back(base);
+  sessions.push_back(std::move(s));
+}
+
+void
+remove_session(std::vector<std::unique_ptr<sim_session>>& sessions, size_t i)
+{
+  // As session destroy: the session stays in all_sessions_vec
+  sessions[i]->priv->session_closed = true;
+  closed.push_back(std::move(sessions[i]->priv));
+  sessions.erase(sessions.begin() + i);
+}
+
+// Give each CU TICK_MS of time, split equally between its busy sessions
+void
+run_cus(std::vector<std::unique_ptr<sim_session>>& sessions, sim_result& r, double& util_sum, uint64_t& util_n)
+{
+  for (auto& dev : g_xma_singleton->hwcfg.devices) {
+    for (auto& kernel : dev.kernels) {
+      std::vector<sim_session*> busy;
+      for (auto& s : sessions)
+        if (s->priv->kernel_info == &kernel && s->pending >= 1)
+          busy.push_back(s.get());
+      double budget = TICK_MS;
+      double used = 0;
+      while (!busy.empty() && budget > 1e-9) {
+        double share = budget / busy.size();
+        std::vector<sim_session*> still;
+        for (auto s : busy) {
+          double left = s->profile->cu_ms - s->done_ms;
+          double run = std::min(share, left);
+          s->done_ms += run;
+          budget -= run;
+          used += run;
+          if (s->done_ms >= s->profile->cu_ms - 1e-9) {
+            s->done_ms = 0;
+            s->pending -= 1;
+            s->priv->kernel_complete_total++;
+            r.completed++;
+            if (s->pending >= 1)
+              still.push_back(s);
+          } else {
+            still.push_back(s);
+          }
+        }
+        busy.swap(still);
+      }
+      if (std::strncmp((char*)kernel.name, "decoder:", 8) == 0) {
+        util_sum += used / TICK_MS;
+        util_n++;
+      }
+    }
+  }
+}
+
+sim_result
+simulate(policy p, uint32_t seed, uint32_t target_sessions, uint32_t seconds)
+{
+  setup_hwcfg();
+  std::mt19937 gen(seed);
+  std::uniform_int_distribution<int> profile_dis(0, sizeof(profiles) / sizeof(profiles[0]) - 1);
+  std::uniform_int_distribution<int> life_dis(1500, 6000);     // 15 to 60 s
+  std::uniform_int_distribution<int> gap_dis(10, 100);         // 0.1 to 1 s
+
+  std::vector<std::unique_ptr<sim_session>> sessions;
+  sim_result r;
+  uint32_t rr_next = 0;
+  uint64_t ticks = seconds * 1000 / TICK_MS;
+  uint64_t next_arrival = 0;
+  double util_sum = 0;
+  uint64_t util_n = 0;
+
+  for (uint64_t t = 0; t < ticks; t++) {
+    for (size_t i = 0; i < sessions.size(); ) {
+      if (sessions[i]->end_tick <= t)
+        remove_session(sessions, i);
+      else
+        i++;
+    }
+    if (t >= next_arrival && sessions.size() < target_sessions) {
+      XmaHwDevice* device = nullptr;
+      auto kernel = place(p, sessions, rr_next, device);
+      if (kernel == nullptr || std::strncmp((char*)kernel->name, "decoder:", 8) != 0) {
+        std::cout << "FAILED TEST: " << policy_name(p) << " placed a decoder on a non-decoder CU" << std::endl;
+        std::exit(1);
+      }
+      add_session(sessions, device, kernel, &profiles[profile_dis(gen)], t + life_dis(gen));
+      next_arrival = t + gap_dis(gen);
+    }
+
+    for (auto& s : sessions) {
+      double before = s->arrivals;
+      s->arrivals += s->profile->fps * TICK_MS / 1000;
+      uint64_t arrived = (uint64_t)s->arrivals - (uint64_t)before;
+      r.offered += arrived;
+      s->pending += arrived;
+      while (s->pending > MAX_BACKLOG + 1) {
+        s->pending -= 1;
+        r.dropped++;
+      }
+    }
+
+    run_cus(sessions, r, util_sum, util_n);
+
+    for (auto& s : sessions) {
+      s->priv->num_cu_cmds = (s->pending >= 1) ? 1 : 0;
+      sample_session_stats(s->priv.get());
+    }
+  }
+  r.cu_util = util_n ? util_sum / util_n : 0;
+  return r;
+}
+
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+  uint32_t target_sessions = (argc > 1) ? std::atoi(argv[1]) : 20;
+  uint32_t seconds = (argc > 2) ? std::atoi(argv[2]) : 300;
+  uint32_t runs = (argc > 3) ? std::atoi(argv[3]) : 4;
+
+  // Weights parse and reject bad input
+  xma_core::placement::cost_model model;
+  if (xma_core::placement::parse_cost_model("busy=2,device=0", model) != XMA_SUCCESS ||
+      model.busy != 2.0f || model.device != 0.0f || model.session != 0.25f ||
+      xma_core::placement::parse_cost_model("busy", model) == XMA_SUCCESS ||
+      xma_core::placement::parse_cost_model("load=1", model) == XMA_SUCCESS ||
+      xma_core::placement::parse_cost_model("cmds=-1", model) == XMA_SUCCESS) {
+    std::cout << "FAILED TEST: cost model parsing" << std::endl;
+    return 1;
+  }
+
+  std::cout << "Up to " << target_sessions << " sessions on " << NUM_DEVICES * CUS_PER_DEVICE
+            << " decoder CUs, " << seconds << " s, " << runs << " runs" << std::endl;
+
+  double throughput[3] = {0, 0, 0};
+  for (auto p : {policy::first_fit, policy::round_robin, policy::load_aware}) {
+    sim_result total;
+    double util = 0;
+    for (uint32_t run = 0; run < runs; run++) {
+      auto r = simulate(p, 1234 + run, target_sessions, seconds);
+      total.offered += r.offered;
+      total.completed += r.completed;
+      total.dropped += r.dropped;
+      util += r.cu_util / runs;
+    }
+    throughput[(int)p] = total.throughput();
+    std::printf("%-12s frames offered %9llu  completed %9llu  dropped %8llu  throughput %6.2f%%  avg CU util %5.1f%%\n",
+                policy_name(p), (unsigned long long)total.offered, (unsigned long long)total.completed,
+                (unsigned long long)total.dropped, 100 * total.throughput(), 100 * util);
+  }
+
+  if (throughput[(int)policy::load_aware] <= throughput[(int)policy::first_fit]) {
+    std::cout << "FAILED TEST: load-aware placement is not better than first-fit" << std::endl;
+    return 1;
+  }
+  std::cout << "PASSED TEST" << std::endl;
+  return 0;
+}
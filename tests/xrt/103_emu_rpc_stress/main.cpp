@@ -0,0 +1,250 @@
+/**
+ * Copyright (C) 2020 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "experimental/xrt_device.h"
+#include "experimental/xrt_kernel.h"
+#include "experimental/xrt_bo.h"
+
+/**
+ * Testcase to stress concurrent access to an emulation device.
+ *
+ * Data threads repeatedly sync large buffers to and from the device
+ * while register threads repeatedly read a kernel argument register.
+ * The test verifies the data and the register value, and reports the
+ * register access latency observed while bulk transfers are in flight.
+ * In emulation, register accesses should not stall behind a complete
+ * buffer transfer.
+ */
+
+static const unsigned LOOP = 16;
+static const unsigned DATA_THREADS = 4;
+static const unsigned REG_THREADS = 4;
+static const size_t BO_SIZE = 32 * 1024 * 1024;
+
+namespace {
+
+/**
+ * @return
+ *   nanoseconds since first call
+ */
+static unsigned long
+time_ns()
+{
+  static auto zero = std::chrono::high_resolution_clock::now();
+  auto now = std::chrono::high_resolution_clock::now();
+  auto integral_duration = std::chrono::duration_cast<std::chrono::nanoseconds>(now-zero).count();
+  return integral_duration;
+}
+
+struct reg_stats
+{
+  unsigned long count = 0;
+  unsigned long total = 0;
+  unsigned long max = 0;
+};
+
+}
+
+static void usage()
+{
+    std::cout << "usage: %s [options] -k <bitstream>\n\n";
+    std::cout << "  -k <bitstream>\n";
+    std::cout << "  -d <index>\n";
+    std::cout << "  -r <num of buffer round trips per data thread, default is 16>\n";
+    std::cout << "  -t <num of data threads, default is 4>\n";
+    std::cout << "  -v\n";
+    std::cout << "  -h\n\n";
+    std::cout << "* Bitstream is required\n";
+}
+
+static void
+data_thread(const xrt::device& device, int grpid, unsigned id, size_t n_runs, std::atomic<bool>& error)
+{
+  auto bo = xrt::bo(device, BO_SIZE, grpid);
+  auto bo_data = bo.map<unsigned int*>();
+  auto words = BO_SIZE / sizeof(unsigned int);
+
+  for (size_t i=0; i<n_runs && !error; ++i) {
+    unsigned int seed = (id << 24) + static_cast<unsigned int>(i);
+    for (size_t w=0; w<words; ++w)
+      bo_data[w] = seed + static_cast<unsigned int>(w);
+    bo.sync(XCL_BO_SYNC_BO_TO_DEVICE, BO_SIZE, 0);
+
+    std::fill(bo_data, bo_data + words, 0);
+    bo.sync(XCL_BO_SYNC_BO_FROM_DEVICE, BO_SIZE, 0);
+
+    for (size_t w=0; w<words; ++w) {
+      if (bo_data[w] != seed + static_cast<unsigned int>(w)) {
+        std::cout << "data thread " << id << " mismatch at word " << w << "\n";
+        error = true;
+        break;
+      }
+    }
+  }
+}
+
+static void
+register_thread(const xrt::kernel& kernel, uint32_t offset, uint32_t expected,
+                const std::atomic<bool>& stop, std::atomic<bool>& error, reg_stats& stats)
+{
+  while (!stop && !error) {
+    auto start = time_ns();
+    auto value = kernel.read_register(offset);
+    auto elapsed = time_ns() - start;
+
+    ++stats.count;
+    stats.total += elapsed;
+    stats.max = std::max(stats.max, elapsed);
+
+    if (static_cast<uint32_t>(value) != expected) {
+      std::cout << "register mismatch: read " << value << " expected " << expected << "\n";
+      error = true;
+    }
+  }
+}
+
+static void
+run(const xrt::device& device, const xrt::uuid& uuid, size_t n_runs, unsigned n_data, bool verbose)
+{
+  auto kernel = xrt::kernel(device, uuid.get(), "hello", xrt::kernel::cu_access_mode::exclusive);
+  auto offset = kernel.offset(0);
+  const uint32_t pattern = 0x5a5a1234;
+  kernel.write_register(offset, pattern);
+
+  std::atomic<bool> stop{false};
+  std::atomic<bool> error{false};
+  std::vector<reg_stats> stats(REG_THREADS);
+
+  std::vector<std::thread> reg_threads;
+  for (unsigned i=0; i<REG_THREADS; ++i)
+    reg_threads.emplace_back(register_thread, std::cref(kernel), offset, pattern,
+                             std::cref(stop), std::ref(error), std::ref(stats[i]));
+
+  auto start = time_ns();
+  std::vector<std::thread> data_threads;
+  for (unsigned i=0; i<n_data; ++i)
+    data_threads.emplace_back(data_thread, std::cref(device), kernel.group_id(0), i, n_runs, std::ref(error));
+
+  for (auto& t : data_threads)
+    t.join();
+  auto elapsed = time_ns() - start;
+
+  stop = true;
+  for (auto& t : reg_threads)
+    t.join();
+
+  reg_stats total;
+  for (auto& s : stats) {
+    total.count += s.count;
+    total.total += s.total;
+    total.max = std::max(total.max, s.max);
+  }
+
+  double mbytes = 2.0 * n_data * n_runs * BO_SIZE / (1024 * 1024);
+  std::cout << "data: " << mbytes << " MB in " << elapsed / 1000000 << " ms\n";
+  std::cout << "register reads: " << total.count;
+  if (total.count)
+    std::cout << " avg " << total.total / total.count / 1000 << " us"
+              << " max " << total.max / 1000 << " us";
+  std::cout << "\n";
+
+  if (verbose)
+    for (unsigned i=0; i<REG_THREADS; ++i)
+      std::cout << "register thread " << i << ": " << stats[i].count << " reads\n";
+
+  if (error)
+    throw std::runtime_error("data or register mismatch");
+}
+
+int
+run(int argc, char** argv)
+{
+  if (argc < 3) {
+    usage();
+    return 1;
+  }
+
+  std::string xclbin_fnm;
+  bool verbose = false;
+  unsigned int device_index = 0;
+  unsigned int num_runs = LOOP;
+  unsigned int num_data = DATA_THREADS;
+
+  std::vector<std::string> args(argv+1,argv+argc);
+  std::string cur;
+  for (auto& arg : args) {
+    if (arg == "-h") {
+      usage();
+      return 1;
+    }
+    else if (arg == "-v") {
+      verbose = true;
+      continue;
+    }
+
+    if (arg[0] == '-') {
+      cur = arg;
+      continue;
+    }
+
+    if (cur == "-k")
+      xclbin_fnm = arg;
+    else if (cur == "-d")
+      device_index = std::stoi(arg);
+    else if (cur == "-r")
+      num_runs = std::stoi(arg);
+    else if (cur == "-t")
+      num_data = std::stoi(arg);
+    else
+      throw std::runtime_error("Unknown option value " + cur + " " + arg);
+  }
+
+  if (xclbin_fnm.empty())
+    throw std::runtime_error("FAILED_TEST\nNo xclbin specified");
+
+  auto device = xrt::device(device_index);
+  auto uuid = device.load_xclbin(xclbin_fnm);
+
+  run(device, uuid, num_runs, num_data, verbose);
+  return 0;
+}
+
+int
+main(int argc, char** argv)
+{
+  try {
+    auto ret = run(argc, argv);
+    std::cout << "PASSED TEST\n";
+    return ret;
+  }
+  catch (std::exception const& e) {
+    std::cout << "Exception: " << e.what() << "\n";
+    std::cout << "FAILED TEST\n";
+    return 1;
+  }
+
+  std::cout << "PASSED TEST\n";
+  return 0;
+}
@@ -0,0 +1,234 @@
+/**
+ * Copyright (C) 2020 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "experimental/xrt_device.h"
+#include "experimental/xrt_kernel.h"
+#include "experimental/xrt_bo.h"
+
+/**
+ * Testcase for xrt::bo::fill
+ *
+ * Fills buffers with patterns of various sizes at various offsets,
+ * reads the device memory back and verifies the content.  The host
+ * backing buffer must match the fill, so that a later sync to device
+ * preserves it.  Fills and copies of sub buffers must land at the
+ * sub buffer offset in the parent.  The time of a large fill is
+ * compared against filling the host buffer one pattern at a time
+ * and syncing it to the device.
+ */
+
+static const size_t BO_SIZE = 256 * 1024 * 1024;
+
+namespace {
+
+/**
+ * @return
+ *   nanoseconds since first call
+ */
+static unsigned long
+time_ns()
+{
+  static auto zero = std::chrono::high_resolution_clock::now();
+  auto now = std::chrono::high_resolution_clock::now();
+  auto integral_duration = std::chrono::duration_cast<std::chrono::nanoseconds>(now-zero).count();
+  return integral_duration;
+}
+
+}
+
+static void usage()
+{
+    std::cout << "usage: %s [options] -k <bitstream>\n\n";
+    std::cout << "  -k <bitstream>\n";
+    std::cout << "  -d <index>\n";
+    std::cout << "  -v\n";
+    std::cout << "  -h\n\n";
+    std::cout << "* Bitstream is required\n";
+}
+
+static void
+verify(xrt::bo& bo, const std::vector<char>& pattern, size_t size, size_t offset)
+{
+  auto bo_data = bo.map<char*>();
+  std::memset(bo_data, 0, bo.size());
+  bo.sync(XCL_BO_SYNC_BO_FROM_DEVICE, bo.size(), 0);
+
+  for (size_t i=0; i<size; ++i) {
+    if (bo_data[offset + i] != pattern[i % pattern.size()])
+      throw std::runtime_error("fill mismatch at byte " + std::to_string(offset + i)
+                               + " pattern size " + std::to_string(pattern.size()));
+  }
+}
+
+// Verify host backing buffer without syncing from device
+static void
+verify_host(xrt::bo& bo, const std::vector<char>& pattern, size_t size, size_t offset)
+{
+  auto bo_data = bo.map<char*>();
+  for (size_t i=0; i<size; ++i) {
+    if (bo_data[offset + i] != pattern[i % pattern.size()])
+      throw std::runtime_error("host buffer mismatch at byte " + std::to_string(offset + i)
+                               + " pattern size " + std::to_string(pattern.size()));
+  }
+}
+
+// Large fill followed by a sync of the whole buffer to device
+static void
+run_fill_sync(xrt::bo& bo)
+{
+  const std::vector<char> pattern = {'x', 'r', 't'};
+  bo.fill(pattern.data(), pattern.size(), bo.size() / 2, 0);
+  verify_host(bo, pattern, bo.size() / 2, 0);
+  bo.sync(XCL_BO_SYNC_BO_TO_DEVICE, bo.size(), 0);
+  verify(bo, pattern, bo.size() / 2, 0);
+}
+
+// Fill and copy of sub buffers
+static void
+run_sub_buffer(xrt::bo& bo)
+{
+  const size_t sub_offset = 64 * 1024 * 1024;
+  const size_t sub_size = 16 * 1024 * 1024;
+  xrt::bo sub0(bo, sub_size, sub_offset);
+  xrt::bo sub1(bo, sub_size, sub_offset + sub_size);
+
+  const std::vector<char> zero = {0};
+  bo.fill(zero.data(), zero.size(), bo.size(), 0);
+
+  const std::vector<char> pattern = {1, 2, 3, 4, 5};
+  sub0.fill(pattern.data(), pattern.size(), sub_size, 0);
+  verify(bo, pattern, sub_size, sub_offset);
+  verify(bo, zero, sub_offset, 0);
+
+  sub1.copy(sub0);
+  verify(bo, pattern, sub_size, sub_offset + sub_size);
+  verify(bo, zero, bo.size() - sub_offset - 2 * sub_size, sub_offset + 2 * sub_size);
+}
+
+static void
+run(const xrt::device& device, const xrt::uuid& uuid, bool verbose)
+{
+  auto kernel = xrt::kernel(device, uuid.get(), "hello");
+  auto bo = xrt::bo(device, BO_SIZE, kernel.group_id(0));
+
+  const size_t pattern_sizes[] = {1, 2, 3, 4, 16, 128, 5000};
+  const size_t fill_sizes[] = {1, 4096, 4 * 1024 * 1024 + 7, BO_SIZE / 2};
+  for (auto pattern_size : pattern_sizes) {
+    std::vector<char> pattern(pattern_size);
+    for (size_t i=0; i<pattern_size; ++i)
+      pattern[i] = static_cast<char>(i * 13 + 1);
+
+    for (auto fill_size : fill_sizes) {
+      size_t offset = (fill_size * 3) % 1000;
+      bo.fill(pattern.data(), pattern_size, fill_size, offset);
+      verify_host(bo, pattern, fill_size, offset);
+      verify(bo, pattern, fill_size, offset);
+      if (verbose)
+        std::cout << "pattern " << pattern_size << " size " << fill_size << " offset " << offset << " ok\n";
+    }
+  }
+
+  run_fill_sync(bo);
+  run_sub_buffer(bo);
+
+  // Compare whole buffer fill against a per pattern host loop
+  const uint32_t value = 0xdeadbeef;
+  auto start = time_ns();
+  bo.fill(value);
+  auto fill_time = time_ns() - start;
+  verify(bo, std::vector<char>(reinterpret_cast<const char*>(&value), reinterpret_cast<const char*>(&value) + sizeof(value)), BO_SIZE, 0);
+
+  auto bo_data = bo.map<char*>();
+  start = time_ns();
+  for (size_t i=0; i<BO_SIZE; i+=sizeof(value))
+    std::memcpy(bo_data + i, &value, sizeof(value));
+  bo.sync(XCL_BO_SYNC_BO_TO_DEVICE, BO_SIZE, 0);
+  auto loop_time = time_ns() - start;
+
+  std::cout << "fill " << BO_SIZE / (1024 * 1024) << " MB: xrt::bo::fill " << fill_time / 1000000
+            << " ms, host loop " << loop_time / 1000000 << " ms\n";
+}
+
+int
+run(int argc, char** argv)
+{
+  if (argc < 3) {
+    usage();
+    return 1;
+  }
+
+  std::string xclbin_fnm;
+  bool verbose = false;
+  unsigned int device_index = 0;
+
+  std::vector<std::string> args(argv+1,argv+argc);
+  std::string cur;
+  for (auto& arg : args) {
+    if (arg == "-h") {
+      usage();
+      return 1;
+    }
+    else if (arg == "-v") {
+      verbose = true;
+      continue;
+    }
+
+    if (arg[0] == '-') {
+      cur = arg;
+      continue;
+    }
+
+    if (cur == "-k")
+      xclbin_fnm = arg;
+    else if (cur == "-d")
+      device_index = std::stoi(arg);
+    else
+      throw std::runtime_error("Unknown option value " + cur + " " + arg);
+  }
+
+  if (xclbin_fnm.empty())
+    throw std::runtime_error("FAILED_TEST\nNo xclbin specified");
+
+  auto device = xrt::device(device_index);
+  auto uuid = device.load_xclbin(xclbin_fnm);
+
+  run(device, uuid, verbose);
+  return 0;
+}
+
+int
+main(int argc, char** argv)
+{
+  try {
+    auto ret = run(argc, argv);
+    std::cout << "PASSED TEST\n";
+    return ret;
+  }
+  catch (std::exception const& e) {
+    std::cout << "Exception: " << e.what() << "\n";
+    std::cout << "FAILED TEST\n";
+    return 1;
+  }
+
+  std::cout << "PASSED TEST\n";
+  return 0;
+}
@@ -0,0 +1,227 @@
+/**
+ * Copyright (C) 2020 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "experimental/xrt_device.h"
+#include "experimental/xrt_kernel.h"
+#include "experimental/xrt_bo.h"
+
+/**
+ * Bandwidth test for xrt::bo::async_sync
+ *
+ * Measures host to device and device to host bandwidth of blocking
+ * syncs against chunked asynchronous syncs, and of a host to device
+ * transfer of one buffer overlapped with a device to host transfer
+ * of another.  Buffer content is verified after each round trip.
+ *
+ * The chunk size and the number of concurrent transfers are set with
+ * Runtime.bo_sync_chunk_size and Runtime.bo_sync_channels in xrt.ini.
+ */
+
+static const unsigned LOOP = 8;
+static const size_t BO_SIZE = 256 * 1024 * 1024;
+
+namespace {
+
+/**
+ * @return
+ *   nanoseconds since first call
+ */
+static unsigned long
+time_ns()
+{
+  static auto zero = std::chrono::high_resolution_clock::now();
+  auto now = std::chrono::high_resolution_clock::now();
+  auto integral_duration = std::chrono::duration_cast<std::chrono::nanoseconds>(now-zero).count();
+  return integral_duration;
+}
+
+static double
+mbps(size_t bytes, unsigned long ns)
+{
+  return ns ? (bytes / (1024.0 * 1024.0)) / (ns / 1000000000.0) : 0;
+}
+
+}
+
+static void usage()
+{
+    std::cout << "usage: %s [options] -k <bitstream>\n\n";
+    std::cout << "  -k <bitstream>\n";
+    std::cout << "  -d <index>\n";
+    std::cout << "  -r <num of repetitions, default is 8>\n";
+    std::cout << "  -v\n";
+    std::cout << "  -h\n\n";
+    std::cout << "* Bitstream is required\n";
+}
+
+static void
+init(xrt::bo& bo, unsigned int seed)
+{
+  auto data = bo.map<unsigned int*>();
+  for (size_t w=0; w<BO_SIZE/sizeof(unsigned int); ++w)
+    data[w] = seed + static_cast<unsigned int>(w);
+}
+
+static void
+verify(xrt::bo& bo, unsigned int seed)
+{
+  auto data = bo.map<unsigned int*>();
+  for (size_t w=0; w<BO_SIZE/sizeof(unsigned int); ++w)
+    if (data[w] != seed + static_cast<unsigned int>(w))
+      throw std::runtime_error("data mismatch at word " + std::to_string(w));
+}
+
+static void
+run(const xrt::device& device, const xrt::uuid& uuid, unsigned int n_runs, bool verbose)
+{
+  auto kernel = xrt::kernel(device, uuid.get(), "hello");
+  auto bo_a = xrt::bo(device, BO_SIZE, kernel.group_id(0));
+  auto bo_b = xrt::bo(device, BO_SIZE, kernel.group_id(0));
+  size_t bytes = static_cast<size_t>(n_runs) * BO_SIZE;
+
+  // blocking syncs
+  init(bo_a, 1);
+  unsigned long h2d = 0, d2h = 0;
+  for (unsigned int i=0; i<n_runs; ++i) {
+    auto start = time_ns();
+    bo_a.sync(XCL_BO_SYNC_BO_TO_DEVICE);
+    h2d += time_ns() - start;
+    std::memset(bo_a.map(), 0, BO_SIZE);
+    start = time_ns();
+    bo_a.sync(XCL_BO_SYNC_BO_FROM_DEVICE);
+    d2h += time_ns() - start;
+    verify(bo_a, 1);
+  }
+  std::cout << "sync:        h2d " << mbps(bytes, h2d) << " MB/s, d2h " << mbps(bytes, d2h) << " MB/s\n";
+
+  // chunked asynchronous syncs
+  init(bo_a, 2);
+  h2d = d2h = 0;
+  for (unsigned int i=0; i<n_runs; ++i) {
+    std::atomic<size_t> progress{0};
+    auto start = time_ns();
+    bo_a.async_sync(XCL_BO_SYNC_BO_TO_DEVICE, BO_SIZE, 0, [&progress](size_t done) { progress = done; }).wait();
+    h2d += time_ns() - start;
+    if (progress != BO_SIZE)
+      throw std::runtime_error("progress reported " + std::to_string(progress) + " bytes");
+    std::memset(bo_a.map(), 0, BO_SIZE);
+    start = time_ns();
+    bo_a.async_sync(XCL_BO_SYNC_BO_FROM_DEVICE).wait();
+    d2h += time_ns() - start;
+    verify(bo_a, 2);
+  }
+  std::cout << "async_sync:  h2d " << mbps(bytes, h2d) << " MB/s, d2h " << mbps(bytes, d2h) << " MB/s\n";
+
+  // h2d of one buffer overlapped with d2h of another
+  init(bo_b, 3);
+  bo_b.sync(XCL_BO_SYNC_BO_TO_DEVICE);
+  unsigned long sequential = 0, overlapped = 0;
+  for (unsigned int i=0; i<n_runs; ++i) {
+    auto start = time_ns();
+    bo_a.sync(XCL_BO_SYNC_BO_TO_DEVICE);
+    bo_b.sync(XCL_BO_SYNC_BO_FROM_DEVICE);
+    sequential += time_ns() - start;
+
+    std::memset(bo_b.map(), 0, BO_SIZE);
+    start = time_ns();
+    auto ev_a = bo_a.async_sync(XCL_BO_SYNC_BO_TO_DEVICE);
+    auto ev_b = bo_b.async_sync(XCL_BO_SYNC_BO_FROM_DEVICE);
+    ev_a.wait();
+    ev_b.wait();
+    overlapped += time_ns() - start;
+    verify(bo_b, 3);
+  }
+  std::cout << "h2d + d2h:   sequential " << mbps(2 * bytes, sequential) << " MB/s, overlapped "
+            << mbps(2 * bytes, overlapped) << " MB/s\n";
+
+  if (verbose)
+    std::cout << "buffer size " << BO_SIZE / (1024 * 1024) << " MB, " << n_runs << " repetitions\n";
+}
+
+int
+run(int argc, char** argv)
+{
+  if (argc < 3) {
+    usage();
+    return 1;
+  }
+
+  std::string xclbin_fnm;
+  bool verbose = false;
+  unsigned int device_index = 0;
+  unsigned int num_runs = LOOP;
+
+  std::vector<std::string> args(argv+1,argv+argc);
+  std::string cur;
+  for (auto& arg : args) {
+    if (arg == "-h") {
+      usage();
+      return 1;
+    }
+    else if (arg == "-v") {
+      verbose = true;
+      continue;
+    }
+
+    if (arg[0] == '-') {
+      cur = arg;
+      continue;
+    }
+
+    if (cur == "-k")
+      xclbin_fnm = arg;
+    else if (cur == "-d")
+      device_index = std::stoi(arg);
+    else if (cur == "-r")
+      num_runs = std::stoi(arg);
+    else
+      throw std::runtime_error("Unknown option value " + cur + " " + arg);
+  }
+
+  if (xclbin_fnm.empty())
+    throw std::runtime_error("FAILED_TEST\nNo xclbin specified");
+
+  auto device = xrt::device(device_index);
+  auto uuid = device.load_xclbin(xclbin_fnm);
+
+  run(device, uuid, num_runs, verbose);
+  return 0;
+}
+
+int
+main(int argc, char** argv)
+{
+  try {
+    auto ret = run(argc, argv);
+    std::cout << "PASSED TEST\n";
+    return ret;
+  }
+  catch (std::exception const& e) {
+    std::cout << "Exception: " << e.what() << "\n";
+    std::cout << "FAILED TEST\n";
+    return 1;
+  }
+
+  std::cout << "PASSED TEST\n";
+  return 0;
+}
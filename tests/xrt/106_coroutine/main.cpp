@@ -0,0 +1,243 @@
+/**
+ * Copyright (C) 2020 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "experimental/xrt_device.h"
+#include "experimental/xrt_kernel.h"
+#include "experimental/xrt_bo.h"
+#include "experimental/xrt_coroutine.h"
+
+/**
+ * Testcase for the coroutine adapters in xrt_coroutine.h
+ *
+ * A single thread drives many concurrent coroutines, each of which
+ * repeatedly syncs its buffer to the device, runs the hello kernel,
+ * and syncs the buffer back from the device.  No thread is blocked
+ * waiting for a run or a sync.  Throughput is compared with the same
+ * sequence of operations done with blocking calls on one thread.
+ */
+
+static const unsigned LOOP = 16;
+static const unsigned COROUTINES = 256;
+static const size_t BO_SIZE = 1024;
+
+namespace {
+
+/**
+ * @return
+ *   nanoseconds since first call
+ */
+static unsigned long
+time_ns()
+{
+  static auto zero = std::chrono::high_resolution_clock::now();
+  auto now = std::chrono::high_resolution_clock::now();
+  auto integral_duration = std::chrono::duration_cast<std::chrono::nanoseconds>(now-zero).count();
+  return integral_duration;
+}
+
+// Coroutine type that starts immediately and is not awaited
+struct detached
+{
+  struct promise_type
+  {
+    detached get_return_object() { return {}; }
+    std::suspend_never initial_suspend() noexcept { return {}; }
+    std::suspend_never final_suspend() noexcept { return {}; }
+    void return_void() {}
+    void unhandled_exception() { std::terminate(); }
+  };
+};
+
+struct shared_state
+{
+  xrt::coro::run_loop loop;
+  std::atomic<unsigned> remaining {0};
+  std::atomic<bool> error {false};
+  std::string message;
+};
+
+}
+
+static void usage()
+{
+    std::cout << "usage: %s [options] -k <bitstream>\n\n";
+    std::cout << "  -k <bitstream>\n";
+    std::cout << "  -d <index>\n";
+    std::cout << "  -r <num of iterations per coroutine, default is 16>\n";
+    std::cout << "  -c <num of coroutines, default is 256>\n";
+    std::cout << "  -v\n";
+    std::cout << "  -h\n\n";
+    std::cout << "* Bitstream is required\n";
+}
+
+static bool
+verify(xrt::bo& bo)
+{
+  auto bo_data = bo.map<char*>();
+  return std::strcmp(bo_data, "Hello World\n") == 0;
+}
+
+static detached
+worker(xrt::kernel& kernel, xrt::bo& bo, unsigned int n_runs, shared_state& state)
+{
+  try {
+    auto run = xrt::run(kernel);
+    run.set_arg(0, bo);
+    for (unsigned int i=0; i<n_runs && !state.error; ++i) {
+      std::memset(bo.map(), 0, BO_SIZE);
+      co_await xrt::coro::sync(bo, XCL_BO_SYNC_BO_TO_DEVICE, state.loop);
+
+      auto s = co_await xrt::coro::start(run, state.loop);
+      if (s != ERT_CMD_STATE_COMPLETED)
+        throw std::runtime_error("run completed with state " + std::to_string(s));
+
+      co_await xrt::coro::sync(bo, XCL_BO_SYNC_BO_FROM_DEVICE, state.loop);
+      if (!verify(bo))
+        throw std::runtime_error("unexpected buffer content");
+    }
+  }
+  catch (const std::exception& ex) {
+    if (!state.error.exchange(true))
+      state.message = ex.what();
+  }
+
+  // the loop thread is the only thread resuming coroutines
+  if (--state.remaining == 0)
+    state.loop.stop();
+}
+
+static void
+run(const xrt::device& device, const xrt::uuid& uuid, unsigned int n_runs, unsigned int n_coroutines, bool verbose)
+{
+  auto kernel = xrt::kernel(device, uuid.get(), "hello");
+  std::vector<xrt::bo> bos;
+  for (unsigned int i=0; i<n_coroutines; ++i)
+    bos.emplace_back(device, BO_SIZE, kernel.group_id(0));
+
+  // blocking calls on one thread
+  auto start = time_ns();
+  {
+    auto run = xrt::run(kernel);
+    run.set_arg(0, bos[0]);
+    for (unsigned int i=0; i<n_runs * n_coroutines; ++i) {
+      bos[0].sync(XCL_BO_SYNC_BO_TO_DEVICE);
+      run.start();
+      run.wait();
+      bos[0].sync(XCL_BO_SYNC_BO_FROM_DEVICE);
+    }
+  }
+  auto blocking = time_ns() - start;
+
+  // coroutines driven by one thread
+  shared_state state;
+  state.remaining = n_coroutines;
+  start = time_ns();
+  for (unsigned int i=0; i<n_coroutines; ++i)
+    worker(kernel, bos[i], n_runs, state);
+  state.loop.run();
+  auto coroutines = time_ns() - start;
+
+  if (state.error)
+    throw std::runtime_error(state.message);
+
+  double total = static_cast<double>(n_runs) * n_coroutines;
+  std::cout << "blocking:   " << total / (blocking / 1e9) << " iterations/s\n";
+  std::cout << "coroutines: " << total / (coroutines / 1e9) << " iterations/s"
+            << " (" << n_coroutines << " concurrent)\n";
+
+  if (verbose)
+    std::cout << "blocking " << blocking / 1000000 << " ms, coroutines "
+              << coroutines / 1000000 << " ms\n";
+}
+
+int
+run(int argc, char** argv)
+{
+  if (argc < 3) {
+    usage();
+    return 1;
+  }
+
+  std::string xclbin_fnm;
+  bool verbose = false;
+  unsigned int device_index = 0;
+  unsigned int num_runs = LOOP;
+  unsigned int num_coroutines = COROUTINES;
+
+  std::vector<std::string> args(argv+1,argv+argc);
+  std::string cur;
+  for (auto& arg : args) {
+    if (arg == "-h") {
+      usage();
+      return 1;
+    }
+    else if (arg == "-v") {
+      verbose = true;
+      continue;
+    }
+
+    if (arg[0] == '-') {
+      cur = arg;
+      continue;
+    }
+
+    if (cur == "-k")
+      xclbin_fnm = arg;
+    else if (cur == "-d")
+      device_index = std::stoi(arg);
+    else if (cur == "-r")
+      num_runs = std::stoi(arg);
+    else if (cur == "-c")
+      num_coroutines = std::stoi(arg);
+    else
+      throw std::runtime_error("Unknown option value " + cur + " " + arg);
+  }
+
+  if (xclbin_fnm.empty())
+    throw std::runtime_error("FAILED_TEST\nNo xclbin specified");
+
+  auto device = xrt::device(device_index);
+  auto uuid = device.load_xclbin(xclbin_fnm);
+
+  run(device, uuid, num_runs, num_coroutines, verbose);
+  return 0;
+}
+
+int
+main(int argc, char** argv)
+{
+  try {
+    auto ret = run(argc, argv);
+    std::cout << "PASSED TEST\n";
+    return ret;
+  }
+  catch (std::exception const& e) {
+    std::cout << "Exception: " << e.what() << "\n";
+    std::cout << "FAILED TEST\n";
+    return 1;
+  }
+
+  std::cout << "PASSED TEST\n";
+  return 0;
+}
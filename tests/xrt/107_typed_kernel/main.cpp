@@ -0,0 +1,210 @@
+/**
+ * Copyright (C) 2020 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "experimental/xrt_device.h"
+#include "experimental/xrt_kernel.h"
+#include "experimental/xrt_bo.h"
+
+/**
+ * Testcase for xrt::typed_kernel and the cost of setting arguments
+ *
+ * Reports ns per operation for
+ *  - construction of a run object
+ *  - set_arg on an existing run (untyped and typed)
+ *  - set_arg + start + wait of an existing run (untyped and typed)
+ * and verifies the kernel output when started through the typed
+ * kernel.  Construction of a typed kernel with a wrong signature
+ * must fail.
+ *
+ * Both typed and untyped set_arg use the command template, so this
+ * test does not measure the gain over the untemplated command setup;
+ * tests/xrt_kernel_cmd compares the two without a device.
+ */
+
+static const unsigned LOOP = 100000;
+static const size_t BO_SIZE = 1024;
+
+namespace {
+
+/**
+ * @return
+ *   nanoseconds since first call
+ */
+static unsigned long
+time_ns()
+{
+  static auto zero = std::chrono::high_resolution_clock::now();
+  auto now = std::chrono::high_resolution_clock::now();
+  auto integral_duration = std::chrono::duration_cast<std::chrono::nanoseconds>(now-zero).count();
+  return integral_duration;
+}
+
+}
+
+static void usage()
+{
+    std::cout << "usage: %s [options] -k <bitstream>\n\n";
+    std::cout << "  -k <bitstream>\n";
+    std::cout << "  -d <index>\n";
+    std::cout << "  -r <num of iterations, default is 100000>\n";
+    std::cout << "  -v\n";
+    std::cout << "  -h\n\n";
+    std::cout << "* Bitstream is required\n";
+}
+
+static void
+report(const std::string& what, unsigned long ns, unsigned int n)
+{
+  std::cout << what << ": " << static_cast<double>(ns) / n << " ns\n";
+}
+
+template <typename Function>
+static unsigned long
+measure(unsigned int n, Function&& f)
+{
+  auto start = time_ns();
+  for (unsigned int i=0; i<n; ++i)
+    f();
+  return time_ns() - start;
+}
+
+static void
+verify(xrt::bo& bo)
+{
+  bo.sync(XCL_BO_SYNC_BO_FROM_DEVICE);
+  auto bo_data = bo.map<char*>();
+  if (std::strcmp(bo_data, "Hello World\n"))
+    throw std::runtime_error("unexpected buffer content: " + std::string(bo_data));
+}
+
+static void
+run(const xrt::device& device, const xrt::uuid& uuid, unsigned int n_runs, bool verbose)
+{
+  auto kernel = xrt::kernel(device, uuid.get(), "hello");
+  auto bo = xrt::bo(device, BO_SIZE, kernel.group_id(0));
+  std::memset(bo.map(), 0, BO_SIZE);
+  bo.sync(XCL_BO_SYNC_BO_TO_DEVICE);
+
+  // hello kernel has one global argument
+  xrt::typed_kernel<xrt::bo> hello(kernel);
+
+  bool rejected = false;
+  try {
+    xrt::typed_kernel<int> bad(kernel);
+  }
+  catch (const std::runtime_error& ex) {
+    rejected = true;
+    if (verbose)
+      std::cout << "expected error: " << ex.what() << "\n";
+  }
+  if (!rejected)
+    throw std::runtime_error("typed kernel with wrong signature was constructed");
+
+  auto ns = measure(n_runs, [&] { xrt::run r(kernel); });
+  report("run construction", ns, n_runs);
+
+  auto run = xrt::run(kernel);
+  ns = measure(n_runs, [&] { run.set_arg(0, bo); });
+  report("set_arg untyped", ns, n_runs);
+
+  ns = measure(n_runs, [&] { hello.set_args(run, bo); });
+  report("set_arg typed", ns, n_runs);
+
+  ns = measure(n_runs, [&] { run.set_arg(0, bo); run.start(); run.wait(); });
+  report("set_arg + start + wait untyped", ns, n_runs);
+
+  std::memset(bo.map(), 0, BO_SIZE);
+  bo.sync(XCL_BO_SYNC_BO_TO_DEVICE);
+
+  ns = measure(n_runs, [&] { hello.start(run, bo); run.wait(); });
+  report("set_arg + start + wait typed", ns, n_runs);
+
+  verify(bo);
+}
+
+int
+run(int argc, char** argv)
+{
+  if (argc < 3) {
+    usage();
+    return 1;
+  }
+
+  std::string xclbin_fnm;
+  bool verbose = false;
+  unsigned int device_index = 0;
+  unsigned int num_runs = LOOP;
+
+  std::vector<std::string> args(argv+1,argv+argc);
+  std::string cur;
+  for (auto& arg : args) {
+    if (arg == "-h") {
+      usage();
+      return 1;
+    }
+    else if (arg == "-v") {
+      verbose = true;
+      continue;
+    }
+
+    if (arg[0] == '-') {
+      cur = arg;
+      continue;
+    }
+
+    if (cur == "-k")
+      xclbin_fnm = arg;
+    else if (cur == "-d")
+      device_index = std::stoi(arg);
+    else if (cur == "-r")
+      num_runs = std::stoi(arg);
+    else
+      throw std::runtime_error("Unknown option value " + cur + " " + arg);
+  }
+
+  if (xclbin_fnm.empty())
+    throw std::runtime_error("FAILED_TEST\nNo xclbin specified");
+
+  auto device = xrt::device(device_index);
+  auto uuid = device.load_xclbin(xclbin_fnm);
+
+  run(device, uuid, num_runs, verbose);
+  return 0;
+}
+
+int
+main(int argc, char** argv)
+{
+  try {
+    auto ret = run(argc, argv);
+    std::cout << "PASSED TEST\n";
+    return ret;
+  }
+  catch (std::exception const& e) {
+    std::cout << "Exception: " << e.what() << "\n";
+    std::cout << "FAILED TEST\n";
+    return 1;
+  }
+
+  std::cout << "PASSED TEST\n";
+  return 0;
+}
@@ -0,0 +1,250 @@
+/**
+ * Copyright (C) 2020 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "experimental/xrt_device.h"
+#include "experimental/xrt_kernel.h"
+#include "experimental/xrt_bo.h"
+
+/**
+ * Multi-threaded benchmark of the C API
+ *
+ * Each thread opens its own run handle of the hello kernel and
+ * repeatedly calls xrtRunStart / xrtRunWait.  A second phase calls
+ * xrtRunState, which does no device access, to measure the cost of
+ * resolving handles when all threads call into the C API at the same
+ * time.
+ */
+
+static const unsigned LOOP = 10000;
+static const unsigned THREADS = 32;
+static const size_t BO_SIZE = 1024;
+
+namespace {
+
+/**
+ * @return
+ *   nanoseconds since first call
+ */
+static unsigned long
+time_ns()
+{
+  static auto zero = std::chrono::high_resolution_clock::now();
+  auto now = std::chrono::high_resolution_clock::now();
+  auto integral_duration = std::chrono::duration_cast<std::chrono::nanoseconds>(now-zero).count();
+  return integral_duration;
+}
+
+}
+
+static void usage()
+{
+    std::cout << "usage: %s [options] -k <bitstream>\n\n";
+    std::cout << "  -k <bitstream>\n";
+    std::cout << "  -d <index>\n";
+    std::cout << "  -r <num of runs per thread, default is 10000>\n";
+    std::cout << "  -t <num of threads, default is 32>\n";
+    std::cout << "  -v\n";
+    std::cout << "  -h\n\n";
+    std::cout << "* Bitstream is required\n";
+}
+
+struct worker
+{
+  xrtKernelHandle kernel;
+  xrtBufferHandle bo = XRT_NULL_HANDLE;
+  xrtRunHandle run = XRT_NULL_HANDLE;
+  unsigned long start_wait_ns = 0;
+  unsigned long state_ns = 0;
+  bool error = false;
+
+  worker(xrtDeviceHandle device, xrtKernelHandle k)
+    : kernel(k)
+  {
+    bo = xrtBOAlloc(device, BO_SIZE, 0, xrtKernelArgGroupId(kernel, 0));
+    if (!bo)
+      throw std::runtime_error("xrtBOAlloc failed");
+    run = xrtRunOpen(kernel);
+    if (!run)
+      throw std::runtime_error("xrtRunOpen failed");
+    xrtRunSetArg(run, 0, bo);
+  }
+
+  ~worker()
+  {
+    if (run)
+      xrtRunClose(run);
+    if (bo)
+      xrtBOFree(bo);
+  }
+
+  void
+  operator() (unsigned int n_runs, std::atomic<bool>* go)
+  {
+    while (!*go)
+      ;
+
+    auto start = time_ns();
+    for (unsigned int i=0; i<n_runs; ++i) {
+      xrtRunStart(run);
+      if (xrtRunWait(run) != ERT_CMD_STATE_COMPLETED)
+        error = true;
+    }
+    start_wait_ns = time_ns() - start;
+
+    start = time_ns();
+    for (unsigned int i=0; i<n_runs; ++i)
+      if (xrtRunState(run) != ERT_CMD_STATE_COMPLETED)
+        error = true;
+    state_ns = time_ns() - start;
+  }
+};
+
+static void
+run(xrtDeviceHandle device, xrtKernelHandle kernel, unsigned int n_runs, unsigned int n_threads, bool verbose)
+{
+  std::vector<std::unique_ptr<worker>> workers;
+  for (unsigned int i=0; i<n_threads; ++i)
+    workers.emplace_back(new worker(device, kernel));
+
+  std::atomic<bool> go {false};
+  std::vector<std::thread> threads;
+  for (auto& w : workers)
+    threads.emplace_back(std::ref(*w), n_runs, &go);
+
+  auto start = time_ns();
+  go = true;
+  for (auto& t : threads)
+    t.join();
+  auto elapsed = time_ns() - start;
+
+  unsigned long start_wait_ns = 0;
+  unsigned long state_ns = 0;
+  for (auto& w : workers) {
+    if (w->error)
+      throw std::runtime_error("run did not complete");
+    start_wait_ns += w->start_wait_ns;
+    state_ns += w->state_ns;
+  }
+
+  double total = static_cast<double>(n_runs) * n_threads;
+  std::cout << n_threads << " threads, " << total / (elapsed / 1e9) << " runs/s\n";
+  std::cout << "xrtRunStart + xrtRunWait: " << start_wait_ns / total << " ns\n";
+  std::cout << "xrtRunState: " << state_ns / total << " ns\n";
+
+  if (verbose)
+    std::cout << "elapsed " << elapsed / 1000000 << " ms\n";
+}
+
+int
+run(int argc, char** argv)
+{
+  if (argc < 3) {
+    usage();
+    return 1;
+  }
+
+  std::string xclbin_fnm;
+  bool verbose = false;
+  unsigned int device_index = 0;
+  unsigned int num_runs = LOOP;
+  unsigned int num_threads = THREADS;
+
+  std::vector<std::string> args(argv+1,argv+argc);
+  std::string cur;
+  for (auto& arg : args) {
+    if (arg == "-h") {
+      usage();
+      return 1;
+    }
+    else if (arg == "-v") {
+      verbose = true;
+      continue;
+    }
+
+    if (arg[0] == '-') {
+      cur = arg;
+      continue;
+    }
+
+    if (cur == "-k")
+      xclbin_fnm = arg;
+    else if (cur == "-d")
+      device_index = std::stoi(arg);
+    else if (cur == "-r")
+      num_runs = std::stoi(arg);
+    else if (cur == "-t")
+      num_threads = std::stoi(arg);
+    else
+      throw std::runtime_error("Unknown option value " + cur + " " + arg);
+  }
+
+  if (xclbin_fnm.empty())
+    throw std::runtime_error("FAILED_TEST\nNo xclbin specified");
+
+  auto device = xrtDeviceOpen(device_index);
+  if (!device)
+    throw std::runtime_error("Failed to open device");
+
+  if (xrtDeviceLoadXclbinFile(device, xclbin_fnm.c_str()))
+    throw std::runtime_error("Failed to load xclbin");
+
+  xuid_t uuid;
+  xrtDeviceGetXclbinUUID(device, uuid);
+
+  auto kernel = xrtPLKernelOpen(device, uuid, "hello");
+  if (!kernel)
+    throw std::runtime_error("Failed to open kernel");
+
+  try {
+    run(device, kernel, num_runs, num_threads, verbose);
+  }
+  catch (...) {
+    xrtKernelClose(kernel);
+    xrtDeviceClose(device);
+    throw;
+  }
+
+  xrtKernelClose(kernel);
+  xrtDeviceClose(device);
+  return 0;
+}
+
+int
+main(int argc, char** argv)
+{
+  try {
+    auto ret = run(argc, argv);
+    std::cout << "PASSED TEST\n";
+    return ret;
+  }
+  catch (std::exception const& e) {
+    std::cout << "Exception: " << e.what() << "\n";
+    std::cout << "FAILED TEST\n";
+    return 1;
+  }
+
+  std::cout << "PASSED TEST\n";
+  return 0;
+}
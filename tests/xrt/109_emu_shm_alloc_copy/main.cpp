@@ -0,0 +1,238 @@
+/**
+ * Copyright (C) 2020 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <dlfcn.h>
+
+#include "experimental/xrt_device.h"
+#include "experimental/xrt_kernel.h"
+#include "experimental/xrt_bo.h"
+
+/**
+ * Testcase for sw_emu shared memory transport under concurrent
+ * buffer allocation.
+ *
+ * Copy threads repeatedly copy data to and from their own buffer
+ * with xclCopyBufferHost2Device and xclCopyBufferDevice2Host, which
+ * the sw_emu shim does not serialize with other device calls, while
+ * alloc threads repeatedly allocate, map and free buffers.  The test
+ * verifies the copied data.
+ *
+ * Run with XCL_EMULATION_MODE=sw_emu and an xrt.ini with
+ *   [Emulation]
+ *   shared_memory_transport=true
+ */
+
+static const unsigned LOOP = 2000;
+static const unsigned COPY_THREADS = 4;
+static const unsigned ALLOC_THREADS = 4;
+static const size_t BO_SIZE = 1024 * 1024;
+
+namespace {
+
+using copy_h2d_type = size_t (*)(xclDeviceHandle, uint64_t, const void*, size_t, size_t);
+using copy_d2h_type = size_t (*)(xclDeviceHandle, void*, uint64_t, size_t, size_t);
+
+copy_h2d_type copy_h2d = nullptr;
+copy_d2h_type copy_d2h = nullptr;
+
+// The copy functions are exported by the emulation shim, which is
+// loaded when the device is opened.  They are not declared in xrt.h
+// and have C++ linkage, so are looked up by their mangled names
+void
+load_copy_functions()
+{
+  void* shim = dlopen("libxrt_swemu.so", RTLD_NOW | RTLD_NOLOAD);
+  if (!shim)
+    throw std::runtime_error("sw_emu shim is not loaded, set XCL_EMULATION_MODE=sw_emu");
+  copy_h2d = reinterpret_cast<copy_h2d_type>(dlsym(shim, "_Z24xclCopyBufferHost2DevicePvmPKvmm"));
+  copy_d2h = reinterpret_cast<copy_d2h_type>(dlsym(shim, "_Z24xclCopyBufferDevice2HostPvS_mmm"));
+  if (!copy_h2d || !copy_d2h)
+    throw std::runtime_error("sw_emu shim does not export buffer copy functions");
+}
+
+}
+
+static void usage()
+{
+    std::cout << "usage: %s [options] -k <bitstream>\n\n";
+    std::cout << "  -k <bitstream>\n";
+    std::cout << "  -d <index>\n";
+    std::cout << "  -r <num of copy round trips per copy thread, default is 2000>\n";
+    std::cout << "  -t <num of copy threads, default is 4>\n";
+    std::cout << "  -h\n\n";
+    std::cout << "* Bitstream is required\n";
+}
+
+static void
+copy_thread(const xrt::device& device, int grpid, unsigned id, size_t n_runs, std::atomic<bool>& error)
+{
+  xclDeviceHandle handle = device;
+  auto bo = xrt::bo(device, BO_SIZE, grpid);
+  auto addr = bo.address();
+  auto words = BO_SIZE / sizeof(unsigned int);
+  std::vector<unsigned int> in(words), out(words);
+
+  for (size_t i=0; i<n_runs && !error; ++i) {
+    unsigned int seed = (id << 24) + static_cast<unsigned int>(i);
+    for (size_t w=0; w<words; ++w)
+      in[w] = seed + static_cast<unsigned int>(w);
+    if (copy_h2d(handle, addr, in.data(), BO_SIZE, 0) != BO_SIZE) {
+      std::cout << "copy thread " << id << " host to device copy failed\n";
+      error = true;
+      break;
+    }
+
+    std::fill(out.begin(), out.end(), 0);
+    if (copy_d2h(handle, out.data(), addr, BO_SIZE, 0) != BO_SIZE) {
+      std::cout << "copy thread " << id << " device to host copy failed\n";
+      error = true;
+      break;
+    }
+
+    if (out != in) {
+      std::cout << "copy thread " << id << " mismatch in round " << i << "\n";
+      error = true;
+    }
+  }
+}
+
+static void
+alloc_thread(const xrt::device& device, int grpid, const std::atomic<bool>& stop,
+             std::atomic<bool>& error, unsigned long& count)
+{
+  size_t size = 4096;
+  while (!stop && !error) {
+    auto bo = xrt::bo(device, size, grpid);
+    auto data = bo.map<char*>();
+    data[0] = 1;
+    ++count;
+    size = size < BO_SIZE ? size * 2 : 4096;
+  }
+}
+
+static void
+run(const xrt::device& device, const xrt::uuid& uuid, size_t n_runs, unsigned n_copy)
+{
+  auto kernel = xrt::kernel(device, uuid.get(), "hello");
+  auto grpid = kernel.group_id(0);
+  load_copy_functions();
+
+  std::atomic<bool> stop{false};
+  std::atomic<bool> error{false};
+  std::vector<unsigned long> allocs(ALLOC_THREADS, 0);
+
+  std::vector<std::thread> alloc_threads;
+  for (unsigned i=0; i<ALLOC_THREADS; ++i)
+    alloc_threads.emplace_back(alloc_thread, std::cref(device), grpid,
+                               std::cref(stop), std::ref(error), std::ref(allocs[i]));
+
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> copy_threads;
+  for (unsigned i=0; i<n_copy; ++i)
+    copy_threads.emplace_back(copy_thread, std::cref(device), grpid, i, n_runs, std::ref(error));
+
+  for (auto& t : copy_threads)
+    t.join();
+  auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+
+  stop = true;
+  for (auto& t : alloc_threads)
+    t.join();
+
+  unsigned long total = 0;
+  for (auto count : allocs)
+    total += count;
+
+  double mbytes = 2.0 * n_copy * n_runs * BO_SIZE / (1024 * 1024);
+  std::cout << "copies: " << mbytes << " MB in " << elapsed << " ms\n";
+  std::cout << "concurrent buffer alloc/free: " << total << "\n";
+
+  if (error)
+    throw std::runtime_error("copy failed or data mismatch");
+}
+
+int
+run(int argc, char** argv)
+{
+  if (argc < 3) {
+    usage();
+    return 1;
+  }
+
+  std::string xclbin_fnm;
+  unsigned int device_index = 0;
+  unsigned int num_runs = LOOP;
+  unsigned int num_copy = COPY_THREADS;
+
+  std::vector<std::string> args(argv+1,argv+argc);
+  std::string cur;
+  for (auto& arg : args) {
+    if (arg == "-h") {
+      usage();
+      return 1;
+    }
+
+    if (arg[0] == '-') {
+      cur = arg;
+      continue;
+    }
+
+    if (cur == "-k")
+      xclbin_fnm = arg;
+    else if (cur == "-d")
+      device_index = std::stoi(arg);
+    else if (cur == "-r")
+      num_runs = std::stoi(arg);
+    else if (cur == "-t")
+      num_copy = std::stoi(arg);
+    else
+      throw std::runtime_error("Unknown option value " + cur + " " + arg);
+  }
+
+  if (xclbin_fnm.empty())
+    throw std::runtime_error("FAILED_TEST\nNo xclbin specified");
+
+  auto device = xrt::device(device_index);
+  auto uuid = device.load_xclbin(xclbin_fnm);
+
+  run(device, uuid, num_runs, num_copy);
+  return 0;
+}
+
+int
+main(int argc, char** argv)
+{
+  try {
+    auto ret = run(argc, argv);
+    std::cout << "PASSED TEST\n";
+    return ret;
+  }
+  catch (std::exception const& e) {
+    std::cout << "Exception: " << e.what() << "\n";
+    std::cout << "FAILED TEST\n";
+    return 1;
+  }
+
+  std::cout << "PASSED TEST\n";
+  return 0;
+}
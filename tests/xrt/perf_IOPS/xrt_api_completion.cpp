@@ -0,0 +1,103 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+
+#include "experimental/xrt_device.h"
+#include "experimental/xrt_bo.h"
+#include "experimental/xrt_kernel.h"
+
+// Measure the host side cost of a command completion as a function
+// of the number of outstanding runs.  With a completion indexed
+// command monitor the cost per completion should stay flat as the
+// number of outstanding runs grows.
+
+void usage()
+{
+  std::cout  << "Usage: test -k <xclbin>\n";
+}
+
+double runTest(std::vector<xrt::run>& cmds, unsigned int outstanding, unsigned int total)
+{
+  unsigned int issued = 0, completed = 0, i = 0;
+  auto start = std::chrono::high_resolution_clock::now();
+
+  for (unsigned int idx = 0; idx < outstanding && issued < total; ++idx, ++issued)
+    cmds[idx].start();
+
+  while (completed < total) {
+    cmds[i].wait();
+
+    completed++;
+    if (issued < total) {
+      cmds[i].start();
+      issued++;
+    }
+
+    if (++i == outstanding)
+      i = 0;
+  }
+
+  auto end = std::chrono::high_resolution_clock::now();
+  return (std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)).count();
+}
+
+int testOutstanding(const xrt::device& device, const xrt::uuid& uuid)
+{
+  std::vector<unsigned int> outstanding_runs = { 16,64,256,1024,4096,16384 };
+  unsigned int total = 100000;
+
+  auto hello = xrt::kernel(device, uuid.get(), "hello");
+
+  std::vector<xrt::run> cmds;
+  for (unsigned int i = 0; i < outstanding_runs.back(); i++) {
+    auto run = xrt::run(hello);
+    run.set_arg(0, xrt::bo(device, 20, hello.group_id(0)));
+    cmds.push_back(std::move(run));
+  }
+  std::cout << "Allocated commands, expect " << outstanding_runs.back() << ", created " << cmds.size() << std::endl;
+
+  for (auto outstanding : outstanding_runs) {
+    double duration = runTest(cmds, outstanding, total);
+    std::cout << "Outstanding: " << std::setw(6) << outstanding
+              << " ns/completion: " << (duration / total)
+              << " iops: " << (total * 1000.0 * 1000.0 * 1000.0 / duration)
+              << std::endl;
+  }
+
+  return 0;
+}
+
+int _main(int argc, char* argv[])
+{
+  if (argc < 3 || argv[1] != std::string("-k")) {
+    usage();
+    return 1;
+  }
+
+  std::string xclbin_fn = argv[2];
+
+  printf("The system has %d device(s)\n", xclProbe());
+  auto device = xrt::device(0);
+  auto uuid = device.load_xclbin(xclbin_fn);
+
+  testOutstanding(device, uuid);
+
+  return 0;
+}
+
+int main(int argc, char *argv[])
+{
+  try {
+    _main(argc, argv);
+    return 0;
+  }
+  catch (const std::exception& ex) {
+    std::cout << "TEST FAILED: " << ex.what() << std::endl;
+  }
+  catch (...) {
+    std::cout << "TEST FAILED" << std::endl;
+  }
+
+  return 1;
+};
@@ -2,6 +2,7 @@
 #include <iomanip>
 #include <vector>
 #include <chrono>
+#include <thread>
 
 #include "experimental/xrt_device.h"
 #include "experimental/xrt_bo.h"
@@ -41,6 +42,73 @@ double runTest(std::vector<xrt::run>& cmds, unsigned int total)
   return (std::chrono::duration_cast<std::chrono::microseconds>(end - start)).count();
 }
 
+double runTestBatched(std::vector<xrt::run>& cmds, unsigned int total, unsigned int batch)
+{
+  unsigned int completed = 0;
+
+  // Partition the commands into lists of batch runs each
+  std::vector<xrt::run_list> lists;
+  for (unsigned int i = 0; i < cmds.size(); i += batch) {
+    xrt::run_list list;
+    for (unsigned int j = i; j < i + batch && j < cmds.size(); j++)
+      list.add(cmds[j]);
+    lists.push_back(std::move(list));
+  }
+
+  auto start = std::chrono::high_resolution_clock::now();
+
+  unsigned int issued = 0, i = 0;
+  for (auto& list : lists) {
+    list.start();
+    issued += list.size();
+    if (issued >= total)
+      break;
+  }
+
+  while (completed < total) {
+    lists[i].wait();
+
+    completed += lists[i].size();
+    if (issued < total) {
+      lists[i].start();
+      issued += lists[i].size();
+    }
+
+    if (++i == lists.size())
+      i = 0;
+  }
+
+  auto end = std::chrono::high_resolution_clock::now();
+  return (std::chrono::duration_cast<std::chrono::microseconds>(end - start)).count();
+}
+
+int testBatched(const xrt::device& device, const xrt::uuid& uuid)
+{
+  /* Commands are started in batches with xrt::run_list */
+  std::vector<unsigned int> batch_sizes = { 1,4,16,64,256 };
+  unsigned int total = 1000000;
+  int expected_cmds = 1024;
+
+  auto hello = xrt::kernel(device, uuid.get(), "hello");
+
+  std::vector<xrt::run> cmds;
+  for (int i = 0; i < expected_cmds; i++) {
+    auto run = xrt::run(hello);
+    run.set_arg(0, xrt::bo(device, 20, hello.group_id(0)));
+    cmds.push_back(std::move(run));
+  }
+
+  for (auto batch : batch_sizes) {
+    double duration = runTestBatched(cmds, total, batch);
+    std::cout << "Batch: " << std::setw(4) << batch
+              << " commands: " << total
+              << " iops: " << (total * 1000.0 * 1000.0 / duration)
+              << std::endl;
+  }
+
+  return 0;
+}
+
 int testSingleThread(const xrt::device& device, const xrt::uuid& uuid)
 {
   /* The command would incease */
@@ -68,6 +136,44 @@ int testSingleThread(const xrt::device& device, const xrt::uuid& uuid)
   return 0;
 }
 
+double createRuns(const xrt::kernel& kernel, unsigned int total)
+{
+  auto start = std::chrono::high_resolution_clock::now();
+
+  for (unsigned int i = 0; i < total; i++) {
+    auto run = xrt::run(kernel);
+  }
+
+  auto end = std::chrono::high_resolution_clock::now();
+  return (std::chrono::duration_cast<std::chrono::microseconds>(end - start)).count();
+}
+
+int testRunCreation(const xrt::device& device, const xrt::uuid& uuid)
+{
+  /* Throughput of creating and destroying runs, exercises exec buffer cache */
+  std::vector<unsigned int> threads_per_run = { 1,2,4,8 };
+  unsigned int runs_per_thread = 100000;
+
+  auto hello = xrt::kernel(device, uuid.get(), "hello");
+
+  for (auto num_threads : threads_per_run) {
+    std::vector<std::thread> threads;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (unsigned int t = 0; t < num_threads; t++)
+      threads.emplace_back(createRuns, std::cref(hello), runs_per_thread);
+    for (auto& thread : threads)
+      thread.join();
+    auto end = std::chrono::high_resolution_clock::now();
+    double duration = (std::chrono::duration_cast<std::chrono::microseconds>(end - start)).count();
+
+    std::cout << "Threads: " << std::setw(2) << num_threads
+              << " run creations/s: " << (num_threads * runs_per_thread * 1000.0 * 1000.0 / duration)
+              << std::endl;
+  }
+
+  return 0;
+}
+
 int _main(int argc, char* argv[])
 {
   if (argc < 3 || argv[1] != std::string("-k")) {
@@ -82,6 +188,8 @@ int _main(int argc, char* argv[])
   auto uuid = device.load_xclbin(xclbin_fn);
 
   testSingleThread(device, uuid);
+  testBatched(device, uuid);
+  testRunCreation(device, uuid);
 
   return 0;
 }